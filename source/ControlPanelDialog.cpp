@@ -3,6 +3,7 @@
 #include "core/Page.h"
 #include "core/ShortcutManager.h"
 #include "core/DocumentViewport.h"
+#include "core/CacheBudget.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -378,6 +379,11 @@ void ControlPanelDialog::applyChanges()
     settings.setValue("tools/wheelScrollSpeed", wheelSpeed);
     DocumentViewport::setWheelScrollSpeed(wheelSpeed);
 
+    if (predictedInkCheck) {
+        settings.setValue("tools/predictedInk", predictedInkCheck->isChecked());
+        DocumentViewport::setPredictedInkEnabled(predictedInkCheck->isChecked());
+    }
+
     if (ocrCjkGridModeCheck)
         settings.setValue("ocrCjkGridMode", ocrCjkGridModeCheck->isChecked());
 
@@ -391,6 +397,10 @@ void ControlPanelDialog::applyChanges()
     // Apply OCR language setting
     if (ocrLanguageCombo)
         settings.setValue("ocrLanguage", ocrLanguageCombo->currentData().toString());
+
+    // Apply render cache memory limit (saved by CacheBudget itself)
+    if (cacheBudgetSpin)
+        CacheBudget::instance()->setCeilingBytes(cacheBudgetSpin->value() * 1024LL * 1024LL);
 }
 
 /*
@@ -1125,6 +1135,25 @@ void ControlPanelDialog::createToolsTab()
 
     layout->addWidget(panGroup);
 
+    // --- Pen input group ---
+    QGroupBox *inkGroup = new QGroupBox(tr("Pen Input"), toolsTab);
+    QVBoxLayout *inkLayout = new QVBoxLayout(inkGroup);
+
+    predictedInkCheck = new QCheckBox(tr("Predict ink ahead of the pen"), inkGroup);
+    predictedInkCheck->setChecked(settings.value("tools/predictedInk", false).toBool());
+    inkLayout->addWidget(predictedInkCheck);
+
+    QLabel *inkHint = new QLabel(
+        tr("Draws a short estimate of where the pen is heading, so the ink keeps up with "
+           "the pen tip while writing. The estimate is replaced as the pen moves and is "
+           "never saved."),
+        inkGroup);
+    inkHint->setWordWrap(true);
+    inkHint->setStyleSheet("color: gray; font-size: 11px;");
+    inkLayout->addWidget(inkHint);
+
+    layout->addWidget(inkGroup);
+
     // --- OCR settings group ---
     QGroupBox *ocrGroup = new QGroupBox(tr("OCR (Handwriting Recognition)"), toolsTab);
     QVBoxLayout *ocrLayout = new QVBoxLayout(ocrGroup);
@@ -1861,6 +1890,30 @@ void ControlPanelDialog::createCacheTab() {
     warningLabel->setStyleSheet("font-size: 11px; color: #e74c3c; font-weight: bold;");
     layout->addWidget(warningLabel);
 
+    layout->addSpacing(30);
+
+    // Memory ceiling shared by all render caches (PDF pages, strokes, images, thumbnails)
+    QGroupBox *memoryGroup = new QGroupBox(tr("Render Cache Memory"), cacheTab);
+    QFormLayout *memoryLayout = new QFormLayout(memoryGroup);
+
+    cacheBudgetSpin = new QSpinBox(memoryGroup);
+    cacheBudgetSpin->setRange(CacheBudget::MIN_CEILING_MB, CacheBudget::MAX_CEILING_MB);
+    cacheBudgetSpin->setSingleStep(128);
+    cacheBudgetSpin->setSuffix(" MB");
+    cacheBudgetSpin->setValue(static_cast<int>(CacheBudget::instance()->ceilingBytes() / (1024 * 1024)));
+    memoryLayout->addRow(tr("Memory limit:"), cacheBudgetSpin);
+
+    QLabel *memoryNote = new QLabel(
+        tr("Rendered pages, strokes, images and thumbnails are freed, least recently used first, "
+           "once they use more than this. Lower it on devices with little RAM."),
+        memoryGroup
+    );
+    memoryNote->setWordWrap(true);
+    memoryNote->setStyleSheet("font-size: 11px; color: #7f8c8d;");
+    memoryLayout->addRow(memoryNote);
+
+    layout->addWidget(memoryGroup);
+
     // Add stretch to push everything to the top
     layout->addStretch();
 
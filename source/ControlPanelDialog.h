@@ -83,6 +83,7 @@ private:
     // === Tools tab ===
     QWidget *toolsTab;
     QDoubleSpinBox *wheelScrollSpeedSpin;
+    QCheckBox *predictedInkCheck = nullptr;
     QCheckBox *ocrCjkGridModeCheck = nullptr;
     void createToolsTab();
 
@@ -104,6 +105,7 @@ private:
 
     // === Cache tab ===
     QWidget *cacheTab;
+    QSpinBox *cacheBudgetSpin = nullptr;   ///< Render cache ceiling in MB (CacheBudget)
     void createCacheTab();
 
     // === About tab ===
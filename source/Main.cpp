@@ -265,6 +265,7 @@ static void applyAndroidFonts(QApplication& app)
 #include "ui/ToolbarButtonTests.h"
 #include "objects/LinkObjectTests.h"
 #include "pdf/MuPdfExporterTests.h"
+#include "strokes/StrokeOutlineBenchmark.h"
 #include "ui/ToolbarButtonTestWidget.h"
 #include "ocr/OcrRasterTests.h"
 #include "ocr/OcrGoldenTests.h"
@@ -617,6 +618,8 @@ static int runTests(const QString& testType)
         success = LinkObjectTests::runAllTests();
     } else if (testType == "pdfexporter") {
         success = MuPdfExporterTests::runAllTests();
+    } else if (testType == "outline") {
+        success = StrokeOutlineBenchmark::runAllTests();
     } else if (testType == "ocr-raster") {
         success = OcrRasterTests::runAllTests();
     } else if (testType == "ocr-golden") {
@@ -904,6 +907,8 @@ int main(int argc, char* argv[])
         QSettings toolSettings("SpeedyNote", "App");
         DocumentViewport::setWheelScrollSpeed(
             toolSettings.value("tools/wheelScrollSpeed", 40.0).toDouble());
+        DocumentViewport::setPredictedInkEnabled(
+            toolSettings.value("tools/predictedInk", false).toBool());
     }
 
     // ========== Initialize System Notifications ==========
@@ -952,6 +957,8 @@ int main(int argc, char* argv[])
             testToRun = "linkobject";
         } else if (arg == "--test-pdfexporter") {
             testToRun = "pdfexporter";
+        } else if (arg == "--bench-outline") {
+            testToRun = "outline";
         } else if (arg == "--test-ocr-raster") {
             testToRun = "ocr-raster";
         } else if (arg == "--test-ocr-golden") {
@@ -319,6 +319,21 @@ MainWindow::MainWindow(QWidget *parent)
     // Phase 3.1.1: Initialize DocumentManager
     m_documentManager = new DocumentManager(this);
     
+    // In-place saves write in the background; report a write that failed
+    // once it lands, and show the document as unsaved again.
+    connect(m_documentManager, &DocumentManager::documentSaveFailed, this,
+            [this](Document* doc, const QString& path) {
+        m_splitViewManager->forEachTabManager([doc](TabManager* tm, SplitViewManager::Pane) {
+            for (int i = 0; i < tm->tabCount(); ++i) {
+                if (tm->documentAt(i) == doc) {
+                    tm->markTabModified(i, true);
+                }
+            }
+        });
+        QMessageBox::critical(this, tr("Save Error"),
+            tr("Failed to save document to:\n%1").arg(path));
+    });
+    
     // Connect SplitViewManager signals (routes through active pane)
     connect(m_splitViewManager, &SplitViewManager::activeViewportChanged, this, [this](DocumentViewport* vp) {
         // MAC.1: Update ShortcutManager's active document scope so PagedOnly /
@@ -860,15 +875,11 @@ void MainWindow::setupUi() {
         DocumentViewport* vp = currentViewport();
         if (!vp || !vp->document()) return;
         
-        QString notesDir = vp->document()->notesPath();
-        if (notesDir.isEmpty()) return;
-        
-        QString filePath = notesDir + "/" + noteId + ".md";
         MarkdownNote note;
         note.id = noteId;
         note.title = title;
         note.content = content;
-        note.saveToFile(filePath);
+        vp->document()->saveNoteFile(note);
     });
     
     // Handle note deletion from sidebar - delete file and clear LinkSlot.
@@ -3774,8 +3785,11 @@ void MainWindow::saveDocument()
     syncDocumentPosition(doc, viewport);
             
     if (!existingPath.isEmpty() && !isUsingTemp) {
-        // ✅ Document was previously saved to permanent location - save in-place
-        if (!m_documentManager->saveDocument(doc)) {
+        // ✅ Document was previously saved to permanent location - save in-place.
+        // The files are written on a worker thread (documentSaveFailed reports
+        // a failed write); synchronous only if that cannot start.
+        if (!m_documentManager->saveDocumentInBackground(doc)
+            && !m_documentManager->saveDocument(doc)) {
             QMessageBox::critical(this, tr("Save Error"),
                 tr("Failed to save document to:\n%1").arg(existingPath));
         return;
@@ -5170,6 +5184,7 @@ void MainWindow::applyBackgroundSettings(Page::BackgroundType type, const QColor
             page->gridColor = gridColor;
             page->gridSpacing = gridSpacing;
             page->lineSpacing = lineSpacing;
+            doc->markPageDirty(i);
         }
     }
     
@@ -8024,7 +8039,9 @@ void MainWindow::autosavePositionOnlyChange(Document* doc, DocumentViewport* vp)
             qDebug() << "autosavePositionOnlyChange: persisting position for"
                      << doc->displayName();
 #endif
-            m_documentManager->saveDocument(doc);
+            if (!m_documentManager->saveDocumentInBackground(doc)) {
+                m_documentManager->saveDocument(doc);
+            }
         }
     }
 }
@@ -8812,10 +8829,9 @@ void MainWindow::navigateToLinkObject(const QString& linkObjectId)
 
 // Phase M.4: Search markdown notes across pages
 // Optimizations applied:
-//   A. Two-tier search: check description first (in memory), load file only if needed
+//   A. No page loads or file reads: links come from the document's link
+//      outline cache, note titles/bodies from its persistent note index
 //   B. Result limiting: stop after MAX_SEARCH_RESULTS
-//   C. (Future) Cancel flag for long searches
-//   D. (Connected below) Background thread via QtConcurrent
 
 static const int MAX_SEARCH_RESULTS = 100;  // Optimization B: Cap results
 
@@ -8832,95 +8848,60 @@ QList<NoteDisplayData> MainWindow::searchMarkdownNotes(const QString& query, int
     if (!vp || !vp->document()) return {};
     
     Document* doc = vp->document();
-    QString notesDir = doc->notesPath();
-    if (notesDir.isEmpty()) return {};
+    if (doc->notesPath().isEmpty()) return {};
     
-    bool reachedLimit = false;
-    int tilesSearched = 0;
+    // Every LinkObject with a markdown slot, including ones on pages/tiles
+    // that are not loaded. Edgeless mode ignores the page range.
+    const bool edgeless = doc->isEdgeless();
+    fromPage = qMax(0, fromPage);
+    toPage = qMin(toPage, doc->pageCount() - 1);
     
-    // Helper lambda to search a page/tile for notes matching query
-    auto searchPage = [&](Page* page) {
-        if (!page || reachedLimit) return;
+    QVector<LinkOutlineEntry> links = doc->enumerateLinkOutline();
+    if (!edgeless) {
+        std::stable_sort(links.begin(), links.end(),
+                         [](const LinkOutlineEntry& a, const LinkOutlineEntry& b) {
+                             return a.pageIndex < b.pageIndex;
+                         });
+    }
+    
+    for (const LinkOutlineEntry& link : links) {
+        if (results.size() >= MAX_SEARCH_RESULTS) break;
+        if (!edgeless && (link.pageIndex < fromPage || link.pageIndex > toPage)) continue;
+        
+        const bool descriptionMatch = link.description.contains(query, Qt::CaseInsensitive);
         
-        for (const auto& objPtr : page->objects) {
-            if (reachedLimit) break;
+        for (const LinkOutlineSlot& slot : link.markdownSlots) {
+            MarkdownNote note = doc->markdownNote(slot.noteId);
+            if (!note.isValid()) continue;
             
-            LinkObject* link = dynamic_cast<LinkObject*>(objPtr.get());
-            if (!link) continue;
+            int score = 0;
+            if (descriptionMatch) {
+                score += 100;  // Description match highest priority
+            }
+            if (note.title.contains(query, Qt::CaseInsensitive)) {
+                score += 75;   // Title match
+            }
+            if (note.content.contains(query, Qt::CaseInsensitive)) {
+                score += 50;   // Content match
+            }
             
-            for (int i = 0; i < LinkObject::SLOT_COUNT; ++i) {
-                const LinkSlot& slot = link->linkSlots[i];
-                if (slot.type != LinkSlot::Type::Markdown) continue;
-                
-                // Optimization A: Two-tier search
-                // Tier 1: Check description first (already in memory - no file I/O)
-                int score = 0;
-                bool descriptionMatch = link->description.contains(query, Qt::CaseInsensitive);
-                if (descriptionMatch) {
-                    score += 100;  // Description match highest priority
-                }
-                
-                // Tier 2: Load file for title/content matching
-                QString filePath = notesDir + "/" + slot.markdownNoteId + ".md";
-                MarkdownNote note = MarkdownNote::loadFromFile(filePath);
-                if (!note.isValid()) continue;
+            if (score > 0) {
+                NoteDisplayData displayData;
+                displayData.noteId = note.id;
+                displayData.title = note.title;
+                displayData.content = note.content;
+                displayData.linkObjectId = link.linkObjectId;
+                displayData.color = link.iconColor;
+                displayData.description = link.description;
                 
-                // Check title and content
-                if (note.title.contains(query, Qt::CaseInsensitive)) {
-                    score += 75;   // Title match
-                }
-                if (note.content.contains(query, Qt::CaseInsensitive)) {
-                    score += 50;   // Content match
-                }
+                results.append({displayData, score});
                 
-                if (score > 0) {
-                    NoteDisplayData displayData;
-                    displayData.noteId = note.id;
-                    displayData.title = note.title;
-                    displayData.content = note.content;
-                    displayData.linkObjectId = link->id;
-                    displayData.color = link->iconColor;
-                    displayData.description = link->description;
-                    
-                    results.append({displayData, score});
-                    
-                    // Optimization B: Stop after reaching limit
-                    if (results.size() >= MAX_SEARCH_RESULTS) {
-                        reachedLimit = true;
-                        break;
-                    }
+                // Optimization B: Stop after reaching limit
+                if (results.size() >= MAX_SEARCH_RESULTS) {
+                    break;
                 }
             }
         }
-    };
-    
-    if (doc->isEdgeless()) {
-        // Edgeless mode: search all loaded tiles (page range is ignored)
-        for (const auto& coord : doc->allLoadedTileCoords()) {
-            if (reachedLimit) break;
-            
-            // Optimization D: Process events periodically
-            if (++tilesSearched % 10 == 0) {
-                QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-            }
-            
-            Page* tile = doc->getTile(coord.first, coord.second);
-            searchPage(tile);
-        }
-    } else {
-        // Paged mode: search within page range
-        fromPage = qMax(0, fromPage);
-        toPage = qMin(toPage, doc->pageCount() - 1);
-        
-        for (int pageIdx = fromPage; pageIdx <= toPage && !reachedLimit; ++pageIdx) {
-            // Optimization D: Process events periodically
-            if (++tilesSearched % 10 == 0) {
-                QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-            }
-            
-            Page* page = doc->page(pageIdx);
-            searchPage(page);
-        }
     }
     
     // Sort by score descending
@@ -0,0 +1,183 @@
+// ============================================================================
+// CacheBudget - Implementation
+// ============================================================================
+
+#include "CacheBudget.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPair>
+#include <QSettings>
+#include <QTimer>
+
+#include <algorithm>
+
+CacheBudget* CacheBudget::s_instance = nullptr;
+
+namespace {
+constexpr const char* SETTINGS_KEY = "performance/cacheBudgetMB";
+}
+
+CacheBudget::CacheBudget(QObject* parent)
+    : QObject(parent)
+{
+#if defined(Q_OS_ANDROID) || defined(Q_OS_IOS)
+    const int defaultMb = MOBILE_DEFAULT_CEILING_MB;
+#else
+    const int defaultMb = DEFAULT_CEILING_MB;
+#endif
+    const int mb = QSettings("SpeedyNote", "App").value(SETTINGS_KEY, defaultMb).toInt();
+    m_ceilingBytes = qBound(MIN_CEILING_MB, mb, MAX_CEILING_MB) * 1024LL * 1024LL;
+
+    m_enforceTimer = new QTimer(this);
+    m_enforceTimer->setSingleShot(true);
+    m_enforceTimer->setInterval(ENFORCE_DELAY_MS);
+    connect(m_enforceTimer, &QTimer::timeout, this, [this]() {
+        enforce();
+    });
+}
+
+CacheBudget* CacheBudget::instance()
+{
+    if (!s_instance) {
+        s_instance = new CacheBudget();
+    }
+    return s_instance;
+}
+
+qint64 CacheBudget::nowMs()
+{
+    static QElapsedTimer s_clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return s_clock.elapsed();
+}
+
+// ===== Clients =====
+
+void CacheBudget::addClient(Client* client)
+{
+    if (client && !m_clients.contains(client)) {
+        m_clients.append(client);
+    }
+}
+
+void CacheBudget::removeClient(Client* client)
+{
+    m_clients.removeAll(client);
+}
+
+// ===== Ceiling =====
+
+void CacheBudget::setCeilingBytes(qint64 bytes)
+{
+    const qint64 mb = qBound<qint64>(MIN_CEILING_MB, bytes / (1024 * 1024), MAX_CEILING_MB);
+    m_ceilingBytes = mb * 1024 * 1024;
+    QSettings("SpeedyNote", "App").setValue(SETTINGS_KEY, static_cast<int>(mb));
+    enforce();
+}
+
+void CacheBudget::requestEnforce()
+{
+    if (!m_enforceTimer->isActive()) {
+        m_enforceTimer->start();
+    }
+}
+
+qint64 CacheBudget::enforce()
+{
+    // One entry per distinct item. Every client reaching a shared item holds
+    // a reference to it, so all of them must evict it to free the memory.
+    struct Candidate {
+        QVector<QPair<Client*, quint64>> owners;
+        qint64 bytes = 0;
+        qint64 lastUse = 0;
+        qreal rebuildCost = 1.0;
+        qreal score = 0.0;
+    };
+
+    QVector<Candidate> entries;
+    QHash<qint64, int> sharedIndex;
+    QVector<Item> items;
+    qint64 total = 0;
+
+    for (Client* client : m_clients) {
+        items.clear();
+        client->collectCacheItems(items);
+        for (const Item& item : items) {
+            if (item.bytes <= 0) {
+                continue;
+            }
+            if (item.sharedKey != 0) {
+                auto it = sharedIndex.constFind(item.sharedKey);
+                if (it != sharedIndex.constEnd()) {
+                    // Same page seen through another view: as protected as
+                    // its most recent use anywhere
+                    Candidate& entry = entries[it.value()];
+                    entry.owners.append({client, item.key});
+                    entry.lastUse = qMax(entry.lastUse, item.lastUse);
+                    entry.rebuildCost = qMax(entry.rebuildCost, item.rebuildCost);
+                    continue;
+                }
+                sharedIndex.insert(item.sharedKey, static_cast<int>(entries.size()));
+            }
+            Candidate entry;
+            entry.owners.append({client, item.key});
+            entry.bytes = item.bytes;
+            entry.lastUse = item.lastUse;
+            entry.rebuildCost = item.rebuildCost;
+            entries.append(std::move(entry));
+            total += item.bytes;
+        }
+    }
+
+    m_lastTotalBytes = total;
+    if (total <= m_ceilingBytes) {
+        return 0;
+    }
+
+    const qint64 now = nowMs();
+    QVector<Candidate> candidates;
+    for (Candidate& entry : entries) {
+        const qint64 idle = now - entry.lastUse;
+        if (idle < PROTECT_MS) {
+            continue;
+        }
+        entry.score = idle / qMax<qreal>(0.01, entry.rebuildCost);
+        candidates.append(std::move(entry));
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+
+    QHash<Client*, QVector<quint64>> victims;
+    qint64 freed = 0;
+    for (const Candidate& candidate : candidates) {
+        if (total - freed <= m_ceilingBytes) {
+            break;
+        }
+        for (const auto& owner : candidate.owners) {
+            victims[owner.first].append(owner.second);
+        }
+        freed += candidate.bytes;
+    }
+
+    for (auto it = victims.constBegin(); it != victims.constEnd(); ++it) {
+#ifdef SPEEDYNOTE_DEBUG
+        qDebug() << "CacheBudget: evicting" << it.value().size() << "items from"
+                 << it.key()->cacheName();
+#endif
+        it.key()->evictCacheItems(it.value());
+    }
+
+    m_lastTotalBytes = total - freed;
+
+#ifdef SPEEDYNOTE_DEBUG
+    qDebug() << "CacheBudget: freed" << (freed >> 20) << "MB, now"
+             << (m_lastTotalBytes >> 20) << "of" << (m_ceilingBytes >> 20) << "MB";
+#endif
+    return freed;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+// ============================================================================
+// CacheBudget - One memory ceiling for every render cache in the process
+// ============================================================================
+// Each cache keeps its own local limits (PDF cache capacity, tile keep
+// margins, thumbnail count, ...), but those cannot see each other: two split
+// views with several tabs each still add up past what a 4 GB tablet has.
+// CacheBudget enforces a single ceiling across all of them.
+//
+// Design:
+// - Caches register as Clients. When asked, a client lists its evictable
+//   items: bytes, time of last use (nowMs()) and a relative rebuild cost
+// - A check runs shortly after any client reports growth (requestEnforce(),
+//   coalesced). If the total is over the ceiling, items are evicted in
+//   cost-aware LRU order - idle time divided by rebuild cost, so a PDF page
+//   render idle for 4 s ranks with a stroke cache idle for 2 s - until the
+//   total fits again
+// - Items used within the last PROTECT_MS are the working set of what is on
+//   screen and are never evicted; evicting them would only rebuild them on
+//   the next paint
+// - Items reached through several clients (two views of one document share
+//   its pages) are counted once via Item::sharedKey. The merged item is as
+//   recent as its latest use by any client, and evicting it evicts it from
+//   every client that reported it
+// - The ceiling is a user setting (QSettings "performance/cacheBudgetMB")
+//
+// Thread safety: GUI thread only, except nowMs() which any thread may call.
+// ============================================================================
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class QTimer;
+
+class CacheBudget : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief One evictable cache entry, as reported by a client.
+     */
+    struct Item {
+        quint64 key = 0;                ///< Client-defined; passed back to evictCacheItems()
+        qint64 sharedKey = 0;           ///< QPixmap/QImage::cacheKey() of entries several
+                                        ///< clients can reach, counted once (0 = not shared)
+        qint64 bytes = 0;               ///< Memory held
+        qint64 lastUse = 0;             ///< nowMs() of the last use
+        qreal rebuildCost = 1.0;        ///< Relative cost of recreating it (COST_*)
+    };
+
+    /**
+     * @brief Interface implemented by each registered cache.
+     */
+    class Client {
+    public:
+        virtual ~Client() = default;
+
+        /// Short name for debug output.
+        virtual QString cacheName() const = 0;
+
+        /// Append every evictable item to @p items.
+        virtual void collectCacheItems(QVector<Item>& items) const = 0;
+
+        /// Drop the items with these keys (from the last collectCacheItems()).
+        virtual void evictCacheItems(const QVector<quint64>& keys) = 0;
+    };
+
+    // Relative rebuild costs; a rough ranking, not measurements.
+    static constexpr qreal COST_SCRATCH = 0.5;        ///< Reallocate a scratch buffer
+    static constexpr qreal COST_THUMBNAIL = 1.0;      ///< Small, rendered in the background
+    static constexpr qreal COST_OUTLINE_CACHE = 1.0;  ///< Rebuild stroke outlines from points
+    static constexpr qreal COST_STROKE_CACHE = 2.0;   ///< Re-rasterize a layer's strokes
+    static constexpr qreal COST_IMAGE_LEVEL = 2.0;    ///< Re-decode an image mip level
+    static constexpr qreal COST_DISPLAY_LIST = 3.0;   ///< Re-record a PDF page's display list
+    static constexpr qreal COST_PDF_RENDER = 4.0;     ///< Re-render a PDF page or tile
+
+    static constexpr int DEFAULT_CEILING_MB = 1024;
+    static constexpr int MOBILE_DEFAULT_CEILING_MB = 512;
+    static constexpr int MIN_CEILING_MB = 128;
+    static constexpr int MAX_CEILING_MB = 16384;
+
+    /// The shared instance.
+    static CacheBudget* instance();
+
+    /// Monotonic milliseconds, for Item::lastUse. Any thread.
+    static qint64 nowMs();
+
+    void addClient(Client* client);
+    void removeClient(Client* client);
+
+    /// Global ceiling in bytes.
+    qint64 ceilingBytes() const { return m_ceilingBytes; }
+
+    /**
+     * @brief Change the ceiling (clamped to MIN/MAX_CEILING_MB), save it to
+     *        the settings and enforce it right away.
+     */
+    void setCeilingBytes(qint64 bytes);
+
+    /// Schedule a check shortly (coalesced). Call after a cache grew.
+    void requestEnforce();
+
+    /**
+     * @brief Evict until the total fits under the ceiling.
+     * @return Bytes freed.
+     */
+    qint64 enforce();
+
+    /// Total reported by the last check.
+    qint64 lastTotalBytes() const { return m_lastTotalBytes; }
+
+private:
+    static constexpr int PROTECT_MS = 1000;        ///< Working set: never evicted
+    static constexpr int ENFORCE_DELAY_MS = 250;   ///< Coalescing window for requestEnforce()
+
+    explicit CacheBudget(QObject* parent = nullptr);
+
+    static CacheBudget* s_instance;
+
+    QVector<Client*> m_clients;
+    qint64 m_ceilingBytes = 0;
+    qint64 m_lastTotalBytes = 0;
+    QTimer* m_enforceTimer = nullptr;
+};
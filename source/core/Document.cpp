@@ -9,7 +9,9 @@
 #include "../objects/LinkObject.h"
 #include "../pdf/PdfMaterializer.h"
 #include <QCryptographicHash>
+#include <QSaveFile>
 #include <QSettings>
+#include <QtConcurrent>
 #include <cmath>
 #include <algorithm>  // Phase 5.4: for std::sort, std::greater in merge
 #include <functional>
@@ -41,7 +43,12 @@ Document::~Document()
     qDebug() << "Document DESTROYED:" << this << "id=" << id.left(8) 
              << "pages=" << m_pageOrder.size() << "tiles=" << m_tiles.size();
 #endif
-    // Note: m_loadedPages, m_tiles, and m_pdfProviders own unique_ptrs, auto-cleaned
+    // Note: m_loadedPages, m_tiles, and m_pdfProviders own smart pointers, auto-cleaned
+    
+    // A background save only writes its own snapshot; let it land
+    if (m_pendingSaveJob) {
+        m_pendingSave.waitForFinished();
+    }
     
     m_loadedPages.clear();
     m_tiles.clear();
@@ -213,7 +220,7 @@ PdfProvider* Document::providerForSource(const QString& sourceId) const
         return nullptr;
     }
 
-    std::unique_ptr<PdfProvider> provider = PdfProvider::create(path);
+    std::shared_ptr<PdfProvider> provider = PdfProvider::shared(path);
     if (!provider || !provider->isValid()) {
         if (PdfSource* mut = const_cast<Document*>(this)->pdfSourceById(s->id)) {
             mut->needsRelink = true;
@@ -259,7 +266,7 @@ bool Document::relinkSource(const QString& sourceId, const QString& newPath)
         return false;
     }
 
-    std::unique_ptr<PdfProvider> provider = PdfProvider::create(newPath);
+    std::shared_ptr<PdfProvider> provider = PdfProvider::shared(newPath);
     if (!provider || !provider->isValid()) {
         return false;
     }
@@ -549,7 +556,7 @@ bool Document::loadPdf(const QString& path)
     }
     
     // Try to load the PDF
-    std::unique_ptr<PdfProvider> provider = PdfProvider::create(path);
+    std::shared_ptr<PdfProvider> provider = PdfProvider::shared(path);
     
     if (!provider || !provider->isValid()) {
         return false;
@@ -649,14 +656,41 @@ QVector<QRect> Document::pdfImageRegions(const QString& sourceId, int pageIndex,
     return provider->imageRegions(providerPage, dpi);
 }
 
-void Document::trimPdfStore() const
+// =========================================================================
+// Search Index
+// =========================================================================
+
+PdfSearchIndex* Document::searchIndex() const
 {
-    for (const auto& [id, provider] : m_pdfProviders) {
-        Q_UNUSED(id);
-        if (provider && provider->isValid()) {
-            provider->trimStore();
+    if (!m_searchIndex) {
+        m_searchIndex = std::make_unique<PdfSearchIndex>();
+        if (!m_bundlePath.isEmpty()) {
+            m_searchIndex->load(m_bundlePath);
+        }
+    }
+    
+    // Pages name their source by id, or by an empty id for the primary
+    QHash<QString, QString> sourceHashes;
+    for (const PdfSource& s : m_pdfSources) {
+        sourceHashes.insert(s.id, s.hash);
+        if (s.primary) {
+            sourceHashes.insert(QString(), s.hash);
         }
     }
+    m_searchIndex->syncSourceHashes(sourceHashes);
+    
+    return m_searchIndex.get();
+}
+
+void Document::saveSearchIndex() const
+{
+    if (!m_searchIndex || m_bundlePath.isEmpty() || mode == Mode::Edgeless) {
+        return;
+    }
+    m_searchIndex->retainPages(QSet<QString>(m_pageOrder.begin(), m_pageOrder.end()));
+    if (m_searchIndex->isDirty()) {
+        m_searchIndex->save(m_bundlePath);
+    }
 }
 
 int Document::pdfPageCount() const
@@ -739,6 +773,22 @@ int Document::pdfPageIndexForNotebookPage(int notebookPageIndex) const
 
 bool Document::pdfBindingForNotebookPage(int notebookPageIndex, QString& outSourceId, int& outPdfPage) const
 {
+    // A page that is not in memory came from the manifest, whose maps are
+    // authoritative for it - answer from them instead of loading the page
+    // (the search index relies on this to skip pages without loading them).
+    if (notebookPageIndex >= 0 && notebookPageIndex < m_pageOrder.size()
+        && !isPageLoaded(notebookPageIndex)) {
+        const QString& uuid = m_pageOrder[notebookPageIndex];
+        auto pdfIt = m_pagePdfIndex.find(uuid);
+        if (pdfIt == m_pagePdfIndex.end() || pdfIt->second < 0) {
+            return false;
+        }
+        auto srcIt = m_pagePdfSource.find(uuid);
+        outSourceId = (srcIt != m_pagePdfSource.end()) ? srcIt->second : QString();
+        outPdfPage = pdfIt->second;
+        return true;
+    }
+    
     // Read live Page fields so this is correct even for pages imported at runtime
     // (D1/D2), whose (sourceId, pdfPageNumber) may not yet be mirrored into the
     // manifest maps. Empty sourceId means the document's primary source.
@@ -1181,10 +1231,21 @@ bool Document::loadPageFromDisk(int index) const
     }
     
     QString uuid = m_pageOrder[index];
+    if (m_unreadableStrokes.count(uuid) > 0) {
+        return false;  // Reported once; see unreadableStrokeFiles()
+    }
     QString pagePath = m_bundlePath + "/pages/" + uuid + ".json";
     
-    QFile file(pagePath);
-    if (!file.open(QIODevice::ReadOnly)) {
+    LoadRequest request;
+    request.key = uuid;
+    request.path = pagePath;
+    request.bundlePath = m_bundlePath;
+    request.bundleVersion = m_loadedBundleVersion;
+    request.epoch = m_evictionEpoch;
+    request.valid = true;
+    
+    LoadedData data = readPageData(request);
+    if (data.fileMissing) {
         // File doesn't exist - check if we can synthesize a pristine PDF page
         auto pdfIt = m_pagePdfIndex.find(uuid);
         if (pdfIt != m_pagePdfIndex.end()) {
@@ -1222,6 +1283,7 @@ bool Document::loadPageFromDisk(int index) const
             page->lineSpacing = defaultLineSpacing;
             
             m_loadedPages[uuid] = std::move(page);
+            m_evictedAtEpoch.remove(uuid);
             
 #ifdef SPEEDYNOTE_DEBUG
             qDebug() << "Synthesized pristine PDF page" << index << "(" << uuid.left(8) << ")";
@@ -1234,42 +1296,132 @@ bool Document::loadPageFromDisk(int index) const
         return false;
     }
     
-    QByteArray data = file.readAll();
+    return installPageData(std::move(data));
+}
+
+Document::LoadRequest Document::pageLoadRequest(int index) const
+{
+    LoadRequest request;
+    if (m_bundlePath.isEmpty() || index < 0 || index >= m_pageOrder.size()) {
+        return request;
+    }
+    
+    const QString& uuid = m_pageOrder[index];
+    if (m_loadedPages.find(uuid) != m_loadedPages.end() || m_unreadableStrokes.count(uuid) > 0) {
+        return request;
+    }
+    
+    request.key = uuid;
+    request.path = m_bundlePath + "/pages/" + uuid + ".json";
+    request.bundlePath = m_bundlePath;
+    request.bundleVersion = m_loadedBundleVersion;
+    request.epoch = m_evictionEpoch;
+    // No file: a pristine PDF page, synthesized from the manifest by page()
+    request.valid = QFileInfo::exists(request.path);
+    return request;
+}
+
+Document::LoadedData Document::readPageData(const LoadRequest& request)
+{
+    LoadedData data;
+    data.request = request;
+    
+    QFile file(request.path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        data.fileMissing = true;
+        return data;
+    }
+    
+    QByteArray bytes = file.readAll();
     file.close();
     
     QJsonParseError parseError;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &parseError);
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(bytes, &parseError);
     if (parseError.error != QJsonParseError::NoError) {
         qWarning() << "Cannot load page: JSON parse error" << parseError.errorString();
-        return false;
+        return data;
     }
     
-    auto page = Page::fromJson(jsonDoc.object());
+    const QJsonObject pageObj = jsonDoc.object();
+    auto page = Page::fromJson(pageObj);
     if (!page) {
         qWarning() << "Cannot load page: Page::fromJson failed";
-        return false;
+        return data;
+    }
+    
+    StrokeBinaryCodec::LayerStrokes sidecarStrokes;
+    const StrokeStore store = readStrokeSidecarFile(pageObj, request.path, request.bundleVersion,
+                                                    sidecarStrokes);
+    if (store == StrokeStore::Unreadable) {
+        data.strokesUnreadable = true;
+        return data;
+    }
+    if (store == StrokeStore::Sidecar) {
+        for (int i = 0; i < page->layerCount(); ++i) {
+            VectorLayer* layer = page->layer(i);
+            auto strokesIt = sidecarStrokes.find(layer->id);
+            if (strokesIt != sidecarStrokes.end()) {
+                layer->setStrokes(std::move(strokesIt.value()));
+            }
+        }
+    } else {
+        // Inline-JSON strokes from an older bundle: rewrite on next save.
+        for (const auto& layer : page->vectorLayers) {
+            if (!layer->isEmpty()) {
+                data.legacyStrokes = true;
+                break;
+            }
+        }
     }
     
     // Phase O2 (BF.3): Load image objects from assets folder.
     // Page::fromJson() only sets imagePath; it does NOT load the actual pixmap.
-    // We must call loadImages() to load image files into memory for rendering.
-    int imagesLoaded = page->loadImages(m_bundlePath);
+    // loadImages() reads the encoded bytes; pixels are decoded when drawn.
+    int imagesLoaded = page->loadImages(request.bundlePath);
     if (imagesLoaded > 0) {
         #ifdef SPEEDYNOTE_DEBUG
-        qDebug() << "loadPageFromDisk: Loaded" << imagesLoaded << "images for page" << index;
+        qDebug() << "readPageData: Loaded" << imagesLoaded << "images for page" << request.key.left(8);
         #endif
     }
     
+    data.page = std::move(page);
+    return data;
+}
+
+bool Document::installPageData(LoadedData&& data) const
+{
+    const QString uuid = data.request.key;
+    if (data.strokesUnreadable) {
+        markStrokesUnreadable(uuid, data.request.path);
+        return false;
+    }
+    if (!data.page) {
+        return false;
+    }
+    
+    // Stale: deleted, loaded synchronously, or evicted (and saved) meanwhile
+    const int index = pageIndexByUuid(uuid);
+    if (index < 0 || m_loadedPages.find(uuid) != m_loadedPages.end()
+        || m_evictedAtEpoch.value(uuid, 0) > data.request.epoch) {
+        return false;
+    }
+    
+    if (data.legacyStrokes) {
+        m_legacyStrokePages.insert(uuid);
+    }
+    
     // Phase O1.5: Update max object extent from loaded objects
-    for (const auto& object : page->objects) {
+    for (const auto& object : data.page->objects) {
         int extent = static_cast<int>(qMax(object->size.width(), object->size.height()));
         if (extent > m_maxObjectExtent) {
             m_maxObjectExtent = extent;
         }
     }
     
-    Page* rawPagePtr = page.get();
-    m_loadedPages[uuid] = std::move(page);
+    Page* rawPagePtr = data.page.get();
+    m_loadedPages[uuid] = std::move(data.page);
+    // Older reads still in flight now fail the loaded check instead
+    m_evictedAtEpoch.remove(uuid);
     
     // Load OCR sidecar data and materialize text objects
     loadPageOcr(rawPagePtr, uuid);
@@ -1291,6 +1443,9 @@ bool Document::savePage(int index)
         return false;
     }
     
+    // Never race a background write of the same file with an older snapshot
+    completeBackgroundSave();
+    
     if (index < 0 || index >= m_pageOrder.size()) {
         return false;
     }
@@ -1304,23 +1459,21 @@ bool Document::savePage(int index)
     // Ensure pages directory exists
     QDir().mkpath(m_bundlePath + "/pages");
     
-    QString pagePath = m_bundlePath + "/pages/" + uuid + ".json";
-    QFile file(pagePath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Cannot save page:" << pagePath;
+    if (!writePageFiles(m_bundlePath, uuid, it->second.get())) {
         return false;
     }
     
-    QJsonDocument jsonDoc(it->second->toJson());
-    file.write(jsonDoc.toJson(QJsonDocument::Compact));
-    file.close();
+    // Clear dirty flag (before the OCR sidecar, which indexes clean pages
+    // only). The written edits are a new saved state of the page, so it
+    // moves to a new revision as in prepareSave(); the next manifest
+    // records it.
+    if (m_dirtyPages.erase(uuid) > 0) {
+        ++m_pageRevisions[uuid];
+    }
     
     // Save OCR sidecar file
     savePageOcr(uuid, it->second.get());
     
-    // Clear dirty flag
-    m_dirtyPages.erase(uuid);
-    
     // Update metadata
     m_pageMetadata[uuid] = it->second->size;
     
@@ -1334,6 +1487,141 @@ bool Document::savePage(int index)
     return true;
 }
 
+bool Document::writePageFiles(const QString& bundlePath, const QString& uuid,
+                              const Page* page) const
+{
+    if (!writeSaveFile(pageSaveFile(bundlePath, uuid, page))) {
+        qWarning() << "Cannot save page:" << uuid;
+        return false;
+    }
+    
+    // Keep the search index in step with the page on disk
+    searchIndex()->setText(PdfSearchIndex::pageKey(uuid), PdfSearchIndex::pageText(page));
+    
+    m_legacyStrokePages.erase(uuid);
+    return true;
+}
+
+Document::SaveFile Document::pageSaveFile(const QString& bundlePath, const QString& uuid,
+                                          const Page* page) const
+{
+    SaveFile file;
+    file.path = bundlePath + "/pages/" + uuid + ".json";
+    
+    // Strokes go to the binary sidecar; the JSON only carries the marker.
+    // The stroke lists are implicitly shared, so copying them here is cheap
+    // and edits after the snapshot detach instead of racing the writer.
+    file.strokes.reserve(page->layerCount());
+    for (int i = 0; i < page->layerCount(); ++i) {
+        const VectorLayer* layer = page->layer(i);
+        file.strokes.append(qMakePair(layer->id, layer->strokes()));
+    }
+    
+    file.json = page->toJson(/*includeStrokes=*/false);
+    file.json["stroke_store"] = StrokeBinaryCodec::storeMarker();
+    return file;
+}
+
+bool Document::writeSaveFile(const SaveFile& file)
+{
+    QVector<StrokeBinaryCodec::LayerBlock> blocks;
+    blocks.reserve(file.strokes.size());
+    bool hasStrokes = false;
+    for (const auto& layer : file.strokes) {
+        blocks.append(StrokeBinaryCodec::LayerBlock{layer.first, &layer.second});
+        hasStrokes = hasStrokes || !layer.second.isEmpty();
+    }
+    const QString sidecarPath = strokeSidecarPath(file.path);
+    
+    // Sidecar first: a JSON must never point at strokes that were not written.
+    // Without strokes the JSON drops the marker instead, so a marker whose
+    // sidecar is missing always means a damaged bundle (never "no strokes").
+    QJsonObject json = file.json;
+    if (hasStrokes) {
+        if (!writeStrokeSidecar(sidecarPath, blocks)) {
+            return false;
+        }
+    } else {
+        json.remove("stroke_store");
+    }
+    
+    QSaveFile out(file.path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot open for writing:" << file.path;
+        return false;
+    }
+    out.write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+    if (!out.commit()) {
+        qWarning() << "Cannot write:" << file.path << out.errorString();
+        return false;
+    }
+    
+    // Only once no JSON refers to it any more
+    if (!hasStrokes) {
+        QFile::remove(sidecarPath);
+    }
+    return true;
+}
+
+QString Document::strokeSidecarPath(const QString& jsonPath)
+{
+    QString path = jsonPath;
+    if (path.endsWith(QLatin1String(".json"))) {
+        path.chop(5);
+    }
+    return path + StrokeBinaryCodec::fileSuffix();
+}
+
+bool Document::writeStrokeSidecar(const QString& path,
+                                  const QVector<StrokeBinaryCodec::LayerBlock>& layers)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot save stroke sidecar:" << path;
+        return false;
+    }
+    file.write(StrokeBinaryCodec::encode(layers));
+    if (!file.commit()) {
+        qWarning() << "Cannot save stroke sidecar:" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+Document::StrokeStore Document::readStrokeSidecarFile(const QJsonObject& containerJson,
+                                                      const QString& jsonPath, int bundleVersion,
+                                                      StrokeBinaryCodec::LayerStrokes& out)
+{
+    out.clear();
+    if (bundleVersion < BINARY_STROKES_BUNDLE_VERSION ||
+        containerJson["stroke_store"].toString() != StrokeBinaryCodec::storeMarker()) {
+        return StrokeStore::Inline;  // Legacy file, or a file without strokes
+    }
+    
+    QFile file(strokeSidecarPath(jsonPath));
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot load strokes: sidecar missing" << file.fileName();
+        return StrokeStore::Unreadable;
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+    
+    if (!StrokeBinaryCodec::decode(data, out)) {
+        qWarning() << "Cannot load strokes: corrupt or unsupported sidecar" << file.fileName();
+        out.clear();
+        return StrokeStore::Unreadable;
+    }
+    return StrokeStore::Sidecar;
+}
+
+void Document::markStrokesUnreadable(const QString& key, const QString& jsonPath) const
+{
+    if (m_unreadableStrokes.insert(key).second) {
+        m_unreadableStrokeFiles.append(strokeSidecarPath(jsonPath));
+        qWarning() << "Leaving" << key << "unloaded; its strokes cannot be read";
+    }
+}
+
 void Document::evictPage(int index)
 {
     if (index < 0 || index >= m_pageOrder.size()) {
@@ -1346,6 +1634,10 @@ void Document::evictPage(int index)
         return;  // Not loaded, nothing to evict
     }
     
+    // A background save may still be writing this page: once it is dropped
+    // from memory, the next load must read the new file
+    completeBackgroundSave();
+    
     // Save if dirty
     if (m_dirtyPages.count(uuid) > 0) {
         if (!savePage(index)) {
@@ -1356,6 +1648,7 @@ void Document::evictPage(int index)
     
     // Remove from memory
     m_loadedPages.erase(it);
+    m_evictedAtEpoch.insert(uuid, ++m_evictionEpoch);
     
 #ifdef SPEEDYNOTE_DEBUG
     qDebug() << "Evicted page" << index << "(" << uuid.left(8) << ") from memory";
@@ -1368,6 +1661,9 @@ void Document::markPageDirty(int index)
         return;
     }
     QString uuid = m_pageOrder[index];
+    if (m_unreadableStrokes.count(uuid) > 0) {
+        return;  // Never written over (see unreadableStrokeFiles())
+    }
     m_dirtyPages.insert(uuid);
     markModified();
 }
@@ -1381,6 +1677,15 @@ bool Document::isPageDirty(int index) const
     return m_dirtyPages.count(uuid) > 0;
 }
 
+quint32 Document::pageRevision(int index) const
+{
+    if (index < 0 || index >= m_pageOrder.size()) {
+        return 0;
+    }
+    auto it = m_pageRevisions.find(m_pageOrder[index]);
+    return (it != m_pageRevisions.end()) ? it->second : 0;
+}
+
 // =========================================================================
 // UUID→Index Cache (Phase C.0.2)
 // =========================================================================
@@ -1555,6 +1860,7 @@ bool Document::removePage(int index)
     
     // Remove metadata
     m_pageMetadata.erase(uuid);
+    m_evictedAtEpoch.remove(uuid);  // Page UUIDs are never reused
     
     // Remove PDF page index tracking
     m_pagePdfIndex.erase(uuid);
@@ -2229,6 +2535,9 @@ Page* Document::getOrCreateTile(int tx, int ty)
             // Phase 5.6.5: No sync needed - loadTileFromDisk reconstructs layers from manifest
             return m_tiles.at(coord).get();
         }
+        if (m_unreadableStrokes.count(QStringLiteral("%1,%2").arg(tx).arg(ty)) > 0) {
+            return nullptr;  // A new tile would overwrite the strokes on disk
+        }
     }
     
     // 3. Create new tile
@@ -2631,38 +2940,10 @@ QJsonObject Document::toJson() const
     return obj;
 }
 
-std::unique_ptr<Document> Document::fromJson(const QJsonObject& obj)
+std::vector<PdfSource> Document::pdfSourcesFromJson(const QJsonObject& obj)
 {
-    auto doc = std::make_unique<Document>();
-    
-    // Clear the auto-generated ID, we'll load it from JSON
-    doc->id = obj["notebook_id"].toString();
-    if (doc->id.isEmpty()) {
-        // Generate new ID if not present (legacy format)
-        doc->id = QUuid::createUuid().toString(QUuid::WithoutBraces);
-    }
-    
-    // NOTE: format_version is no longer read - use bundle_format_version instead
-    // Old files may have format_version but it's ignored for backward compatibility
-    
-    // Identity
-    doc->name = obj["name"].toString();
-    doc->author = obj["author"].toString();
-    
-    // Timestamps
-    QString createdStr = obj["created"].toString();
-    if (!createdStr.isEmpty()) {
-        doc->created = QDateTime::fromString(createdStr, Qt::ISODate);
-    }
-    QString modifiedStr = obj["last_modified"].toString();
-    if (!modifiedStr.isEmpty()) {
-        doc->lastModified = QDateTime::fromString(modifiedStr, Qt::ISODate);
-    }
+    std::vector<PdfSource> sources;
     
-    // Mode
-    doc->mode = stringToMode(obj["mode"].toString("paged"));
-    
-    // PDF reference (don't load yet, just store paths).
     // Prefer the multi-source pdf_sources[] when present; otherwise synthesize a single
     // primary source from the legacy top-level keys (with a fresh id).
     if (obj.contains("pdf_sources") && obj["pdf_sources"].isArray()) {
@@ -2686,25 +2967,25 @@ std::unique_ptr<Document> Document::fromJson(const QJsonObject& obj)
                     s.pageMap.insert(it.key().toInt(), it.value().toInt());
                 }
             }
-            doc->m_pdfSources.push_back(s);
+            sources.push_back(s);
         }
 
         // Resolve which source is primary. pdf_primary_id is authoritative when
         // present (empty value => genuinely no primary, e.g. an import-only doc).
         // When the key is absent (docs written before the explicit-primary change),
         // fall back to the historical convention that the front source is primary.
-        if (!doc->m_pdfSources.empty()) {
+        if (!sources.empty()) {
             if (obj.contains("pdf_primary_id")) {
                 const QString primaryId = obj["pdf_primary_id"].toString();
-                for (PdfSource& s : doc->m_pdfSources) {
+                for (PdfSource& s : sources) {
                     s.primary = (!primaryId.isEmpty() && s.id == primaryId);
                 }
             } else {
-                doc->m_pdfSources.front().primary = true;
+                sources.front().primary = true;
             }
         }
     }
-    if (doc->m_pdfSources.empty()) {
+    if (sources.empty()) {
         // Legacy / single-PDF: synthesize the primary from top-level keys.
         QString legacyPath = obj["pdf_path"].toString();
         QString legacyHash = obj["pdf_hash"].toString();
@@ -2718,15 +2999,53 @@ std::unique_ptr<Document> Document::fromJson(const QJsonObject& obj)
             s.hash = legacyHash;
             s.size = legacySize;
             s.primary = true;  // The document's own base PDF.
-            doc->m_pdfSources.push_back(s);
+            sources.push_back(s);
         }
-    } else if (const PdfSource* p = doc->primarySource()) {
+    } else {
         // Ensure the primary picks up the legacy relative-path mirror if the array
         // entry omitted it (older multi-source writes).
-        if (p->relativePath.isEmpty()) {
-            const_cast<PdfSource*>(p)->relativePath = obj["pdf_relative_path"].toString();
+        for (PdfSource& s : sources) {
+            if (s.primary && s.relativePath.isEmpty()) {
+                s.relativePath = obj["pdf_relative_path"].toString();
+            }
         }
     }
+    return sources;
+}
+
+std::unique_ptr<Document> Document::fromJson(const QJsonObject& obj)
+{
+    auto doc = std::make_unique<Document>();
+    
+    // Clear the auto-generated ID, we'll load it from JSON
+    doc->id = obj["notebook_id"].toString();
+    if (doc->id.isEmpty()) {
+        // Generate new ID if not present (legacy format)
+        doc->id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    }
+    
+    // NOTE: format_version is no longer read - use bundle_format_version instead
+    // Old files may have format_version but it's ignored for backward compatibility
+    
+    // Identity
+    doc->name = obj["name"].toString();
+    doc->author = obj["author"].toString();
+    
+    // Timestamps
+    QString createdStr = obj["created"].toString();
+    if (!createdStr.isEmpty()) {
+        doc->created = QDateTime::fromString(createdStr, Qt::ISODate);
+    }
+    QString modifiedStr = obj["last_modified"].toString();
+    if (!modifiedStr.isEmpty()) {
+        doc->lastModified = QDateTime::fromString(modifiedStr, Qt::ISODate);
+    }
+    
+    // Mode
+    doc->mode = stringToMode(obj["mode"].toString("paged"));
+    
+    // PDF reference (don't load yet, just store paths)
+    doc->m_pdfSources = pdfSourcesFromJson(obj);
     
     // State
     doc->lastAccessedPage = obj["last_accessed_page"].toInt(0);
@@ -2983,6 +3302,9 @@ bool Document::saveTile(TileCoord coord)
         return false;
     }
     
+    // Never race a background write of the same file with an older snapshot
+    completeBackgroundSave();
+    
     auto it = m_tiles.find(coord);
     if (it == m_tiles.end()) {
         qWarning() << "Cannot save tile: not loaded in memory" << coord.first << coord.second;
@@ -2990,44 +3312,57 @@ bool Document::saveTile(TileCoord coord)
     }
     
     // Ensure tiles directory exists
-    QString tilesDir = m_bundlePath + "/tiles";
-    QDir().mkpath(tilesDir);
-    
-    // Build tile file path
-    QString tilePath = tilesDir + "/" + 
-                       QString("%1,%2.json").arg(coord.first).arg(coord.second);
+    QDir().mkpath(m_bundlePath + "/tiles");
     
-    QFile file(tilePath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Cannot save tile: failed to open file" << tilePath;
+    const SaveFile file = tileSaveFile(m_bundlePath, coord, it->second.get());
+    if (!writeSaveFile(file)) {
+        qWarning() << "Cannot save tile" << coord.first << coord.second;
         return false;
     }
+    m_legacyStrokeTiles.erase(coord);
+    
+    // Save OCR sidecar file
+    saveTileOcr(coord);
+    
+    // Update state
+    m_dirtyTiles.erase(coord);
+    m_tileIndex.insert(coord);
+
+    // Outline cache: in-memory tile is authoritative and now saved.
+    refreshLinkOutlineFor(coord);
+
+#ifdef SPEEDYNOTE_DEBUG
+    qDebug() << "Saved tile" << coord.first << "," << coord.second << "to" << file.path;
+#endif
+    
+    return true;
+}
+
+Document::SaveFile Document::tileSaveFile(const QString& bundlePath, TileCoord coord,
+                                          const Page* tile) const
+{
+    SaveFile file;
+    file.path = bundlePath + "/tiles/" + 
+                QString("%1,%2.json").arg(coord.first).arg(coord.second);
     
     // Phase 5.6.3: For edgeless mode, use compact format:
     // - layers: array of {id, strokes} (layer properties stored in manifest)
     // - objects: array of InsertedObjects (Phase O2)
     // - coord_x, coord_y: tile coordinates for debugging
-    QJsonObject tileObj;
-    Page* tile = it->second.get();
-    
+    //
+    // Strokes themselves live in the binary sidecar (tiles/x,y.strokes).
     if (isEdgeless()) {
         QJsonArray layersArray;
         for (int i = 0; i < tile->layerCount(); ++i) {
-            VectorLayer* layer = tile->layer(i);
+            const VectorLayer* layer = tile->layer(i);
             if (layer && !layer->isEmpty()) {
                 QJsonObject layerObj;
                 layerObj["id"] = layer->id;
-                
-                QJsonArray strokesArray;
-                for (const auto& stroke : layer->strokes()) {
-                    strokesArray.append(stroke.toJson());
-                }
-                layerObj["strokes"] = strokesArray;
-                
                 layersArray.append(layerObj);
+                file.strokes.append(qMakePair(layer->id, layer->strokes()));
             }
         }
-        tileObj["layers"] = layersArray;
+        file.json["layers"] = layersArray;
         
         // Phase O2: Save objects to tile (BF.5)
         // Objects are stored in tile-local coordinates; skip unlocked OCR objects
@@ -3041,36 +3376,23 @@ bool Document::saveTile(TileCoord coord)
                 }
                 objectsArray.append(obj->toJson());
             }
-            tileObj["objects"] = objectsArray;
+            file.json["objects"] = objectsArray;
         }
         
         // Store tile coordinate for debugging/verification
-        tileObj["coord_x"] = coord.first;
-        tileObj["coord_y"] = coord.second;
+        file.json["coord_x"] = coord.first;
+        file.json["coord_y"] = coord.second;
     } else {
         // Paged mode: use full Page serialization (legacy behavior)
-        tileObj = tile->toJson();
+        file.json = tile->toJson(/*includeStrokes=*/false);
+        for (int i = 0; i < tile->layerCount(); ++i) {
+            const VectorLayer* layer = tile->layer(i);
+            file.strokes.append(qMakePair(layer->id, layer->strokes()));
+        }
     }
     
-    QJsonDocument jsonDoc(tileObj);
-    file.write(jsonDoc.toJson(QJsonDocument::Compact));
-    file.close();
-    
-    // Save OCR sidecar file
-    saveTileOcr(coord);
-    
-    // Update state
-    m_dirtyTiles.erase(coord);
-    m_tileIndex.insert(coord);
-
-    // Outline cache: in-memory tile is authoritative and now saved.
-    refreshLinkOutlineFor(coord);
-
-#ifdef SPEEDYNOTE_DEBUG
-    qDebug() << "Saved tile" << coord.first << "," << coord.second << "to" << tilePath;
-#endif
-    
-    return true;
+    file.json["stroke_store"] = StrokeBinaryCodec::storeMarker();
+    return file;
 }
 
 bool Document::loadTileFromDisk(TileCoord coord) const
@@ -3079,26 +3401,68 @@ bool Document::loadTileFromDisk(TileCoord coord) const
         return false;
     }
     
-    QString tilePath = m_bundlePath + "/tiles/" + 
-                       QString("%1,%2.json").arg(coord.first).arg(coord.second);
+    LoadRequest request;
+    request.key = QStringLiteral("%1,%2").arg(coord.first).arg(coord.second);
+    if (m_unreadableStrokes.count(request.key) > 0) {
+        return false;  // Reported once; see unreadableStrokeFiles()
+    }
+    request.coord = coord;
+    request.path = m_bundlePath + "/tiles/" + 
+                   QString("%1,%2.json").arg(coord.first).arg(coord.second);
+    request.bundlePath = m_bundlePath;
+    request.bundleVersion = m_loadedBundleVersion;
+    request.compactTile = (mode == Mode::Edgeless && !m_edgelessLayers.empty());
+    request.epoch = m_evictionEpoch;
+    request.valid = true;
     
-    QFile file(tilePath);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Cannot load tile: file not found" << tilePath;
-        // CR-6: Remove from index to prevent repeated failed loads
-        m_tileIndex.erase(coord);
-        return false;
+    return installTileData(readTileData(request));
+}
+
+Document::LoadRequest Document::tileLoadRequest(TileCoord coord) const
+{
+    LoadRequest request;
+    if (m_bundlePath.isEmpty() || !m_lazyLoadEnabled
+        || m_tiles.find(coord) != m_tiles.end() || m_tileIndex.count(coord) == 0) {
+        return request;
     }
     
-    QByteArray data = file.readAll();
+    const QString key = QStringLiteral("%1,%2").arg(coord.first).arg(coord.second);
+    if (m_unreadableStrokes.count(key) > 0) {
+        return request;
+    }
+    
+    request.key = key;
+    request.coord = coord;
+    request.path = m_bundlePath + "/tiles/" + 
+                   QString("%1,%2.json").arg(coord.first).arg(coord.second);
+    request.bundlePath = m_bundlePath;
+    request.bundleVersion = m_loadedBundleVersion;
+    request.compactTile = (mode == Mode::Edgeless && !m_edgelessLayers.empty());
+    request.epoch = m_evictionEpoch;
+    request.valid = true;
+    return request;
+}
+
+Document::LoadedData Document::readTileData(const LoadRequest& request)
+{
+    LoadedData data;
+    data.request = request;
+    
+    QFile file(request.path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot load tile: file not found" << request.path;
+        data.fileMissing = true;
+        return data;
+    }
+    
+    QByteArray bytes = file.readAll();
     file.close();
     
     QJsonParseError parseError;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &parseError);
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(bytes, &parseError);
     if (parseError.error != QJsonParseError::NoError) {
         qWarning() << "Cannot load tile: JSON parse error" << parseError.errorString();
-        m_tileIndex.erase(coord);  // CR-6: Remove from index
-        return false;
+        return data;
     }
     
     QJsonObject obj = jsonDoc.object();
@@ -3108,52 +3472,36 @@ bool Document::loadTileFromDisk(TileCoord coord) const
     // We check for coord_x/coord_y as markers of the new compact format.
     bool isNewFormat = obj.contains("coord_x") && obj.contains("coord_y");
     
-    if (mode == Mode::Edgeless && isNewFormat && !m_edgelessLayers.empty()) {
-        // New compact format: reconstruct full VectorLayers from manifest
+    if (request.compactTile && isNewFormat) {
+        // New compact format: strokes per layer id here, full VectorLayers
+        // from the manifest in installTileData()
         
-        // Build map of layerId → strokes from tile file
-        std::map<QString, QVector<VectorStroke>> strokesByLayerId;
-        QJsonArray tileLayersArray = obj["layers"].toArray();
-        for (const auto& val : tileLayersArray) {
-            QJsonObject layerObj = val.toObject();
-            QString layerId = layerObj["id"].toString();
-            QVector<VectorStroke> strokes;
-            for (const auto& strokeVal : layerObj["strokes"].toArray()) {
-                strokes.append(VectorStroke::fromJson(strokeVal.toObject()));
-            }
-            strokesByLayerId[layerId] = strokes;
-        }
-        
-        // Create tile with default page settings
-        auto tile = std::make_unique<Page>();
-        tile->size = QSizeF(EDGELESS_TILE_SIZE, EDGELESS_TILE_SIZE);
-        tile->backgroundType = defaultBackgroundType;
-        tile->backgroundColor = defaultBackgroundColor;
-        tile->gridColor = defaultGridColor;
-        tile->gridSpacing = defaultGridSpacing;
-        tile->lineSpacing = defaultLineSpacing;
-        
-        // Clear default layer and reconstruct from manifest
-        tile->vectorLayers.clear();
-        for (const auto& layerDef : m_edgelessLayers) {
-            auto layer = std::make_unique<VectorLayer>(layerDef.name);
-            layer->id = layerDef.id;
-            layer->visible = layerDef.visible;
-            layer->opacity = layerDef.opacity;
-            layer->locked = layerDef.locked;
-            
-            // Add strokes if this tile has any for this layer
-            auto it = strokesByLayerId.find(layerDef.id);
-            if (it != strokesByLayerId.end()) {
-                for (const auto& stroke : it->second) {
-                    layer->addStroke(stroke);
+        // Build map of layerId → strokes from the binary sidecar, or from
+        // the inline JSON arrays for tiles written before format version 4.
+        const StrokeStore store = readStrokeSidecarFile(obj, request.path, request.bundleVersion,
+                                                        data.strokesByLayer);
+        if (store == StrokeStore::Unreadable) {
+            data.strokesUnreadable = true;
+            return data;
+        }
+        if (store == StrokeStore::Inline) {
+            QJsonArray tileLayersArray = obj["layers"].toArray();
+            for (const auto& val : tileLayersArray) {
+                QJsonObject layerObj = val.toObject();
+                QString layerId = layerObj["id"].toString();
+                QVector<VectorStroke> strokes;
+                for (const auto& strokeVal : layerObj["strokes"].toArray()) {
+                    strokes.append(VectorStroke::fromJson(strokeVal.toObject()));
                 }
+                if (!strokes.isEmpty()) {
+                    data.legacyStrokes = true;
+                }
+                data.strokesByLayer[layerId] = strokes;
             }
-            
-            tile->vectorLayers.push_back(std::move(layer));
         }
         
-        tile->activeLayerIndex = m_edgelessActiveLayerIndex;
+        auto tile = std::make_unique<Page>();
+        data.compactLayers = true;
         
         // Phase O1.5: Load objects from tile file
         if (obj.contains("objects")) {
@@ -3161,11 +3509,6 @@ bool Document::loadTileFromDisk(TileCoord coord) const
             for (const auto& val : objectsArray) {
                 auto object = InsertedObject::fromJson(val.toObject());
                 if (object) {
-                    // Update max object extent
-                    int extent = static_cast<int>(qMax(object->size.width(), object->size.height()));
-                    if (extent > m_maxObjectExtent) {
-                        m_maxObjectExtent = extent;
-                    }
                     tile->objects.push_back(std::move(object));
                 }
             }
@@ -3174,50 +3517,126 @@ bool Document::loadTileFromDisk(TileCoord coord) const
             
             // Phase O2 (BF.3): Load image objects from assets folder.
             // InsertedObject::fromJson() only sets imagePath; it does NOT load the pixmap.
-            tile->loadImages(m_bundlePath);
+            tile->loadImages(request.bundlePath);
         }
         
-        Page* rawTilePtr = tile.get();
-        m_tiles[coord] = std::move(tile);
-        ++m_tileLoadVersion;
-        loadTileOcr(rawTilePtr, coord);
-        materializeOcrTextObjects(rawTilePtr);
-        
-#ifdef SPEEDYNOTE_DEBUG
-        qDebug() << "Loaded tile" << coord.first << "," << coord.second 
-                 << "from disk (manifest reconstruction)";
-#endif
+        data.page = std::move(tile);
     } else {
         // Legacy format or paged mode: use full Page deserialization
         auto tile = Page::fromJson(obj);
         if (!tile) {
             qWarning() << "Cannot load tile: Page::fromJson failed";
-            m_tileIndex.erase(coord);  // CR-6: Remove from index
-            return false;
+            return data;
+        }
+        
+        StrokeBinaryCodec::LayerStrokes sidecarStrokes;
+        const StrokeStore store = readStrokeSidecarFile(obj, request.path, request.bundleVersion,
+                                                        sidecarStrokes);
+        if (store == StrokeStore::Unreadable) {
+            data.strokesUnreadable = true;
+            return data;
+        }
+        if (store == StrokeStore::Sidecar) {
+            for (int i = 0; i < tile->layerCount(); ++i) {
+                VectorLayer* layer = tile->layer(i);
+                auto strokesIt = sidecarStrokes.find(layer->id);
+                if (strokesIt != sidecarStrokes.end()) {
+                    layer->setStrokes(std::move(strokesIt.value()));
+                }
+            }
+        } else {
+            for (const auto& layer : tile->vectorLayers) {
+                if (!layer->isEmpty()) {
+                    data.legacyStrokes = true;
+                    break;
+                }
+            }
         }
         
         // Phase O2 (BF.3): Load image objects from assets folder.
         // Page::fromJson() only sets imagePath; it does NOT load the actual pixmap.
-        tile->loadImages(m_bundlePath);
+        tile->loadImages(request.bundlePath);
         
-        // Phase O1.5: Update max object extent from loaded objects
-        for (const auto& object : tile->objects) {
-            int extent = static_cast<int>(qMax(object->size.width(), object->size.height()));
-            if (extent > m_maxObjectExtent) {
-                m_maxObjectExtent = extent;
+        data.page = std::move(tile);
+    }
+    
+    return data;
+}
+
+bool Document::installTileData(LoadedData&& data) const
+{
+    const TileCoord coord = data.request.coord;
+    
+    // Stale: loaded synchronously, removed, or evicted (and saved) meanwhile
+    if (m_tiles.find(coord) != m_tiles.end() || m_tileIndex.count(coord) == 0
+        || m_evictedAtEpoch.value(data.request.key, 0) > data.request.epoch) {
+        return false;
+    }
+    
+    if (data.strokesUnreadable) {
+        // Stays in the index: the tile exists, it just must not be replaced
+        markStrokesUnreadable(data.request.key, data.request.path);
+        return false;
+    }
+    if (!data.page) {
+        // CR-6: Remove from index to prevent repeated failed loads
+        m_tileIndex.erase(coord);
+        return false;
+    }
+    
+    Page* rawTilePtr = data.page.get();
+    
+    if (data.compactLayers) {
+        // Phase 5.6.4: default page settings, and full VectorLayers rebuilt
+        // from the manifest as it is now (it may have changed during the read)
+        rawTilePtr->size = QSizeF(EDGELESS_TILE_SIZE, EDGELESS_TILE_SIZE);
+        rawTilePtr->backgroundType = defaultBackgroundType;
+        rawTilePtr->backgroundColor = defaultBackgroundColor;
+        rawTilePtr->gridColor = defaultGridColor;
+        rawTilePtr->gridSpacing = defaultGridSpacing;
+        rawTilePtr->lineSpacing = defaultLineSpacing;
+        
+        rawTilePtr->vectorLayers.clear();
+        for (const auto& layerDef : m_edgelessLayers) {
+            auto layer = std::make_unique<VectorLayer>(layerDef.name);
+            layer->id = layerDef.id;
+            layer->visible = layerDef.visible;
+            layer->opacity = layerDef.opacity;
+            layer->locked = layerDef.locked;
+            
+            // Add strokes if this tile has any for this layer
+            auto it = data.strokesByLayer.find(layerDef.id);
+            if (it != data.strokesByLayer.end()) {
+                layer->setStrokes(std::move(it.value()));
             }
+            
+            rawTilePtr->vectorLayers.push_back(std::move(layer));
         }
         
-        Page* rawTilePtr = tile.get();
-        m_tiles[coord] = std::move(tile);
-        ++m_tileLoadVersion;
-        loadTileOcr(rawTilePtr, coord);
-        materializeOcrTextObjects(rawTilePtr);
-        
+        rawTilePtr->activeLayerIndex = m_edgelessActiveLayerIndex;
+    }
+    
+    if (data.legacyStrokes) {
+        m_legacyStrokeTiles.insert(coord);
+    }
+    
+    // Phase O1.5: Update max object extent from loaded objects
+    for (const auto& object : rawTilePtr->objects) {
+        int extent = static_cast<int>(qMax(object->size.width(), object->size.height()));
+        if (extent > m_maxObjectExtent) {
+            m_maxObjectExtent = extent;
+        }
+    }
+    
+    m_tiles[coord] = std::move(data.page);
+    ++m_tileLoadVersion;
+    m_evictedAtEpoch.remove(data.request.key);
+    loadTileOcr(rawTilePtr, coord);
+    materializeOcrTextObjects(rawTilePtr);
+    
 #ifdef SPEEDYNOTE_DEBUG
-        qDebug() << "Loaded tile" << coord.first << "," << coord.second << "from disk (legacy)";
+    qDebug() << "Loaded tile" << coord.first << "," << coord.second << "from disk";
 #endif
-    }
 
     // Outline cache: in-memory tile is now authoritative; reconcile with
     // any prior disk-peek entry.  Safe no-op if the cache hasn't been
@@ -3234,6 +3653,9 @@ void Document::evictTile(TileCoord coord)
         return;  // Not loaded, nothing to evict
     }
     
+    // See evictPage()
+    completeBackgroundSave();
+    
     // Save if dirty
     if (m_dirtyTiles.count(coord) > 0) {
         if (!saveTile(coord)) {
@@ -3245,6 +3667,8 @@ void Document::evictTile(TileCoord coord)
     // Remove from memory
     m_tiles.erase(it);
     ++m_tileLoadVersion;
+    m_evictedAtEpoch.insert(QStringLiteral("%1,%2").arg(coord.first).arg(coord.second),
+                            ++m_evictionEpoch);
 
 #ifdef SPEEDYNOTE_DEBUG
     qDebug() << "Evicted tile" << coord.first << "," << coord.second << "from memory";
@@ -3524,6 +3948,10 @@ bool Document::deleteNoteFile(const QString& noteId)
         return false;
     }
     
+    if (m_noteIndex) {
+        m_noteIndex->remove(noteId);
+    }
+    
     QString filePath = notes + "/" + noteId + ".md";
     if (QFile::exists(filePath)) {
         return QFile::remove(filePath);
@@ -3531,6 +3959,40 @@ bool Document::deleteNoteFile(const QString& noteId)
     return true;  // File didn't exist, consider it successfully "deleted"
 }
 
+bool Document::saveNoteFile(const MarkdownNote& note)
+{
+    QString notes = notesPath();
+    if (notes.isEmpty() || !note.isValid()) {
+        return false;
+    }
+    
+    if (!note.saveToFile(notes + "/" + note.id + ".md")) {
+        return false;
+    }
+    noteIndex()->update(notes, note);
+    return true;
+}
+
+MarkdownNote Document::markdownNote(const QString& noteId) const
+{
+    QString notes = notesPath();
+    if (notes.isEmpty()) {
+        return MarkdownNote();
+    }
+    return noteIndex()->note(notes, noteId);
+}
+
+MarkdownNoteIndex* Document::noteIndex() const
+{
+    if (!m_noteIndex) {
+        m_noteIndex = std::make_unique<MarkdownNoteIndex>();
+        if (!m_bundlePath.isEmpty()) {
+            m_noteIndex->load(m_bundlePath, notesPath());
+        }
+    }
+    return m_noteIndex.get();
+}
+
 // ============================================================================
 // Link Outline Cache (Phase M.9)
 // ============================================================================
@@ -3921,6 +4383,66 @@ QVector<LinkOutlineEntry> Document::enumerateLinkOutline() const
 
 bool Document::saveBundle(const QString& path, bool finalize)
 {
+    completeBackgroundSave();
+    
+    SaveJob job;
+    if (!prepareSave(path, finalize, job)) {
+        return false;
+    }
+    const bool ok = writeSaveJob(job);
+    finishSave(job, ok);
+    return ok;
+}
+
+bool Document::saveBundleInBackground(const QString& path)
+{
+    if (isSaveInFlight()) {
+        return false;
+    }
+    
+    auto job = std::make_shared<SaveJob>();
+    if (!prepareSave(path, /*finalize=*/false, *job)) {
+        return false;
+    }
+    
+    m_pendingSaveJob = job;
+    m_pendingSave = QtConcurrent::run([job]() {
+        return writeSaveJob(*job);
+    });
+    
+#ifdef SPEEDYNOTE_DEBUG
+    qDebug() << "saveBundleInBackground:" << job->files.size() << "files,"
+             << (job->manifest.isEmpty() ? "manifest unchanged" : "manifest changed");
+#endif
+    return true;
+}
+
+bool Document::completeBackgroundSave()
+{
+    if (!m_pendingSaveJob) {
+        return true;
+    }
+    
+    m_pendingSave.waitForFinished();
+    const bool ok = m_pendingSave.result();
+    
+    // Clear first: finishSave() must not see a save in flight
+    const std::shared_ptr<SaveJob> job = std::move(m_pendingSaveJob);
+    m_pendingSaveJob.reset();
+    m_pendingSave = QFuture<bool>();
+    
+    finishSave(*job, ok);
+    return ok;
+}
+
+bool Document::prepareSave(const QString& path, bool finalize, SaveJob& job)
+{
+    job = SaveJob();
+    job.bundlePath = path;
+    if (m_strokeJournal && m_strokeJournal->bundlePath() == path) {
+        job.journalBytes = m_strokeJournal->size();
+    }
+    
     // Save old bundle path before overwriting - needed for copying evicted tiles/pages
     QString oldBundlePath = m_bundlePath;
     m_bundlePath = path;
@@ -4055,6 +4577,18 @@ bool Document::saveBundle(const QString& path, bool finalize)
             metaObj["width"] = size.width();
             metaObj["height"] = size.height();
             
+            // Pages written by this save move to a new content revision,
+            // taken over by finishSave() once the files are on disk
+            auto revIt = m_pageRevisions.find(uuid);
+            quint32 revision = (revIt != m_pageRevisions.end()) ? revIt->second : 0;
+            if (m_dirtyPages.count(uuid) > 0) {
+                ++revision;
+                job.pageRevisions.append(qMakePair(uuid, revision));
+            }
+            if (revision > 0) {
+                metaObj["revision"] = static_cast<qint64>(revision);
+            }
+            
             // Include PDF page index if this is a PDF page
             auto pdfIt = m_pagePdfIndex.find(uuid);
             if (pdfIt != m_pagePdfIndex.end()) {
@@ -4080,18 +4614,15 @@ bool Document::saveBundle(const QString& path, bool finalize)
         }
     }
     
-    // Write manifest
-    QString manifestPath = path + "/document.json";
-    QFile manifestFile(manifestPath);
-    if (!manifestFile.open(QIODevice::WriteOnly)) {
-        qWarning() << "Cannot write manifest" << manifestPath;
-        return false;
-    }
-    manifestFile.write(QJsonDocument(manifest).toJson(QJsonDocument::Indented));
-    manifestFile.close();
-    
     bool savingToNewLocation = !oldBundlePath.isEmpty() && oldBundlePath != path;
     
+    // Manifest: written last by writeSaveJob(), and only when it changed
+    const QByteArray manifestBytes = QJsonDocument(manifest).toJson(QJsonDocument::Indented);
+    if (savingToNewLocation || manifestBytes != m_savedManifest
+        || !QFile::exists(path + "/document.json")) {
+        job.manifest = manifestBytes;
+    }
+    
     // ========== COPY ASSETS WHEN SAVING TO NEW LOCATION (Phase O1.6 fix) ==========
     if (savingToNewLocation) {
         QString oldAssetsPath = oldBundlePath + "/assets/images";
@@ -4147,13 +4678,17 @@ bool Document::saveBundle(const QString& path, bool finalize)
                     }
                 }
                 
-                // Copy OCR sidecar file if it exists
+                // Copy OCR and stroke sidecar files if they exist
                 QString ocrFileName = QString("%1,%2.ocr.json").arg(coord.first).arg(coord.second);
                 QString oldOcrPath = oldBundlePath + "/tiles/" + ocrFileName;
                 QString newOcrPath = path + "/tiles/" + ocrFileName;
                 if (QFile::exists(oldOcrPath)) {
                     QFile::copy(oldOcrPath, newOcrPath);
                 }
+                const QString oldStrokesPath = strokeSidecarPath(oldTilePath);
+                if (QFile::exists(oldStrokesPath)) {
+                    QFile::copy(oldStrokesPath, strokeSidecarPath(newTilePath));
+                }
             }
         }
         
@@ -4161,12 +4696,16 @@ bool Document::saveBundle(const QString& path, bool finalize)
         for (const auto& pair : m_tiles) {
             TileCoord coord = pair.first;
             // When saving to new location: save ALL in-memory tiles
-            // When saving to same location: only save dirty/new tiles
+            // When saving to same location: only save dirty/new tiles, plus
+            // tiles still in the pre-v4 inline-JSON stroke format (migration)
             bool needsSave = savingToNewLocation || 
                              m_dirtyTiles.count(coord) > 0 || 
-                             m_tileIndex.count(coord) == 0;
+                             m_tileIndex.count(coord) == 0 ||
+                             m_legacyStrokeTiles.count(coord) > 0;
             if (needsSave) {
-                saveTile(coord);
+                job.files.append(tileSaveFile(path, coord, pair.second.get()));
+                job.tileKeys.append(coord);
+                saveTileOcr(coord);
             }
         }
         
@@ -4174,28 +4713,20 @@ bool Document::saveBundle(const QString& path, bool finalize)
         for (const auto& coord : m_deletedTiles) {
             QString tileFileName = QString("%1,%2.json").arg(coord.first).arg(coord.second);
             QString tilePath = path + "/tiles/" + tileFileName;
-            if (QFile::exists(tilePath)) {
-                if (QFile::remove(tilePath)) {
-#ifdef SPEEDYNOTE_DEBUG
-                    qDebug() << "Deleted empty tile file:" << tileFileName;
-#endif
-                } else {
-                    #ifdef SPEEDYNOTE_DEBUG
-                        qDebug() << "Failed to delete empty tile file:" << tilePath;
-                    #endif
-                }
-            }
-            // Also delete OCR sidecar
-            QString ocrPath = path + "/tiles/" +
-                QString("%1,%2.ocr.json").arg(coord.first).arg(coord.second);
-            QFile::remove(ocrPath);
+            job.removals.append(tilePath);
+            // Also delete OCR and stroke sidecars
+            job.removals.append(path + "/tiles/" +
+                QString("%1,%2.ocr.json").arg(coord.first).arg(coord.second));
+            job.removals.append(strokeSidecarPath(tilePath));
+            job.deletedTileKeys.append(coord);
+            m_legacyStrokeTiles.erase(coord);
         }
         m_deletedTiles.clear();
         m_dirtyTiles.clear();
         m_tileIndex = allTileCoords;
         
 #ifdef SPEEDYNOTE_DEBUG
-        qDebug() << "Saved edgeless bundle to" << path << "with" << allTileCoords.size() << "tiles";
+        qDebug() << "Saving edgeless bundle to" << path << "with" << allTileCoords.size() << "tiles";
 #endif
     } else {
         // ========== PAGED MODE FILE HANDLING (Phase O1.7.4) ==========
@@ -4224,12 +4755,25 @@ bool Document::saveBundle(const QString& path, bool finalize)
                     }
                 }
                 
-                // Copy OCR sidecar file if it exists
+                // Copy OCR and stroke sidecar files if they exist
                 QString oldOcrPath = oldBundlePath + "/pages/" + uuid + ".ocr.json";
                 QString newOcrPath = path + "/pages/" + uuid + ".ocr.json";
                 if (QFile::exists(oldOcrPath)) {
                     QFile::copy(oldOcrPath, newOcrPath);
                 }
+                const QString oldStrokesPath = strokeSidecarPath(oldPagePath);
+                if (QFile::exists(oldStrokesPath)) {
+                    QFile::copy(oldStrokesPath, strokeSidecarPath(newPagePath));
+                }
+            }
+            
+            // Carry the search index over (before the page saves below update it)
+            const QString indexName = QLatin1String(PdfSearchIndex::FILE_NAME);
+            if (m_searchIndex) {
+                m_searchIndex->save(path);
+            } else if (QFile::exists(oldBundlePath + "/" + indexName)) {
+                QFile::remove(path + "/" + indexName);
+                QFile::copy(oldBundlePath + "/" + indexName, path + "/" + indexName);
             }
         }
         
@@ -4252,67 +4796,183 @@ bool Document::saveBundle(const QString& path, bool finalize)
                 
                 // Delete any stale file from when page had content
                 QString pagePath = path + "/pages/" + uuid + ".json";
-                if (QFile::exists(pagePath)) {
-                    QFile::remove(pagePath);
-#ifdef SPEEDYNOTE_DEBUG
-                    qDebug() << "Deleted stale file for pristine PDF page" << uuid;
-#endif
-                }
+                job.removals.append(strokeSidecarPath(pagePath));
+                job.removals.append(pagePath);
                 
                 continue;  // Don't save file - synthesize on load
             }
             
             // When saving to new location: save ALL in-memory pages (with content)
-            // When saving to same location: only save dirty pages
-            bool needsSave = savingToNewLocation || m_dirtyPages.count(uuid) > 0;
+            // When saving to same location: only save dirty pages, plus pages
+            // still in the pre-v4 inline-JSON stroke format (migration)
+            bool needsSave = savingToNewLocation || m_dirtyPages.count(uuid) > 0 ||
+                             m_legacyStrokePages.count(uuid) > 0;
             if (needsSave) {
-                QString pagePath = path + "/pages/" + uuid + ".json";
-                QFile file(pagePath);
-                if (file.open(QIODevice::WriteOnly)) {
-                    QJsonDocument doc(pagePtr->toJson());
-                    file.write(doc.toJson(QJsonDocument::Compact));
-                    file.close();
-#ifdef SPEEDYNOTE_DEBUG
-                    qDebug() << "Saved page" << uuid;
-#endif
-                } else {
-                    #ifdef SPEEDYNOTE_DEBUG
-                        qDebug() << "Failed to save page" << pagePath;
-                    #endif
-                }
+                job.files.append(pageSaveFile(path, uuid, pagePtr.get()));
+                job.pageKeys.append(uuid);
+                // Keep the search index in step with the page on disk
+                searchIndex()->setText(PdfSearchIndex::pageKey(uuid),
+                                       PdfSearchIndex::pageText(pagePtr.get()));
             }
         }
         
         // ========== DELETE REMOVED PAGES FROM DISK ==========
         for (const QString& uuid : m_deletedPages) {
             QString pagePath = path + "/pages/" + uuid + ".json";
-            if (QFile::exists(pagePath)) {
-                if (QFile::remove(pagePath)) {
-#ifdef SPEEDYNOTE_DEBUG
-                    qDebug() << "Deleted page file:" << uuid;
-#endif
-                } else {
-                    qWarning() << "Failed to delete page file:" << pagePath;
-                }
-            }
-            // Also delete OCR sidecar
-            QString ocrPath = path + "/pages/" + uuid + ".ocr.json";
-            QFile::remove(ocrPath);
+            job.removals.append(pagePath);
+            // Also delete OCR and stroke sidecars
+            job.removals.append(path + "/pages/" + uuid + ".ocr.json");
+            job.removals.append(strokeSidecarPath(pagePath));
+            job.deletedPageKeys.append(uuid);
+            m_legacyStrokePages.erase(uuid);
         }
         m_deletedPages.clear();
         m_dirtyPages.clear();
         
+        saveSearchIndex();
+        
 #ifdef SPEEDYNOTE_DEBUG
-        qDebug() << "Saved paged bundle to" << path << "with" << m_pageOrder.size() << "pages";
+        qDebug() << "Saving paged bundle to" << path << "with" << m_pageOrder.size() << "pages";
 #endif
     }
     
-    m_lazyLoadEnabled = true;
+    // Note files are written as they are edited; only their index is pending
+    if (m_noteIndex && m_noteIndex->isDirty()) {
+        m_noteIndex->save(path);
+    }
+    
+    // Edits from here on mark the document modified again
     clearModified();
     
     return true;
 }
 
+bool Document::writeSaveJob(const SaveJob& job)
+{
+    bool ok = true;
+    for (const SaveFile& file : job.files) {
+        if (!writeSaveFile(file)) {
+            ok = false;
+        }
+    }
+    
+    if (!ok) {
+        return false;  // The next save retries the removals
+    }
+    
+    for (const QString& removal : job.removals) {
+        QFile::remove(removal);
+    }
+    
+    // Manifest last, so it never lists a page or tile that was not written
+    if (!job.manifest.isEmpty()) {
+        const QString manifestPath = job.bundlePath + "/document.json";
+        QSaveFile manifestFile(manifestPath);
+        if (!manifestFile.open(QIODevice::WriteOnly)) {
+            qWarning() << "Cannot write manifest" << manifestPath;
+            return false;
+        }
+        manifestFile.write(job.manifest);
+        if (!manifestFile.commit()) {
+            qWarning() << "Cannot write manifest" << manifestPath << manifestFile.errorString();
+            return false;
+        }
+    }
+    return ok;
+}
+
+void Document::finishSave(const SaveJob& job, bool ok)
+{
+    if (!ok) {
+        // Everything in the snapshot is written again by the next save. The
+        // search index was given the snapshot's text; drop it until then.
+        for (const QString& uuid : job.pageKeys) {
+            if (m_loadedPages.find(uuid) != m_loadedPages.end()) {
+                m_dirtyPages.insert(uuid);
+            }
+            if (m_searchIndex) {
+                m_searchIndex->remove(PdfSearchIndex::pageKey(uuid));
+            }
+        }
+        for (const TileCoord& coord : job.tileKeys) {
+            if (m_tiles.find(coord) != m_tiles.end()) {
+                m_dirtyTiles.insert(coord);
+            }
+        }
+        // Files of deleted pages/tiles were not removed; remove them next time
+        for (const QString& uuid : job.deletedPageKeys) {
+            if (pageIndexByUuid(uuid) < 0) {
+                m_deletedPages.insert(uuid);
+            }
+        }
+        for (const TileCoord& coord : job.deletedTileKeys) {
+            if (m_tiles.find(coord) == m_tiles.end()) {
+                m_deletedTiles.insert(coord);
+            }
+        }
+        if (isEdgeless()) {
+            m_edgelessManifestDirty = true;
+        }
+        m_savedManifest.clear();
+        markModified();
+        return;
+    }
+    
+    if (!job.manifest.isEmpty()) {
+        m_savedManifest = job.manifest;
+    }
+    for (const auto& [uuid, revision] : job.pageRevisions) {
+        quint32& current = m_pageRevisions[uuid];
+        current = qMax(current, revision);
+    }
+    m_loadedBundleVersion = BUNDLE_FORMAT_VERSION;
+    if (m_strokeJournal) {
+        if (m_strokeJournal->bundlePath() != job.bundlePath) {
+            // Save As: the old bundle keeps its last saved state
+            m_strokeJournal->discard();
+            m_strokeJournal.reset();
+        } else {
+            m_strokeJournal->dropBefore(job.journalBytes);
+        }
+    }
+    for (const QString& uuid : job.pageKeys) {
+        m_legacyStrokePages.erase(uuid);
+#ifdef SPEEDYNOTE_DEBUG
+        qDebug() << "Saved page" << uuid;
+#endif
+    }
+    for (const TileCoord& coord : job.tileKeys) {
+        m_legacyStrokeTiles.erase(coord);
+        // Outline cache: in-memory tile is authoritative and now saved.
+        refreshLinkOutlineFor(coord);
+    }
+    m_lazyLoadEnabled = true;
+}
+
+QString Document::resolvePdfSourcePath(const PdfSource& s, const QString& bundleDir)
+{
+    // Bundled sources live inside the .snb.
+    if (s.bundled && !s.bundledFile.isEmpty()) {
+        QString bundledPath = QDir(bundleDir).absoluteFilePath(s.bundledFile);
+        if (QFile::exists(bundledPath)) {
+            return bundledPath;
+        }
+    }
+    // Absolute path first.
+    if (!s.path.isEmpty() && QFile::exists(s.path)) {
+        return s.path;
+    }
+    // Then bundle-relative path (canonicalized).
+    if (!s.relativePath.isEmpty()) {
+        QString rawPath = QDir(bundleDir).absoluteFilePath(s.relativePath);
+        QFileInfo fi(rawPath);
+        if (fi.exists()) {
+            return fi.canonicalFilePath();
+        }
+    }
+    return QString();
+}
+
 std::unique_ptr<Document> Document::loadBundle(const QString& path)
 {
     QString manifestPath = path + "/document.json";
@@ -4352,6 +5012,8 @@ std::unique_ptr<Document> Document::loadBundle(const QString& path)
     // Set bundle path and enable lazy loading
     doc->m_bundlePath = path;
     doc->m_lazyLoadEnabled = true;
+    doc->m_loadedBundleVersion = bundleVersion;
+    doc->m_savedManifest = data;  // An unchanged manifest is not rewritten
     
     // ========== MODE-SPECIFIC LOADING ==========
     if (doc->mode == Mode::Edgeless) {
@@ -4438,6 +5100,11 @@ std::unique_ptr<Document> Document::loadBundle(const QString& path)
                                metaObj["height"].toDouble(842.0));
                     doc->m_pageMetadata[uuid] = size;
                     
+                    if (metaObj.contains("revision")) {
+                        doc->m_pageRevisions[uuid] =
+                            static_cast<quint32>(metaObj["revision"].toDouble());
+                    }
+                    
                     // Parse PDF page index for pristine page synthesis
                     if (metaObj.contains("pdf_page")) {
                         doc->m_pagePdfIndex[uuid] = metaObj["pdf_page"].toInt();
@@ -4477,29 +5144,6 @@ std::unique_ptr<Document> Document::loadBundle(const QString& path)
     if (!doc->m_pdfSources.empty()) {
         QString bundleDir = QFileInfo(manifestPath).absolutePath();
 
-        auto resolveSourcePath = [&](const PdfSource& s) -> QString {
-            // Bundled sources live inside the .snb.
-            if (s.bundled && !s.bundledFile.isEmpty()) {
-                QString bundledPath = QDir(bundleDir).absoluteFilePath(s.bundledFile);
-                if (QFile::exists(bundledPath)) {
-                    return bundledPath;
-                }
-            }
-            // Absolute path first.
-            if (!s.path.isEmpty() && QFile::exists(s.path)) {
-                return s.path;
-            }
-            // Then bundle-relative path (canonicalized).
-            if (!s.relativePath.isEmpty()) {
-                QString rawPath = QDir(bundleDir).absoluteFilePath(s.relativePath);
-                QFileInfo fi(rawPath);
-                if (fi.exists()) {
-                    return fi.canonicalFilePath();
-                }
-            }
-            return QString();
-        };
-
         for (size_t i = 0; i < doc->m_pdfSources.size(); ++i) {
             PdfSource& s = doc->m_pdfSources[i];
             const bool isPrimary = s.primary;
@@ -4510,7 +5154,7 @@ std::unique_ptr<Document> Document::loadBundle(const QString& path)
                 continue;
             }
 
-            QString resolved = resolveSourcePath(s);
+            QString resolved = resolvePdfSourcePath(s, bundleDir);
             if (resolved.isEmpty()) {
                 s.needsRelink = true;
                 qWarning() << "loadBundle: PDF source not found:" << s.path << "/" << s.relativePath;
@@ -4539,6 +5183,13 @@ std::unique_ptr<Document> Document::loadBundle(const QString& path)
         }
     }
     
+    // Stroke edits made after the last save (the session ended without one)
+    const int replayed = doc->replayStrokeJournal();
+    if (replayed > 0) {
+        qWarning() << "loadBundle: recovered" << replayed << "unsaved stroke changes from"
+                   << StrokeJournal::FILE_NAME;
+    }
+    
     return doc;
 }
 
@@ -4583,6 +5234,133 @@ const LayerDefinition* Document::edgelessLayerDef(int index) const
     return &m_edgelessLayers[index];
 }
 
+// ===== Stroke Journal =====
+
+void Document::journalStrokes(StrokeJournal::Op op, int pageIndex, TileCoord coord,
+                              int layerIndex, const QVector<VectorStroke>& strokes)
+{
+    if (m_bundlePath.isEmpty() || !m_lazyLoadEnabled || strokes.isEmpty()) {
+        return;
+    }
+    
+    QString container;
+    QString layerId;
+    if (mode == Mode::Edgeless) {
+        container = QStringLiteral("%1,%2").arg(coord.first).arg(coord.second);
+        layerId = edgelessLayerId(layerIndex);
+    } else {
+        container = pageUuidAt(pageIndex);
+        auto it = m_loadedPages.find(container);
+        if (it != m_loadedPages.end()) {
+            if (const VectorLayer* layer = it->second->layer(layerIndex)) {
+                layerId = layer->id;
+            }
+        }
+    }
+    if (container.isEmpty() || layerId.isEmpty()) {
+        return;
+    }
+    
+    if (!m_strokeJournal || m_strokeJournal->bundlePath() != m_bundlePath) {
+        m_strokeJournal = std::make_unique<StrokeJournal>(m_bundlePath);
+    }
+    m_strokeJournal->append(op, container, layerId, strokes);
+}
+
+void Document::discardStrokeJournal()
+{
+    completeBackgroundSave();
+    if (!m_strokeJournal && !m_bundlePath.isEmpty()) {
+        m_strokeJournal = std::make_unique<StrokeJournal>(m_bundlePath);
+    }
+    if (m_strokeJournal) {
+        m_strokeJournal->discard();
+        m_strokeJournal.reset();
+    }
+}
+
+int Document::replayStrokeJournal()
+{
+    const QVector<StrokeJournal::Entry> entries = StrokeJournal::read(m_bundlePath);
+    if (entries.isEmpty()) {
+        return 0;
+    }
+    
+    int applied = 0;
+    for (const StrokeJournal::Entry& entry : entries) {
+        const bool adds = (entry.op != StrokeJournal::Op::Remove);
+        
+        Page* container = nullptr;
+        TileCoord coord{0, 0};
+        int pageIndex = -1;
+        if (mode == Mode::Edgeless) {
+            const QStringList parts = entry.container.split(QLatin1Char(','));
+            if (parts.size() != 2) {
+                continue;
+            }
+            coord = {parts[0].toInt(), parts[1].toInt()};
+            container = adds ? getOrCreateTile(coord.first, coord.second)
+                             : getTile(coord.first, coord.second);
+        } else {
+            pageIndex = pageIndexByUuid(entry.container);
+            container = (pageIndex >= 0) ? page(pageIndex) : nullptr;
+        }
+        if (!container) {
+            continue;   // Page deleted since, or nothing left to remove
+        }
+        
+        VectorLayer* layer = nullptr;
+        for (int i = 0; i < container->layerCount(); ++i) {
+            if (container->layer(i)->id == entry.layerId) {
+                layer = container->layer(i);
+                break;
+            }
+        }
+        if (!layer) {
+            continue;
+        }
+        
+        // Tolerate records the files already contain (see StrokeJournal)
+        switch (entry.op) {
+            case StrokeJournal::Op::Add:
+                for (const VectorStroke& stroke : entry.strokes) {
+                    if (layer->indexOfStroke(stroke.id) < 0) {
+                        layer->addStroke(stroke);
+                    }
+                }
+                break;
+            case StrokeJournal::Op::Remove:
+                for (const QString& id : entry.strokeIds) {
+                    layer->removeStroke(id);
+                }
+                break;
+            case StrokeJournal::Op::Replace:
+                for (const VectorStroke& stroke : entry.strokes) {
+                    const int index = layer->indexOfStroke(stroke.id);
+                    if (index >= 0) {
+                        layer->strokes()[index] = stroke;
+                    }
+                }
+                layer->invalidateStrokeCache();
+                break;
+        }
+        
+        if (mode == Mode::Edgeless) {
+            markTileDirty(coord);
+            if (!adds) {
+                removeTileIfEmpty(coord.first, coord.second);
+            }
+        } else {
+            markPageDirty(pageIndex);
+        }
+        ++applied;
+    }
+    
+    // Records already applied stay until the next save writes their pages
+    m_strokeJournal = std::make_unique<StrokeJournal>(m_bundlePath);
+    return applied;
+}
+
 QString Document::edgelessLayerId(int index) const
 {
     if (index < 0 || index >= static_cast<int>(m_edgelessLayers.size())) {
@@ -5004,8 +5782,20 @@ bool Document::savePageOcr(const QString& uuid, const Page* page)
 
     QString ocrPath = m_bundlePath + "/pages/" + uuid + ".ocr.json";
 
+    // The index mirrors the bundle on disk. A dirty page's text boxes are not
+    // saved yet, so its entry is dropped (searched in full) until the next
+    // save writes the page and indexes it again.
+    auto updateIndex = [&]() {
+        if (m_dirtyPages.count(uuid) > 0) {
+            searchIndex()->remove(PdfSearchIndex::pageKey(uuid));
+        } else {
+            searchIndex()->setText(PdfSearchIndex::pageKey(uuid), PdfSearchIndex::pageText(page));
+        }
+    };
+
     if (page->ocrTextBlocks.isEmpty() && page->suppressedStrokeIds.isEmpty()) {
         QFile::remove(ocrPath);
+        updateIndex();
         return true;
     }
 
@@ -5028,10 +5818,14 @@ bool Document::savePageOcr(const QString& uuid, const Page* page)
         root["suppressedStrokeIds"] = suppressed;
     }
 
-    QFile file(ocrPath);
+    // Atomic, like the page file: a crash mid-write keeps the old sidecar
+    QSaveFile file(ocrPath);
     if (!file.open(QIODevice::WriteOnly))
         return false;
     file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit())
+        return false;
+    updateIndex();
     return true;
 }
 
@@ -5104,11 +5898,11 @@ bool Document::saveTileOcr(TileCoord coord)
         root["suppressedStrokeIds"] = suppressed;
     }
 
-    QFile file(ocrPath);
+    QSaveFile file(ocrPath);
     if (!file.open(QIODevice::WriteOnly))
         return false;
     file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
-    return true;
+    return file.commit();
 }
 
 bool Document::loadTileOcr(Page* tile, TileCoord coord) const
@@ -16,8 +16,12 @@
 // ============================================================================
 
 #include "Page.h"
+#include "MarkdownNoteIndex.h"
+#include "StrokeJournal.h"
 #include "../pdf/PdfProvider.h"
+#include "../pdf/PdfSearchIndex.h"
 #include "../ui/sidebars/LinkOutlineEntry.h"
+#include "../strokes/StrokeBinaryCodec.h"
 
 #include <QCoreApplication>  // For translate() in displayName()
 #include <QString>
@@ -35,6 +39,7 @@
 #include <QHash>
 #include <QVector>
 #include <QStringList>
+#include <QFuture>
 #include <vector>
 #include <map>
 #include <set>
@@ -164,8 +169,20 @@ public:
      * Version history:
      * - 1: Initial .snb bundle format (2026-01)
      * - 2: Added pdf_relative_path for portable .snbx packages (2026-01)
+     * - 3: Last version with strokes inline in the page/tile JSON. It was
+     *      written by releases before binary strokes; its change was never
+     *      recorded in this list
+     * - 4: Strokes stored in binary .strokes sidecars (see StrokeBinaryCodec);
+     *      older bundles are still read and migrated page by page on save
+     *
+     * Every version up to the current one is readable; a newer one only
+     * produces a warning on load.
      */
-    static constexpr int BUNDLE_FORMAT_VERSION = 3;
+    static constexpr int BUNDLE_FORMAT_VERSION = 4;
+    
+    /// First bundle format version whose page/tile files may carry strokes in
+    /// a binary sidecar. Bundles below this are never probed for sidecars.
+    static constexpr int BINARY_STROKES_BUNDLE_VERSION = 4;
     
     // ===== Document Mode =====
     
@@ -469,6 +486,27 @@ public:
      */
     bool deleteNoteFile(const QString& noteId);
 
+    /**
+     * @brief Write a markdown note file and update the note index.
+     * @param note The note (id decides the file name).
+     * @return true if the file was written.
+     *
+     * All note writes go through here so note search never has to re-read
+     * files it has already seen.
+     */
+    bool saveNoteFile(const MarkdownNote& note);
+
+    /**
+     * @brief Get a markdown note's title and content.
+     * @param noteId The note UUID.
+     * @return The note, or an invalid note if its file is missing.
+     *
+     * Served from the bundle's persistent note index (notes_index.json); the
+     * .md file is only read the first time a note is seen or after it was
+     * changed outside SpeedyNote. Used by the note search.
+     */
+    MarkdownNote markdownNote(const QString& noteId) const;
+
     /**
      * @brief Enumerate every LinkObject with at least one markdown slot.
      *
@@ -702,6 +740,107 @@ public:
      */
     bool saveBundle(const QString& path, bool finalize = false);
     
+    // ===== Incremental Background Save =====
+    // saveBundle() runs in three steps, mirroring background loading:
+    //   1. prepareSave() - GUI thread: bookkeeping, small sidecars, and a
+    //      snapshot of every dirty page/tile (JSON properties plus shared
+    //      copies of its stroke lists) and of the manifest
+    //   2. writeSaveJob() - any thread: encode stroke sidecars, serialize JSON
+    //      and write each file to a temp file renamed over the old one
+    //      (QSaveFile), so a crash leaves either the old or the new file
+    //   3. finishSave() - GUI thread: settle state, or re-mark everything
+    //      dirty if a write failed
+    // document.json is only rewritten when its bytes change. saveBundle()
+    // runs the steps back to back; saveBundleInBackground() runs step 2 on a
+    // worker thread. Edits made meanwhile simply mark pages dirty again.
+    
+    /**
+     * @brief Snapshot of one page/tile file pair to write.
+     */
+    struct SaveFile {
+        QString path;                   ///< JSON file; the stroke sidecar path derives from it
+        QJsonObject json;               ///< Contents (stroke_store marker included)
+        QVector<QPair<QString, QVector<VectorStroke>>> strokes;  ///< Sidecar layers, in order
+    };
+    
+    /**
+     * @brief Everything a save writes; built by prepareSave().
+     */
+    struct SaveJob {
+        QString bundlePath;
+        QVector<SaveFile> files;        ///< Dirty pages/tiles
+        QStringList removals;           ///< Deleted pages/tiles and stale files (best effort)
+        QStringList deletedPageKeys;    ///< Page UUIDs whose files are removed
+        QVector<TileCoord> deletedTileKeys; ///< Tiles whose files are removed
+        QVector<QPair<QString, quint32>> pageRevisions; ///< New revisions, applied on success
+        QByteArray manifest;            ///< New document.json, or empty if unchanged
+        QStringList pageKeys;           ///< Page UUIDs written
+        QVector<TileCoord> tileKeys;    ///< Tiles written
+        qint64 journalBytes = 0;        ///< Stroke journal length the snapshot covers
+    };
+    
+    /**
+     * @brief Step 1 of a save (GUI thread). See saveBundle() for @p finalize.
+     * @return False if the bundle directories cannot be created.
+     */
+    bool prepareSave(const QString& path, bool finalize, SaveJob& job);
+    
+    /**
+     * @brief Step 2 of a save: write the job's files atomically. Any thread.
+     * @return True if every file and the manifest were written.
+     *
+     * Removals run only after every file was written, so a failed save
+     * never leaves the old manifest listing a page whose file is gone.
+     */
+    static bool writeSaveJob(const SaveJob& job);
+    
+    /// Step 3 of a save (GUI thread).
+    void finishSave(const SaveJob& job, bool ok);
+    
+    /**
+     * @brief Save in place with the file writes on a worker thread.
+     * @return False if nothing could be started (another save still in
+     *         flight, or prepareSave() failed).
+     *
+     * Watch backgroundSave() and call completeBackgroundSave() when it
+     * finishes. Saves, evictions and destruction wait for it on their own.
+     */
+    bool saveBundleInBackground(const QString& path);
+    
+    /// True while a background save is writing.
+    bool isSaveInFlight() const { return m_pendingSaveJob != nullptr; }
+    
+    /// Future of the background save in flight (to watch for completion).
+    QFuture<bool> backgroundSave() const { return m_pendingSave; }
+    
+    /**
+     * @brief Wait for the background save in flight, if any, and finish it.
+     * @return False if it failed; true if it succeeded or none was in flight.
+     */
+    bool completeBackgroundSave();
+    
+    // ===== Stroke Journal =====
+    // Stroke edits are appended to the bundle's strokes.journal as they happen
+    // (see StrokeJournal), replayed by loadBundle() and dropped once a save
+    // has written the pages/tiles they touched.
+    
+    /**
+     * @brief Record a stroke change that was just applied.
+     * @param pageIndex Page (paged mode).
+     * @param coord Tile (edgeless mode).
+     * @param layerIndex Layer within the page/tile.
+     *
+     * No-op for documents without a bundle on disk.
+     */
+    void journalStrokes(StrokeJournal::Op op, int pageIndex, TileCoord coord, int layerIndex,
+                        const QVector<VectorStroke>& strokes);
+    
+    /**
+     * @brief Delete the stroke journal: the unsaved changes it holds were
+     *        discarded. Call when closing a document without saving.
+     */
+    void discardStrokeJournal();
+    
     /**
      * @brief Load a document from a bundle (tiles lazy-loaded).
      * @param path Path to the .snb directory.
@@ -709,6 +848,23 @@ public:
      */
     static std::unique_ptr<Document> loadBundle(const QString& path);
     
+    /**
+     * @brief Read the PDF sources listed in a bundle manifest.
+     * @param obj The parsed document.json.
+     *
+     * Reads pdf_sources[] (or synthesizes the primary from the legacy
+     * top-level keys) without creating a Document. Any thread.
+     */
+    static std::vector<PdfSource> pdfSourcesFromJson(const QJsonObject& obj);
+    
+    /**
+     * @brief Locate a source's PDF: bundled file, then absolute path, then
+     *        bundle-relative path. Any thread.
+     * @param bundleDir Absolute path of the .snb directory.
+     * @return The existing file, or an empty string if none is found.
+     */
+    static QString resolvePdfSourcePath(const PdfSource& s, const QString& bundleDir);
+    
     /**
      * @brief Peek at a bundle's document ID without fully loading it.
      * @param path Path to the .snb directory.
@@ -1080,10 +1236,30 @@ public:
      */
     QVector<QRect> pdfImageRegions(const QString& sourceId, int pageIndex, qreal dpi = 96.0) const;
 
+    // ===== Search Index =====
+
+    /**
+     * @brief Persistent full-text search index of this notebook.
+     * @return The index (never null).
+     *
+     * Loaded from the bundle's search_index.bin on first use; PDF entries of
+     * sources whose hash changed are dropped on every call. Call on the main
+     * thread and hand the pointer to search workers (the index itself is
+     * thread-safe). Page entries follow what is saved: writePageFiles() and
+     * the save pipeline index pages as they write them; savePageOcr()
+     * re-indexes clean pages and drops the entry of dirty ones until their
+     * next save.
+     */
+    PdfSearchIndex* searchIndex() const;
+
     /**
-     * @brief Shrink every open PDF provider's internal resource cache to free memory.
+     * @brief Write the search index into the bundle if it changed.
+     *
+     * Called by saveBundle() and after a whole-document search scan (so a
+     * read-only session still keeps the index it built). No-op for unsaved
+     * documents.
      */
-    void trimPdfStore() const;
+    void saveSearchIndex() const;
 
     /**
      * @brief Get the number of pages in the primary PDF.
@@ -1274,7 +1450,8 @@ public:
      *
      * Unlike pdfPageIndexForNotebookPage(), this resolves against ANY source (not
      * just primary), reading the live Page fields so it stays correct for pages
-     * imported at runtime. Used by multi-source export and search.
+     * imported at runtime. Pages not in memory are answered from the manifest
+     * maps without loading them. Used by multi-source export and search.
      */
     bool pdfBindingForNotebookPage(int notebookPageIndex, QString& outSourceId, int& outPdfPage) const;
 
@@ -1422,6 +1599,73 @@ public:
      */
     QVector<int> loadedPageIndices() const;
     
+    // ===== Background Loading =====
+    // page() and getTile() load lazily on the calling (GUI) thread. The paint
+    // path instead splits a load in three, so file I/O, JSON parsing, stroke
+    // sidecar decoding and image asset reads run on a worker thread:
+    //   1. pageLoadRequest() / tileLoadRequest() - GUI thread: capture what
+    //      the reader needs (the worker never touches the Document)
+    //   2. readPageData() / readTileData() - any thread: build a detached Page
+    //   3. installPageData() / installTileData() - GUI thread: adopt it, unless
+    //      a synchronous load, an eviction or a deletion happened meanwhile
+    // The synchronous loaders run the same three steps back to back.
+    
+    /**
+     * @brief What a background read needs; captured on the GUI thread.
+     */
+    struct LoadRequest {
+        QString key;                 ///< Page UUID, or "x,y" for a tile
+        TileCoord coord{0, 0};       ///< Tile coordinate (edgeless only)
+        QString path;                ///< JSON file to read
+        QString bundlePath;          ///< For image assets
+        int bundleVersion = 0;       ///< Decides between sidecar and inline strokes
+        bool compactTile = false;    ///< Tile layers are rebuilt from the manifest on install
+        quint64 epoch = 0;           ///< Eviction epoch at request time
+        bool valid = false;          ///< False: nothing to read in the background
+    };
+    
+    /**
+     * @brief Result of a background read: a page/tile not yet in the document.
+     */
+    struct LoadedData {
+        LoadRequest request;
+        std::unique_ptr<Page> page;                     ///< Null if the read failed
+        StrokeBinaryCodec::LayerStrokes strokesByLayer; ///< Compact tiles: strokes per layer id
+        bool compactLayers = false;                     ///< Tile layers still to be built from the manifest
+        bool legacyStrokes = false;                     ///< Strokes were inline JSON
+        bool fileMissing = false;                       ///< The JSON file could not be opened
+        bool strokesUnreadable = false;                 ///< The stroke sidecar is missing or corrupt
+    };
+    
+    /**
+     * @brief Prepare a background load of a page.
+     * @return Invalid if the page is loaded, out of range, or has no file on
+     *         disk (pristine PDF pages are synthesized cheaply by page()).
+     */
+    LoadRequest pageLoadRequest(int index) const;
+    
+    /**
+     * @brief Prepare a background load of a tile.
+     * @return Invalid if the tile is loaded, not on disk, or lazy loading is off.
+     */
+    LoadRequest tileLoadRequest(TileCoord coord) const;
+    
+    /// Read and parse a page file into a detached Page. Any thread.
+    static LoadedData readPageData(const LoadRequest& request);
+    
+    /// Read and parse a tile file into a detached Page. Any thread.
+    static LoadedData readTileData(const LoadRequest& request);
+    
+    /**
+     * @brief Adopt a page read by readPageData().
+     * @return True if installed; false if it failed to read or is stale
+     *         (already loaded, evicted or deleted since the request).
+     */
+    bool installPageData(LoadedData&& data) const;
+    
+    /// Adopt a tile read by readTileData(); see installPageData().
+    bool installTileData(LoadedData&& data) const;
+    
     /**
      * @brief Get the UUID of a page by index.
      * @param index 0-based page index.
@@ -1492,6 +1736,65 @@ public:
      */
     bool savePage(int index);
     
+    /**
+     * @brief Write a page's JSON file and its binary stroke sidecar.
+     * @param bundlePath Target bundle (differs from m_bundlePath on Save As).
+     * @param uuid Page UUID (file name stem).
+     * @param page Page to serialize.
+     * @return True if the JSON file was written.
+     *
+     * The JSON keeps page properties, layer properties and objects; strokes go
+     * to pages/{uuid}.strokes. Also drops the page from the legacy-format
+     * migration set.
+     */
+    bool writePageFiles(const QString& bundlePath, const QString& uuid,
+                        const Page* page) const;
+    
+    /**
+     * @brief Path of the binary stroke sidecar belonging to a page/tile JSON file.
+     */
+    static QString strokeSidecarPath(const QString& jsonPath);
+    
+    /**
+     * @brief Encode the given layers' strokes into the sidecar at @p path.
+     * @return True on success.
+     */
+    static bool writeStrokeSidecar(const QString& path,
+                                   const QVector<StrokeBinaryCodec::LayerBlock>& layers);
+    
+    /// Snapshot a page for writing into @p bundlePath (GUI thread).
+    SaveFile pageSaveFile(const QString& bundlePath, const QString& uuid, const Page* page) const;
+    
+    /// Snapshot a tile for writing into @p bundlePath (GUI thread).
+    SaveFile tileSaveFile(const QString& bundlePath, TileCoord coord, const Page* tile) const;
+    
+    /// Write a snapshot's sidecar, then its JSON, each atomically. Any thread.
+    static bool writeSaveFile(const SaveFile& file);
+    
+    /// Where a page/tile file keeps its strokes (see readStrokeSidecarFile()).
+    enum class StrokeStore {
+        Inline,     ///< No store marker: inline JSON arrays (pre-v4, or no strokes)
+        Sidecar,    ///< Read from the binary sidecar
+        Unreadable  ///< Marker present, but the sidecar is missing or corrupt
+    };
+    
+    /**
+     * @brief Load strokes for a page/tile JSON object that uses the sidecar.
+     * @param containerJson Parsed page/tile JSON.
+     * @param jsonPath Path of that JSON file (sidecar path is derived from it).
+     * @param bundleVersion Format version of the bundle.
+     * @param out Receives strokes keyed by layer id.
+     * 
+     * Files are only written with the marker when their sidecar has strokes,
+     * so a marker without a readable sidecar is always an error. Any thread.
+     */
+    static StrokeStore readStrokeSidecarFile(const QJsonObject& containerJson,
+                                             const QString& jsonPath, int bundleVersion,
+                                             StrokeBinaryCodec::LayerStrokes& out);
+    
+    /// Record a page/tile whose sidecar is unreadable (see m_unreadableStrokes).
+    void markStrokesUnreadable(const QString& key, const QString& jsonPath) const;
+    
     /**
      * @brief Evict a page from memory (save if dirty first).
      * @param index 0-based page index.
@@ -1514,6 +1817,26 @@ public:
      */
     bool isPageDirty(int index) const;
     
+    /**
+     * @brief Content revision of a page, persisted in the manifest.
+     * @param index 0-based page index.
+     * @return Revision of the page's last saved state (0 = never rewritten).
+     * 
+     * Each save or eviction that writes a dirty page advances its revision, so
+     * (page UUID, revision) names one saved state of the page. Only
+     * meaningful while the page is clean (see ThumbnailStore).
+     */
+    quint32 pageRevision(int index) const;
+    
+    /**
+     * @brief Stroke sidecars that failed to load, one per page/tile.
+     * 
+     * Such pages/tiles are kept out of memory: page() and getTile() return
+     * nullptr for them and getOrCreateTile() does not replace them, so no
+     * save can overwrite the file with an empty page. The list only grows.
+     */
+    QStringList unreadableStrokeFiles() const;
+    
     /**
      * @brief Add a new page at the end of the document.
      * @return Pointer to the newly created page.
@@ -1802,7 +2125,18 @@ private:
     /// Lazily-opened providers keyed by source id. The primary is opened eagerly on
     /// load; other sources open on first render. Mutable so providerForSource() (used
     /// from const render paths) can populate the cache.
-    mutable std::map<QString, std::unique_ptr<PdfProvider>> m_pdfProviders;
+    /// Providers come from PdfProvider::shared(), so background workers that
+    /// open the same file reuse this parse instead of reopening it.
+    mutable std::map<QString, std::shared_ptr<PdfProvider>> m_pdfProviders;
+
+    /// Full-text search index (lazily loaded by searchIndex()).
+    mutable std::unique_ptr<PdfSearchIndex> m_searchIndex;
+
+    /// Markdown note title/body index (lazily loaded by noteIndex()).
+    mutable std::unique_ptr<MarkdownNoteIndex> m_noteIndex;
+
+    /// m_noteIndex, loaded from the bundle on first use.
+    MarkdownNoteIndex* noteIndex() const;
 
     // ===== Private PDF source helpers =====
     /// The primary source (the document's own base PDF, flagged primary), or nullptr
@@ -1888,9 +2222,53 @@ private:
     /// Pages that have been modified since last save.
     mutable std::set<QString> m_dirtyPages;
     
+    /// Content revision per page (see pageRevision()). Key: page UUID.
+    /// Kept for deleted pages so an undone deletion never reuses a revision.
+    std::map<QString, quint32> m_pageRevisions;
+    
     /// Pages that have been deleted and need cleanup on next save.
     std::set<QString> m_deletedPages;
     
+    /// Pages/tiles whose stroke sidecar could not be read (key: page UUID or
+    /// "x,y" tile key; value: sidecar path). They stay unloaded so the files
+    /// on disk are never replaced by an empty page/tile.
+    mutable std::map<QString, QString> m_unreadableStrokes;
+    
+    /// Pages/tiles loaded from legacy inline-JSON strokes. saveBundle rewrites
+    /// them in the binary format even when they are not dirty, so old bundles
+    /// migrate incrementally as they are used.
+    mutable std::set<QString> m_legacyStrokePages;
+    mutable std::set<std::pair<int,int>> m_legacyStrokeTiles;
+    
+    /// bundle_format_version read from document.json (current version for
+    /// documents that were never loaded from disk).
+    int m_loadedBundleVersion = BUNDLE_FORMAT_VERSION;
+    
+    /// Bumped on every page/tile eviction. A background read requested
+    /// before its key was evicted may have read the file before the eviction
+    /// saved it, so installPageData()/installTileData() reject it. An entry
+    /// is dropped once its key is loaded again (older reads then fail the
+    /// "already loaded" check) or its page is deleted.
+    mutable quint64 m_evictionEpoch = 0;
+    mutable QHash<QString, quint64> m_evictedAtEpoch;   ///< LoadRequest::key -> epoch
+    
+    /// document.json as last written or read; an identical manifest is not
+    /// rewritten.
+    QByteArray m_savedManifest;
+    
+    /// Stroke journal of m_bundlePath; created on the first journaled edit.
+    std::unique_ptr<StrokeJournal> m_strokeJournal;
+    
+    /**
+     * @brief Apply the bundle's stroke journal on top of the loaded files.
+     * @return Number of records applied. Touched pages/tiles are marked dirty.
+     */
+    int replayStrokeJournal();
+    
+    /// Background save in flight (see saveBundleInBackground()).
+    std::shared_ptr<SaveJob> m_pendingSaveJob;
+    QFuture<bool> m_pendingSave;
+    
     // ===== Tiles (Phase E1 - Edgeless Mode) =====
     /// Sparse 2D map of tiles for edgeless mode. Key = (tx, ty) tile coordinate.
     /// Uses std::map instead of QMap because QMap requires copyable values,
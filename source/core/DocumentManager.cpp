@@ -12,6 +12,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
+#include <QFutureWatcher>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QStandardPaths>
@@ -41,6 +42,12 @@ DocumentManager::~DocumentManager()
 {
     // Clean up temp bundles and delete all owned documents
     for (Document* doc : m_documents) {
+        // Let a background save land before anything touches the bundle.
+        // Unsaved stroke edits were declined by now; don't replay them on
+        // the next open.
+        doc->completeBackgroundSave();
+        doc->discardStrokeJournal();
+        
         // Clean up temp bundle if exists (handles discarded edgeless docs)
         cleanupTempBundle(doc);
         
@@ -261,6 +268,47 @@ bool DocumentManager::saveDocument(Document* doc)
     return doSave(doc, path);
 }
 
+bool DocumentManager::saveDocumentInBackground(Document* doc)
+{
+    if (!doc || !m_documents.contains(doc)) {
+        return false;
+    }
+    
+    const QString path = m_documentPaths.value(doc);
+    if (path.isEmpty() || isUsingTempBundle(doc) || path != doc->bundlePath()) {
+        return false;  // First save or Save As: copies files, stays synchronous
+    }
+    
+    if (!doc->saveBundleInBackground(path)) {
+        return false;
+    }
+    m_modifiedFlags[doc] = false;  // doc->modified was cleared by the snapshot
+    
+    auto* watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, doc, path]() {
+        watcher->deleteLater();
+        
+        // Closed, or finished early by a save/eviction that had to wait for it
+        if (!m_documents.contains(doc) || !doc->isSaveInFlight()) {
+            return;
+        }
+        
+        if (!doc->completeBackgroundSave()) {
+            qWarning() << "DocumentManager: Background save failed:" << path;
+            m_modifiedFlags[doc] = true;
+            emit documentModified(doc);
+            emit documentSaveFailed(doc, path);
+            return;
+        }
+        
+        addToRecent(path);
+        NotebookLibrary::instance()->addToRecent(path);
+        emit documentSaved(doc);
+    });
+    watcher->setFuture(doc->backgroundSave());
+    return true;
+}
+
 bool DocumentManager::saveDocumentAs(Document* doc, const QString& path)
 {
     if (!doc) {
@@ -298,6 +346,11 @@ void DocumentManager::closeDocument(Document* doc)
              << "remaining=" << (m_documents.size() - 1);
 #endif
     
+    // Let a background save land before the bundle is cleaned up. Unsaved
+    // stroke edits were declined by now; don't replay them on the next open.
+    doc->completeBackgroundSave();
+    doc->discardStrokeJournal();
+    
     // Emit signal before deletion so receivers can clean up
     // Phase P.2.8: MainWindow should connect to this signal to save thumbnail
     // via NotebookLibrary::instance()->saveThumbnail(path, thumbnail)
@@ -685,6 +738,12 @@ int DocumentManager::autoSaveModifiedDocuments()
     for (Document* doc : m_documents) {
         if (!doc) continue;
         
+        // The process may be killed right after this returns: land a
+        // background save still writing, and retry it below if it failed
+        if (doc->isSaveInFlight() && !doc->completeBackgroundSave()) {
+            m_modifiedFlags[doc] = true;
+        }
+        
         // Check if document has unsaved changes
         // IMPORTANT: Use hasUnsavedChanges() which checks both m_modifiedFlags
         // AND doc->modified. User edits often set doc->modified directly
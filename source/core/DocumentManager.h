@@ -92,7 +92,8 @@ public:
      * @brief Auto-save all modified documents (for Android background save).
      * @return Number of documents saved.
      * 
-     * For documents with existing paths: saves in-place.
+     * For documents with existing paths: saves in-place. Every save,
+     * including a background save already in flight, is on disk on return.
      * For new documents: saves to app storage with auto-generated name.
      * All saved documents are added to NotebookLibrary.
      * 
@@ -135,6 +136,19 @@ public:
      */
     bool saveDocumentAs(Document* doc, const QString& path);
 
+    /**
+     * @brief Save a document in place, writing its files on a worker thread.
+     * @param doc Document to save.
+     * @return True if the save started.
+     * 
+     * Used by manual in-place saves. Only for documents that already have a
+     * permanent bundle (not temp, not a first save); suspend, close and
+     * Save As stay synchronous. Dirty pages are snapshotted right away; edits made
+     * while the files are written mark the document modified again.
+     * Emits documentSaved() once the files are on disk.
+     */
+    bool saveDocumentInBackground(Document* doc);
+
     /**
      * @brief Close a document and release its resources.
      * @param doc Document to close.
@@ -279,6 +293,13 @@ signals:
      */
     void documentModified(Document* doc);
 
+    /**
+     * @brief Emitted when a background save could not write its files.
+     * @param doc The document, marked modified again.
+     * @param path Bundle that was being written.
+     */
+    void documentSaveFailed(Document* doc, const QString& path);
+
     /**
      * @brief Emitted when the recent documents list changes.
      */
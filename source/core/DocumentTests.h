@@ -10,15 +10,22 @@
 // - Page management (add, remove, insert, move)
 // - Bookmarks (set, remove, navigate)
 // - Serialization round-trip (toFullJson/fromFullJson)
+// - Binary stroke sidecar round-trip (saveBundle/loadBundle)
+// - Markdown note index (saveNoteFile/markdownNote)
+// - Search index entries follow saved content (savePageOcr/saveBundle)
+// - Page revisions and stored thumbnails across evict/reopen
 // - PDF reference (if PDF available)
 // ============================================================================
 
 #include "Document.h"
 #include "Page.h"
+#include "../pdf/PdfSearchIndex.h"
+#include "../ui/ThumbnailStore.h"
 #include <QDebug>
 #include <QJsonDocument>
 #include <QFileInfo>
 #include <QImage>
+#include <QTemporaryDir>
 #include <cassert>
 
 namespace DocumentTests {
@@ -1349,6 +1356,497 @@ inline bool testMovePage()
     return success;
 }
 
+/**
+ * @brief Test the binary stroke sidecar written by saveBundle.
+ * 
+ * Tests:
+ * - Codec round-trip keeps ids, colors, timestamps and quantized positions
+ * - Saved page JSON carries the stroke_store marker and no inline strokes
+ * - loadBundle restores the strokes from pages/<uuid>.strokes
+ * - Pages without strokes carry no marker
+ * - A missing/corrupt sidecar leaves its page unloaded and untouched by saves
+ */
+inline bool testBinaryStrokeRoundTrip()
+{
+    qDebug() << "=== Test: Binary Stroke Sidecar Round-Trip ===";
+    bool success = true;
+    
+    VectorStroke stroke;
+    stroke.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    stroke.color = QColor(10, 20, 30, 128);
+    stroke.baseThickness = 4.5;
+    stroke.points.append({QPointF(12.25, 40.5), 0.5, 1000});
+    stroke.points.append({QPointF(13.0, 41.75), 0.75, 1008});
+    stroke.points.append({QPointF(-5.125, 300.0), 1.0, 1016});
+    stroke.updateBoundingBox();
+    
+    VectorStroke legacyId;
+    legacyId.id = "stroke-legacy";
+    legacyId.color = Qt::red;
+    legacyId.points.append({QPointF(1, 2), 0.3});
+    legacyId.updateBoundingBox();
+    
+    // 1. Codec round-trip
+    QVector<VectorStroke> strokes{stroke, legacyId};
+    QVector<StrokeBinaryCodec::LayerBlock> blocks;
+    blocks.append(StrokeBinaryCodec::LayerBlock{QStringLiteral("layer-a"), &strokes});
+    QByteArray blob = StrokeBinaryCodec::encode(blocks);
+    StrokeBinaryCodec::LayerStrokes decoded;
+    if (!StrokeBinaryCodec::decode(blob, decoded) || decoded.value("layer-a").size() != 2) {
+        qDebug() << "FAIL: codec did not decode its own output";
+        return false;
+    }
+    const VectorStroke& d0 = decoded["layer-a"][0];
+    const VectorStroke& d1 = decoded["layer-a"][1];
+    if (d0.id != stroke.id || d1.id != legacyId.id) {
+        qDebug() << "FAIL: stroke ids not preserved:" << d0.id << d1.id;
+        success = false;
+    }
+    if (d0.color != stroke.color || !qFuzzyCompare(d0.baseThickness, 4.5)) {
+        qDebug() << "FAIL: color/thickness not preserved";
+        success = false;
+    }
+    for (int i = 0; i < stroke.points.size(); ++i) {
+        const StrokePoint& a = stroke.points[i];
+        const StrokePoint& b = d0.points[i];
+        if (qAbs(a.pos.x() - b.pos.x()) > 1.0 / StrokeBinaryCodec::COORD_SCALE ||
+            qAbs(a.pos.y() - b.pos.y()) > 1.0 / StrokeBinaryCodec::COORD_SCALE ||
+            qAbs(a.pressure - b.pressure) > 1.0 / StrokeBinaryCodec::PRESSURE_SCALE ||
+            a.timestamp != b.timestamp) {
+            qDebug() << "FAIL: point" << i << "differs after decode";
+            success = false;
+        }
+    }
+    
+    // Truncated data must be rejected rather than half-loaded
+    if (StrokeBinaryCodec::decode(blob.left(blob.size() - 3), decoded)) {
+        qDebug() << "FAIL: truncated container was accepted";
+        success = false;
+    }
+    qDebug() << "  - Codec round-trip:" << blob.size() << "bytes";
+    
+    // 2. Bundle round-trip
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        qDebug() << "SKIP: no temporary directory";
+        return success;
+    }
+    const QString bundlePath = tempDir.path() + "/binary.snb";
+    
+    auto doc = Document::createNew("Binary Strokes", Document::Mode::Paged);
+    doc->page(0)->activeLayer()->addStroke(stroke);
+    const QString pageUuid = doc->page(0)->uuid;
+    if (!doc->saveBundle(bundlePath)) {
+        qDebug() << "FAIL: saveBundle failed";
+        return false;
+    }
+    
+    QFile pageFile(bundlePath + "/pages/" + pageUuid + ".json");
+    if (!pageFile.open(QIODevice::ReadOnly)) {
+        qDebug() << "FAIL: page JSON not written";
+        return false;
+    }
+    const QJsonObject pageObj = QJsonDocument::fromJson(pageFile.readAll()).object();
+    pageFile.close();
+    if (pageObj["stroke_store"].toString() != StrokeBinaryCodec::storeMarker() ||
+        pageObj["layers"].toArray().first().toObject().contains("strokes")) {
+        qDebug() << "FAIL: page JSON still carries inline strokes";
+        success = false;
+    }
+    if (!QFile::exists(bundlePath + "/pages/" + pageUuid + ".strokes")) {
+        qDebug() << "FAIL: stroke sidecar not written";
+        success = false;
+    }
+    
+    auto loaded = Document::loadBundle(bundlePath);
+    if (!loaded || !loaded->page(0) || loaded->page(0)->activeLayer()->strokeCount() != 1) {
+        qDebug() << "FAIL: strokes not restored from sidecar";
+        return false;
+    }
+    if (loaded->page(0)->activeLayer()->strokes().first().id != stroke.id) {
+        qDebug() << "FAIL: restored stroke id mismatch";
+        success = false;
+    }
+    qDebug() << "  - Bundle round-trip: OK";
+    
+    // 3. A page without strokes carries no marker (so never needs a sidecar)
+    {
+        const QString emptyPath = tempDir.path() + "/empty.snb";
+        auto emptyDoc = Document::createNew("No Strokes", Document::Mode::Paged);
+        const QString emptyUuid = emptyDoc->page(0)->uuid;
+        emptyDoc->markPageDirty(0);
+        if (!emptyDoc->saveBundle(emptyPath)) {
+            qDebug() << "FAIL: saveBundle of empty page failed";
+            return false;
+        }
+        QFile emptyFile(emptyPath + "/pages/" + emptyUuid + ".json");
+        emptyFile.open(QIODevice::ReadOnly);
+        const QJsonObject emptyObj = QJsonDocument::fromJson(emptyFile.readAll()).object();
+        if (emptyObj.contains("stroke_store")
+            || QFile::exists(emptyPath + "/pages/" + emptyUuid + ".strokes")) {
+            qDebug() << "FAIL: page without strokes still refers to a sidecar";
+            success = false;
+        }
+        auto emptyLoaded = Document::loadBundle(emptyPath);
+        if (!emptyLoaded || !emptyLoaded->page(0)
+            || !emptyLoaded->unreadableStrokeFiles().isEmpty()) {
+            qDebug() << "FAIL: page without strokes did not load";
+            success = false;
+        }
+    }
+    
+    // 4. Marker with a missing or corrupt sidecar: the page stays unloaded and
+    //    a later save must not replace its files
+    const QString pageJsonPath = bundlePath + "/pages/" + pageUuid + ".json";
+    const QString sidecarPath = bundlePath + "/pages/" + pageUuid + ".strokes";
+    loaded.reset();
+    for (int variant = 0; variant < 2; ++variant) {
+        QFile::remove(sidecarPath);
+        if (variant == 1) {
+            QFile corrupt(sidecarPath);
+            corrupt.open(QIODevice::WriteOnly);
+            corrupt.write(blob.left(blob.size() - 3));
+        }
+        
+        auto damaged = Document::loadBundle(bundlePath);
+        if (!damaged) {
+            qDebug() << "FAIL: loadBundle failed on a damaged sidecar";
+            return false;
+        }
+        if (damaged->page(0) || damaged->unreadableStrokeFiles().size() != 1) {
+            qDebug() << "FAIL: page with" << (variant ? "corrupt" : "missing")
+                     << "sidecar was loaded instead of reported";
+            success = false;
+        }
+        
+        // Any other change, then save: the damaged page's files stay as they are
+        damaged->addPage();
+        damaged->markPageDirty(0);
+        if (!damaged->saveBundle(bundlePath)) {
+            qDebug() << "FAIL: saveBundle failed next to a damaged page";
+            success = false;
+        }
+        QFile pageJson(pageJsonPath);
+        pageJson.open(QIODevice::ReadOnly);
+        const QJsonObject kept = QJsonDocument::fromJson(pageJson.readAll()).object();
+        if (kept["stroke_store"].toString() != StrokeBinaryCodec::storeMarker()
+            || QFile::exists(sidecarPath) != (variant == 1)) {
+            qDebug() << "FAIL: save overwrote the page with the damaged sidecar";
+            success = false;
+        }
+    }
+    qDebug() << "  - Damaged sidecar kept and reported: OK";
+    
+    if (success) {
+        qDebug() << "PASS: Binary stroke sidecar round-trip";
+    }
+    return success;
+}
+
+/**
+ * @brief Test the persistent markdown note index.
+ * 
+ * Tests:
+ * - saveNoteFile() writes the .md file and markdownNote() serves it
+ * - saveBundle() persists notes_index.json and loadBundle() reuses it
+ * - A note edited outside SpeedyNote is re-read instead of served stale
+ */
+inline bool testMarkdownNoteIndex()
+{
+    qDebug() << "=== Test: Markdown Note Index ===";
+    bool success = true;
+    
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        qDebug() << "SKIP: no temporary directory";
+        return true;
+    }
+    const QString bundlePath = tempDir.path() + "/notes.snb";
+    
+    auto doc = Document::createNew("Notes", Document::Mode::Paged);
+    if (!doc->saveBundle(bundlePath)) {
+        qDebug() << "FAIL: saveBundle failed";
+        return false;
+    }
+    
+    MarkdownNote note;
+    note.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    note.title = "Groceries";
+    note.content = "Milk and eggs\n";
+    if (!doc->saveNoteFile(note) || !QFile::exists(doc->notesPath() + "/" + note.id + ".md")) {
+        qDebug() << "FAIL: note file not written";
+        return false;
+    }
+    if (doc->markdownNote(note.id).content != "Milk and eggs") {
+        qDebug() << "FAIL: indexed note differs from a reload";
+        success = false;
+    }
+    doc->saveBundle(bundlePath);
+    if (!QFile::exists(bundlePath + "/" + MarkdownNoteIndex::FILE_NAME)) {
+        qDebug() << "FAIL: note index not saved";
+        success = false;
+    }
+    
+    auto loaded = Document::loadBundle(bundlePath);
+    if (!loaded || loaded->markdownNote(note.id).title != "Groceries") {
+        qDebug() << "FAIL: note not served after reload";
+        return false;
+    }
+    
+    // Edit the file behind the index's back
+    MarkdownNote edited = note;
+    edited.content = "Bread, butter and jam";
+    edited.saveToFile(loaded->notesPath() + "/" + note.id + ".md");
+    auto reloaded = Document::loadBundle(bundlePath);
+    if (!reloaded || reloaded->markdownNote(note.id).content != edited.content) {
+        qDebug() << "FAIL: stale index entry served for an edited note";
+        success = false;
+    }
+    
+    if (success) {
+        qDebug() << "PASS: Markdown note index";
+    }
+    return success;
+}
+
+/**
+ * @brief Test crash recovery from the stroke journal.
+ * 
+ * Tests:
+ * - journalStrokes() appends to strokes.journal in the bundle
+ * - loadBundle() replays it (as after a crash) and marks the page dirty
+ * - A torn record at the end is ignored
+ * - The next save writes the page and drops the journal
+ */
+inline bool testStrokeJournalReplay()
+{
+    qDebug() << "=== Test: Stroke Journal Replay ===";
+    bool success = true;
+    
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        qDebug() << "SKIP: no temporary directory";
+        return true;
+    }
+    const QString bundlePath = tempDir.path() + "/journal.snb";
+    const QString journalPath = bundlePath + "/" + StrokeJournal::FILE_NAME;
+    
+    auto doc = Document::createNew("Journal", Document::Mode::Paged);
+    if (!doc->saveBundle(bundlePath)) {
+        qDebug() << "FAIL: saveBundle failed";
+        return false;
+    }
+    
+    VectorStroke kept;
+    kept.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    kept.color = Qt::blue;
+    kept.points.append({QPointF(10, 10), 0.5});
+    kept.points.append({QPointF(20, 30), 0.5});
+    kept.updateBoundingBox();
+    VectorStroke erased = kept;
+    erased.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    
+    // Draw two strokes, erase one; the session then "crashes" (no save)
+    VectorLayer* layer = doc->page(0)->activeLayer();
+    const int layerIndex = doc->page(0)->activeLayerIndex;
+    layer->addStroke(kept);
+    layer->addStroke(erased);
+    doc->journalStrokes(StrokeJournal::Op::Add, 0, {0, 0}, layerIndex, {kept, erased});
+    layer->removeStroke(erased.id);
+    doc->journalStrokes(StrokeJournal::Op::Remove, 0, {0, 0}, layerIndex, {erased});
+    if (!QFile::exists(journalPath)) {
+        qDebug() << "FAIL: journal not written";
+        return false;
+    }
+    
+    // A torn record from a crash mid-append
+    {
+        QFile journal(journalPath);
+        journal.open(QIODevice::Append);
+        journal.write(QByteArray("\x40\x00\x00\x00garbage", 11));
+    }
+    
+    auto recovered = Document::loadBundle(bundlePath);
+    if (!recovered || !recovered->page(0)) {
+        qDebug() << "FAIL: bundle did not load";
+        return false;
+    }
+    const VectorLayer* recoveredLayer = recovered->page(0)->activeLayer();
+    if (recoveredLayer->strokeCount() != 1 || recoveredLayer->strokes().first().id != kept.id) {
+        qDebug() << "FAIL: journal replay gave" << recoveredLayer->strokeCount() << "strokes";
+        success = false;
+    }
+    if (!recovered->modified) {
+        qDebug() << "FAIL: recovered document not marked modified";
+        success = false;
+    }
+    
+    if (!recovered->saveBundle(bundlePath) || QFile::exists(journalPath)) {
+        qDebug() << "FAIL: save did not fold the journal into the page files";
+        success = false;
+    }
+    auto reloaded = Document::loadBundle(bundlePath);
+    if (!reloaded || reloaded->page(0)->activeLayer()->strokeCount() != 1) {
+        qDebug() << "FAIL: strokes lost after compaction";
+        success = false;
+    }
+    
+    if (success) {
+        qDebug() << "PASS: Stroke journal replay";
+    }
+    return success;
+}
+
+/**
+ * @brief Test that page entries of the search index follow saved content.
+ * 
+ * Tests:
+ * - savePageOcr() on a dirty page drops its entry instead of indexing
+ *   text boxes that are not saved yet
+ * - The next saveBundle() indexes the page again
+ * - savePageOcr() on a clean page indexes its new OCR text
+ */
+inline bool testSearchIndexFollowsSave()
+{
+    qDebug() << "=== Test: Search Index Follows Save ===";
+    bool success = true;
+    
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        qDebug() << "SKIP: no temporary directory";
+        return true;
+    }
+    const QString bundlePath = tempDir.path() + "/search.snb";
+    
+    auto doc = Document::createNew("Search", Document::Mode::Paged);
+    if (!doc->saveBundle(bundlePath)) {
+        qDebug() << "FAIL: saveBundle failed";
+        return false;
+    }
+    Page* page = doc->page(0);
+    const QString key = PdfSearchIndex::pageKey(page->uuid);
+    auto lookup = [&](const char* query) {
+        return doc->searchIndex()->lookup(key, PdfSearchIndex::trigrams(QString::fromLatin1(query)));
+    };
+    
+    // Unsaved edits: OCR finishing must not index them
+    OcrTextBlock block = OcrTextBlock::create();
+    block.text = QStringLiteral("alphabet soup");
+    page->ocrTextBlocks.append(block);
+    doc->markPageDirty(0);
+    doc->savePageOcr(page->uuid, page);
+    if (lookup("alphabet") != PdfSearchIndex::Lookup::Unknown) {
+        qDebug() << "FAIL: dirty page indexed before it was saved";
+        success = false;
+    }
+    
+    if (!doc->saveBundle(bundlePath) || lookup("alphabet") != PdfSearchIndex::Lookup::Possible) {
+        qDebug() << "FAIL: saved page not indexed";
+        success = false;
+    }
+    
+    // Clean page: the OCR sidecar is all that changed, so index it
+    block = OcrTextBlock::create();
+    block.text = QStringLiteral("zebra crossing");
+    page->ocrTextBlocks.append(block);
+    doc->savePageOcr(page->uuid, page);
+    if (lookup("zebra") != PdfSearchIndex::Lookup::Possible) {
+        qDebug() << "FAIL: OCR text of a clean page not indexed";
+        success = false;
+    }
+    
+    if (success) {
+        qDebug() << "PASS: Search index follows save";
+    }
+    return success;
+}
+
+/**
+ * @brief Test that a page written by eviction moves to a new revision.
+ * 
+ * Tests:
+ * - Evicting an edited page advances pageRevision(), so the thumbnail
+ *   stored for the old revision is not served for the new content
+ * - The revision survives save and reopen, and the reopened page has the edit
+ */
+inline bool testPageRevisionAfterEviction()
+{
+    qDebug() << "=== Test: Page Revision After Eviction ===";
+    bool success = true;
+    
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        qDebug() << "SKIP: no temporary directory";
+        return true;
+    }
+    const QString bundlePath = tempDir.path() + "/revision.snb";
+    
+    auto doc = Document::createNew("Revision", Document::Mode::Paged);
+    if (!doc->saveBundle(bundlePath)) {
+        qDebug() << "FAIL: saveBundle failed";
+        return false;
+    }
+    const quint32 savedRevision = doc->pageRevision(0);
+    const ThumbnailStore::Key savedKey = ThumbnailStore::makeKey(doc.get(), 0, 120, false);
+    QImage thumbnail(120, 160, QImage::Format_ARGB32_Premultiplied);
+    thumbnail.fill(Qt::white);
+    if (!ThumbnailStore::save(bundlePath, savedKey, thumbnail)) {
+        qDebug() << "FAIL: thumbnail not stored";
+        return false;
+    }
+    
+    // Edit, then evict: the eviction writes the page file
+    VectorStroke stroke;
+    stroke.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    stroke.points.append({QPointF(10, 10), 0.5, 1000});
+    stroke.points.append({QPointF(60, 40), 0.5, 1008});
+    stroke.updateBoundingBox();
+    doc->page(0)->activeLayer()->addStroke(stroke);
+    doc->markPageDirty(0);
+    doc->evictPage(0);
+    
+    const quint32 evictedRevision = doc->pageRevision(0);
+    if (doc->isPageDirty(0) || evictedRevision <= savedRevision) {
+        qDebug() << "FAIL: evicted page kept revision" << evictedRevision;
+        success = false;
+    }
+    const ThumbnailStore::Key evictedKey = ThumbnailStore::makeKey(doc.get(), 0, 120, false);
+    if (!ThumbnailStore::load(bundlePath, evictedKey).isNull()) {
+        qDebug() << "FAIL: thumbnail of the old content served after eviction";
+        success = false;
+    }
+    
+    if (!doc->saveBundle(bundlePath)) {
+        qDebug() << "FAIL: saveBundle after eviction failed";
+        return false;
+    }
+    doc.reset();
+    
+    auto reopened = Document::loadBundle(bundlePath);
+    if (!reopened) {
+        qDebug() << "FAIL: loadBundle failed";
+        return false;
+    }
+    if (reopened->pageRevision(0) != evictedRevision) {
+        qDebug() << "FAIL: revision not persisted:" << reopened->pageRevision(0)
+                 << "expected" << evictedRevision;
+        success = false;
+    }
+    if (!ThumbnailStore::load(bundlePath, ThumbnailStore::makeKey(reopened.get(), 0, 120, false)).isNull()) {
+        qDebug() << "FAIL: thumbnail of the old content served after reopen";
+        success = false;
+    }
+    if (!reopened->page(0) || reopened->page(0)->activeLayer()->strokeCount() != 1) {
+        qDebug() << "FAIL: evicted edit not on disk";
+        success = false;
+    }
+    
+    if (success) {
+        qDebug() << "PASS: Page revision after eviction";
+    }
+    return success;
+}
+
 /**
  * @brief Run all Document tests.
  * @return True if all tests pass.
@@ -1376,6 +1874,21 @@ inline bool runAllTests()
     allPass &= testSerializationRoundTrip();
     qDebug() << "";
     
+    allPass &= testBinaryStrokeRoundTrip();
+    qDebug() << "";
+    
+    allPass &= testMarkdownNoteIndex();
+    qDebug() << "";
+    
+    allPass &= testStrokeJournalReplay();
+    qDebug() << "";
+    
+    allPass &= testSearchIndexFollowsSave();
+    qDebug() << "";
+    
+    allPass &= testPageRevisionAfterEviction();
+    qDebug() << "";
+    
     allPass &= testPdfReference();
     qDebug() << "";
     
@@ -12,6 +12,7 @@
 #include "MarkdownNote.h"           // Phase M.2: For markdown note creation
 #include "../layers/VectorLayer.h"
 #include "../pdf/PdfProvider.h"     // Use abstract interface, not concrete impl
+#include "../objects/ImageMipCache.h"  // Async image decode: repaint when a level is ready
 #include "../objects/LinkObject.h"  // Phase C.2.3: For cloneWithBackLink
 #include "../objects/OcrTextObject.h"  // Phase 1D: OCR text object deletion
 #include "../objects/TextBoxObject.h"  // Phase 2B: text edit undo
@@ -31,6 +32,7 @@
 #include <QtMath>     // For qPow
 #include <QtConcurrent>   // For async PDF rendering
 #include <QThreadStorage> // For thread-local PDF provider caching
+#include <QVarLengthArray>  // Live stroke tail caps
 #include <cmath>      // For std::floor, std::ceil
 #include <algorithm>  // For std::remove_if
 #include <limits>
@@ -105,23 +107,24 @@ QMap<QString, QPixmap> DocumentViewport::s_objectClipboardAssets;
 
 // ===== Thread-Local PDF Provider Cache =====
 // 
-// Each thread in the QThreadPool keeps its own cached PdfProvider to avoid
-// re-opening and parsing the PDF file for every page render. This significantly
-// improves scrolling performance for large PDFs.
+// Each thread in the QThreadPool keeps a reference to the provider it last
+// rendered from, so a page render doesn't even take the registry lock.
+// The provider itself is the process-wide shared instance
+// (PdfProvider::shared), which renders on pooled MuPDF contexts: all workers
+// and the Document render from one parse of the file, in parallel.
 //
-// Cache entry: stores the PDF path and the provider instance.
-// When the path changes (different document), the old provider is released
-// and a new one is created for the new document.
+// Cache entry: stores the PDF path and the provider reference.
+// When the path changes (different document), the old reference is released.
 
 struct ThreadPdfCache {
     QString pdfPath;
-    std::unique_ptr<PdfProvider> provider;
+    std::shared_ptr<PdfProvider> provider;
     
     PdfProvider* getOrCreate(const QString& path) {
         if (pdfPath != path || !provider || !provider->isValid()) {
-            // Different file or invalid provider - create new one
+            // Different file or invalid provider - look up the shared one
             pdfPath = path;
-            provider = PdfProvider::create(path);
+            provider = PdfProvider::shared(path);
         }
         return provider.get();
     }
@@ -191,6 +194,16 @@ DocumentViewport::DocumentViewport(QWidget* parent)
     m_scrollSettleTimer->setSingleShot(true);
     m_scrollSettleTimer->setInterval(SCROLL_SETTLE_MS);
     connect(m_scrollSettleTimer, &QTimer::timeout, this, &DocumentViewport::onScrollSettled);
+
+    // Scroll-aware residency: throttled prefetch during a pan, idle warming after
+    m_prefetchTimer = new QTimer(this);
+    m_prefetchTimer->setSingleShot(true);
+    m_prefetchTimer->setInterval(PREFETCH_INTERVAL_MS);
+    connect(m_prefetchTimer, &QTimer::timeout, this, &DocumentViewport::prefetchAhead);
+
+    m_idleWarmTimer = new QTimer(this);
+    m_idleWarmTimer->setInterval(IDLE_WARM_INTERVAL_MS);
+    connect(m_idleWarmTimer, &QTimer::timeout, this, &DocumentViewport::warmNextIdle);
     
     // Gesture timeout timer - fallback for detecting gesture end (zoom or pan)
     m_gestureTimeoutTimer = new QTimer(this);
@@ -219,6 +232,41 @@ DocumentViewport::DocumentViewport(QWidget* parent)
         update();
     });
 
+    // Background stroke-cache rebuild poll. Layers rebuilding their capped
+    // cache on the thread pool keep showing the old (scaled) pixmap; the
+    // finished one is swapped in by the next paint, so keep repainting at a
+    // low rate while any rebuild is pending (see noteStrokeCacheRebuild).
+    m_strokeCacheRebuildTimer = new QTimer(this);
+    m_strokeCacheRebuildTimer->setSingleShot(true);
+    m_strokeCacheRebuildTimer->setInterval(30);
+    connect(m_strokeCacheRebuildTimer, &QTimer::timeout, this, [this]() {
+        update();
+    });
+
+    // Predicted ink: no real point arrived within the prediction horizon, so
+    // the pen has stopped. Redraw the live tail (from the last real point)
+    // without the predicted ink.
+    m_inkRetractTimer = new QTimer(this);
+    m_inkRetractTimer->setSingleShot(true);
+    connect(m_inkRetractTimer, &QTimer::timeout, this, [this]() {
+        const int n = static_cast<int>(m_currentStroke.points.size());
+        if (!m_isDrawing || n < 3 || m_lastRenderedPointIndex != n) {
+            return;
+        }
+        m_inkRetractedPoints = n;
+        m_lastRenderedPointIndex = n - 1;
+        updateLiveStrokeTail();
+    });
+
+    // Report this view's render caches to the process-wide memory ceiling
+    CacheBudget::instance()->addClient(this);
+
+    // Image objects decode their mip levels in the background during paint
+    // (see the AsyncScope in paintEvent); draw the sharper level once it lands.
+    connect(ImageMipCache::instance(), &ImageMipCache::imageReady, this, [this]() {
+        update();
+    });
+
     // Tablet hover timer - detects when stylus leaves viewport by timeout
     // When stylus hovers to another widget, we stop receiving TabletMove events.
     // This timer fires if no tablet hover event received within the interval.
@@ -248,6 +296,8 @@ DocumentViewport::DocumentViewport(QWidget* parent)
 
 DocumentViewport::~DocumentViewport()
 {
+    CacheBudget::instance()->removeClient(this);
+    
     // Cancel any pending preload requests
     if (m_pdfPreloadTimer) {
         m_pdfPreloadTimer->stop();
@@ -268,6 +318,9 @@ DocumentViewport::~DocumentViewport()
     if (m_focusRebuildTimer) {
         m_focusRebuildTimer->stop();
     }
+    if (m_strokeCacheRebuildTimer) {
+        m_strokeCacheRebuildTimer->stop();
+    }
     
     // Stop touch handler gestures (including inertia timer)
     // Must happen before m_gesture.reset() to avoid accessing stale gesture state
@@ -296,6 +349,7 @@ DocumentViewport::~DocumentViewport()
         m_pdfCache.clear();
         m_pdfCache.squeeze();  // Release excess capacity
     }
+    m_pdfTileCache.clear();
     
     // Clear selection/drag snapshot caches (can be full viewport-sized pixmaps)
     m_selectionBackgroundSnapshot = QPixmap();
@@ -393,6 +447,14 @@ void DocumentViewport::setDocument(Document* doc)
     m_currentPageIndex = 0;
     m_needsPositionRestore = false;  // Reset deferred restore flag for new document
     m_edgelessPositionHistory.clear();  // Clear old position history for new document
+    m_residency.reset();
+    m_residencyShownPages.clear();
+    m_residencyShownTiles.clear();
+    stopIdleWarm();
+    ++m_loadGeneration;  // Drop reads still in flight for the old document
+    m_pendingLoads.clear();
+    m_failedLoads.clear();
+    m_reportedUnreadable = 0;
     
     // Track if we need to defer update for edgeless position restore
     bool deferUpdateForEdgeless = false;
@@ -1032,6 +1094,7 @@ void DocumentViewport::setPanOffset(QPointF offset, bool steppedScroll)
         m_focusRebuildTimer->start(150);
     }
 
+    const QPointF previousPan = m_panOffset;
     m_panOffset = offset;
     clampPanOffset();
     
@@ -1041,6 +1104,8 @@ void DocumentViewport::setPanOffset(QPointF offset, bool steppedScroll)
     emit panChanged(m_panOffset);
     emitScrollFractions();
     
+    noteScrollMotion(m_panOffset - previousPan);
+    
     // SP1: defer the heavy housekeeping (PDF preload, stroke-cache preload, tile
     // eviction) to onScrollSettled() so it runs once ~SCROLL_SETTLE_MS after the
     // user stops scrolling instead of on every wheel/touchpad event.
@@ -1083,6 +1148,13 @@ void DocumentViewport::onScrollSettled()
     preloadPdfCache();
     preloadStrokeCaches();
     evictDistantTiles();
+    scheduleIdleWarm();
+
+#ifdef SPEEDYNOTE_DEBUG
+    const ResidencyPolicy::Stats& stats = m_residency.stats();
+    qDebug() << "Residency: hits" << stats.hits << "misses" << stats.misses
+             << "prefetched" << stats.prefetched << "hit rate" << stats.hitRate();
+#endif
 
     // Final clean repaint (matters in SP2, where painting draws cache-only
     // while scrolling and needs one repaint to show freshly rendered pages).
@@ -2593,6 +2665,16 @@ void DocumentViewport::paintEvent(QPaintEvent* event)
     }
     
     QPainter painter(this);
+    // Image objects missing their mip level queue a background decode and
+    // draw the nearest cached level; imageReady() triggers the repaint.
+    ImageMipCache::AsyncScope asyncImageDecode;
+    // Caches grow while painting; have the budget check them shortly after
+    // (coalesced, so this is one timer check per frame).
+    CacheBudget::instance()->requestEnforce();
+    // Pages that failed to load draw nothing; say why, outside the paint
+    if (m_document && m_document->unreadableStrokeFiles().size() > m_reportedUnreadable) {
+        QTimer::singleShot(0, this, &DocumentViewport::reportUnreadableStrokeFiles);
+    }
     // Note: Antialiasing is deferred until after gesture fast paths.
     // Gesture paths only blit cached pixmaps and don't need it.
     
@@ -2707,6 +2789,12 @@ void DocumentViewport::paintEvent(QPaintEvent* event)
     QRect dirtyRect = event->rect();
     bool isPartialUpdate = (dirtyRect.width() < width() / 2 || dirtyRect.height() < height() / 2);
     
+    // Everything a full repaint draws is stamped at or after this time, which
+    // tells collectCacheItems() what is on screen right now.
+    if (!isPartialUpdate) {
+        m_lastFullPaintMs = CacheBudget::nowMs();
+    }
+    
     // Fill background - only the dirty region for partial updates
     if (isPartialUpdate) {
         painter.fillRect(dirtyRect, m_backgroundColor);
@@ -2741,6 +2829,7 @@ void DocumentViewport::paintEvent(QPaintEvent* event)
     // ========== PAGED MODE ==========
     // Get visible pages to render
     QVector<int> visible = visiblePages();
+    noteResidency(visible);
     
     // Apply view transform
     painter.save();
@@ -2750,12 +2839,21 @@ void DocumentViewport::paintEvent(QPaintEvent* event)
     // Render each visible page
     // For partial updates, only render pages that intersect the dirty region
     for (int pageIdx : visible) {
-        Page* page = m_document->page(pageIdx);
-        if (!page) continue;
-        
         // Get page position once (O(1) with cache, but avoid redundant calls)
         QPointF pos = pagePosition(pageIdx);
         
+        // While scrolling, a page not yet in memory loads in the background
+        // (no disk I/O on the paint path); draw a blank page until it arrives
+        if (isScrolling() && !m_document->isPageLoaded(pageIdx)
+            && requestBackgroundLoad(pageIdx, false)) {
+            painter.fillRect(QRectF(pos, m_document->pageSizeAt(pageIdx)),
+                             m_document->defaultBackgroundColor);
+            continue;
+        }
+        
+        Page* page = m_document->page(pageIdx);
+        if (!page) continue;
+        
         // Check if this page intersects the dirty region (optimization for partial updates)
         if (isPartialUpdate) {
             QRectF pageRectInViewport = QRectF(
@@ -2785,6 +2883,15 @@ void DocumentViewport::paintEvent(QPaintEvent* event)
     // is in viewport coordinates (not document coordinates)
     if (m_isDrawing && !m_currentStroke.points.isEmpty() && m_activeDrawingPage >= 0) {
         renderCurrentStrokeIncremental(painter);
+        
+        // Input-to-paint delay of every point this paint shows first
+        if (!m_inkPendingInputMs.isEmpty()) {
+            const qint64 now = QElapsedTimer::msecsSinceReference();
+            for (qint64 inputMs : m_inkPendingInputMs) {
+                m_inkPredictor.noteLatency(now - inputMs);
+            }
+            m_inkPendingInputMs.clear();
+        }
     }
     
     // Task 2.9: Draw straight line preview
@@ -3994,6 +4101,7 @@ void DocumentViewport::updatePanGesture(QPointF panDelta)
     
     // Accumulate pan offset (additive)
     m_gesture.targetPan += panDelta;
+    noteScrollMotion(panDelta);
     
     // Note: We don't clamp targetPan here - let endPanGesture handle clamping
     // This allows the visual feedback to show unclamped pan during the gesture
@@ -4043,6 +4151,8 @@ void DocumentViewport::endPanGesture()
     if (m_document && m_document->isEdgeless()) {
         evictDistantTiles();
     }
+    
+    scheduleIdleWarm();
 }
 
 void DocumentViewport::onGestureTimeout()
@@ -4203,6 +4313,7 @@ QPixmap DocumentViewport::lookupCachedPdfPage(const QString& sourceId, int pageI
     QMutexLocker locker(&m_pdfCacheMutex);
     for (const PdfCacheEntry& entry : m_pdfCache) {
         if (entry.matches(sourceId, pageIndex, dpi)) {
+            entry.lastUse = CacheBudget::nowMs();
             return entry.pixmap;  // Cache hit
         }
     }
@@ -4255,8 +4366,6 @@ QPixmap DocumentViewport::getCachedPdfPage(const QString& sourceId, int pageInde
         DarkModeUtils::invertImageLightness(pdfImage, imgRegions);
     }
     
-    m_document->trimPdfStore();
-    
     QPixmap pixmap = QPixmap::fromImage(pdfImage);
     
     // Add to cache (thread-safe)
@@ -4274,6 +4383,7 @@ QPixmap DocumentViewport::getCachedPdfPage(const QString& sourceId, int pageInde
     entry.pageIndex = pageIndex;
     entry.dpi = dpi;
     entry.pixmap = pixmap;
+    entry.lastUse = CacheBudget::nowMs();
     
     // If cache is full, evict the page FURTHEST from current page (smart eviction)
     // This prevents evicting pages we're about to need (like the next visible page)
@@ -4322,10 +4432,13 @@ void DocumentViewport::doAsyncPdfPreload()
     // Pre-load buffer depends on layout mode:
     // - Single column: ±1 page (above and below)
     // - Two column: ±2 pages (1 row above + 1 row below = 4 pages)
+    // The residency policy widens it in the direction of travel and narrows
+    // it behind the reader.
     int preloadBuffer = (m_layoutMode == LayoutMode::TwoColumn) ? 2 : 1;
+    const ResidencyPolicy::Span span = residencyPageSpan(preloadBuffer);
     
-    int preloadStart = qMax(0, first - preloadBuffer);
-    int preloadEnd = qMin(m_document->pageCount() - 1, last + preloadBuffer);
+    int preloadStart = qMax(0, first - span.before);
+    int preloadEnd = qMin(m_document->pageCount() - 1, last + span.after);
     
     qreal dpi = effectivePdfDpi();
     
@@ -4338,6 +4451,11 @@ void DocumentViewport::doAsyncPdfPreload()
     {
         QMutexLocker locker(&m_pdfCacheMutex);
         for (int i = preloadStart; i <= preloadEnd; ++i) {
+            // Pages not in memory load in the background first; the load
+            // completing asks for another preload, which renders them
+            if (!m_document->isPageLoaded(i) && requestBackgroundLoad(i, true)) {
+                continue;
+            }
             Page* page = m_document->page(i);
             if (!page || page->backgroundType != Page::BackgroundType::PDF) {
                 continue;
@@ -4345,6 +4463,11 @@ void DocumentViewport::doAsyncPdfPreload()
             int pdfPageNum = page->pdfPageNumber;
             const QString sourceId = page->pdfSourceId;
             
+            // Already rendering (prefetch runs repeatedly during a pan)
+            if (m_pdfPreloadPending.contains(qMakePair(sourceId, pdfPageNum))) {
+                continue;
+            }
+            
             // Check if already cached
             bool alreadyCached = false;
             for (const PdfCacheEntry& entry : m_pdfCache) {
@@ -4383,6 +4506,7 @@ void DocumentViewport::doAsyncPdfPreload()
         
         // Track watcher for cleanup
         m_activePdfWatchers.append(watcher);
+        m_pdfPreloadPending.insert(qMakePair(sourceId, pdfPageNum));
         
         // THREAD SAFETY FIX: QPixmap must only be created on the main thread.
         // The background thread returns QImage, and we convert to QPixmap here
@@ -4391,6 +4515,7 @@ void DocumentViewport::doAsyncPdfPreload()
             // BUG-A006 FIX: Check if watcher was cancelled (e.g., by invalidatePdfCache)
             // This happens when document/page changes while render is in progress
             m_activePdfWatchers.removeOne(watcher);
+            m_pdfPreloadPending.remove(qMakePair(sourceId, pdfPageNum));
             
             bool wasCancelled = watcher->isCanceled();
             QImage pdfImage;
@@ -4440,6 +4565,7 @@ void DocumentViewport::doAsyncPdfPreload()
             entry.pageIndex = pdfPageNum;
             entry.dpi = dpi;
             entry.pixmap = pixmap;
+            entry.lastUse = CacheBudget::nowMs();
             
             // Evict page FURTHEST from this page (smart eviction)
             if (m_pdfCache.size() >= m_pdfCacheCapacity) {
@@ -4466,18 +4592,16 @@ void DocumentViewport::doAsyncPdfPreload()
         // NOTE: QImage is explicitly documented as thread-safe for read operations
         // and can be safely passed between threads.
         QFuture<QImage> future = QtConcurrent::run([renderPageNum, dpi, pdfPath]() -> QImage {
-            // Use thread-local cached PDF provider to avoid re-opening the PDF
-            // for every page render. Each thread pool worker caches its own provider
-            // (keyed by resolved source path).
+            // Shared provider for the resolved source path (see ThreadPdfCache).
+            // The MuPDF store is shared with every other renderer of this file,
+            // so it is not trimmed after each page any more.
             ThreadPdfCache& cache = s_threadPdfCache.localData();
             PdfProvider* threadPdf = cache.getOrCreate(pdfPath);
             if (!threadPdf || !threadPdf->isValid()) {
                 return QImage();  // Return null image on failure
             }
             
-            QImage result = threadPdf->renderPageToImage(renderPageNum, dpi);
-            threadPdf->trimStore();
-            return result;
+            return threadPdf->renderPageToImage(renderPageNum, dpi);
         });
         
         watcher->setFuture(future);
@@ -4500,6 +4624,14 @@ void DocumentViewport::cancelAndWaitForBackgroundThreads()
         delete watcher;
     }
     m_activePdfWatchers.clear();
+    m_pdfPreloadPending.clear();
+    for (QFutureWatcher<QImage>* watcher : m_activePdfTileWatchers) {
+        watcher->cancel();
+        watcher->waitForFinished();
+        delete watcher;
+    }
+    m_activePdfTileWatchers.clear();
+    m_pendingPdfTiles.clear();
 }
 
 void DocumentViewport::invalidatePdfCache()
@@ -4515,6 +4647,14 @@ void DocumentViewport::invalidatePdfCache()
     for (QFutureWatcher<QImage>* watcher : m_activePdfWatchers) {
         watcher->cancel();
     }
+    m_pdfPreloadPending.clear();
+    for (QFutureWatcher<QImage>* watcher : m_activePdfTileWatchers) {
+        watcher->cancel();
+    }
+    
+    // Tiles are main-thread only; cancelled renders are dropped on delivery
+    m_pdfTileCache.clear();
+    m_pendingPdfTiles.clear();
     
     // Thread-safe cache clear
     QMutexLocker locker(&m_pdfCacheMutex);
@@ -4529,6 +4669,14 @@ void DocumentViewport::invalidatePdfCache()
 
 void DocumentViewport::invalidatePdfCachePage(const QString& sourceId, int pageIndex)
 {
+    m_pdfTileCache.erase(
+        std::remove_if(m_pdfTileCache.begin(), m_pdfTileCache.end(),
+                       [&sourceId, pageIndex](const PdfTileEntry& entry) {
+                           return entry.pageIndex == pageIndex && entry.sourceId == sourceId;
+                       }),
+        m_pdfTileCache.end()
+    );
+    
     // Thread-safe page removal
     QMutexLocker locker(&m_pdfCacheMutex);
     m_pdfCache.erase(
@@ -4550,6 +4698,11 @@ void DocumentViewport::updatePdfCacheCapacity()
     //         6 pages for 2-column (1 row above + 1 row below = 4, plus margin)
     int buffer = (m_layoutMode == LayoutMode::TwoColumn) ? 6 : 3;
     
+    // Room for everything the async preload may bring in ahead of a fast
+    // scroll, so prefetched pages don't evict the visible ones
+    const int preloadBuffer = (m_layoutMode == LayoutMode::TwoColumn) ? 2 : 1;
+    buffer = qMax(buffer, preloadBuffer / 2 + residencyTier(m_zoomLevel * devicePixelRatioF()).maxAhead + 1);
+    
     // New capacity with minimum of 4
     int newCapacity = qMax(4, visibleCount + buffer);
     
@@ -4594,6 +4747,311 @@ void DocumentViewport::evictFurthestCacheEntries()
     }
 }
 
+// ===== Tiled PDF Rendering (high zoom) =====
+
+qreal DocumentViewport::pdfTileDpi() const
+{
+    // Same formula as effectivePdfDpi(), without the 300 DPI cap
+    const qreal dpi = 96.0 * m_zoomLevel * devicePixelRatioF();
+    return dpi > effectivePdfDpi() + 1.0 ? dpi : 0.0;
+}
+
+void DocumentViewport::renderPdfTiles(QPainter& painter, Page* page, int pageIndex,
+                                      int renderPageNum, qreal dpi)
+{
+    // Page units are 96 dpi, so the full page image at this DPI is
+    // page->size * dpi / 96 pixels - the same grid renderPageToImage() uses.
+    const qreal scale = dpi / 96.0;
+    const QRect imageRect(0, 0, qCeil(page->size.width() * scale),
+                          qCeil(page->size.height() * scale));
+    
+    const QRectF pageRect(QPointF(0, 0), page->size);
+    const QRectF visible = visibleRect().translated(-pagePosition(pageIndex)).intersected(pageRect);
+    if (visible.isEmpty()) {
+        return;
+    }
+    
+    const QRect visiblePx = QRectF(visible.x() * scale, visible.y() * scale,
+                                   visible.width() * scale, visible.height() * scale)
+                                .toAlignedRect().intersected(imageRect);
+    if (visiblePx.isEmpty()) {
+        return;
+    }
+    const int firstCol = visiblePx.left() / PDF_TILE_SIZE;
+    const int lastCol = visiblePx.right() / PDF_TILE_SIZE;
+    const int firstRow = visiblePx.top() / PDF_TILE_SIZE;
+    const int lastRow = visiblePx.bottom() / PDF_TILE_SIZE;
+    
+    const QString& sourceId = page->pdfSourceId;
+    const int pdfPageNum = page->pdfPageNumber;
+    const bool canRequest = !isScrolling();
+    
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int col = firstCol; col <= lastCol; ++col) {
+            const QPoint tile(col, row);
+            const QRect pixelRect = QRect(col * PDF_TILE_SIZE, row * PDF_TILE_SIZE,
+                                          PDF_TILE_SIZE, PDF_TILE_SIZE).intersected(imageRect);
+            
+            const PdfTileEntry* cached = nullptr;
+            for (PdfTileEntry& entry : m_pdfTileCache) {
+                if (entry.matches(sourceId, pdfPageNum, dpi, tile)) {
+                    entry.lastUse = CacheBudget::nowMs();
+                    cached = &entry;
+                    break;
+                }
+            }
+            
+            if (cached) {
+                const QPixmap& pm = cached->pixmap;
+                painter.drawPixmap(QRectF(pixelRect.x() / scale, pixelRect.y() / scale,
+                                          pm.width() / scale, pm.height() / scale),
+                                   pm, QRectF(pm.rect()));
+            } else if (canRequest) {
+                requestPdfTile(sourceId, pdfPageNum, renderPageNum, dpi, tile, pixelRect);
+            }
+        }
+    }
+}
+
+void DocumentViewport::requestPdfTile(const QString& sourceId, int pdfPageNum, int renderPageNum,
+                                      qreal dpi, const QPoint& tile, const QRect& pixelRect)
+{
+    for (const PdfTileEntry& pending : m_pendingPdfTiles) {
+        if (pending.matches(sourceId, pdfPageNum, dpi, tile)) {
+            return;  // Already in flight
+        }
+    }
+    
+    const QString pdfPath = m_document->pdfPathForSource(sourceId);
+    if (pdfPath.isEmpty()) {
+        return;
+    }
+    
+    PdfTileEntry key;
+    key.sourceId = sourceId;
+    key.pageIndex = pdfPageNum;
+    key.dpi = dpi;
+    key.tile = tile;
+    m_pendingPdfTiles.append(key);
+    
+    QFutureWatcher<QImage>* watcher = new QFutureWatcher<QImage>(this);
+    m_activePdfTileWatchers.append(watcher);
+    
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, key]() {
+        m_activePdfTileWatchers.removeOne(watcher);
+        m_pendingPdfTiles.erase(
+            std::remove_if(m_pendingPdfTiles.begin(), m_pendingPdfTiles.end(),
+                           [&key](const PdfTileEntry& pending) {
+                               return pending.matches(key.sourceId, key.pageIndex, key.dpi, key.tile);
+                           }),
+            m_pendingPdfTiles.end());
+        
+        const bool wasCancelled = watcher->isCanceled();
+        QImage tileImage;
+        if (!wasCancelled) {
+            tileImage = watcher->result();
+        }
+        delete watcher;
+        
+        // Cancelled by invalidatePdfCache(), failed, or zoom moved on meanwhile
+        if (wasCancelled || tileImage.isNull() || !m_document
+            || !qFuzzyCompare(pdfTileDpi(), key.dpi)) {
+            return;
+        }
+        
+        PdfTileEntry entry = key;
+        entry.pixmap = QPixmap::fromImage(tileImage);
+        entry.lastUse = CacheBudget::nowMs();
+        m_pdfTileCache.append(entry);
+        evictPdfTiles();
+        
+        update();
+    });
+    
+    // Dark-mode inversion runs in the worker too: it is pure QImage work and
+    // a screen of tiles would otherwise stall the GUI thread at high zoom.
+    const bool invert = m_isDarkMode && m_pdfDarkModeEnabled;
+    const bool maskImages = !m_skipImageMasking;
+    QFuture<QImage> future = QtConcurrent::run(
+        [pdfPath, renderPageNum, dpi, pixelRect, invert, maskImages]() -> QImage {
+            ThreadPdfCache& cache = s_threadPdfCache.localData();
+            PdfProvider* threadPdf = cache.getOrCreate(pdfPath);
+            if (!threadPdf || !threadPdf->isValid()) {
+                return QImage();
+            }
+            
+            QImage image = threadPdf->renderPageRegionToImage(renderPageNum, dpi, pixelRect);
+            if (invert && !image.isNull()) {
+                QVector<QRect> tileRegions;
+                if (maskImages) {
+                    for (const QRect& r : threadPdf->imageRegions(renderPageNum, dpi)) {
+                        const QRect local = r.intersected(pixelRect).translated(-pixelRect.topLeft());
+                        if (!local.isEmpty()) {
+                            tileRegions.append(local);
+                        }
+                    }
+                }
+                DarkModeUtils::invertImageLightness(image, tileRegions);
+            }
+            return image;
+        });
+    watcher->setFuture(future);
+}
+
+void DocumentViewport::evictPdfTiles()
+{
+    // Two viewports' worth of tiles: the visible set plus room to pan back
+    const qreal dpr = devicePixelRatioF();
+    const int cols = qCeil(width() * dpr / PDF_TILE_SIZE) + 1;
+    const int rows = qCeil(height() * dpr / PDF_TILE_SIZE) + 1;
+    const int capacity = qMax(16, cols * rows * 2);
+    
+    while (m_pdfTileCache.size() > capacity) {
+        int evictIdx = 0;
+        for (int i = 1; i < m_pdfTileCache.size(); ++i) {
+            if (m_pdfTileCache[i].lastUse < m_pdfTileCache[evictIdx].lastUse) {
+                evictIdx = i;
+            }
+        }
+        m_pdfTileCache.removeAt(evictIdx);
+    }
+}
+
+// ===== CacheBudget::Client =====
+
+void DocumentViewport::collectCacheItems(QVector<CacheBudget::Item>& items) const
+{
+    // What the last full repaint of a visible view drew is still on screen;
+    // evicting it would force a synchronous rebuild on the next repaint, so
+    // report it as in use now.
+    const qint64 now = CacheBudget::nowMs();
+    const bool shown = isVisible() && m_lastFullPaintMs > 0;
+    auto lastUseOf = [&](qint64 lastUse) {
+        return (shown && lastUse >= m_lastFullPaintMs) ? now : lastUse;
+    };
+
+    auto pixmapItem = [&](const QPixmap& pixmap, qint64 lastUse, qreal cost) {
+        CacheBudget::Item item;
+        item.key = static_cast<quint64>(pixmap.cacheKey());
+        item.sharedKey = pixmap.cacheKey();
+        item.bytes = static_cast<qint64>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+        item.lastUse = lastUseOf(lastUse);
+        item.rebuildCost = cost;
+        return item;
+    };
+
+    {
+        QMutexLocker locker(&m_pdfCacheMutex);
+        for (const PdfCacheEntry& entry : m_pdfCache) {
+            if (!entry.pixmap.isNull()) {
+                items.append(pixmapItem(entry.pixmap, entry.lastUse, CacheBudget::COST_PDF_RENDER));
+            }
+        }
+    }
+    for (const PdfTileEntry& entry : m_pdfTileCache) {
+        if (!entry.pixmap.isNull()) {
+            items.append(pixmapItem(entry.pixmap, entry.lastUse, CacheBudget::COST_PDF_RENDER));
+        }
+    }
+
+    // Stroke, focus and outline caches live on the document's pages; another
+    // view of the same document reports the same caches, which CacheBudget
+    // counts once.
+    if (!m_document) {
+        return;
+    }
+    forEachLoadedLayer([&](VectorLayer* layer) {
+        if (layer->hasStrokeCacheAllocated()) {
+            CacheBudget::Item item;
+            item.key = static_cast<quint64>(layer->strokeCacheKey());
+            item.sharedKey = layer->strokeCacheKey();
+            item.bytes = layer->strokeCacheBytes();
+            item.lastUse = lastUseOf(layer->cacheLastUse());
+            item.rebuildCost = CacheBudget::COST_STROKE_CACHE;
+            items.append(item);
+        }
+        if (layer->hasFocusCacheAllocated()) {
+            CacheBudget::Item item;
+            item.key = static_cast<quint64>(layer->focusCacheKey());
+            item.sharedKey = layer->focusCacheKey();
+            item.bytes = layer->focusCacheBytes();
+            item.lastUse = lastUseOf(layer->cacheLastUse());
+            item.rebuildCost = CacheBudget::COST_STROKE_CACHE;
+            items.append(item);
+        }
+        if (layer->outlineCacheBytes() > 0) {
+            CacheBudget::Item item;
+            item.key = static_cast<quint64>(layer->outlineCacheKey());
+            item.sharedKey = layer->outlineCacheKey();
+            item.bytes = layer->outlineCacheBytes();
+            item.lastUse = lastUseOf(layer->cacheLastUse());
+            item.rebuildCost = CacheBudget::COST_OUTLINE_CACHE;
+            items.append(item);
+        }
+    });
+}
+
+void DocumentViewport::evictCacheItems(const QVector<quint64>& keys)
+{
+    const QSet<quint64> victims(keys.begin(), keys.end());
+    auto isVictim = [&victims](const QPixmap& pixmap) {
+        return !pixmap.isNull() && victims.contains(static_cast<quint64>(pixmap.cacheKey()));
+    };
+
+    {
+        QMutexLocker locker(&m_pdfCacheMutex);
+        m_pdfCache.erase(
+            std::remove_if(m_pdfCache.begin(), m_pdfCache.end(),
+                           [&](const PdfCacheEntry& entry) { return isVictim(entry.pixmap); }),
+            m_pdfCache.end());
+    }
+    m_pdfTileCache.erase(
+        std::remove_if(m_pdfTileCache.begin(), m_pdfTileCache.end(),
+                       [&](const PdfTileEntry& entry) { return isVictim(entry.pixmap); }),
+        m_pdfTileCache.end());
+
+    if (!m_document) {
+        return;
+    }
+    forEachLoadedLayer([&](VectorLayer* layer) {
+        if (layer->hasStrokeCacheAllocated()
+            && victims.contains(static_cast<quint64>(layer->strokeCacheKey()))) {
+            layer->releaseStrokeCache();
+        }
+        if (layer->hasFocusCacheAllocated()
+            && victims.contains(static_cast<quint64>(layer->focusCacheKey()))) {
+            layer->releaseFocusCache();
+        }
+        if (victims.contains(static_cast<quint64>(layer->outlineCacheKey()))) {
+            layer->releaseOutlineCache();
+        }
+    });
+}
+
+void DocumentViewport::forEachLoadedLayer(const std::function<void(VectorLayer*)>& fn) const
+{
+    auto visitPage = [&fn](Page* page) {
+        if (!page) {
+            return;
+        }
+        for (int i = 0; i < page->layerCount(); ++i) {
+            if (VectorLayer* layer = page->layer(i)) {
+                fn(layer);
+            }
+        }
+    };
+
+    if (m_document->isEdgeless()) {
+        for (const auto& coord : m_document->allLoadedTileCoords()) {
+            visitPage(m_document->getTile(coord.first, coord.second));
+        }
+    } else {
+        for (int i : m_document->loadedPageIndices()) {
+            visitPage(m_document->page(i));  // Already loaded, no disk I/O
+        }
+    }
+}
+
 // ===== Page Layout Cache (Performance Optimization) =====
 
 void DocumentViewport::ensurePageLayoutCache() const
@@ -4709,16 +5167,11 @@ void DocumentViewport::preloadStrokeCaches()
     // MEMORY OPTIMIZATION: Keep caches/pages for visible ± buffer pages, evict the rest.
     // At high zoom * dpr each page cache is large (capped at MAX_STROKE_CACHE_DIM),
     // so the buffer shrinks to limit total memory while remaining safe for panning.
-    qreal effectiveScale = m_zoomLevel * devicePixelRatioF();
-    int pageBuffer;
-    if (effectiveScale <= 2.0)
-        pageBuffer = 2;
-    else if (effectiveScale <= 4.0)
-        pageBuffer = 1;
-    else
-        pageBuffer = 0;
-    int keepStart = qMax(0, first - pageBuffer);
-    int keepEnd = qMin(pageCount - 1, last + pageBuffer);
+    const int pageBuffer = residencyTier(m_zoomLevel * devicePixelRatioF()).buffer;
+    // Widened ahead of / narrowed behind the reader by the residency policy
+    const ResidencyPolicy::Span span = residencyPageSpan(pageBuffer);
+    int keepStart = qMax(0, first - span.before);
+    int keepEnd = qMin(pageCount - 1, last + span.after);
 
     // Never preload beyond the eviction keep window, otherwise the next
     // preload/scroll evicts these pages and we reload (and re-decode every
@@ -4779,6 +5232,12 @@ void DocumentViewport::preloadStrokeCaches()
     // Phase O1.7.5: Preload nearby pages (triggers lazy loading if needed)
     // page() will automatically load from disk if not already in memory
     for (int i = preloadStart; i <= preloadEnd; ++i) {
+        // Off-screen pages load in the background; warmNextIdle() builds
+        // their caches once they are in
+        if (!m_document->isPageLoaded(i) && (i < first || i > last)
+            && requestBackgroundLoad(i, true)) {
+            continue;
+        }
         Page* page = m_document->page(i);  // This triggers lazy load
         if (!page) continue;
 
@@ -4801,7 +5260,8 @@ void DocumentViewport::preloadStrokeCaches()
             VectorLayer* layer = page->layer(layerIdx);
             if (layer && layer->visible && !layer->isEmpty()) {
                 // Build cache at current zoom level for sharp rendering
-                layer->ensureStrokeCacheValid(page->size, m_zoomLevel, dpr);
+                layer->ensureStrokeCacheValid(page->size, m_zoomLevel, dpr,
+                                              VectorLayer::CacheRebuild::Background);
             }
         }
     }
@@ -4815,25 +5275,13 @@ void DocumentViewport::evictDistantTiles()
     }
     
     QRectF viewRect = visibleRect();
-    
-    // Dynamic margin: at high zoom * dpr, each tile cache is large (up to
-    // MAX_STROKE_CACHE_DIM^2 * 4 bytes) but the viewport covers a tiny
-    // fraction of a tile. Reduce the margin to limit total memory.
-    // At low effective scale the caches are small, so a generous margin
-    // is affordable and ensures smooth panning without disk-load stutters.
-    qreal effectiveScale = m_zoomLevel * devicePixelRatioF();
-    int keepMargin;
-    if (effectiveScale <= 2.0)
-        keepMargin = 2;
-    else if (effectiveScale <= 4.0)
-        keepMargin = 1;
-    else
-        keepMargin = 0;
     int tileSize = Document::EDGELESS_TILE_SIZE;
     
+    // Zoom-dependent margin, widened ahead of / narrowed behind the pan
+    const QMargins margins = residencyTileMargins();
     QRectF keepRect = viewRect.adjusted(
-        -keepMargin * tileSize, -keepMargin * tileSize,
-        keepMargin * tileSize, keepMargin * tileSize);
+        -margins.left() * tileSize, -margins.top() * tileSize,
+        margins.right() * tileSize, margins.bottom() * tileSize);
     
     // Get all loaded tiles and check which to evict
     QVector<Document::TileCoord> loadedTiles = m_document->allLoadedTileCoords();
@@ -4923,6 +5371,391 @@ void DocumentViewport::releaseFocusCachesBelowThreshold()
     }
 }
 
+// ===== Scroll-Aware Residency =====
+
+DocumentViewport::ResidencyTier DocumentViewport::residencyTier(qreal effectiveScale)
+{
+    ResidencyTier tier;
+    if (effectiveScale <= 2.0) {
+        tier.buffer = 2;
+        tier.maxAhead = 6;
+        tier.tilesAhead = 2;
+    } else if (effectiveScale <= 4.0) {
+        tier.buffer = 1;
+        tier.maxAhead = 3;
+        tier.tilesAhead = 1;
+    } else {
+        tier.buffer = 0;
+        tier.maxAhead = 1;
+        tier.tilesAhead = 1;
+    }
+    return tier;
+}
+
+ResidencyPolicy::Span DocumentViewport::residencyPageSpan(int baseBuffer) const
+{
+    // Velocity is in document units; convert with the pitch of one page
+    qreal pageExtent = 0;
+    if (m_document && m_document->pageCount() > 0) {
+        const int idx = qBound(0, m_currentPageIndex, m_document->pageCount() - 1);
+        const int columns = (m_layoutMode == LayoutMode::TwoColumn) ? 2 : 1;
+        pageExtent = (m_document->pageSizeAt(idx).height() + m_pageGap) / columns;
+    }
+    const int maxAhead = qMax(baseBuffer, residencyTier(m_zoomLevel * devicePixelRatioF()).maxAhead);
+    return m_residency.pageSpan(baseBuffer, maxAhead, pageExtent, CacheBudget::nowMs());
+}
+
+QMargins DocumentViewport::residencyTileMargins() const
+{
+    // Dynamic margin: at high zoom * dpr, each tile cache is large (up to
+    // MAX_STROKE_CACHE_DIM^2 * 4 bytes) but the viewport covers a tiny
+    // fraction of a tile. Reduce the margin to limit total memory.
+    // At low effective scale the caches are small, so a generous margin
+    // is affordable and ensures smooth panning without disk-load stutters.
+    // Tiles add up in two dimensions, so the ahead side grows less than pages do
+    const ResidencyTier tier = residencyTier(m_zoomLevel * devicePixelRatioF());
+    return m_residency.tileMargins(tier.buffer, tier.buffer + tier.tilesAhead,
+                                   Document::EDGELESS_TILE_SIZE, CacheBudget::nowMs());
+}
+
+QVector<Document::TileCoord> DocumentViewport::coldTilesByHeading() const
+{
+    const int tileSize = Document::EDGELESS_TILE_SIZE;
+    const QMargins margins = residencyTileMargins();
+    const QRectF viewRect = visibleRect();
+    const QRectF keepRect = viewRect.adjusted(
+        -margins.left() * tileSize, -margins.top() * tileSize,
+        margins.right() * tileSize, margins.bottom() * tileSize);
+
+    // Nearest to where the view is heading first
+    const QPointF heading = viewRect.center() + QPointF(
+        m_residency.directionX() * viewRect.width() / 2,
+        m_residency.directionY() * viewRect.height() / 2);
+    auto distance = [&](const Document::TileCoord& coord) {
+        const QPointF center((coord.first + 0.5) * tileSize, (coord.second + 0.5) * tileSize);
+        const QPointF d = center - heading;
+        return d.x() * d.x() + d.y() * d.y();
+    };
+
+    QVector<Document::TileCoord> cold;
+    for (const auto& coord : m_document->tilesInRect(keepRect)) {
+        if (!m_document->isTileLoaded(coord) && m_document->tileExistsOnDisk(coord)) {
+            cold.append(coord);
+        }
+    }
+    std::sort(cold.begin(), cold.end(),
+              [&](const Document::TileCoord& a, const Document::TileCoord& b) {
+                  return distance(a) < distance(b);
+              });
+    return cold;
+}
+
+void DocumentViewport::noteScrollMotion(QPointF delta)
+{
+    if (delta.isNull()) {
+        return;
+    }
+
+    stopIdleWarm();
+    m_residency.noteScroll(delta, visibleRect().size(), CacheBudget::nowMs());
+
+    // Throttled, not debounced: a long flick prefetches all along the way
+    if (m_document && m_prefetchTimer && !m_prefetchTimer->isActive()) {
+        m_prefetchTimer->start();
+    }
+}
+
+void DocumentViewport::prefetchAhead()
+{
+    // During a touch pan the committed pan offset lags behind; endPanGesture()
+    // does the housekeeping at the final position.
+    if (!m_document || m_gesture.isActive()) {
+        return;
+    }
+
+    if (!m_document->isEdgeless()) {
+        // Renders the ahead window in the background, loading those pages
+        doAsyncPdfPreload();
+        return;
+    }
+
+    if (!m_document->isLazyLoadEnabled()) {
+        return;
+    }
+
+    const QVector<Document::TileCoord> cold = coldTilesByHeading();
+    const int count = qMin(static_cast<int>(cold.size()), PREFETCH_TILES_PER_STEP);
+    for (int i = 0; i < count; ++i) {
+        requestBackgroundTileLoad(cold[i], true);
+    }
+}
+
+void DocumentViewport::scheduleIdleWarm()
+{
+    stopIdleWarm();
+    if (!m_document || !m_idleWarmTimer) {
+        return;
+    }
+
+    if (m_document->isEdgeless()) {
+        if (!m_document->isLazyLoadEnabled()) {
+            return;
+        }
+        m_idleWarmTiles = coldTilesByHeading();
+    } else {
+        const QVector<int> visible = visiblePages();
+        if (visible.isEmpty()) {
+            return;
+        }
+
+        // Same window as preloadStrokeCaches(), so nothing warmed here is
+        // evicted by the next sweep
+        const int pageBuffer = residencyTier(m_zoomLevel * devicePixelRatioF()).buffer;
+        const ResidencyPolicy::Span span = residencyPageSpan(pageBuffer);
+        const int first = visible.first();
+        const int last = visible.last();
+        const int pageCount = m_document->pageCount();
+        const bool backwards = m_residency.directionY() < 0;
+
+        // Nearest first; at equal distance the direction of travel first
+        for (int d = 1; d <= qMax(span.before, span.after); ++d) {
+            const int after = (d <= span.after) ? last + d : -1;
+            const int before = (d <= span.before) ? first - d : -1;
+            for (int idx : { backwards ? before : after, backwards ? after : before }) {
+                if (idx >= 0 && idx < pageCount) {
+                    m_idleWarmPages.append(idx);
+                }
+            }
+        }
+    }
+
+    if (!m_idleWarmPages.isEmpty() || !m_idleWarmTiles.isEmpty()) {
+        m_idleWarmTimer->start();
+    }
+}
+
+void DocumentViewport::warmNextIdle()
+{
+    // Never compete with input; the next settle queues whatever is left
+    if (!m_document || m_isDrawing || m_scrollActive || m_gesture.isActive()) {
+        stopIdleWarm();
+        return;
+    }
+
+    // One unit of real work (a load request or a stroke cache build) per tick
+    // Pages still loading in the background get their caches on a later tick
+    const qreal dpr = devicePixelRatioF();
+    QVector<int> loading;
+    while (!m_idleWarmPages.isEmpty()) {
+        const int idx = m_idleWarmPages.takeFirst();
+        if (idx >= m_document->pageCount()) {
+            continue;
+        }
+        if (!m_document->isPageLoaded(idx) && requestBackgroundLoad(idx, true)) {
+            loading.append(idx);
+            continue;
+        }
+        Page* page = m_document->page(idx);
+        if (!page) {
+            continue;
+        }
+        bool worked = false;
+        for (int layerIdx = 0; layerIdx < page->layerCount(); ++layerIdx) {
+            VectorLayer* layer = page->layer(layerIdx);
+            if (layer && layer->visible && !layer->isEmpty() && !layer->isStrokeCacheValid()) {
+                layer->ensureStrokeCacheValid(page->size, m_zoomLevel, dpr,
+                                              VectorLayer::CacheRebuild::Background);
+                worked = true;
+            }
+        }
+        if (worked) {
+            m_idleWarmPages += loading;
+            return;
+        }
+    }
+    m_idleWarmPages = loading;
+
+    while (!m_idleWarmTiles.isEmpty()) {
+        const Document::TileCoord coord = m_idleWarmTiles.takeFirst();
+        if (requestBackgroundTileLoad(coord, true)) {
+            return;
+        }
+    }
+
+    if (m_idleWarmPages.isEmpty()) {
+        stopIdleWarm();
+    }
+}
+
+void DocumentViewport::stopIdleWarm()
+{
+    if (m_idleWarmTimer) {
+        m_idleWarmTimer->stop();
+    }
+    m_idleWarmPages.clear();
+    m_idleWarmTiles.clear();
+}
+
+void DocumentViewport::noteResidency(const QVector<int>& visible)
+{
+    if (visible == m_residencyShownPages) {
+        return;
+    }
+
+    // A page is resident when it is loaded and, for PDF pages, its render is
+    // cached; anything else is loaded or rendered on demand (or drawn blank
+    // while scrolling).
+    const qreal dpi = effectivePdfDpi();
+    for (int idx : visible) {
+        if (m_residencyShownPages.contains(idx)) {
+            continue;
+        }
+        bool resident = m_document->isPageLoaded(idx);
+        if (resident) {
+            const Page* page = m_document->page(idx);  // Already loaded, no disk I/O
+            if (page && page->backgroundType == Page::BackgroundType::PDF
+                && page->pdfPageNumber >= 0
+                && m_document->providerForSource(page->pdfSourceId)) {
+                resident = !lookupCachedPdfPage(page->pdfSourceId, page->pdfPageNumber, dpi).isNull();
+            }
+        }
+        if (resident) {
+            m_residency.noteHit();
+        } else {
+            m_residency.noteMiss();
+        }
+    }
+    m_residencyShownPages = visible;
+}
+
+void DocumentViewport::noteTileResidency(const QRectF& viewRect)
+{
+    QVector<Document::TileCoord> shown;
+    for (const auto& coord : m_document->tilesInRect(viewRect)) {
+        const bool loaded = m_document->isTileLoaded(coord);
+        if (!loaded && !m_document->tileExistsOnDisk(coord)) {
+            continue;  // Empty canvas: nothing to be resident
+        }
+        shown.append(coord);
+        if (!m_residencyShownTiles.contains(coord)) {
+            if (loaded) {
+                m_residency.noteHit();
+            } else {
+                m_residency.noteMiss();
+            }
+        }
+    }
+    m_residencyShownTiles = shown;
+}
+
+// ===== Background Loading =====
+
+bool DocumentViewport::requestBackgroundLoad(int pageIndex, bool prefetch)
+{
+    if (!m_document) {
+        return false;
+    }
+    const Document::LoadRequest request = m_document->pageLoadRequest(pageIndex);
+    if (!request.valid || m_failedLoads.contains(request.key)) {
+        return false;
+    }
+    if (!m_pendingLoads.contains(request.key)) {
+        startBackgroundLoad(request, false);
+        if (prefetch) {
+            m_residency.notePrefetched();
+        }
+    }
+    return true;
+}
+
+bool DocumentViewport::requestBackgroundTileLoad(Document::TileCoord coord, bool prefetch)
+{
+    if (!m_document) {
+        return false;
+    }
+    const Document::LoadRequest request = m_document->tileLoadRequest(coord);
+    if (!request.valid || m_failedLoads.contains(request.key)) {
+        return false;
+    }
+    if (!m_pendingLoads.contains(request.key)) {
+        startBackgroundLoad(request, true);
+        if (prefetch) {
+            m_residency.notePrefetched();
+        }
+    }
+    return true;
+}
+
+void DocumentViewport::startBackgroundLoad(const Document::LoadRequest& request, bool isTile)
+{
+    m_pendingLoads.insert(request.key);
+
+    // LoadedData is move-only; the worker fills it in place
+    auto result = std::make_shared<Document::LoadedData>();
+    const quint64 generation = m_loadGeneration;
+
+    auto* watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this,
+            [this, watcher, result, generation, key = request.key, isTile]() {
+        watcher->deleteLater();
+
+        // Document changed while reading
+        if (generation != m_loadGeneration || !m_document) {
+            return;
+        }
+        m_pendingLoads.remove(key);
+
+        const bool readFailed = !result->page;
+        const bool installed = isTile
+            ? m_document->installTileData(std::move(*result))
+            : m_document->installPageData(std::move(*result));
+
+        if (!installed) {
+            // A failed read falls back to the synchronous path (which reports
+            // or repairs the file); anything else was loaded, evicted or
+            // deleted meanwhile and is simply dropped
+            if (readFailed) {
+                m_failedLoads.insert(key);
+            }
+            reportUnreadableStrokeFiles();
+#ifdef SPEEDYNOTE_DEBUG
+            qDebug() << "Background load dropped:" << key << (readFailed ? "(read failed)" : "(stale)");
+#endif
+            return;
+        }
+
+        update();
+        preloadPdfCache();
+    });
+    watcher->setFuture(QtConcurrent::run([result, request, isTile]() {
+        *result = isTile ? Document::readTileData(request) : Document::readPageData(request);
+    }));
+}
+
+void DocumentViewport::reportUnreadableStrokeFiles()
+{
+    if (!m_document) {
+        return;
+    }
+    const QStringList files = m_document->unreadableStrokeFiles();
+    if (files.size() <= m_reportedUnreadable) {
+        return;
+    }
+    // Before emitting: the warning dialog runs an event loop (and paints)
+    const QStringList newFiles = files.mid(m_reportedUnreadable);
+    m_reportedUnreadable = files.size();
+    
+    QStringList names;
+    for (const QString& path : newFiles) {
+        names.append(QFileInfo(path).fileName());
+    }
+    emit userWarning(tr("The strokes of %n page(s) could not be loaded (%1). "
+                        "These pages are shown empty and left unchanged on disk; "
+                        "restore the files from a backup to recover them.",
+                        nullptr, newFiles.size())
+                         .arg(names.join(QStringLiteral(", "))));
+}
+
 // ===== Input Routing (Task 1.3.8) =====
 
 PointerEvent DocumentViewport::mouseToPointerEvent(QMouseEvent* event, PointerEvent::Type type)
@@ -4945,6 +5778,7 @@ PointerEvent DocumentViewport::mouseToPointerEvent(QMouseEvent* event, PointerEv
     pe.buttons = event->buttons();
     pe.modifiers = event->modifiers();
     pe.timestamp = QDateTime::currentMSecsSinceEpoch();
+    pe.inputMs = inputEventMs(event);
     
     return pe;
 }
@@ -5002,10 +5836,19 @@ PointerEvent DocumentViewport::tabletToPointerEvent(QTabletEvent* event, Pointer
     pe.buttons = event->buttons();
     pe.modifiers = event->modifiers();
     pe.timestamp = QDateTime::currentMSecsSinceEpoch();
+    pe.inputMs = inputEventMs(event);
     
     return pe;
 }
 
+qint64 DocumentViewport::inputEventMs(const QInputEvent* event)
+{
+    const qint64 now = QElapsedTimer::msecsSinceReference();
+    const qint64 stamp = static_cast<qint64>(event->timestamp());
+    const qint64 queued = now - stamp;
+    return (queued >= 0 && queued < MAX_INPUT_QUEUE_MS) ? stamp : now;
+}
+
 void DocumentViewport::handlePointerEvent(const PointerEvent& pe)
 {
     switch (pe.type) {
@@ -5412,6 +6255,8 @@ void DocumentViewport::startStroke(const PointerEvent& pe)
         
         // Reset incremental rendering cache
         resetCurrentStrokeCache();
+        m_inkPendingInputMs.clear();
+        m_inkRetractedPoints = -1;
         
         // Get document coordinates for the first point
         QPointF docPt = viewportToDocument(pe.viewportPos);
@@ -5444,6 +6289,8 @@ void DocumentViewport::startStroke(const PointerEvent& pe)
     
     // Reset incremental rendering cache (Task 2.3)
     resetCurrentStrokeCache();
+    m_inkPendingInputMs.clear();
+    m_inkRetractedPoints = -1;
     
     // Add first point (in page-local coordinates)
     // Marker uses fixed pressure (1.0) for consistent thickness
@@ -5467,7 +6314,7 @@ void DocumentViewport::continueStroke(const PointerEvent& pe)
         // Point decimation (same logic as addPointToStroke but for document coords)
         // Zoom-aware: threshold is constant in screen pixels, not document space.
         if (!m_currentStroke.points.isEmpty()) {
-            const QPointF& lastPos = m_currentStroke.points.last().pos;
+            const QPointF lastPos = m_currentStroke.points.last().pos;
             qreal dx = docPt.x() - lastPos.x();
             qreal dy = docPt.y() - lastPos.y();
             qreal distSq = dx * dx + dy * dy;
@@ -5478,7 +6325,7 @@ void DocumentViewport::continueStroke(const PointerEvent& pe)
                 // Compare the floored effective pressure, not the raw reading,
                 // so the stored pressure can never slip below the min-width floor.
                 if (!useFixedPressure && effectivePressure > m_currentStroke.points.last().pressure) {
-                    m_currentStroke.points.last().pressure = effectivePressure;
+                    m_currentStroke.points.setPressure(m_currentStroke.points.size() - 1, effectivePressure);
                 }
                 return;
             }
@@ -5489,21 +6336,10 @@ void DocumentViewport::continueStroke(const PointerEvent& pe)
         pt.pressure = effectivePressure;
         pt.timestamp = pe.timestamp;
         m_currentStroke.points.append(pt);
+        m_inkPendingInputMs.append(pe.inputMs);
         
         // Dirty region update for edgeless (document coords → viewport coords)
-        // Use current stroke thickness (may be pen or marker)
-        qreal padding = m_currentStroke.baseThickness * 2 * m_zoomLevel;
-        QPointF vpPos = documentToViewport(docPt);
-        QRectF dirtyRect(vpPos.x() - padding, vpPos.y() - padding, padding * 2, padding * 2);
-        
-        if (m_currentStroke.points.size() > 1) {
-            const auto& prevPt = m_currentStroke.points[m_currentStroke.points.size() - 2];
-            QPointF prevVpPos = documentToViewport(prevPt.pos);
-            dirtyRect = dirtyRect.united(QRectF(prevVpPos.x() - padding, prevVpPos.y() - padding, 
-                                                 padding * 2, padding * 2));
-        }
-        
-        update(dirtyRect.toAlignedRect());
+        updateLiveStrokeTail();
         return;
     }
     
@@ -5524,7 +6360,11 @@ void DocumentViewport::continueStroke(const PointerEvent& pe)
     }
     
     // Use effective pressure (fixed 1.0 for marker, actual pressure for pen)
+    const qsizetype pointsBefore = m_currentStroke.points.size();
     addPointToStroke(pagePos, effectivePressure, pe.timestamp);
+    if (m_currentStroke.points.size() > pointsBefore) {
+        m_inkPendingInputMs.append(pe.inputMs);
+    }
 }
 
 void DocumentViewport::finishStroke()
@@ -5805,8 +6645,7 @@ void DocumentViewport::createStraightLineStroke(const QPointF& start, const QPoi
             QPointF tileOrigin(startTile.first * Document::EDGELESS_TILE_SIZE,
                                startTile.second * Document::EDGELESS_TILE_SIZE);
             VectorStroke localStroke = stroke;
-            localStroke.points[0].pos -= tileOrigin;
-            localStroke.points[1].pos -= tileOrigin;
+            localStroke.points.translate(-tileOrigin);
             localStroke.updateBoundingBox();
             
             layer->addStroke(localStroke);
@@ -5833,7 +6672,8 @@ void DocumentViewport::createStraightLineStroke(const QPointF& start, const QPoi
                                          std::pow(end.y() - start.y(), 2));
             int numPoints = qMax(2, static_cast<int>(lineLength / 10.0));  // ~10px spacing
             
-            QVector<StrokePoint> linePoints;
+            StrokePointStore linePoints;
+            linePoints.reserve(numPoints + 1);
             for (int i = 0; i <= numPoints; ++i) {
                 qreal t = static_cast<qreal>(i) / numPoints;
                 StrokePoint pt;
@@ -8645,7 +9485,7 @@ void DocumentViewport::createMarkdownNoteForSlot(int slotIndex)
     
     // Save note file
     QString filePath = notesDir + "/" + noteId + ".md";
-    if (!note.saveToFile(filePath)) {
+    if (!m_document->saveNoteFile(note)) {
         qWarning() << "createMarkdownNoteForSlot: Failed to create note file:" << filePath;
         emit userWarning(tr("Failed to create note file. Check disk space and permissions."));
         return;
@@ -9348,20 +10188,17 @@ void DocumentViewport::finalizeLassoSelection()
             QPointF tileOrigin(coord.first * Document::EDGELESS_TILE_SIZE,
                                coord.second * Document::EDGELESS_TILE_SIZE);
             
+            // Hit test in tile-local coordinates against a translated lasso,
+            // visiting only strokes the layer's spatial index places under it
+            const QPolygonF localLasso = m_lassoPath.translated(-tileOrigin);
             const auto& strokes = layer->strokes();
-            for (int i = 0; i < strokes.size(); ++i) {
+            for (int i : layer->strokeIndicesIntersecting(localLasso.boundingRect())) {
                 const VectorStroke& stroke = strokes[i];
-                
-                // Transform stroke to document coordinates for hit test
-                // We create a temporary copy with document coords
-                VectorStroke docStroke = stroke;
-                for (auto& pt : docStroke.points) {
-                    pt.pos += tileOrigin;
-                }
-                docStroke.updateBoundingBox();
-                
-                if (strokeIntersectsLasso(docStroke, m_lassoPath)) {
-                    // Store the document-coordinate version for rendering
+                if (strokeIntersectsLasso(stroke, localLasso)) {
+                    // Store a document-coordinate copy for rendering
+                    VectorStroke docStroke = stroke;
+                    docStroke.points.translate(tileOrigin);
+                    docStroke.updateBoundingBox();
                     m_lassoSelection.selectedStrokes.append(docStroke);
                     m_lassoSelection.originalIndices.append(i);
                     // For edgeless, we store the tile coord; for simplicity,
@@ -9399,7 +10236,7 @@ void DocumentViewport::finalizeLassoSelection()
         m_lassoSelection.sourceLayerIndex = page->activeLayerIndex;
         
         const auto& strokes = layer->strokes();
-        for (int i = 0; i < strokes.size(); ++i) {
+        for (int i : layer->strokeIndicesIntersecting(m_lassoPath.boundingRect())) {
             const VectorStroke& stroke = strokes[i];
             
             if (strokeIntersectsLasso(stroke, m_lassoPath)) {
@@ -9438,8 +10275,13 @@ bool DocumentViewport::strokeIntersectsLasso(const VectorStroke& stroke,
                                               const QPolygonF& lasso) const
 {
     // Check if any point of the stroke is inside the lasso polygon
-    for (const auto& pt : stroke.points) {
-        if (lasso.containsPoint(pt.pos, Qt::OddEvenFill)) {
+    const float* xs = stroke.points.xData();
+    const float* ys = stroke.points.yData();
+    const QRectF lassoBounds = lasso.boundingRect();
+    for (int i = 0; i < stroke.points.size(); ++i) {
+        const QPointF pt(xs[i], ys[i]);
+        // Cheap rect test first; containsPoint walks every lasso edge
+        if (lassoBounds.contains(pt) && lasso.containsPoint(pt, Qt::OddEvenFill)) {
             return true;
         }
     }
@@ -9828,59 +10670,11 @@ void DocumentViewport::rebuildSelectionCache()
     cachePainter.scale(m_zoomLevel, m_zoomLevel);
     cachePainter.translate(-bounds.topLeft());
     
-    // P4: Render each stroke at identity (no selection transform)
-    // For semi-transparent strokes, render to a temp buffer with full opacity,
-    // then composite with the stroke's alpha. Opaque strokes render directly.
+    // P4: Render each stroke at identity (no selection transform).
+    // renderStroke composites semi-transparent strokes through its reusable
+    // scratch buffer, so no per-stroke temp pixmap is needed here.
     for (const VectorStroke& stroke : m_lassoSelection.selectedStrokes) {
-        int strokeAlpha = stroke.color.alpha();
-        
-        if (strokeAlpha < 255) {
-            // Semi-transparent stroke: render opaque to temp buffer, then composite
-            // This prevents alpha compounding within the stroke's self-intersections
-            QRectF strokeBounds = stroke.boundingBox;
-            strokeBounds.adjust(-stroke.baseThickness, -stroke.baseThickness,
-                               stroke.baseThickness, stroke.baseThickness);
-            
-            // Create temp buffer for this stroke
-            int tempW = qCeil(strokeBounds.width() * m_zoomLevel * dpr) + 4;
-            int tempH = qCeil(strokeBounds.height() * m_zoomLevel * dpr) + 4;
-            
-            // Safety check for temp buffer size
-            if (tempW > 0 && tempH > 0 && tempW <= 4096 && tempH <= 4096) {
-                QPixmap tempBuffer(tempW, tempH);
-                tempBuffer.setDevicePixelRatio(dpr);
-                tempBuffer.fill(Qt::transparent);
-                
-                QPainter tempPainter(&tempBuffer);
-                tempPainter.setRenderHint(QPainter::Antialiasing, true);
-                tempPainter.scale(m_zoomLevel, m_zoomLevel);
-                tempPainter.translate(-strokeBounds.topLeft());
-                
-                // Render stroke with full opacity
-                VectorStroke opaqueStroke = stroke;
-                opaqueStroke.color.setAlpha(255);
-                VectorLayer::renderStroke(tempPainter, opaqueStroke);
-                tempPainter.end();
-                
-                // Composite temp buffer to cache with stroke's alpha
-                cachePainter.save();
-                cachePainter.resetTransform();  // Work in cache pixel coords
-                cachePainter.setOpacity(strokeAlpha / 255.0);
-                
-                // Calculate where to blit in cache coordinates
-                QPointF cachePos = (strokeBounds.topLeft() - bounds.topLeft()) * m_zoomLevel;
-                cachePainter.drawPixmap(cachePos, tempBuffer);
-                
-                cachePainter.setOpacity(1.0);
-                cachePainter.restore();
-            } else {
-                // Fallback: render directly (may have alpha compounding)
-                VectorLayer::renderStroke(cachePainter, stroke);
-            }
-        } else {
-            // Opaque stroke: render directly
-            VectorLayer::renderStroke(cachePainter, stroke);
-        }
+        VectorLayer::renderStroke(cachePainter, stroke);
     }
     
     cachePainter.end();
@@ -10284,9 +11078,7 @@ void DocumentViewport::startSelectionTransform(HandleHit handle, const QPointF&
         
         // Translate stored strokes to match
         for (VectorStroke& stroke : m_lassoSelection.selectedStrokes) {
-            for (StrokePoint& pt : stroke.points) {
-                pt.pos += m_lassoSelection.offset;
-            }
+            stroke.points.translate(m_lassoSelection.offset);
             stroke.updateBoundingBox();
         }
         
@@ -10515,9 +11307,7 @@ void DocumentViewport::finalizeSelectionTransform()
 
 void DocumentViewport::transformStrokePoints(VectorStroke& stroke, const QTransform& transform)
 {
-    for (StrokePoint& pt : stroke.points) {
-        pt.pos = transform.map(pt.pos);
-    }
+    stroke.points.map(transform);
     stroke.updateBoundingBox();
 }
 
@@ -10622,8 +11412,7 @@ void DocumentViewport::applySelectionTransform()
             if (destPage != srcPage) {
                 QPointF dstOrigin = pagePosition(destPage);
                 QPointF offset = srcOrigin - dstOrigin;
-                for (auto& pt : transformedStroke.points)
-                    pt.pos += offset;
+                transformedStroke.points.translate(offset);
                 transformedStroke.updateBoundingBox();
             }
 
@@ -10874,8 +11663,7 @@ void DocumentViewport::pasteSelection()
 
         for (const VectorStroke& stroke : s_clipboard.strokes) {
             VectorStroke pastedStroke = stroke;
-            for (StrokePoint& pt : pastedStroke.points)
-                pt.pos += offset;
+            pastedStroke.points.translate(offset);
             pastedStroke.updateBoundingBox();
 
             auto addedSegments = addStrokeToEdgelessTiles(pastedStroke, m_edgelessActiveLayerIndex);
@@ -10906,8 +11694,7 @@ void DocumentViewport::pasteSelection()
 
         for (const VectorStroke& stroke : s_clipboard.strokes) {
             VectorStroke pastedStroke = stroke;
-            for (StrokePoint& pt : pastedStroke.points)
-                pt.pos += offset;
+            pastedStroke.points.translate(offset);
             pastedStroke.updateBoundingBox();
             pastedStroke.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
             layer->addStroke(pastedStroke);
@@ -12839,7 +13626,7 @@ void DocumentViewport::addPointToStroke(const QPointF& pagePos, qreal pressure,
     const qreal flooredPressure = applyPenPressureFloor(pressure);
 
     if (!m_currentStroke.points.isEmpty()) {
-        const QPointF& lastPos = m_currentStroke.points.last().pos;
+        const QPointF lastPos = m_currentStroke.points.last().pos;
         qreal dx = pagePos.x() - lastPos.x();
         qreal dy = pagePos.y() - lastPos.y();
         qreal distSq = dx * dx + dy * dy;
@@ -12850,7 +13637,7 @@ void DocumentViewport::addPointToStroke(const QPointF& pagePos, qreal pressure,
             // Compare the *floored* pressure so the stored peak never slips
             // below the preset's min-width floor.
             if (flooredPressure > m_currentStroke.points.last().pressure) {
-                m_currentStroke.points.last().pressure = flooredPressure;
+                m_currentStroke.points.setPressure(m_currentStroke.points.size() - 1, flooredPressure);
             }
             return;  // Skip this point
         }
@@ -12863,26 +13650,10 @@ void DocumentViewport::addPointToStroke(const QPointF& pagePos, qreal pressure,
     m_currentStroke.points.append(pt);
     
     // ========== OPTIMIZATION: Dirty Region Update ==========
-    // Only repaint the small region around the new point instead of the entire widget.
-    // This significantly improves performance, especially on lower-end hardware.
-    
-    // Use current stroke's thickness (may be pen or marker - marker is typically larger)
-    qreal padding = m_currentStroke.baseThickness * 2 * m_zoomLevel;  // Extra padding for stroke width
-    
-    // Convert page position to viewport coordinates
-    QPointF vpPos = pageToViewport(m_activeDrawingPage, pagePos);
-    QRectF dirtyRect(vpPos.x() - padding, vpPos.y() - padding, padding * 2, padding * 2);
-    
-    // Include line from previous point if exists
-    if (m_currentStroke.points.size() > 1) {
-        const auto& prevPt = m_currentStroke.points[m_currentStroke.points.size() - 2];
-        QPointF prevVpPos = pageToViewport(m_activeDrawingPage, prevPt.pos);
-        QRectF prevRect(prevVpPos.x() - padding, prevVpPos.y() - padding, padding * 2, padding * 2);
-        dirtyRect = dirtyRect.united(prevRect);
-    }
-    
-    // Update only the dirty region (much faster than full widget repaint)
-    update(dirtyRect.toRect().adjusted(-2, -2, 2, 2));
+    // Only repaint the small region around the stroke's tail instead of the
+    // entire widget. This significantly improves performance, especially on
+    // lower-end hardware.
+    updateLiveStrokeTail();
 }
 
 // ===== Incremental Stroke Rendering (Task 2.3) =====
@@ -12906,20 +13677,67 @@ void DocumentViewport::resetCurrentStrokeCache()
     }
     m_currentStrokeCache.fill(Qt::transparent);
     m_lastRenderedPointIndex = 0;
+    m_liveCommittedSegments = 0;
+    m_liveTailBackup = QPixmap();
     
     // Track the transform state when cache was created
     m_cacheZoom = m_zoomLevel;
     m_cachePan = m_panOffset;
 }
 
+void DocumentViewport::updateLiveStrokeTail()
+{
+    const int n = static_cast<int>(m_currentStroke.points.size());
+    if (n < 1) return;
+    
+    QPointF lo = m_currentStroke.points.pos(n - 1);
+    QPointF hi = lo;
+    for (int i = qMax(0, n - LIVE_DIRTY_POINTS); i < n - 1; ++i) {
+        const QPointF p = m_currentStroke.points.pos(i);
+        lo = QPointF(qMin(lo.x(), p.x()), qMin(lo.y(), p.y()));
+        hi = QPointF(qMax(hi.x(), p.x()), qMax(hi.y(), p.y()));
+    }
+    const QRectF docRect(lo, hi);
+    
+    // Edgeless stroke points are document coordinates, paged ones page-local
+    QRectF dirtyRect;
+    if (m_document && m_document->isEdgeless()) {
+        dirtyRect = QRectF(documentToViewport(docRect.topLeft()),
+                           documentToViewport(docRect.bottomRight()));
+    } else {
+        dirtyRect = QRectF(pageToViewport(m_activeDrawingPage, docRect.topLeft()),
+                           pageToViewport(m_activeDrawingPage, docRect.bottomRight()));
+    }
+    
+    // Use current stroke's thickness (may be pen or marker - marker is
+    // typically larger); also covers the spline's overshoot past the points
+    // and the predicted tail, old and new.
+    qreal padding = m_currentStroke.baseThickness * 2 * m_zoomLevel;
+    if (s_predictedInk) {
+        padding += MAX_PREDICTION_SCREEN_PX;
+    }
+    update(dirtyRect.normalized().adjusted(-padding, -padding, padding, padding)
+               .toAlignedRect().adjusted(-2, -2, 2, 2));
+}
+
 void DocumentViewport::renderCurrentStrokeIncremental(QPainter& painter)
 {
     // ========== In-Progress Stroke Rendering ==========
-    // Renders the current stroke to m_currentStrokeCache using the same
-    // VectorLayer::renderStroke() path as finalized strokes, giving it
-    // Catmull-Rom smoothed curves. The cache is re-rendered when new
-    // points arrive (tracked via m_lastRenderedPointIndex) and reused
-    // for repaints where no new points were added.
+    // Rasterizes the current stroke into m_currentStrokeCache piece by piece
+    // with the same Catmull-Rom outline as finalized strokes.
+    //
+    // A segment's spline uses the points on either side of it, and the last
+    // point's pressure can still rise (decimated samples keep the peak), so
+    // only segments at least two points back from the end are final. Those
+    // are drawn into the cache once (m_liveCommittedSegments). The rest - the
+    // tail - is drawn on top after saving the pixels underneath, and the
+    // saved patch is put back before the next tail is drawn. Work per new
+    // point is therefore a few segments and a small rect, instead of
+    // clearing the viewport-sized cache and re-tessellating the whole stroke.
+    //
+    // Committed segments are exactly the final geometry; on pen-up the stroke
+    // goes to the layer and is drawn from the full outline, which only
+    // differs in the seams between pieces (hidden by a one-segment overlap).
     
     const int n = static_cast<int>(m_currentStroke.points.size());
     if (n < 1) return;
@@ -12966,52 +13784,144 @@ void DocumentViewport::renderCurrentStrokeIncremental(QPainter& painter)
     QPointF snapCorrection(std::round(originPhysical.x()) - originPhysical.x(),
                            std::round(originPhysical.y()) - originPhysical.y());
     
-    // Pre-compute the snap translate in logical pixels (reused by cache painter and end cap)
-    qreal snapTxLogical = snapCorrection.x() / dpr;
-    qreal snapTyLogical = snapCorrection.y() / dpr;
-    
     // ========== Semi-Transparent Stroke Rendering ==========
     // For strokes with alpha < 255 (e.g., marker at 50% opacity), we draw
     // with FULL OPACITY to the cache, then blit with the desired opacity.
-    // This prevents alpha compounding at segment joints / cap overlaps.
+    // This prevents alpha compounding at segment joints / cap overlaps and
+    // where the committed pieces overlap.
     
     int strokeAlpha = m_currentStroke.color.alpha();
     bool hasSemiTransparency = (strokeAlpha < 255);
     
-    // Re-render the full stroke to cache when new points arrive.
-    // Uses VectorLayer::renderStroke() for Catmull-Rom smoothed curves,
-    // giving the in-progress stroke the same visual quality as finalized strokes.
-    // Performance: a single stroke with ~100-300 points renders in <1ms.
-    if (n > m_lastRenderedPointIndex && n >= 2) {
-        m_currentStrokeCache.fill(Qt::transparent);
-        
+    if (n > m_lastRenderedPointIndex) {
         QPainter cachePainter(&m_currentStrokeCache);
+        
+        // Take the previous tail back out. Done in physical pixels (identity
+        // device transform) so the patch lands exactly where it was copied.
+        if (!m_liveTailBackup.isNull()) {
+            cachePainter.setTransform(QTransform::fromScale(1.0 / dpr, 1.0 / dpr));
+            cachePainter.setCompositionMode(QPainter::CompositionMode_Source);
+            cachePainter.drawPixmap(m_liveTailRect.topLeft(), m_liveTailBackup);
+            cachePainter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+            m_liveTailBackup = QPixmap();
+        }
+        
+        // Stroke coordinates -> cache (viewport) coordinates: snap page/tile
+        // origin to an integer physical pixel (see comment above), then pan,
+        // zoom, and for paged mode the page position (edgeless stroke points
+        // are already in document coords).
+        QTransform toCache;
+        toCache.translate(snapCorrection.x() / dpr - m_panOffset.x() * m_zoomLevel,
+                          snapCorrection.y() / dpr - m_panOffset.y() * m_zoomLevel);
+        toCache.scale(m_zoomLevel, m_zoomLevel);
+        if (!isEdgeless) {
+            toCache.translate(snapOrigin.x(), snapOrigin.y());
+        }
+        cachePainter.setTransform(toCache);
         cachePainter.setRenderHint(QPainter::Antialiasing, true);
+        cachePainter.setPen(Qt::NoPen);
+        QColor inkColor = m_currentStroke.color;
+        inkColor.setAlpha(255);
+        cachePainter.setBrush(inkColor);
+        
+        const StrokePointStore& pts = m_currentStroke.points;
+        const qreal halfThickness = m_currentStroke.baseThickness / 2.0;
+        QPolygonF outline;
+        auto buildSpan = [&](int firstSegment, int lastSegment) {
+            outline.resize(StrokeOutlineKernel::spanVertexCount(lastSegment - firstSegment));
+            StrokeOutlineKernel::buildSpan(pts.xData(), pts.yData(), pts.pressureData(), n,
+                                           firstSegment, lastSegment,
+                                           m_currentStroke.baseThickness, outline.data());
+        };
+        const QPointF startCenter = pts.pos(0);
+        const qreal startRadius = halfThickness * pts.pressure(0);
+        
+        // Settled segments: drawn once, overlapping the previous piece by
+        // one segment so anti-aliased edges don't leave a seam.
+        const int settled = (n >= 3) ? n - LIVE_TAIL_SEGMENTS : 0;
+        if (settled > m_liveCommittedSegments) {
+            buildSpan(qMax(0, m_liveCommittedSegments - 1), settled);
+            cachePainter.drawPolygon(outline, Qt::WindingFill);
+            if (m_liveCommittedSegments == 0) {
+                cachePainter.drawEllipse(startCenter, startRadius, startRadius);
+            }
+            m_liveCommittedSegments = settled;
+        }
+        
+        // Tail: the provisional segments and the caps that still move.
+        struct Cap { QPointF center; qreal radius; };
+        QVarLengthArray<Cap, 3> caps;
+        if (n < 3) {
+            // Too short to smooth: the whole stroke (dot or straight line)
+            VectorLayer::StrokePolygonResult poly = VectorLayer::buildStrokePolygon(m_currentStroke);
+            outline = poly.polygon;
+            caps.append({poly.startCapCenter, poly.startCapRadius});
+            if (poly.hasRoundCaps) {
+                caps.append({poly.endCapCenter, poly.endCapRadius});
+            }
+        } else {
+            const int committed = m_liveCommittedSegments;
+            buildSpan(qMax(0, committed - 1), n - 1);
+            caps.append({pts.pos(n - 1), halfThickness * qBound<qreal>(0.1, pts.pressure(n - 1), 1.0)});
+            if (committed == 0) {
+                caps.append({startCenter, startRadius});
+            }
+        }
         
-        // Snap page/tile origin to integer physical pixel (see comment above)
-        cachePainter.translate(snapTxLogical, snapTyLogical);
+        // Predicted ink: the extrapolated continuation, drawn with the tail
+        // so the next real point replaces it. If none arrives within the
+        // horizon (the pen stopped), m_inkRetractTimer redraws the tail
+        // without it.
+        QPolygonF predictedOutline;
+        if (s_predictedInk && n >= 3 && n != m_inkRetractedPoints) {
+            const QVector<StrokePoint> predicted =
+                m_inkPredictor.predict(pts, MAX_PREDICTION_SCREEN_PX / m_zoomLevel);
+            if (!predicted.isEmpty()) {
+                const int m = predicted.size() + 1;
+                float px[InkPredictor::STEPS + 1], py[InkPredictor::STEPS + 1], pp[InkPredictor::STEPS + 1];
+                px[0] = pts.xData()[n - 1];
+                py[0] = pts.yData()[n - 1];
+                pp[0] = pts.pressureData()[n - 1];
+                for (int i = 1; i < m; ++i) {
+                    px[i] = static_cast<float>(predicted[i - 1].pos.x());
+                    py[i] = static_cast<float>(predicted[i - 1].pos.y());
+                    pp[i] = static_cast<float>(predicted[i - 1].pressure);
+                }
+                predictedOutline.resize(StrokeOutlineKernel::vertexCount(m));
+                StrokeOutlineKernel::Caps predictedCaps;
+                StrokeOutlineKernel::build(px, py, pp, m, m_currentStroke.baseThickness,
+                                           predictedOutline.data(), predictedCaps);
+                caps.append({predictedCaps.endCenter, predictedCaps.endRadius});
+            }
+        }
         
-        // Apply transform to convert coords to viewport coords
-        // The cache is in viewport coordinates (widget pixels)
-        cachePainter.translate(-m_panOffset.x() * m_zoomLevel, -m_panOffset.y() * m_zoomLevel);
-        cachePainter.scale(m_zoomLevel, m_zoomLevel);
+        QRectF tailBounds = outline.boundingRect() | predictedOutline.boundingRect();
+        for (const Cap& cap : caps) {
+            tailBounds |= QRectF(cap.center - QPointF(cap.radius, cap.radius),
+                                 QSizeF(2 * cap.radius, 2 * cap.radius));
+        }
         
-        // For paged mode, translate to page position
-        // For edgeless, stroke points are already in document coords - no extra translate
-        if (!isEdgeless) {
-            cachePainter.translate(snapOrigin);
+        // Save what the tail covers before drawing it
+        const QRectF logical = toCache.mapRect(tailBounds);
+        m_liveTailRect = QRectF(logical.topLeft() * dpr, logical.size() * dpr)
+                             .toAlignedRect().adjusted(-2, -2, 2, 2)
+                             .intersected(QRect(QPoint(0, 0), m_currentStrokeCache.size()));
+        if (!m_liveTailRect.isEmpty()) {
+            m_liveTailBackup = m_currentStrokeCache.copy(m_liveTailRect);
+            m_liveTailBackup.setDevicePixelRatio(1.0);
         }
         
-        // Render using the same path as finalized strokes (Catmull-Rom smoothing).
-        // For semi-transparent strokes, create a copy with full opacity (alpha
-        // is applied during the blit step below). For opaque strokes, render
-        // directly to avoid copying the stroke's point vector.
-        if (hasSemiTransparency) {
-            VectorStroke drawStroke = m_currentStroke;
-            drawStroke.color.setAlpha(255);
-            VectorLayer::renderStroke(cachePainter, drawStroke);
+        if (!outline.isEmpty()) {
+            cachePainter.drawPolygon(outline, Qt::WindingFill);
+        }
+        if (!predictedOutline.isEmpty()) {
+            cachePainter.drawPolygon(predictedOutline, Qt::WindingFill);
+            m_inkRetractTimer->start(qCeil(m_inkPredictor.horizonMs()));
         } else {
-            VectorLayer::renderStroke(cachePainter, m_currentStroke);
+            m_inkRetractTimer->stop();
+        }
+        for (const Cap& cap : caps) {
+            cachePainter.drawEllipse(cap.center, cap.radius, cap.radius);
         }
         
         m_lastRenderedPointIndex = n;
@@ -13026,30 +13936,6 @@ void DocumentViewport::renderCurrentStrokeIncremental(QPainter& painter)
     if (hasSemiTransparency) {
         painter.setOpacity(1.0);  // Restore full opacity
     }
-    
-    // Draw end cap at current position (always needs updating as it moves)
-    if (n >= 1) {
-        painter.save();
-        
-        // Apply same sub-pixel snap so the end cap aligns with the cached stroke body
-        painter.translate(snapTxLogical, snapTyLogical);
-        
-        painter.translate(-m_panOffset.x() * m_zoomLevel, -m_panOffset.y() * m_zoomLevel);
-        painter.scale(m_zoomLevel, m_zoomLevel);
-        
-        // For paged mode, translate to page position
-        // For edgeless, stroke points are already in document coords
-        if (!isEdgeless) {
-            painter.translate(snapOrigin);
-        }
-        
-        qreal endRadius = qMax(m_currentStroke.baseThickness * m_currentStroke.points[n - 1].pressure, 1.0) / 2.0;
-        painter.setPen(Qt::NoPen);
-        painter.setBrush(m_currentStroke.color);
-        painter.drawEllipse(m_currentStroke.points[n - 1].pos, endRadius, endRadius);
-        
-        painter.restore();
-    }
 }
 
 // ===== Eraser Tool (Task 2.4) =====
@@ -13078,18 +13964,14 @@ void DocumentViewport::eraseAt(const PointerEvent& pe)
     
     if (hitIds.isEmpty()) return;
     
-    // Collect strokes for undo before removing
-    // Use a set for O(1) lookup instead of O(n) per ID
-    QSet<QString> hitIdSet(hitIds.begin(), hitIds.end());
+    // Collect strokes for undo before removing (id lookup via the layer's
+    // spatial index; hitIds is already in paint order)
     QVector<VectorStroke> removedStrokes;
     removedStrokes.reserve(hitIds.size());
     
-    for (const VectorStroke& s : layer->strokes()) {
-        if (hitIdSet.contains(s.id)) {
-            removedStrokes.append(s);
-            if (removedStrokes.size() == hitIds.size()) {
-                break;  // Found all strokes, no need to continue
-            }
+    for (const QString& id : hitIds) {
+        if (const VectorStroke* s = layer->strokeById(id)) {
+            removedStrokes.append(*s);
         }
     }
     
@@ -13165,14 +14047,11 @@ void DocumentViewport::eraseAtEdgeless(QPointF viewportPos)
             if (hitIds.isEmpty()) continue;
 
             for (const QString& id : hitIds) {
-                for (const VectorStroke& stroke : layer->strokes()) {
-                    if (stroke.id == id) {
-                        UndoAction::StrokeSegment seg;
-                        seg.tileCoord = {tx, ty};
-                        seg.stroke = stroke;
-                        undoAction.segments.append(seg);
-                        break;
-                    }
+                if (const VectorStroke* stroke = layer->strokeById(id)) {
+                    UndoAction::StrokeSegment seg;
+                    seg.tileCoord = {tx, ty};
+                    seg.stroke = *stroke;
+                    undoAction.segments.append(seg);
                 }
             }
             for (const QString& id : hitIds)
@@ -13256,18 +14135,14 @@ void DocumentViewport::finalizeEraserLasso()
             QPointF tileOrigin(coord.first * Document::EDGELESS_TILE_SIZE,
                                coord.second * Document::EDGELESS_TILE_SIZE);
 
+            // Test in tile-local coordinates so strokes need no copy; the
+            // spatial index limits the candidates to the lasso's bounds
             QSet<QString> idsToRemove;
+            const QPolygonF localLasso = m_lassoPath.translated(-tileOrigin);
             const auto& strokes = layer->strokes();
-            for (const VectorStroke& stroke : strokes) {
-                // Quick bounding-box rejection before expensive per-point copy + test
-                QRectF docBBox = stroke.boundingBox.translated(tileOrigin);
-                if (!docBBox.intersects(lassoBounds)) continue;
-
-                VectorStroke docStroke = stroke;
-                for (auto& pt : docStroke.points) {
-                    pt.pos += tileOrigin;
-                }
-                if (strokeIntersectsLasso(docStroke, m_lassoPath)) {
+            for (int i : layer->strokeIndicesIntersecting(lassoBounds.translated(-tileOrigin))) {
+                const VectorStroke& stroke = strokes[i];
+                if (strokeIntersectsLasso(stroke, localLasso)) {
                     idsToRemove.insert(stroke.id);
                 }
             }
@@ -13297,9 +14172,10 @@ void DocumentViewport::finalizeEraserLasso()
         undoAction.layerIndex = page->activeLayerIndex;
 
         QSet<QString> idsToRemove;
-        for (const VectorStroke& stroke : layer->strokes()) {
-            if (strokeIntersectsLasso(stroke, m_lassoPath)) {
-                idsToRemove.insert(stroke.id);
+        const auto& strokes = layer->strokes();
+        for (int i : layer->strokeIndicesIntersecting(m_lassoPath.boundingRect())) {
+            if (strokeIntersectsLasso(strokes[i], m_lassoPath)) {
+                idsToRemove.insert(strokes[i].id);
             }
         }
 
@@ -13331,6 +14207,7 @@ void DocumentViewport::finalizeEraserLasso()
 
 void DocumentViewport::pushUndoAction(const UndoAction& action)
 {
+    journalUndoAction(action, /*inverse=*/false);
     m_undoStack.push(action);
     trimUndoStack();
     m_redoStack.clear();
@@ -13553,7 +14430,7 @@ void DocumentViewport::trimUndoStack()
 //  all undo/redo is now handled by the unified undo() and redo() below)
 
 QVector<DocumentViewport::TileSegment> DocumentViewport::splitStrokeIntoTileSegments(
-    const QVector<StrokePoint>& points) const
+    const StrokePointStore& points) const
 {
     QVector<TileSegment> segments;
     
@@ -13568,7 +14445,7 @@ QVector<DocumentViewport::TileSegment> DocumentViewport::splitStrokeIntoTileSegm
     
     // Walk through remaining points, detecting tile boundary crossings
     for (int i = 1; i < points.size(); ++i) {
-        const StrokePoint& pt = points[i];
+        const StrokePoint pt = points[i];
         Document::TileCoord ptTile = m_document->tileCoordForPoint(pt.pos);
         
         if (ptTile != currentSegment.coord) {
@@ -13660,6 +14537,57 @@ static QSet<int> collectAffectedPages(const UndoAction& action)
     return pages;
 }
 
+void DocumentViewport::journalUndoAction(const UndoAction& action, bool inverse)
+{
+    if (!m_document) {
+        return;
+    }
+    using Op = StrokeJournal::Op;
+
+    // One journal record per container and operation
+    auto record = [this, &action](Op op, const QVector<UndoAction::StrokeSegment>& segments) {
+        QMap<QPair<int, Document::TileCoord>, QVector<VectorStroke>> byContainer;
+        for (const auto& seg : segments) {
+            const auto key = qMakePair(seg.pageIndex, seg.tileCoord);
+            if (op != Op::Replace) {
+                byContainer[key].append(seg.stroke);
+                continue;
+            }
+            // Replace records the stroke as it is now (the segment holds the
+            // color from before the recolor)
+            Page* c = getContainer(m_document, seg, /*create*/false);
+            const VectorLayer* layer = c ? c->layer(action.layerIndex) : nullptr;
+            const VectorStroke* current = layer ? layer->strokeById(seg.stroke.id) : nullptr;
+            if (current) {
+                byContainer[key].append(*current);
+            }
+        }
+        for (auto it = byContainer.constBegin(); it != byContainer.constEnd(); ++it) {
+            m_document->journalStrokes(op, it.key().first, it.key().second,
+                                       action.layerIndex, it.value());
+        }
+    };
+
+    switch (action.type) {
+        case UndoAction::AddStroke:
+            record(inverse ? Op::Remove : Op::Add, action.segments);
+            break;
+        case UndoAction::RemoveStroke:
+        case UndoAction::RemoveMultiple:
+            record(inverse ? Op::Add : Op::Remove, action.segments);
+            break;
+        case UndoAction::TransformSelection:
+            record(Op::Remove, inverse ? action.addedSegments : action.removedSegments);
+            record(Op::Add, inverse ? action.removedSegments : action.addedSegments);
+            break;
+        case UndoAction::RecolorStrokes:
+            record(Op::Replace, action.segments);
+            break;
+        default:
+            break;  // Objects and page structure are saved with their pages
+    }
+}
+
 void DocumentViewport::undo()
 {
     if (m_undoStack.isEmpty() || !m_document) return;
@@ -13938,6 +14866,8 @@ void DocumentViewport::undo()
         }
     }
 
+    journalUndoAction(action, /*inverse=*/true);
+
     // Auto-navigate if the action's page differs from current view (paged mode)
     if (!m_document->isEdgeless()) {
         int actionPage = -1;
@@ -14262,6 +15192,8 @@ void DocumentViewport::redo()
         }
     }
 
+    journalUndoAction(action, /*inverse=*/false);
+
     // Auto-navigate if the action's page differs from current view (paged mode)
     if (!m_document->isEdgeless()) {
         int actionPage = -1;
@@ -14682,6 +15614,13 @@ void DocumentViewport::renderPage(QPainter& painter, Page* page, int pageIndex)
                         // Scale pixmap to fit page rect
                         painter.drawPixmap(pageRect.toRect(), pdfPixmap);
                     }
+                    
+                    // Past the full-page DPI cap, sharpen the visible region
+                    // with tiles at the real DPI (the capped page is the fallback)
+                    const qreal tileDpi = pdfTileDpi();
+                    if (tileDpi > 0) {
+                        renderPdfTiles(painter, page, pageIndex, resolvedPage, tileDpi);
+                    }
                 }
             }
             break;
@@ -14771,6 +15710,8 @@ void DocumentViewport::renderPage(QPainter& painter, Page* page, int pageIndex)
         bool layerIsVisible = layer && layer->visible;
         
         if (layerIsVisible) {
+            layer->markCacheUsed(CacheBudget::nowMs());
+
             // When we won't draw from the capped pixmap this paint, free it
             // outright - holding a 4096^2 pixmap per layer per page burns
             // ~67 MB without serving any frame.
@@ -14791,7 +15732,9 @@ void DocumentViewport::renderPage(QPainter& painter, Page* page, int pageIndex)
                                              tier, focusRect);
             } else {
                 layer->renderTiered(painter, pageSize, m_zoomLevel, dpr,
-                                    tier, focusRect);
+                                    tier, focusRect,
+                                    VectorLayer::CacheRebuild::Background);
+                noteStrokeCacheRebuild(layer);
             }
         }
         
@@ -14825,6 +15768,7 @@ void DocumentViewport::renderEdgelessMode(QPainter& painter)
     
     // Get visible rect in document coordinates
     QRectF viewRect = visibleRect();
+    noteTileResidency(viewRect);
     
     // ========== TILE RENDERING STRATEGY ==========
     // With stroke splitting, cross-tile strokes are stored as separate segments in each tile.
@@ -14845,6 +15789,26 @@ void DocumentViewport::renderEdgelessMode(QPainter& painter)
     QRectF strokeRect = viewRect.adjusted(-totalMargin, -totalMargin, totalMargin, totalMargin);
     QVector<Document::TileCoord> allTiles = m_document->tilesInRect(strokeRect);
     
+    // While scrolling, tiles not yet in memory load in the background and
+    // show as empty canvas until they arrive (no disk I/O on the paint path).
+    // Objects and strokes come from the tiles that are in memory.
+    QVector<Document::TileCoord> pendingTiles;
+    if (isScrolling()) {
+        for (const auto& coord : allTiles) {
+            if (!m_document->isTileLoaded(coord) && requestBackgroundTileLoad(coord, false)) {
+                pendingTiles.append(coord);
+            }
+        }
+    }
+    QVector<Document::TileCoord> contentTiles = allTiles;
+    if (!pendingTiles.isEmpty()) {
+        contentTiles.erase(std::remove_if(contentTiles.begin(), contentTiles.end(),
+                                          [&pendingTiles](const Document::TileCoord& coord) {
+                                              return pendingTiles.contains(coord);
+                                          }),
+                           contentTiles.end());
+    }
+    
     // Pre-calculate visible tile range for background filtering
     int tileSize = Document::EDGELESS_TILE_SIZE;
     int minVisibleTx = static_cast<int>(std::floor(viewRect.left() / tileSize));
@@ -14874,7 +15838,8 @@ void DocumentViewport::renderEdgelessMode(QPainter& painter)
         QRectF tileRect(tileOrigin.x(), tileOrigin.y(), tileSize, tileSize);
         
         // Check if tile exists - use its settings, otherwise use document defaults
-        Page* tile = m_document->getTile(coord.first, coord.second);
+        Page* tile = pendingTiles.contains(coord)
+            ? nullptr : m_document->getTile(coord.first, coord.second);
         
         if (tile) {
             // Existing tile: use its background settings
@@ -14905,7 +15870,7 @@ void DocumentViewport::renderEdgelessMode(QPainter& painter)
     
     // ========== PASS 2: Render objects with default affinity (-1) ==========
     // These render BELOW all stroke layers (e.g., background images, pasted test papers)
-    renderEdgelessObjectsWithAffinity(painter, -1, allTiles);
+    renderEdgelessObjectsWithAffinity(painter, -1, contentTiles);
     
     // ========== PASS 3: Interleaved layer strokes and objects ==========
     // For each layer index, render strokes from all tiles, then objects with that affinity.
@@ -14913,7 +15878,7 @@ void DocumentViewport::renderEdgelessMode(QPainter& painter)
     
     // First, determine the maximum layer count across all visible tiles
     int maxLayerCount = 0;
-    for (const auto& coord : allTiles) {
+    for (const auto& coord : contentTiles) {
         Page* tile = m_document->getTile(coord.first, coord.second);
         if (tile) {
             maxLayerCount = qMax(maxLayerCount, tile->layerCount());
@@ -14924,7 +15889,7 @@ void DocumentViewport::renderEdgelessMode(QPainter& painter)
     painter.setRenderHint(QPainter::Antialiasing, true);
     for (int layerIdx = 0; layerIdx < maxLayerCount; ++layerIdx) {
         // PASS 3a: Render this layer's strokes from all tiles
-        for (const auto& coord : allTiles) {
+        for (const auto& coord : contentTiles) {
             Page* tile = m_document->getTile(coord.first, coord.second);
             if (!tile) continue;
             
@@ -14937,7 +15902,7 @@ void DocumentViewport::renderEdgelessMode(QPainter& painter)
         }
         
         // PASS 3b: Render objects with affinity = layerIdx
-        renderEdgelessObjectsWithAffinity(painter, layerIdx, allTiles);
+        renderEdgelessObjectsWithAffinity(painter, layerIdx, contentTiles);
     }
     
     // Render text selection overlay (Highlighter tool) in edgeless mode.
@@ -15026,6 +15991,8 @@ void DocumentViewport::dispatchTileLayer(QPainter& painter, VectorLayer* layer,
     const VectorLayer::RenderTier tier =
         chooseRenderTier(tileSize, tileLocalVp, &focusRect);
 
+    layer->markCacheUsed(CacheBudget::nowMs());
+
     if (tier != VectorLayer::RenderTier::Capped &&
         layer->hasStrokeCacheAllocated()) {
         layer->releaseStrokeCache();
@@ -15043,7 +16010,17 @@ void DocumentViewport::dispatchTileLayer(QPainter& painter, VectorLayer* layer,
                                      tier, focusRect);
     } else {
         layer->renderTiered(painter, tileSize, m_zoomLevel, dpr,
-                            tier, focusRect);
+                            tier, focusRect,
+                            VectorLayer::CacheRebuild::Background);
+        noteStrokeCacheRebuild(layer);
+    }
+}
+
+void DocumentViewport::noteStrokeCacheRebuild(const VectorLayer* layer)
+{
+    if (layer->isBackgroundRebuildPending() &&
+        m_strokeCacheRebuildTimer && !m_strokeCacheRebuildTimer->isActive()) {
+        m_strokeCacheRebuildTimer->start();
     }
 }
 
@@ -25,6 +25,9 @@ enum class TouchGestureMode {
 };
 #endif
 
+#include "CacheBudget.h"
+#include "InkPredictor.h"
+#include "ResidencyPolicy.h"
 #include "Document.h"
 #include "Page.h"
 #include "ToolType.h"
@@ -166,12 +169,14 @@ struct UndoAction {
 #include <QMutex>
 #include <QFutureWatcher>
 #include <deque>
+#include <functional>
 
 // Forward declarations
 class QPaintEvent;
 class QResizeEvent;
 class QMouseEvent;
 class QTabletEvent;
+class QInputEvent;
 class QWheelEvent;
 class QDragEnterEvent;
 class QDragMoveEvent;
@@ -208,6 +213,7 @@ struct PdfCacheEntry {
     int pageIndex = -1;     ///< Which page this is (-1 = invalid)
     qreal dpi = 0;          ///< DPI at which it was rendered
     QPixmap pixmap;         ///< The rendered PDF image
+    mutable qint64 lastUse = 0;  ///< CacheBudget::nowMs() of the last lookup
     
     bool isValid() const { return pageIndex >= 0 && !pixmap.isNull(); }
     bool matches(const QString& source, int page, qreal targetDpi) const {
@@ -219,6 +225,27 @@ struct PdfCacheEntry {
     }
 };
 
+/**
+ * @brief One tile of a PDF page rendered at high zoom.
+ * 
+ * Above the full-page DPI cap, the visible part of a page is rendered as
+ * PDF_TILE_SIZE pixel tiles at the true DPI and drawn over the capped
+ * full-page image. Tiles are only touched on the main thread.
+ */
+struct PdfTileEntry {
+    QString sourceId;       ///< PDF source id (empty = primary source)
+    int pageIndex = -1;     ///< PDF page number
+    qreal dpi = 0;          ///< DPI of the tile grid
+    QPoint tile;            ///< Column/row in the tile grid
+    QPixmap pixmap;         ///< Rendered tile (null while pending)
+    qint64 lastUse = 0;     ///< CacheBudget::nowMs() of the last draw (LRU)
+    
+    bool matches(const QString& source, int page, qreal targetDpi, const QPoint& t) const {
+        return sourceId == source && pageIndex == page && tile == t
+            && qFuzzyCompare(dpi, targetDpi);
+    }
+};
+
 /**
  * @brief Unified pointer event for all input types (Task 1.3.8).
  * 
@@ -249,6 +276,10 @@ struct PointerEvent {
     
     // Timestamp for velocity calculations
     qint64 timestamp = 0;
+    
+    /// When the input event happened, on the monotonic clock of
+    /// QElapsedTimer::msecsSinceReference() (for latency measurement)
+    qint64 inputMs = 0;
 };
 
 /**
@@ -288,8 +319,10 @@ struct GestureState {
  * - Managing caches for smooth scrolling
  * 
  * One DocumentViewport instance per tab (each tab has its own view state).
+ * Its PDF page/tile caches and the stroke caches of the pages it shows are
+ * reported to CacheBudget, which evicts idle ones across all viewports.
  */
-class DocumentViewport : public QWidget {
+class DocumentViewport : public QWidget, public CacheBudget::Client {
     Q_OBJECT
     
     // Allow test class to access private members
@@ -430,6 +463,24 @@ public:
     static void setWheelScrollSpeed(qreal speed) { s_wheelScrollSpeed = qBound(5.0, speed, 200.0); }
     static qreal wheelScrollSpeed() { return s_wheelScrollSpeed; }
 
+    // ===== Predicted Ink =====
+
+    /**
+     * @brief Draw a short extrapolated tail ahead of the pen while drawing
+     *        (see InkPredictor). Display only; never saved.
+     */
+    static void setPredictedInkEnabled(bool enabled) { s_predictedInk = enabled; }
+    static bool predictedInkEnabled() { return s_predictedInk; }
+
+    /**
+     * @brief Measured delay from a pen event to the end of the paint that
+     *        showed it; also the prediction horizon.
+     */
+    const InkPredictor::Latency& inkLatency() const { return m_inkPredictor.latency(); }
+
+    /// How far ahead the predicted tail currently reaches (from inkLatency()).
+    qreal inkPredictionHorizonMs() const { return m_inkPredictor.horizonMs(); }
+
     // ===== View State Getters =====
     
     /**
@@ -1521,6 +1572,18 @@ public:
      */
     void notifyPdfChanged();
     
+    // ===== CacheBudget::Client =====
+    
+    QString cacheName() const override { return QStringLiteral("viewport"); }
+    
+    /**
+     * @brief Report PDF pages, PDF tiles and the stroke/focus/outline caches
+     *        of the loaded pages or tiles. Keys are the pixmaps' cacheKey(),
+     *        or VectorLayer::outlineCacheKey() for outlines.
+     */
+    void collectCacheItems(QVector<CacheBudget::Item>& items) const override;
+    void evictCacheItems(const QVector<quint64>& keys) override;
+    
     // ===== View State Setters (Slots) =====
     
 public slots:
@@ -1721,6 +1784,15 @@ public slots:
      */
     bool isScrolling() const { return m_scrollActive; }
     
+    /**
+     * @brief Whether pages/tiles were already resident when they came into
+     *        view, and how many were prefetched (see ResidencyPolicy).
+     */
+    const ResidencyPolicy::Stats& residencyStats() const { return m_residency.stats(); }
+    
+    /// Zero the residency counters.
+    void resetResidencyStats() { m_residency.resetStats(); }
+    
     /**
      * @brief Emit scroll fraction signals for current state.
      * 
@@ -2160,6 +2232,9 @@ private:
     /// 150ms single-shot. Restarted on every setPanOffset / setZoomLevel.
     /// On timeout, clears m_focusCacheSuspended and triggers an update().
     QTimer* m_focusRebuildTimer = nullptr;
+    /// 30ms single-shot repaint while a layer's capped stroke cache is being
+    /// rebuilt on the thread pool (VectorLayer::CacheRebuild::Background).
+    QTimer* m_strokeCacheRebuildTimer = nullptr;
     
     // ===== Pan Tool State =====
     bool m_isPanToolDragging = false;
@@ -2200,6 +2275,9 @@ private:
     // ----- Mouse Wheel Scroll Speed -----
     static inline qreal s_wheelScrollSpeed = 40.0;  ///< Document units per wheel click
     
+    // ----- Predicted Ink -----
+    static inline bool s_predictedInk = false;      ///< Extrapolate the live stroke (InkPredictor)
+    
     // ----- Tool Defaults -----
     // These are initial values; MainWindow will set them from user preferences.
     ToolType m_currentTool = ToolType::Pen;
@@ -2762,6 +2840,16 @@ private:
     QTimer* m_pdfPreloadTimer = nullptr;  ///< Debounce timer for preload requests
     QList<QFutureWatcher<QImage>*> m_activePdfWatchers;  ///< Active async render operations (returns QImage for thread safety)
     static constexpr int PDF_PRELOAD_DELAY_MS = 150;   ///< Debounce delay (ms) before preloading
+    
+    // ===== Tiled PDF Rendering (high zoom) =====
+    // Main thread only (paint path and watcher handlers), so no mutex.
+    QVector<PdfTileEntry> m_pdfTileCache;     ///< Rendered tiles
+    QVector<PdfTileEntry> m_pendingPdfTiles;  ///< Tiles with a render in flight
+    QList<QFutureWatcher<QImage>*> m_activePdfTileWatchers;  ///< Async tile renders
+    static constexpr int PDF_TILE_SIZE = 512; ///< Tile edge in device pixels
+
+    /// CacheBudget::nowMs() at the start of the last full (non-partial) repaint.
+    qint64 m_lastFullPaintMs = 0;
 
     // ===== Scroll-activity gate (SP1) =====
     // The immediate-pan route (wheel/touchpad/scroll-bar) marks itself active on
@@ -2771,6 +2859,33 @@ private:
     bool m_scrollActive = false;            ///< True while actively scrolling (see isScrolling())
     static constexpr int SCROLL_SETTLE_MS = 120;  ///< Idle delay (ms) before deferred housekeeping runs
     
+    // ===== Scroll-aware residency =====
+    // Velocity/direction-driven keep windows (see ResidencyPolicy). While a pan
+    // is in flight m_prefetchTimer loads and renders ahead of the view at most
+    // every PREFETCH_INTERVAL_MS; once it settles m_idleWarmTimer warms the
+    // rest of the window one page/tile per tick.
+    ResidencyPolicy m_residency;
+    QTimer* m_prefetchTimer = nullptr;     ///< Throttles prefetchAhead() during a pan
+    QTimer* m_idleWarmTimer = nullptr;     ///< Drives warmNextIdle() after settling
+    QVector<int> m_idleWarmPages;          ///< Pages left to warm, nearest first
+    QVector<Document::TileCoord> m_idleWarmTiles;  ///< Tiles left to warm, nearest first
+    QVector<int> m_residencyShownPages;    ///< Pages visible in the last counted frame
+    QVector<Document::TileCoord> m_residencyShownTiles;  ///< Tiles visible in the last counted frame
+    QSet<QPair<QString, int>> m_pdfPreloadPending;  ///< (source, PDF page) renders in flight
+    static constexpr int PREFETCH_INTERVAL_MS = 100;  ///< Min spacing of in-flight prefetches
+    static constexpr int IDLE_WARM_INTERVAL_MS = 30;  ///< Spacing of idle warm steps
+    static constexpr int PREFETCH_TILES_PER_STEP = 2; ///< Tile loads per in-flight prefetch
+    
+    // ===== Background page/tile loading =====
+    // Pages/tiles that are not in memory are read and parsed on a worker
+    // thread (Document::readPageData/readTileData) and installed here on the
+    // GUI thread. Used while scrolling and for prefetch; everything else still
+    // loads synchronously through Document::page()/getTile().
+    QSet<QString> m_pendingLoads;   ///< Page UUIDs / "x,y" tile keys being read
+    QSet<QString> m_failedLoads;    ///< Reads that failed; later requests load synchronously
+    quint64 m_loadGeneration = 0;   ///< Bumped on document change; stale results are dropped
+    int m_reportedUnreadable = 0;   ///< Document::unreadableStrokeFiles() already reported
+    
     // ===== Page Layout Cache (Performance: O(1) page position lookup) =====
     mutable QVector<qreal> m_pageYCache;  ///< Cached Y position for each page (single column)
     mutable QSizeF m_cachedContentSize;   ///< Cached total content size (computed during layout)
@@ -2811,6 +2926,29 @@ private:
     // ===== Incremental Stroke Rendering (Task 2.3) =====
     QPixmap m_currentStrokeCache;             ///< Cache for in-progress stroke segments
     int m_lastRenderedPointIndex = 0;         ///< Index of last point rendered to cache
+    int m_liveCommittedSegments = 0;          ///< Segments [0, n) are final in the cache
+    QPixmap m_liveTailBackup;                 ///< Cache pixels under the drawn tail (DPR 1)
+    QRect m_liveTailRect;                     ///< Where m_liveTailBackup came from (physical px)
+    
+    /// Trailing segments of the live stroke that can still change: a segment
+    /// depends on the point after its end, and the last point's pressure is
+    /// raised while decimated samples arrive.
+    static constexpr int LIVE_TAIL_SEGMENTS = 3;
+    
+    /// Points whose on-screen area can change when a point is appended
+    /// (old tail, newly settled segments and new tail, with their neighbours).
+    static constexpr int LIVE_DIRTY_POINTS = 6;
+    
+    InkPredictor m_inkPredictor;              ///< Predicted tail + input-to-paint latency
+    QVector<qint64> m_inkPendingInputMs;      ///< Input times of points not painted yet
+    QTimer* m_inkRetractTimer = nullptr;      ///< Takes the prediction back if the pen stalls
+    int m_inkRetractedPoints = -1;            ///< Point count whose prediction was taken back
+    
+    /// Longest predicted tail, in screen pixels.
+    static constexpr qreal MAX_PREDICTION_SCREEN_PX = 24.0;
+    
+    /// Older input event timestamps are taken to be on another clock.
+    static constexpr qint64 MAX_INPUT_QUEUE_MS = 1000;
     qreal m_cacheZoom = 1.0;                  ///< Zoom level when cache was built
     QPointF m_cachePan;                       ///< Pan offset when cache was built
     
@@ -2980,18 +3118,134 @@ private:
      */
     void onScrollSettled();
     
+    /**
+     * @brief Feed a pan to the residency policy and, while it is in flight,
+     *        schedule prefetchAhead() (throttled).
+     * @param delta Pan offset change in document units.
+     */
+    void noteScrollMotion(QPointF delta);
+    
+    /**
+     * @brief Load and render ahead of the view while a pan is in flight.
+     * Paged: async PDF preload of the ahead window (loads those pages).
+     * Edgeless: loads up to PREFETCH_TILES_PER_STEP tiles in the direction
+     * of travel. Stroke caches wait for warmNextIdle().
+     */
+    void prefetchAhead();
+    
+    /**
+     * @brief Queue the keep window for idle warming, nearest first.
+     * Called once scrolling settles; any pan or drawing cancels it.
+     */
+    void scheduleIdleWarm();
+    
+    /// Warm one queued page/tile: load it and build its stroke caches.
+    void warmNextIdle();
+    
+    /// Drop the idle warm queue.
+    void stopIdleWarm();
+    
+    /**
+     * @brief Keep window around the visible pages for this zoom and motion.
+     * @param baseBuffer The symmetric buffer used when direction is unknown.
+     */
+    ResidencyPolicy::Span residencyPageSpan(int baseBuffer) const;
+    
+    /**
+     * @brief Keep-window sizes for one memory tier. Caches grow with the
+     *        effective scale (zoom * dpr), so windows shrink as it rises.
+     */
+    struct ResidencyTier {
+        int buffer = 0;       ///< Symmetric buffer: pages, or tile margin
+        int maxAhead = 0;     ///< Upper bound for the ahead side, in pages
+        int tilesAhead = 0;   ///< Extra tiles on the ahead side
+    };
+    
+    /// Tier for an effective scale; the one place the thresholds live.
+    static ResidencyTier residencyTier(qreal effectiveScale);
+    
+    /// Keep margins (in tiles) around the visible rect for this zoom and motion.
+    QMargins residencyTileMargins() const;
+    
+    /// Tiles of the keep window still on disk only, nearest to where the
+    /// view is heading first (prefetchAhead(), scheduleIdleWarm()).
+    QVector<Document::TileCoord> coldTilesByHeading() const;
+    
+    /// Count pages coming into view as residency hits or misses.
+    void noteResidency(const QVector<int>& visible);
+    
+    /// Count edgeless tiles coming into view as residency hits or misses.
+    void noteTileResidency(const QRectF& viewRect);
+    
+    /**
+     * @brief Load a page on a worker thread instead of the GUI thread.
+     * @param prefetch True when loading ahead of the view (counted as prefetch).
+     * @return True if the page is now loading in the background. False if it
+     *         cannot be (already loaded, not on disk, an earlier read failed):
+     *         the caller loads it synchronously via Document::page().
+     */
+    bool requestBackgroundLoad(int pageIndex, bool prefetch);
+    
+    /// Edgeless counterpart of requestBackgroundLoad().
+    bool requestBackgroundTileLoad(Document::TileCoord coord, bool prefetch);
+    
+    /// Start the worker read for @p request and install the result when done.
+    void startBackgroundLoad(const Document::LoadRequest& request, bool isTile);
+    
+    /// Warn once about pages/tiles whose strokes failed to load since the last call.
+    void reportUnreadableStrokeFiles();
+    
     /**
      * @brief Invalidate the entire PDF cache.
      * Called when zoom changes (DPI changed) or document changes.
      */
     void invalidatePdfCache();
     
+    /**
+     * @brief Call @p fn for every layer of the loaded pages (paged) or
+     *        loaded tiles (edgeless). Never loads anything.
+     */
+    void forEachLoadedLayer(const std::function<void(VectorLayer*)>& fn) const;
+    
     /**
      * @brief Invalidate a single page in the PDF cache.
      * @param pageIndex The page to invalidate.
      */
     void invalidatePdfCachePage(const QString& sourceId, int pageIndex);
     
+    /**
+     * @brief DPI for tiled PDF rendering, or 0 when not tiling.
+     * 
+     * Tiling kicks in once the zoom asks for more than effectivePdfDpi()'s
+     * full-page cap; the tiles then render at the uncapped DPI.
+     */
+    qreal pdfTileDpi() const;
+    
+    /**
+     * @brief Draw the cached high-zoom tiles of a page's visible region.
+     * @param page The page (painter is in page coordinates).
+     * @param pageIndex The page's index in the document.
+     * @param renderPageNum Page index in the provider (resolved source page).
+     * @param dpi Tile DPI from pdfTileDpi().
+     * 
+     * Missing tiles are requested asynchronously (not while scrolling); the
+     * full-page image drawn underneath shows until they arrive.
+     */
+    void renderPdfTiles(QPainter& painter, Page* page, int pageIndex,
+                        int renderPageNum, qreal dpi);
+    
+    /**
+     * @brief Start an async render of one tile.
+     * @param pixelRect The tile in full-page pixel coordinates at @p dpi.
+     */
+    void requestPdfTile(const QString& sourceId, int pdfPageNum, int renderPageNum,
+                        qreal dpi, const QPoint& tile, const QRect& pixelRect);
+    
+    /**
+     * @brief Drop least recently drawn tiles beyond two viewports' worth.
+     */
+    void evictPdfTiles();
+    
     /**
      * @brief Update cache capacity based on visible pages and layout mode.
      * 
@@ -3069,6 +3323,12 @@ private:
      */
     void releaseFocusCachesBelowThreshold();
 
+    /**
+     * @brief Keep repainting while @p layer rebuilds its stroke cache in the
+     *        background, so the finished cache is picked up promptly.
+     */
+    void noteStrokeCacheRebuild(const VectorLayer* layer);
+
     // ===== Input Routing (Task 1.3.8) =====
     
     /**
@@ -3081,6 +3341,15 @@ private:
      */
     PointerEvent tabletToPointerEvent(QTabletEvent* event, PointerEvent::Type type);
     
+    /**
+     * @brief Time of an input event on the QElapsedTimer monotonic clock.
+     *
+     * Platform event timestamps use that clock on most platforms (X11,
+     * Wayland, evdev, Android); a timestamp that does not fit (in the future,
+     * or older than MAX_INPUT_QUEUE_MS) falls back to the time of receipt.
+     */
+    static qint64 inputEventMs(const QInputEvent* event);
+    
     /**
      * @brief Main pointer event handler.
      * Routes to the correct page and handles the input.
@@ -3586,12 +3855,19 @@ private:
      * @brief Render the in-progress stroke to the viewport.
      * @param painter The QPainter to render to (viewport painter, unmodified transform).
      * 
-     * Uses VectorLayer::renderStroke() with Catmull-Rom smoothing for visual
-     * consistency with finalized strokes. The cache is re-rendered only when
-     * new points arrive; repaints without new points reuse the existing cache.
+     * Uses the same Catmull-Rom outline as finalized strokes. When new points
+     * arrive, only the newly settled segments are added to the cache and the
+     * provisional tail is redrawn in a small rect; repaints without new
+     * points reuse the existing cache.
      */
     void renderCurrentStrokeIncremental(QPainter& painter);
     
+    /**
+     * @brief Schedule a repaint of the part of the live stroke that changes
+     *        when a point is appended (see LIVE_DIRTY_POINTS).
+     */
+    void updateLiveStrokeTail();
+    
     // ===== Eraser Tool (Task 2.4) =====
     
     /**
@@ -3631,6 +3907,13 @@ private:
      */
     void pushUndoAction(const UndoAction& action);
     
+    /**
+     * @brief Append a stroke action that was just applied to the document's
+     *        stroke journal (crash recovery).
+     * @param inverse True when the action was undone rather than done/redone.
+     */
+    void journalUndoAction(const UndoAction& action, bool inverse);
+    
     /**
      * @brief Convenience: push a single-stroke undo on a given page (paged mode).
      * @param layerIndex Layer the stroke was added to/removed from, so undo/redo
@@ -3681,7 +3964,7 @@ private:
      * @param points The stroke points in document coordinates.
      * @return Vector of TileSegments, each containing points for one tile.
      */
-    QVector<TileSegment> splitStrokeIntoTileSegments(const QVector<StrokePoint>& points) const;
+    QVector<TileSegment> splitStrokeIntoTileSegments(const StrokePointStore& points) const;
     
     // ===== Rendering Helpers (Task 1.3.3) =====
     
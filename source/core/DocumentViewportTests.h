@@ -11,10 +11,13 @@
 #include "Document.h"
 #include "ObjectConstraints.h"
 #include "Page.h"
+#include "InkPredictor.h"
+#include "ResidencyPolicy.h"
 #include "../strokes/VectorStroke.h"
 #include "../strokes/StrokePoint.h"
 
 #include <QApplication>
+#include <QLineF>
 #include <QtMath>
 #include <cstdio>
 #include <memory>
@@ -371,6 +374,147 @@ public:
         return true;
     }
     
+    /**
+     * @brief Test scroll-aware keep windows and residency counters.
+     */
+    static bool testResidencyPolicy() {
+        printf("  testResidencyPolicy... ");
+        
+        const QSizeF view(800, 600);
+        const qreal pageExtent = 1000;
+        ResidencyPolicy policy;
+        
+        // No direction yet: symmetric base buffer
+        ResidencyPolicy::Span span = policy.pageSpan(2, 6, pageExtent, 0);
+        if (span.before != 2 || span.after != 2) {
+            printf("FAILED: expected symmetric 2/2, got %d/%d\n", span.before, span.after);
+            return false;
+        }
+        
+        // Slow forward reading: one extra page ahead, half the buffer behind
+        policy.noteScroll(QPointF(0, 40), view, 1000);
+        span = policy.pageSpan(2, 6, pageExtent, 1000);
+        if (span.before != 1 || span.after != 3) {
+            printf("FAILED: reading forward expected 1/3, got %d/%d\n", span.before, span.after);
+            return false;
+        }
+        
+        // Fast flick: 500 units per 20 ms = 25000/s covers many pages in the
+        // lookahead, capped by maxAhead
+        for (int i = 1; i <= 5; ++i) {
+            policy.noteScroll(QPointF(0, 500), view, 1000 + i * 20);
+        }
+        span = policy.pageSpan(2, 6, pageExtent, 1100);
+        if (span.after != 6 || span.before != 1) {
+            printf("FAILED: flick expected 1/6, got %d/%d\n", span.before, span.after);
+            return false;
+        }
+        
+        // Speed goes stale once the flick stops; direction is kept
+        span = policy.pageSpan(2, 6, pageExtent, 1100 + ResidencyPolicy::STALE_MS + 1);
+        if (span.after != 3 || span.before != 1) {
+            printf("FAILED: after flick expected 1/3, got %d/%d\n", span.before, span.after);
+            return false;
+        }
+        
+        // Reversing flips the window; a jump does not read as speed
+        policy.noteScroll(QPointF(0, -40), view, 5000);
+        policy.noteScroll(QPointF(0, -50000), view, 5010);
+        span = policy.pageSpan(2, 6, pageExtent, 5010);
+        if (span.before != 3 || span.after != 1) {
+            printf("FAILED: reversed expected 3/1, got %d/%d\n", span.before, span.after);
+            return false;
+        }
+        
+        // Horizontal pan in edgeless: only the x axis gets a direction
+        policy.reset();
+        policy.noteScroll(QPointF(-60, 5), view, 0);
+        const QMargins margins = policy.tileMargins(2, 4, 1024, 0);
+        if (margins.left() != 3 || margins.right() != 1
+            || margins.top() != 2 || margins.bottom() != 2) {
+            printf("FAILED: tile margins wrong\n");
+            return false;
+        }
+        
+        policy.noteHit();
+        policy.noteHit();
+        policy.noteHit();
+        policy.noteMiss();
+        if (!qFuzzyCompare(policy.stats().hitRate(), 0.75)) {
+            printf("FAILED: hit rate should be 0.75\n");
+            return false;
+        }
+        
+        printf("PASSED\n");
+        return true;
+    }
+    
+    /**
+     * @brief Test predicted ink extrapolation and latency tracking.
+     */
+    static bool testInkPredictor() {
+        printf("  testInkPredictor... ");
+        
+        // Straight line at 1 unit/ms, a point every 4 ms
+        auto makeStroke = [](qreal pressure, qreal pressureStep) {
+            StrokePointStore points;
+            for (int i = 0; i <= 10; ++i) {
+                StrokePoint pt;
+                pt.pos = QPointF(4.0 * i, 20.0);
+                pt.pressure = pressure + pressureStep * i;
+                pt.timestamp = 1000 + 4 * i;
+                points.append(pt);
+            }
+            return points;
+        };
+        
+        InkPredictor predictor;
+        if (!qFuzzyCompare(predictor.horizonMs(), static_cast<qreal>(InkPredictor::MIN_HORIZON_MS))) {
+            printf("FAILED: unmeasured horizon should be the minimum\n");
+            return false;
+        }
+        predictor.noteLatency(16);
+        if (!qFuzzyCompare(predictor.horizonMs(), 16.0) || predictor.latency().samples != 1) {
+            printf("FAILED: horizon should follow measured latency\n");
+            return false;
+        }
+        
+        QVector<StrokePoint> predicted = predictor.predict(makeStroke(0.5, 0), 100);
+        if (predicted.size() != InkPredictor::STEPS
+            || qAbs(predicted.last().pos.x() - 56.0) > 0.5
+            || qAbs(predicted.last().pos.y() - 20.0) > 0.5) {
+            printf("FAILED: constant velocity should extrapolate to (56, 20)\n");
+            return false;
+        }
+        
+        // Distance cap
+        predicted = predictor.predict(makeStroke(0.5, 0), 5);
+        if (predicted.isEmpty() || QLineF(QPointF(40, 20), predicted.last().pos).length() > 5.001) {
+            printf("FAILED: prediction should respect the distance cap\n");
+            return false;
+        }
+        
+        // Pressure falling towards lift-off: nothing predicted
+        predicted = predictor.predict(makeStroke(0.9, -0.08), 100);
+        if (!predicted.isEmpty()) {
+            printf("FAILED: lifting pen should not be extrapolated\n");
+            return false;
+        }
+        
+        // No timestamps, no prediction
+        StrokePointStore untimed;
+        for (int i = 0; i < 5; ++i) {
+            untimed.append({QPointF(i * 4.0, 0), 0.5});
+        }
+        if (!predictor.predict(untimed, 100).isEmpty()) {
+            printf("FAILED: untimed stroke should not be extrapolated\n");
+            return false;
+        }
+        
+        printf("PASSED\n");
+        return true;
+    }
+    
     /**
      * @brief Test PointerEvent creation from mouse events.
      */
@@ -579,6 +723,8 @@ public:
         runTest(testVisiblePages, "testVisiblePages");
         runTest(testScrollFractions, "testScrollFractions");
         runTest(testPdfCache, "testPdfCache");
+        runTest(testResidencyPolicy, "testResidencyPolicy");
+        runTest(testInkPredictor, "testInkPredictor");
         runTest(testPointerEvents, "testPointerEvents");
         runTest(testObjectPageContainment, "testObjectPageContainment");
         runTest(testObjectGroupContainment, "testObjectGroupContainment");
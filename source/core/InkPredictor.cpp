@@ -0,0 +1,105 @@
+// ============================================================================
+// InkPredictor - Implementation
+// ============================================================================
+
+#include "InkPredictor.h"
+
+#include <QtGlobal>
+
+#include <cmath>
+
+QVector<StrokePoint> InkPredictor::predict(const StrokePointStore& points, qreal maxDistance) const
+{
+    QVector<StrokePoint> predicted;
+    const int n = points.size();
+    if (n < 3 || maxDistance <= 0 || !points.hasTimestamps()) {
+        return predicted;
+    }
+
+    const qint64 tLast = points.timestamp(n - 1);
+    if (tLast == 0) {
+        return predicted;
+    }
+
+    // Oldest point inside the window (timestamps are non-decreasing)
+    int first = n - 1;
+    while (first > 0) {
+        const qint64 t = points.timestamp(first - 1);
+        if (t == 0 || tLast - t > WINDOW_MS) {
+            break;
+        }
+        --first;
+    }
+    const qint64 span = tLast - points.timestamp(first);
+    if (n - first < 3 || span < MIN_SPAN_MS) {
+        return predicted;
+    }
+
+    // Average velocity over the window and over each half of it (units/ms)
+    const int mid = (first + n - 1) / 2;
+    auto velocity = [&points](int from, int to) {
+        const qint64 dt = points.timestamp(to) - points.timestamp(from);
+        return dt > 0 ? (points.pos(to) - points.pos(from)) / static_cast<qreal>(dt) : QPointF();
+    };
+    const QPointF v = velocity(first, n - 1);
+    const qreal halfSpan = span / 2.0;
+    const QPointF a = (velocity(mid, n - 1) - velocity(first, mid)) / halfSpan;
+    const qreal dp = (points.pressure(n - 1) - points.pressure(first)) / static_cast<qreal>(span);
+
+    const qreal horizon = horizonMs();
+    const QPointF origin = points.pos(n - 1);
+    const qreal p0 = points.pressure(n - 1);
+
+    predicted.reserve(STEPS);
+    for (int s = 1; s <= STEPS; ++s) {
+        const qreal t = horizon * s / STEPS;
+        QPointF offset = v * t + a * (ACCEL_DAMPING * 0.5 * t * t);
+
+        // Never extrapolate backwards along the current motion: a strong
+        // deceleration term would otherwise fold the tail back on itself.
+        if (QPointF::dotProduct(offset, v) <= 0) {
+            break;
+        }
+        const qreal length = std::hypot(offset.x(), offset.y());
+        if (length > maxDistance) {
+            offset *= maxDistance / length;
+        }
+
+        const qreal pressure = p0 + dp * t;
+        if (pressure <= LIFT_PRESSURE) {
+            break;   // Pen is lifting within the horizon
+        }
+
+        StrokePoint pt;
+        pt.pos = origin + offset;
+        pt.pressure = qMin<qreal>(pressure, 1.0);
+        pt.timestamp = tLast + static_cast<qint64>(t);
+        predicted.append(pt);
+
+        if (length >= maxDistance) {
+            break;
+        }
+    }
+    return predicted;
+}
+
+qreal InkPredictor::horizonMs() const
+{
+    if (m_latency.samples == 0) {
+        return MIN_HORIZON_MS;
+    }
+    return qBound<qreal>(MIN_HORIZON_MS, m_latency.meanMs, MAX_HORIZON_MS);
+}
+
+void InkPredictor::noteLatency(qreal ms)
+{
+    if (ms < 0) {
+        return;
+    }
+    m_latency.lastMs = ms;
+    m_latency.maxMs = qMax(m_latency.maxMs, ms);
+    m_latency.meanMs = (m_latency.samples == 0)
+        ? ms
+        : m_latency.meanMs * (1.0 - LATENCY_SMOOTHING) + ms * LATENCY_SMOOTHING;
+    ++m_latency.samples;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+// ============================================================================
+// InkPredictor - Provisional ink ahead of the pen
+// ============================================================================
+// Pen input reaches the screen one paint cycle (plus compositor) after the
+// event: tabletEvent -> addPointToStroke -> update() -> paintEvent. At normal
+// writing speed the ink visibly trails the nib.
+//
+// InkPredictor extrapolates the in-progress stroke a few milliseconds ahead
+// from its recent timestamped points:
+// - Velocity comes from the points of the last WINDOW_MS (event timestamps
+//   are whole milliseconds, so single deltas are too coarse); acceleration
+//   from the newer half against the older half, damped
+// - Pressure follows its linear trend; a trend that reaches the lift-off
+//   pressure within the horizon ends the prediction there
+// - The horizon is the measured input-to-paint delay (noteLatency()), within
+//   [MIN_HORIZON_MS, MAX_HORIZON_MS]; the distance is capped by the caller
+//
+// The viewport draws the predicted points as part of the live stroke's
+// provisional tail, so they are replaced as soon as real points arrive and
+// never reach the document. If no point arrives within the horizon, the
+// viewport takes the prediction back.
+//
+// Latency is measured for every point, from the input event's platform
+// timestamp (monotonic clock) to the paint that first showed the point.
+// Scanout/compositing after that is not visible to the application, so this
+// is a lower bound of input-to-photon.
+//
+// Plain value class, GUI thread only. Times are in ms (QDateTime epoch, as
+// stored in StrokePoint::timestamp).
+// ============================================================================
+
+#include "../strokes/StrokePointStore.h"
+
+#include <QVector>
+
+class InkPredictor {
+public:
+    /**
+     * @brief Measured input-to-paint delay (see noteLatency()).
+     */
+    struct Latency {
+        quint64 samples = 0;
+        qreal meanMs = 0;     ///< Exponentially smoothed
+        qreal lastMs = 0;
+        qreal maxMs = 0;
+    };
+
+    static constexpr int WINDOW_MS = 40;            ///< History used for velocity
+    static constexpr int MIN_SPAN_MS = 8;           ///< Less history than this: no prediction
+    static constexpr int MIN_HORIZON_MS = 8;
+    static constexpr int MAX_HORIZON_MS = 32;
+    static constexpr int STEPS = 3;                 ///< Predicted points
+    static constexpr qreal ACCEL_DAMPING = 0.5;     ///< Share of the acceleration term kept
+    static constexpr qreal LIFT_PRESSURE = 0.05;    ///< Predicted pressure that ends the stroke
+    static constexpr qreal LATENCY_SMOOTHING = 0.1; ///< Weight of the newest latency sample
+
+    /**
+     * @brief Extrapolate the continuation of a stroke.
+     * @param points The stroke so far (needs timestamps).
+     * @param maxDistance Cap on the predicted length, in the points' units.
+     * @return Up to STEPS points after the last one, or none if the recent
+     *         motion is too short or too slow to extrapolate.
+     */
+    QVector<StrokePoint> predict(const StrokePointStore& points, qreal maxDistance) const;
+
+    /// How far ahead predict() extrapolates, from the measured latency.
+    qreal horizonMs() const;
+
+    /// Record the delay between a point's input event and the paint showing it.
+    void noteLatency(qreal ms);
+
+    const Latency& latency() const { return m_latency; }
+    void resetLatency() { m_latency = Latency(); }
+
+private:
+    Latency m_latency;
+};
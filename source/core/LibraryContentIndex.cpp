@@ -0,0 +1,512 @@
+#include "LibraryContentIndex.h"
+#include "Document.h"
+#include "MarkdownNote.h"
+#include "../ocr/OcrTextBlock.h"
+#include "../pdf/PdfProvider.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSet>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr quint32 INDEX_MAGIC = 0x534E4C49;  // "SNLI"
+
+/// Ranking weight per LibraryContentIndex::Field: text the user wrote
+/// (notes, handwriting) says more about a notebook than a PDF's body text.
+constexpr double FIELD_WEIGHTS[LibraryContentIndex::FIELD_COUNT] = {1.0, 1.5, 2.0};
+}
+
+// ============================================================================
+// Construction
+// ============================================================================
+
+LibraryContentIndex::LibraryContentIndex(const QString& indexFilePath, QObject* parent)
+    : QObject(parent)
+    , m_indexFilePath(indexFilePath)
+{
+    connect(&m_passWatcher, &QFutureWatcher<void>::finished, this, [this]() {
+        if (m_refreshPending) {
+            m_refreshPending = false;
+            startPass(m_pendingRefresh);
+            m_pendingRefresh.clear();
+        }
+    });
+}
+
+LibraryContentIndex::~LibraryContentIndex()
+{
+    m_cancelled.store(true);
+    m_passWatcher.waitForFinished();
+}
+
+void LibraryContentIndex::refresh(const QStringList& bundlePaths)
+{
+    if (m_passWatcher.isRunning()) {
+        m_pendingRefresh = bundlePaths;
+        m_refreshPending = true;
+        return;
+    }
+    startPass(bundlePaths);
+}
+
+void LibraryContentIndex::startPass(const QStringList& bundlePaths)
+{
+    m_cancelled.store(false);
+    m_passWatcher.setFuture(QtConcurrent::run([this, bundlePaths]() {
+        runPass(bundlePaths);
+    }));
+}
+
+bool LibraryContentIndex::isIndexing() const
+{
+    return m_passWatcher.isRunning();
+}
+
+int LibraryContentIndex::bundleCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_bundleIds.size());
+}
+
+// ============================================================================
+// Tokenizing and Harvesting
+// ============================================================================
+
+QStringList LibraryContentIndex::tokenize(const QString& text)
+{
+    QStringList terms;
+    QString word;
+    auto flush = [&]() {
+        if (word.size() >= 2) {
+            terms.append(word);
+        }
+        word.clear();
+    };
+
+    const QString folded = text.toCaseFolded();
+    for (const QChar c : folded) {
+        if (isCjkLikeChar(c)) {
+            // CJK has no word separators: index every character
+            flush();
+            terms.append(QString(c));
+        } else if (c.isLetterOrNumber()) {
+            word += c;
+        } else {
+            flush();
+        }
+    }
+    flush();
+    return terms;
+}
+
+qint64 LibraryContentIndex::bundleStamp(const QString& bundlePath)
+{
+    const QFileInfo manifest(bundlePath + "/document.json");
+    if (!manifest.exists()) {
+        return 0;
+    }
+
+    qint64 stamp = manifest.lastModified().toMSecsSinceEpoch();
+    auto consider = [&stamp](const QFileInfo& info) {
+        if (info.exists()) {
+            stamp = qMax(stamp, info.lastModified().toMSecsSinceEpoch());
+        }
+    };
+    consider(QFileInfo(bundlePath + "/pages"));
+    consider(QFileInfo(bundlePath + "/tiles"));
+    consider(QFileInfo(bundlePath + "/assets/notes"));
+
+    // OCR sidecars and notes are written when OCR finishes or a note is
+    // edited, without a bundle save
+    for (const char* dir : {"/pages", "/tiles"}) {
+        QDirIterator ocr(bundlePath + dir, QStringList{QStringLiteral("*.ocr.json")}, QDir::Files);
+        while (ocr.hasNext()) {
+            ocr.next();
+            consider(ocr.fileInfo());
+        }
+    }
+    QDirIterator notes(bundlePath + "/assets/notes", QStringList{QStringLiteral("*.md")}, QDir::Files);
+    while (notes.hasNext()) {
+        notes.next();
+        consider(notes.fileInfo());
+    }
+    return stamp;
+}
+
+LibraryContentIndex::TermTable LibraryContentIndex::harvest(const QString& bundlePath,
+                                                            const std::atomic<bool>& cancelled)
+{
+    TermTable terms;
+    auto add = [&terms](const QString& text, Field field) {
+        const QStringList words = tokenize(text);
+        for (const QString& word : words) {
+            ++terms[word].count[field];
+        }
+    };
+
+    // OCR sidecars of pages and edgeless tiles, read without loading them
+    for (const char* dir : {"/pages", "/tiles"}) {
+        QDirIterator it(bundlePath + dir, QStringList{QStringLiteral("*.ocr.json")}, QDir::Files);
+        while (it.hasNext()) {
+            QFile file(it.next());
+            if (!file.open(QIODevice::ReadOnly)) continue;
+            const QJsonArray blocks =
+                QJsonDocument::fromJson(file.readAll()).object().value("blocks").toArray();
+            for (const QJsonValue& block : blocks) {
+                add(block.toObject().value("text").toString(), OcrField);
+            }
+        }
+    }
+
+    QDirIterator notes(bundlePath + "/assets/notes", QStringList{QStringLiteral("*.md")}, QDir::Files);
+    while (notes.hasNext()) {
+        const MarkdownNote note = MarkdownNote::loadFromFile(notes.next());
+        add(note.title, NoteField);
+        add(note.content, NoteField);
+    }
+
+    if (cancelled.load()) {
+        return terms;
+    }
+
+    // PDF text: the manifest resolves every source (relinked, relative or
+    // bundled). Read directly - a Document is GUI-thread only, and pages
+    // stay on disk.
+    QFile manifest(bundlePath + "/document.json");
+    if (!manifest.open(QIODevice::ReadOnly)) {
+        return terms;
+    }
+    const QJsonObject manifestObj = QJsonDocument::fromJson(manifest.readAll()).object();
+    manifest.close();
+
+    const QString bundleDir = QFileInfo(bundlePath).absoluteFilePath();
+    for (const PdfSource& source : Document::pdfSourcesFromJson(manifestObj)) {
+        const QString pdfPath = Document::resolvePdfSourcePath(source, bundleDir);
+        if (pdfPath.isEmpty()) continue;
+        const std::shared_ptr<PdfProvider> pdf = PdfProvider::shared(pdfPath);
+        if (!pdf || !pdf->isValid() || !pdf->supportsTextExtraction()) continue;
+
+        for (int page = 0; page < pdf->pageCount(); ++page) {
+            if (cancelled.load()) {
+                return terms;
+            }
+            QString pageText;
+            const QVector<PdfTextBox> boxes = pdf->textBoxes(page);
+            for (const PdfTextBox& box : boxes) {
+                pageText += box.text;
+                pageText += QLatin1Char(' ');
+            }
+            add(pageText, PdfField);
+        }
+    }
+    return terms;
+}
+
+// ============================================================================
+// Background Pass
+// ============================================================================
+
+void LibraryContentIndex::runPass(const QStringList& bundlePaths)
+{
+    bool loadedNow = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_loaded) {
+            m_loaded = true;
+            loadLocked();
+            loadedNow = !m_bundleIds.isEmpty();
+        }
+    }
+    if (loadedNow) {
+        emit indexUpdated();  // Queued to the GUI thread
+    }
+
+    bool changed = false;
+    const QSet<QString> wanted(bundlePaths.begin(), bundlePaths.end());
+    {
+        QMutexLocker locker(&m_mutex);
+        const QList<QString> indexed = m_bundleIds.keys();
+        for (const QString& path : indexed) {
+            if (!wanted.contains(path)) {
+                removeBundleLocked(m_bundleIds.value(path));
+                changed = true;
+            }
+        }
+    }
+
+    QElapsedTimer sinceUpdate;
+    sinceUpdate.start();
+    int harvested = 0;
+
+    for (const QString& path : bundlePaths) {
+        if (m_cancelled.load()) {
+            break;
+        }
+
+        const qint64 stamp = bundleStamp(path);
+        {
+            QMutexLocker locker(&m_mutex);
+            auto it = m_bundleIds.constFind(path);
+            if (it != m_bundleIds.constEnd()) {
+                if (m_bundles[it.value()].stamp == stamp) {
+                    continue;  // Unchanged since it was indexed
+                }
+                if (stamp == 0) {
+                    removeBundleLocked(it.value());  // Bundle is gone
+                    changed = true;
+                    continue;
+                }
+            } else if (stamp == 0) {
+                continue;
+            }
+        }
+
+        BundleEntry entry;
+        entry.path = path;
+        entry.stamp = stamp;
+        entry.terms = harvest(path, m_cancelled);
+        if (m_cancelled.load()) {
+            break;  // Possibly incomplete - keep the old entry
+        }
+
+        {
+            QMutexLocker locker(&m_mutex);
+            setBundleLocked(std::move(entry));
+        }
+        changed = true;
+        ++harvested;
+
+        if (sinceUpdate.elapsed() >= UPDATE_INTERVAL_MS) {
+            emit indexUpdated();
+            sinceUpdate.restart();
+        }
+    }
+
+    if (changed) {
+        save();
+        emit indexUpdated();
+    }
+
+#ifdef SPEEDYNOTE_DEBUG
+    qDebug() << "LibraryContentIndex: pass over" << bundlePaths.size() << "bundles,"
+             << harvested << "re-indexed";
+#else
+    Q_UNUSED(harvested)
+#endif
+}
+
+void LibraryContentIndex::setBundleLocked(BundleEntry entry)
+{
+    auto existing = m_bundleIds.constFind(entry.path);
+    if (existing != m_bundleIds.constEnd()) {
+        removeBundleLocked(existing.value());
+    }
+
+    int id;
+    if (!m_freeIds.isEmpty()) {
+        id = m_freeIds.takeLast();
+    } else {
+        id = static_cast<int>(m_bundles.size());
+        m_bundles.append(BundleEntry());
+    }
+    for (auto it = entry.terms.constBegin(); it != entry.terms.constEnd(); ++it) {
+        m_postings[it.key()].insert(id, it.value());
+    }
+    m_bundleIds.insert(entry.path, id);
+    m_bundles[id] = std::move(entry);
+}
+
+void LibraryContentIndex::removeBundleLocked(int id)
+{
+    BundleEntry& entry = m_bundles[id];
+    for (auto it = entry.terms.constBegin(); it != entry.terms.constEnd(); ++it) {
+        auto postIt = m_postings.find(it.key());
+        if (postIt != m_postings.end()) {
+            postIt->remove(id);
+            if (postIt->isEmpty()) {
+                m_postings.erase(postIt);
+            }
+        }
+    }
+    m_bundleIds.remove(entry.path);
+    entry = BundleEntry();
+    m_freeIds.append(id);
+}
+
+// ============================================================================
+// Query
+// ============================================================================
+
+QList<LibraryContentIndex::Hit> LibraryContentIndex::search(const QString& query,
+                                                           int maxResults) const
+{
+    const QStringList words = tokenize(query);
+    if (words.isEmpty()) {
+        return {};
+    }
+
+    QMutexLocker locker(&m_mutex);
+    const double bundleTotal = static_cast<double>(m_bundleIds.size());
+    QHash<int, Hit> hits;
+
+    for (int w = 0; w < words.size(); ++w) {
+        const QString& word = words[w];
+        const bool prefix = (w == words.size() - 1);
+
+        // Per bundle, this word's score: every matching term, weighted by
+        // field and by how rare the term is across the library
+        QHash<int, Hit> wordHits;
+        int expansions = 0;
+        for (auto it = m_postings.lowerBound(word);
+             it != m_postings.constEnd() && expansions < MAX_PREFIX_TERMS; ++it, ++expansions) {
+            if (it.key() != word && !(prefix && it.key().startsWith(word))) {
+                break;
+            }
+            const double idf = std::log(1.0 + bundleTotal / it->size());
+            for (auto post = it->constBegin(); post != it->constEnd(); ++post) {
+                Hit& hit = wordHits[post.key()];
+                for (int f = 0; f < FIELD_COUNT; ++f) {
+                    const quint32 count = post->count[f];
+                    if (count == 0) continue;
+                    hit.score += FIELD_WEIGHTS[f] * (1.0 + std::log(double(count))) * idf;
+                    hit.matches[f] += static_cast<int>(count);
+                }
+            }
+        }
+
+        // Every word must match
+        if (w == 0) {
+            hits = std::move(wordHits);
+        } else {
+            for (auto it = hits.begin(); it != hits.end();) {
+                auto wordIt = wordHits.constFind(it.key());
+                if (wordIt == wordHits.constEnd()) {
+                    it = hits.erase(it);
+                    continue;
+                }
+                it->score += wordIt->score;
+                for (int f = 0; f < FIELD_COUNT; ++f) {
+                    it->matches[f] += wordIt->matches[f];
+                }
+                ++it;
+            }
+        }
+        if (hits.isEmpty()) {
+            return {};
+        }
+    }
+
+    QList<Hit> results;
+    results.reserve(hits.size());
+    for (auto it = hits.begin(); it != hits.end(); ++it) {
+        it->bundlePath = m_bundles[it.key()].path;
+        results.append(*it);
+    }
+    locker.unlock();
+
+    std::sort(results.begin(), results.end(), [](const Hit& a, const Hit& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        return a.bundlePath < b.bundlePath;
+    });
+    if (results.size() > maxResults) {
+        results.erase(results.begin() + maxResults, results.end());
+    }
+    return results;
+}
+
+// ============================================================================
+// Persistence
+// ============================================================================
+
+void LibraryContentIndex::loadLocked()
+{
+    QFile file(m_indexFilePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QByteArray payload = qUncompress(file.readAll());
+    file.close();
+
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0, version = 0, bundleTotal = 0;
+    in >> magic >> version >> bundleTotal;
+    if (magic != INDEX_MAGIC || version != FORMAT_VERSION) {
+        return;
+    }
+
+    for (quint32 b = 0; b < bundleTotal && in.status() == QDataStream::Ok; ++b) {
+        BundleEntry entry;
+        quint32 termTotal = 0;
+        in >> entry.path >> entry.stamp >> termTotal;
+        entry.terms.reserve(static_cast<int>(qMin<quint32>(termTotal, 1 << 20)));
+        for (quint32 t = 0; t < termTotal && in.status() == QDataStream::Ok; ++t) {
+            QString term;
+            TermCounts counts;
+            in >> term;
+            for (int f = 0; f < FIELD_COUNT; ++f) {
+                in >> counts.count[f];
+            }
+            entry.terms.insert(term, counts);
+        }
+        if (in.status() == QDataStream::Ok) {
+            setBundleLocked(std::move(entry));
+        }
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "LibraryContentIndex: corrupt index" << m_indexFilePath << "- rebuilding";
+        m_bundles.clear();
+        m_freeIds.clear();
+        m_bundleIds.clear();
+        m_postings.clear();
+    }
+}
+
+void LibraryContentIndex::save() const
+{
+    QByteArray payload;
+    {
+        QMutexLocker locker(&m_mutex);
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_12);
+        out << INDEX_MAGIC << FORMAT_VERSION << quint32(m_bundleIds.size());
+        for (const BundleEntry& entry : m_bundles) {
+            if (entry.path.isEmpty()) continue;
+            out << entry.path << entry.stamp << quint32(entry.terms.size());
+            for (auto it = entry.terms.constBegin(); it != entry.terms.constEnd(); ++it) {
+                out << it.key();
+                for (int f = 0; f < FIELD_COUNT; ++f) {
+                    out << it->count[f];
+                }
+            }
+        }
+    }
+
+    QDir().mkpath(QFileInfo(m_indexFilePath).absolutePath());
+    QSaveFile file(m_indexFilePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "LibraryContentIndex: cannot write" << m_indexFilePath;
+        return;
+    }
+    file.write(qCompress(payload));
+    if (!file.commit()) {
+        qWarning() << "LibraryContentIndex: cannot write" << m_indexFilePath;
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+// ============================================================================
+// LibraryContentIndex - Library-wide full-text index over notebook contents
+// ============================================================================
+// Lets the launcher find notebooks by what is written in them, not only by
+// name: PDF text, handwriting OCR results and markdown notes.
+//
+// Design:
+// - One term table per bundle (case-folded word -> occurrence count per
+//   field), plus an in-memory inverted map term -> bundles for queries
+// - Bundles are harvested on a background thread. A bundle is re-read only
+//   when its stamp (newest mtime of document.json, the page/tile/notes
+//   directories, the OCR sidecars and the note files) changed since it was
+//   last indexed, so a refresh over thousands of notebooks is mostly stat()
+//   calls
+// - Harvesting reads OCR sidecars, note files and the manifest directly, and
+//   PDF text through the manifest's PDF sources; no Document is created and
+//   no page is ever loaded
+// - Persisted as one compressed file in the app cache directory; it can be
+//   deleted at any time and is rebuilt on the next refresh. The file is read
+//   by the first pass, off the GUI thread
+//
+// Thread safety: the public API is for the GUI thread; the index data is
+// shared with the indexing thread under a mutex.
+// ============================================================================
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+
+class LibraryContentIndex : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Where a term occurred. Fields are weighted when ranking.
+     */
+    enum Field {
+        PdfField = 0,   ///< PDF text layer
+        OcrField,       ///< Handwriting OCR results
+        NoteField,      ///< Markdown note titles and bodies
+        FIELD_COUNT
+    };
+
+    /**
+     * @brief One notebook matching a query.
+     */
+    struct Hit {
+        QString bundlePath;
+        double score = 0.0;              ///< Relevance (higher is better)
+        int matches[FIELD_COUNT] = {};   ///< Matching term occurrences per field
+    };
+
+    /**
+     * @brief Create an index persisted at @p indexFilePath.
+     *
+     * The file is read by the first refresh(); until then search() is empty.
+     */
+    explicit LibraryContentIndex(const QString& indexFilePath, QObject* parent = nullptr);
+
+    /// Stops a running pass and waits for it.
+    ~LibraryContentIndex() override;
+
+    /**
+     * @brief Bring the index up to date with @p bundlePaths in the background.
+     *
+     * Changed and new bundles are (re)harvested, bundles not in the list are
+     * dropped. If a pass is already running, another one starts when it ends.
+     */
+    void refresh(const QStringList& bundlePaths);
+
+    /// True while a background pass is running.
+    bool isIndexing() const;
+
+    /// Number of indexed bundles.
+    int bundleCount() const;
+
+    /**
+     * @brief Find notebooks containing every word of @p query.
+     *
+     * The last word also matches as a prefix, so results appear while the
+     * user is still typing it.
+     * @return Hits sorted by descending score, at most @p maxResults.
+     */
+    QList<Hit> search(const QString& query, int maxResults = MAX_RESULTS) const;
+
+    /**
+     * @brief Split text into index terms: case-folded runs of letters and
+     *        digits, with every CJK character a term of its own.
+     *        Single Latin characters are dropped.
+     */
+    static QStringList tokenize(const QString& text);
+
+signals:
+    /// Part of a pass finished; queries may now return more results.
+    void indexUpdated();
+
+private:
+    /// Occurrence counts of one term in one bundle.
+    struct TermCounts {
+        quint32 count[FIELD_COUNT] = {};
+    };
+    using TermTable = QHash<QString, TermCounts>;
+
+    struct BundleEntry {
+        QString path;
+        qint64 stamp = 0;
+        TermTable terms;
+    };
+
+    static constexpr int MAX_RESULTS = 200;
+    static constexpr int MAX_PREFIX_TERMS = 64;       ///< Expansions of a prefix word
+    static constexpr int UPDATE_INTERVAL_MS = 1000;   ///< indexUpdated() throttle
+    static constexpr quint32 FORMAT_VERSION = 1;
+
+    /// Newest mtime (ms) of the files that change when a bundle's text does.
+    static qint64 bundleStamp(const QString& bundlePath);
+
+    /// Read every indexed field of one bundle.
+    static TermTable harvest(const QString& bundlePath, const std::atomic<bool>& cancelled);
+
+    /// Background pass body (indexing thread).
+    void runPass(const QStringList& bundlePaths);
+    void startPass(const QStringList& bundlePaths);
+    void setBundleLocked(BundleEntry entry);
+    void removeBundleLocked(int id);
+    void loadLocked();
+    void save() const;
+
+    QString m_indexFilePath;
+
+    mutable QMutex m_mutex;                          ///< Guards everything below
+    QVector<BundleEntry> m_bundles;                  ///< Bundle id -> entry (empty path = free)
+    QVector<int> m_freeIds;                          ///< Reusable bundle ids
+    QHash<QString, int> m_bundleIds;                 ///< Bundle path -> id
+    QMap<QString, QHash<int, TermCounts>> m_postings; ///< Term -> bundle id -> counts (sorted for prefixes)
+    bool m_loaded = false;                           ///< Index file read (by the first pass)
+
+    std::atomic<bool> m_cancelled{false};            ///< Set to stop the running pass
+
+    // GUI thread only
+    QFutureWatcher<void> m_passWatcher;
+    QStringList m_pendingRefresh;                    ///< GUI thread: paths for the next pass
+    bool m_refreshPending = false;
+};
@@ -0,0 +1,139 @@
+// ============================================================================
+// MarkdownNoteIndex - Implementation
+// ============================================================================
+
+#include "MarkdownNoteIndex.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+// ===== Lookup and Update =====
+
+MarkdownNote MarkdownNoteIndex::note(const QString& notesDir, const QString& noteId)
+{
+    auto it = m_entries.constFind(noteId);
+    if (it != m_entries.constEnd()) {
+        MarkdownNote cached;
+        cached.id = noteId;
+        cached.title = it->title;
+        cached.content = it->content;
+        return cached;
+    }
+
+    // Not indexed yet (first search, or copied in from another notebook)
+    MarkdownNote loaded = MarkdownNote::loadFromFile(notesDir + "/" + noteId + ".md");
+    if (loaded.isValid()) {
+        store(notesDir, loaded);
+    }
+    return loaded;
+}
+
+void MarkdownNoteIndex::update(const QString& notesDir, const MarkdownNote& note)
+{
+    if (!note.isValid()) {
+        return;
+    }
+    // Keep the body as loadFromFile() would return it after a reopen
+    MarkdownNote stored = note;
+    stored.content = note.content.trimmed();
+    store(notesDir, stored);
+}
+
+void MarkdownNoteIndex::remove(const QString& noteId)
+{
+    if (m_entries.remove(noteId) > 0) {
+        m_dirty = true;
+    }
+}
+
+void MarkdownNoteIndex::store(const QString& notesDir, const MarkdownNote& note)
+{
+    const QFileInfo info(notesDir + "/" + note.id + ".md");
+
+    Entry entry;
+    entry.title = note.title;
+    entry.content = note.content;
+    entry.size = info.size();
+    entry.modified = info.lastModified().toMSecsSinceEpoch();
+    m_entries.insert(note.id, entry);
+    m_dirty = true;
+}
+
+// ===== Persistence =====
+
+bool MarkdownNoteIndex::load(const QString& bundlePath, const QString& notesDir)
+{
+    QFile file(bundlePath + "/" + QLatin1String(FILE_NAME));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+
+    if (root.value("version").toInt() != FORMAT_VERSION) {
+        return false;
+    }
+
+    m_entries.clear();
+    m_dirty = false;
+
+    const QJsonObject notes = root.value("notes").toObject();
+    for (auto it = notes.constBegin(); it != notes.constEnd(); ++it) {
+        const QJsonObject obj = it.value().toObject();
+        Entry entry;
+        entry.title = obj.value("title").toString();
+        entry.content = obj.value("content").toString();
+        entry.size = static_cast<qint64>(obj.value("size").toDouble(-1));
+        entry.modified = static_cast<qint64>(obj.value("modified").toDouble());
+
+        // Only trust entries whose file is exactly as it was when indexed
+        const QFileInfo info(notesDir + "/" + it.key() + ".md");
+        if (!info.exists() || info.size() != entry.size
+            || info.lastModified().toMSecsSinceEpoch() != entry.modified) {
+            m_dirty = true;
+            continue;
+        }
+        m_entries.insert(it.key(), entry);
+    }
+
+#ifdef SPEEDYNOTE_DEBUG
+    qDebug() << "MarkdownNoteIndex: loaded" << m_entries.size() << "of" << notes.size()
+             << "notes from" << bundlePath;
+#endif
+    return true;
+}
+
+bool MarkdownNoteIndex::save(const QString& bundlePath)
+{
+    QJsonObject notes;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        QJsonObject obj;
+        obj["title"] = it->title;
+        obj["content"] = it->content;
+        obj["size"] = static_cast<double>(it->size);
+        obj["modified"] = static_cast<double>(it->modified);
+        notes[it.key()] = obj;
+    }
+
+    QJsonObject root;
+    root["version"] = FORMAT_VERSION;
+    root["notes"] = notes;
+
+    QSaveFile file(bundlePath + "/" + QLatin1String(FILE_NAME));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "MarkdownNoteIndex: cannot write index to" << bundlePath;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qWarning() << "MarkdownNoteIndex: cannot write index to" << bundlePath;
+        return false;
+    }
+    m_dirty = false;
+    return true;
+}
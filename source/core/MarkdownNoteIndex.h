@@ -0,0 +1,85 @@
+#pragma once
+
+// ============================================================================
+// MarkdownNoteIndex - Persistent title/body cache for a bundle's markdown notes
+// ============================================================================
+// Lets note search run from memory instead of re-reading every .md file on
+// every query.
+//
+// Design:
+// - One entry per note id: title, body, and the file's size/mtime when the
+//   entry was taken
+// - Filled lazily (a note not in the index is read once, then cached) and
+//   kept current by Document::saveNoteFile() / deleteNoteFile()
+// - Stored in the bundle as notes_index.json; on load, entries whose file
+//   is gone or whose size/mtime changed (e.g. edited outside SpeedyNote)
+//   are dropped and re-read on next use
+//
+// The link side of a search (owning page/tile, description, color) comes
+// from Document's link outline cache, which never loads pages.
+//
+// Thread safety: GUI thread only, like the rest of the notes code.
+// ============================================================================
+
+#include "MarkdownNote.h"
+
+#include <QHash>
+#include <QString>
+
+class MarkdownNoteIndex {
+public:
+    /// File name inside the bundle directory.
+    static constexpr const char* FILE_NAME = "notes_index.json";
+
+    /**
+     * @brief Get a note, reading its file only if it is not indexed yet.
+     * @param notesDir The bundle's assets/notes directory.
+     * @return The note, or an invalid note if its file cannot be read.
+     */
+    MarkdownNote note(const QString& notesDir, const QString& noteId);
+
+    /**
+     * @brief Record a note that was just written to @p notesDir.
+     */
+    void update(const QString& notesDir, const MarkdownNote& note);
+
+    /**
+     * @brief Forget a note (deleted file).
+     */
+    void remove(const QString& noteId);
+
+    /// True when entries changed since the last load()/save().
+    bool isDirty() const { return m_dirty; }
+
+    /// Number of indexed notes.
+    int size() const { return static_cast<int>(m_entries.size()); }
+
+    /**
+     * @brief Load from a bundle directory, dropping entries whose file in
+     *        @p notesDir no longer matches. A missing or unreadable file
+     *        leaves the index empty.
+     */
+    bool load(const QString& bundlePath, const QString& notesDir);
+
+    /**
+     * @brief Write to a bundle directory (atomically, via QSaveFile).
+     */
+    bool save(const QString& bundlePath);
+
+private:
+    /// On-disk format version; bump to discard old files.
+    static constexpr int FORMAT_VERSION = 1;
+
+    struct Entry {
+        QString title;
+        QString content;
+        qint64 size = -1;      ///< File size when indexed
+        qint64 modified = 0;   ///< File mtime (ms since epoch) when indexed
+    };
+
+    /// Store @p note with the current size/mtime of its file.
+    void store(const QString& notesDir, const MarkdownNote& note);
+
+    QHash<QString, Entry> m_entries;   ///< Note id -> entry
+    bool m_dirty = false;
+};
@@ -1,4 +1,5 @@
 #include "NotebookLibrary.h"
+#include "LibraryContentIndex.h"
 
 #include <QStandardPaths>
 #include <QDir>
@@ -21,6 +22,7 @@ NotebookLibrary::NotebookLibrary(QObject* parent)
     
     m_libraryFilePath = dataPath + "/notebook_library.json";
     m_thumbnailCachePath = cachePath + "/thumbnails";
+    m_contentIndexPath = cachePath + "/library_index.bin";
     
     // Ensure directories exist
     QDir().mkpath(dataPath);
@@ -538,6 +540,41 @@ QStringList NotebookLibrary::searchStarredFolders(const QString& query) const
     return results;
 }
 
+QList<NotebookInfo> NotebookLibrary::searchContent(const QString& query) const
+{
+    if (query.isEmpty() || !m_contentIndex) {
+        return {};
+    }
+    
+    QList<NotebookInfo> results;
+    const QList<LibraryContentIndex::Hit> hits = m_contentIndex->search(query);
+    for (const LibraryContentIndex::Hit& hit : hits) {
+        // The index may still hold a notebook removed since its last pass
+        if (const NotebookInfo* nb = findNotebook(hit.bundlePath)) {
+            results.append(*nb);
+        }
+    }
+    return results;
+}
+
+LibraryContentIndex* NotebookLibrary::contentIndex()
+{
+    if (!m_contentIndex) {
+        m_contentIndex = new LibraryContentIndex(m_contentIndexPath, this);
+    }
+    return m_contentIndex;
+}
+
+void NotebookLibrary::refreshContentIndex()
+{
+    QStringList paths;
+    paths.reserve(m_notebooks.size());
+    for (const NotebookInfo& nb : m_notebooks) {
+        paths.append(nb.bundlePath);
+    }
+    contentIndex()->refresh(paths);
+}
+
 // === Thumbnails ===
 
 QString NotebookLibrary::thumbnailPathFor(const QString& bundlePath) const
@@ -9,6 +9,8 @@
 #include <QPixmap>
 #include <QTimer>
 
+class LibraryContentIndex;
+
 /**
  * @brief Metadata for a notebook stored in the library.
  * 
@@ -67,7 +69,7 @@ Q_DECLARE_METATYPE(NotebookInfo)
  * NotebookLibrary is a singleton that:
  * - Tracks recently opened notebooks
  * - Manages starred notebooks and folders
- * - Provides search functionality
+ * - Provides search functionality (names, and contents via LibraryContentIndex)
  * - Manages thumbnail cache on disk
  * 
  * Data is persisted to a JSON file in the app's data directory.
@@ -250,6 +252,28 @@ public:
      */
     QStringList searchStarredFolders(const QString& query) const;
     
+    /**
+     * @brief Search notebooks by their contents (PDF text, OCR, notes).
+     * @param query Search query string.
+     * @return Matching notebooks sorted by relevance.
+     * 
+     * Answered from the library content index, which may still be filling
+     * in: call refreshContentIndex() first and re-query on its
+     * indexUpdated() signal.
+     */
+    QList<NotebookInfo> searchContent(const QString& query) const;
+    
+    /**
+     * @brief Get the library-wide content index (created on first use).
+     */
+    LibraryContentIndex* contentIndex();
+    
+    /**
+     * @brief Re-index notebooks that changed since the last pass, in the
+     *        background.
+     */
+    void refreshContentIndex();
+    
     // === Thumbnails ===
     
     /**
@@ -323,6 +347,8 @@ private:
     
     QString m_libraryFilePath;        ///< Path to the library JSON file
     QString m_thumbnailCachePath;     ///< Path to the thumbnail cache directory
+    QString m_contentIndexPath;       ///< Path to the library content index file
+    LibraryContentIndex* m_contentIndex = nullptr;  ///< Created by contentIndex()
     QList<NotebookInfo> m_notebooks;  ///< All tracked notebooks
     QStringList m_starredFolderOrder; ///< Ordered list of starred folder names
     QStringList m_recentFolders;      ///< Recently used folders (L-008), max 5
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "NotebookLibrary.h"
+#include "LibraryContentIndex.h"
+#include "MarkdownNote.h"
 
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
@@ -11,6 +14,7 @@
 #include <QJsonObject>
 #include <QStandardPaths>
 #include <QTemporaryDir>
+#include <QThread>
 
 namespace NotebookLibraryTests {
 
@@ -247,6 +251,95 @@ inline bool testBundlePathMigration()
     return success;
 }
 
+inline bool testContentIndex()
+{
+    qDebug() << "=== Test: Library content index ===";
+
+    QTemporaryDir tempDir;
+    if (!check(tempDir.isValid(), "temporary directory is available")) {
+        return false;
+    }
+
+    const QString bundlePath = tempDir.path() + "/Content.snb";
+    QDir().mkpath(bundlePath + "/pages");
+    QDir().mkpath(bundlePath + "/assets/notes");
+    bool success = check(writeManifest(bundlePath, "Content", "content-id"),
+                         "manifest is written");
+
+    QJsonObject block;
+    block["text"] = "Handwritten Photosynthesis notes";
+    QJsonObject ocr;
+    ocr["blocks"] = QJsonArray{block};
+    QFile ocrFile(bundlePath + "/pages/page-1.ocr.json");
+    success &= check(ocrFile.open(QIODevice::WriteOnly), "OCR sidecar is written");
+    ocrFile.write(QJsonDocument(ocr).toJson());
+    ocrFile.close();
+
+    MarkdownNote note;
+    note.id = "note-1";
+    note.title = "Chlorophyll";
+    note.content = "Light reactions";
+    success &= check(note.saveToFile(bundlePath + "/assets/notes/note-1.md"),
+                     "note is written");
+
+    auto runPass = [](LibraryContentIndex& index, const QStringList& paths) {
+        index.refresh(paths);
+        while (index.isIndexing()) {
+            QCoreApplication::processEvents();
+            QThread::msleep(5);
+        }
+    };
+
+    const QString indexPath = tempDir.path() + "/library_index.bin";
+    {
+        LibraryContentIndex index(indexPath);
+        runPass(index, {bundlePath});
+
+        success &= check(LibraryContentIndex::tokenize("Ab, cd-EF x") ==
+                             QStringList({"ab", "cd", "ef"}),
+                         "tokenizer folds case and drops single letters");
+        const auto hits = index.search("photosynthesis");
+        success &= check(hits.size() == 1 && hits.first().bundlePath == bundlePath &&
+                             hits.first().matches[LibraryContentIndex::OcrField] == 1,
+                         "OCR text is found");
+        success &= check(index.search("light reac").size() == 1,
+                         "note body is found, last word as a prefix");
+        success &= check(index.search("light photosynthesis chlorophyll").size() == 1,
+                         "words from different fields all match");
+        success &= check(index.search("light nonexistent").isEmpty(),
+                         "every word must match");
+
+        // OCR finishing rewrites only the sidecar: no bundle save, and the
+        // pages directory keeps its mtime
+        block["text"] = "Respiration";
+        ocr["blocks"] = QJsonArray{block};
+        success &= check(ocrFile.open(QIODevice::WriteOnly), "OCR sidecar is rewritten");
+        ocrFile.write(QJsonDocument(ocr).toJson());
+        ocrFile.setFileTime(QDateTime::currentDateTime().addSecs(60),
+                            QFileDevice::FileModificationTime);
+        ocrFile.close();
+        runPass(index, {bundlePath});
+        success &= check(index.search("respiration").size() == 1 &&
+                             index.search("photosynthesis").isEmpty(),
+                         "a rewritten OCR sidecar is re-indexed");
+    }
+
+    {
+        // Reloaded from disk; an unknown bundle list drops the entry
+        LibraryContentIndex index(indexPath);
+        runPass(index, {bundlePath});
+        success &= check(index.bundleCount() == 1 && index.search("chlorophyll").size() == 1,
+                         "index is reloaded from disk");
+        runPass(index, {});
+        success &= check(index.bundleCount() == 0, "removed notebooks are dropped");
+    }
+
+    if (success) {
+        qDebug() << "PASS: Library content index";
+    }
+    return success;
+}
+
 inline bool runAllTests()
 {
     qDebug() << "\n========================================";
@@ -263,7 +356,8 @@ inline bool runAllTests()
     QDir(dataPath).removeRecursively();
     QDir(cachePath).removeRecursively();
 
-    const bool success = testBundlePathMigration();
+    bool success = testBundlePathMigration();
+    success &= testContentIndex();
 
     QDir(dataPath).removeRecursively();
     QDir(cachePath).removeRecursively();
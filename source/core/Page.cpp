@@ -312,6 +312,8 @@ void Page::releaseLayerCaches()
             // the foreseeable future, so the focus cache (max ~viewport*4
             // bytes per layer) is dead weight.
             layer->releaseFocusCache();
+            // Cached stroke outlines are cheap to rebuild from the points.
+            layer->releaseOutlineCache();
         }
     }
 }
@@ -321,7 +323,8 @@ bool Page::hasLayerCachesAllocated() const
     for (const auto& layer : vectorLayers) {
         if (layer &&
             (layer->hasStrokeCacheAllocated() ||
-             layer->hasFocusCacheAllocated())) {
+             layer->hasFocusCacheAllocated() ||
+             layer->outlineCacheBytes() > 0)) {
             return true;
         }
     }
@@ -702,7 +705,7 @@ void Page::renderObjectsWithAffinity(QPainter& painter, qreal zoom, int affinity
 
 // ===== Serialization =====
 
-QJsonObject Page::toJson() const
+QJsonObject Page::toJson(bool includeStrokes) const
 {
     QJsonObject obj;
     
@@ -737,7 +740,7 @@ QJsonObject Page::toJson() const
     // Layers
     QJsonArray layersArray;
     for (const auto& layer : vectorLayers) {
-        layersArray.append(layer->toJson());
+        layersArray.append(layer->toJson(includeStrokes));
     }
     obj["layers"] = layersArray;
     
@@ -431,9 +431,11 @@ public:
     
     /**
      * @brief Serialize page to JSON.
+     * @param includeStrokes If false, layers are written without their
+     *        "strokes" arrays (the bundle stores them in a binary sidecar).
      * @return JSON object containing all page data.
      */
-    QJsonObject toJson() const;
+    QJsonObject toJson(bool includeStrokes = true) const;
     
     /**
      * @brief Deserialize page from JSON.
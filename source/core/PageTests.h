@@ -14,10 +14,16 @@
 
 #include "Page.h"
 #include "../objects/ImageObject.h"
+#include "../objects/ImageMipCache.h"
+#include "../pdf/PdfSearchIndex.h"
+#include "../pdf/PdfProvider.h"
+#include "../pdf/PdfProviderCache.h"
 #include <QDebug>
 #include <QDir>
 #include <QFile>
 #include <QJsonDocument>
+#include <QTemporaryDir>
+#include <algorithm>
 #include <cassert>
 
 namespace PageTests {
@@ -320,6 +326,700 @@ inline bool testObjectManagement()
     return success;
 }
 
+/**
+ * @brief Test the structure-of-arrays point store behind VectorStroke.
+ */
+inline bool testStrokePointStore()
+{
+    qDebug() << "=== Test: Stroke Point Store ===";
+    
+    bool success = true;
+    
+    VectorStroke stroke;
+    stroke.baseThickness = 2.0;
+    stroke.points.append({QPointF(0, 0), 0.5});           // No timestamp
+    stroke.points.append({QPointF(10, 0), 0.75, 5000});
+    stroke.points.append({QPointF(20, 10), 1.0, 5016});
+    stroke.updateBoundingBox();
+    
+    if (stroke.points.size() != 3 || !stroke.points.hasTimestamps()) {
+        qDebug() << "FAIL: point count or timestamp flag wrong";
+        success = false;
+    }
+    if (stroke.points[0].timestamp != 0 || stroke.points[2].timestamp != 5016) {
+        qDebug() << "FAIL: timestamps not preserved:"
+                 << stroke.points[0].timestamp << stroke.points[2].timestamp;
+        success = false;
+    }
+    if (!qFuzzyCompare(stroke.points.last().pressure, 1.0) ||
+        stroke.points[1].pos != QPointF(10, 0)) {
+        qDebug() << "FAIL: point values not preserved";
+        success = false;
+    }
+    
+    // Hit testing streams the coordinate arrays
+    if (!stroke.containsPoint(QPointF(5, 1), 0.5) || stroke.containsPoint(QPointF(5, 8), 0.5)) {
+        qDebug() << "FAIL: containsPoint wrong";
+        success = false;
+    }
+    
+    stroke.points.translate(QPointF(100, 50));
+    stroke.points.setPressure(0, 0.25);
+    stroke.updateBoundingBox();
+    if (stroke.points.pos(0) != QPointF(100, 50) || !qFuzzyCompare(stroke.points.pressure(0), 0.25)) {
+        qDebug() << "FAIL: translate/setPressure wrong";
+        success = false;
+    }
+    if (stroke.boundingBox != QRectF(96, 46, 28, 18)) {
+        qDebug() << "FAIL: bounding box wrong:" << stroke.boundingBox;
+        success = false;
+    }
+    
+    // JSON round trip goes through the same store
+    VectorStroke restored = VectorStroke::fromJson(stroke.toJson());
+    if (restored.points.size() != 3 || restored.points[1].timestamp != 5000) {
+        qDebug() << "FAIL: JSON round trip lost points/timestamps";
+        success = false;
+    }
+    
+    if (success) {
+        qDebug() << "PASS: Stroke point store tests successful!";
+    }
+    
+    return success;
+}
+
+/**
+ * @brief Test the layer's spatial index stays in sync through add/remove.
+ */
+inline bool testStrokeSpatialIndex()
+{
+    qDebug() << "=== Test: Stroke Spatial Index ===";
+    
+    bool success = true;
+    VectorLayer layer;
+    
+    // A 20x20 grid of short strokes, 40px apart, plus one long ruler line
+    for (int gy = 0; gy < 20; ++gy) {
+        for (int gx = 0; gx < 20; ++gx) {
+            VectorStroke s;
+            s.id = QString("s%1_%2").arg(gx).arg(gy);
+            s.baseThickness = 2.0;
+            s.points.append({QPointF(gx * 40.0, gy * 40.0), 1.0});
+            s.points.append({QPointF(gx * 40.0 + 10, gy * 40.0), 1.0});
+            s.updateBoundingBox();
+            layer.addStroke(s);
+        }
+    }
+    VectorStroke ruler;
+    ruler.id = "ruler";
+    ruler.points.append({QPointF(-5000, 5), 1.0});
+    ruler.points.append({QPointF(5000, 5), 1.0});
+    ruler.updateBoundingBox();
+    layer.addStroke(ruler);
+    
+    QVector<QString> hits = layer.strokesAtPoint(QPointF(205, 200), 1.0);
+    if (hits.size() != 1 || hits[0] != "s5_5") {
+        qDebug() << "FAIL: expected only s5_5 at (205,200), got" << hits;
+        success = false;
+    }
+    
+    // Remove a few strokes, then make sure indices still line up
+    layer.removeStroke("s0_0");
+    layer.removeStroke("s5_5");
+    layer.removeStroke("s19_19");
+    if (!layer.strokesAtPoint(QPointF(205, 200), 1.0).isEmpty()) {
+        qDebug() << "FAIL: removed stroke still hit";
+        success = false;
+    }
+    const VectorStroke* s = layer.strokeById("s6_5");
+    if (!s || s->id != "s6_5" || layer.indexOfStroke("s6_5") != 5 * 20 + 6 - 2) {
+        qDebug() << "FAIL: id lookup wrong after removals";
+        success = false;
+    }
+    hits = layer.strokesAtPoint(QPointF(3000, 5), 1.0);
+    if (hits.size() != 1 || hits[0] != "ruler") {
+        qDebug() << "FAIL: oversized stroke not found:" << hits;
+        success = false;
+    }
+    
+    // Rect query matches a brute-force scan, in paint order
+    const QRectF rect(90, 90, 100, 60);
+    QVector<int> expected;
+    for (int i = 0; i < layer.strokes().size(); ++i) {
+        if (layer.strokes()[i].boundingBox.intersects(rect)) expected.append(i);
+    }
+    if (layer.strokeIndicesIntersecting(rect) != expected) {
+        qDebug() << "FAIL: rect query differs from linear scan";
+        success = false;
+    }
+    
+    if (success) {
+        qDebug() << "PASS: Stroke spatial index tests successful!";
+    }
+    
+    return success;
+}
+
+/**
+ * @brief Test VectorLayer's per-stroke outline cache.
+ */
+inline bool testStrokeOutlineCache()
+{
+    qDebug() << "=== Test: Stroke Outline Cache ===";
+    
+    bool success = true;
+    VectorLayer layer;
+    VectorStroke stroke;
+    stroke.id = "wave";
+    stroke.baseThickness = 3.0;
+    for (int i = 0; i < 40; ++i) {
+        stroke.points.append({QPointF(i * 5.0, qSin(i * 0.3) * 20.0), 0.5 + i / 80.0});
+    }
+    stroke.updateBoundingBox();
+    layer.addStroke(stroke);
+    
+    // A hit hands back the cached (implicitly shared) polygon
+    const VectorStroke& stored = layer.strokes().first();
+    const QPolygonF first = layer.outlineFor(stored).polygon;
+    const QPolygonF second = layer.outlineFor(stored).polygon;
+    if (first.constData() != second.constData() ||
+        first != VectorLayer::buildStrokePolygon(stored).polygon) {
+        qDebug() << "FAIL: outline not served from cache";
+        success = false;
+    }
+    
+    // Moving the stroke's points must not serve the stale outline
+    layer.strokes().first().points.translate(QPointF(100, 0));
+    const QPolygonF moved = layer.outlineFor(layer.strokes().first()).polygon;
+    if (moved.isEmpty() || qAbs(moved.first().x() - (first.first().x() + 100)) > 1e-3) {
+        qDebug() << "FAIL: stale outline after translate";
+        success = false;
+    }
+    
+    layer.removeStroke("wave");
+    if (layer.outlineCacheBytes() != 0) {
+        qDebug() << "FAIL: removed stroke still accounted:" << layer.outlineCacheBytes();
+        success = false;
+    }
+    
+    // Stay within the budget on a layer far larger than it
+    for (int i = 0; i < 20000; ++i) {
+        VectorStroke s = stroke;
+        s.id = QString::number(i);
+        layer.addStroke(s);
+    }
+    for (const VectorStroke& s : layer.strokes()) {
+        layer.outlineFor(s);
+    }
+    if (layer.outlineCacheBytes() > VectorLayer::OUTLINE_CACHE_BUDGET) {
+        qDebug() << "FAIL: outline cache over budget:" << layer.outlineCacheBytes();
+        success = false;
+    }
+    
+    if (success) {
+        qDebug() << "PASS: Stroke outline cache tests successful!";
+    }
+    
+    return success;
+}
+
+/**
+ * @brief Test that the tiled, multi-threaded cache rasterizer matches a
+ *        single-threaded render of the same strokes.
+ */
+inline bool testStrokeCacheRasterizer()
+{
+    qDebug() << "=== Test: Stroke Cache Rasterizer ===";
+    
+    bool success = true;
+    QVector<VectorStroke> strokes;
+    for (int s = 0; s < 60; ++s) {
+        VectorStroke stroke;
+        stroke.color = (s % 3 == 0) ? QColor(200, 30, 30, 120) : QColor(20, 20, 80);
+        stroke.baseThickness = 1.0 + (s % 6);
+        for (int i = 0; i < 30; ++i) {
+            // Long diagonal strokes so most of them cross tile boundaries
+            stroke.points.append({QPointF(s * 13.0 + i * 20.0, i * 25.0 + qSin(i + s) * 15.0),
+                                  0.4 + 0.02 * i});
+        }
+        stroke.updateBoundingBox();
+        strokes.append(stroke);
+    }
+    
+    const qreal scale = 1.7;
+    const QSize size(1400, 1300);  // Several partial edge tiles
+    
+    QImage expected(size, QImage::Format_ARGB32_Premultiplied);
+    expected.fill(Qt::transparent);
+    {
+        QPainter p(&expected);
+        p.setRenderHint(QPainter::Antialiasing, true);
+        p.scale(scale, scale);
+        for (const VectorStroke& stroke : strokes) {
+            VectorLayer::renderStroke(p, stroke);
+        }
+    }
+    
+    const QImage tiled = StrokeCacheRasterizer::render(strokes, size, scale);
+    if (tiled.size() != size) {
+        qDebug() << "FAIL: wrong image size" << tiled.size();
+        return false;
+    }
+    
+    // Antialiasing at tile seams may round differently; allow small noise.
+    int worst = 0;
+    for (int y = 0; y < size.height(); ++y) {
+        const QRgb* a = reinterpret_cast<const QRgb*>(expected.constScanLine(y));
+        const QRgb* b = reinterpret_cast<const QRgb*>(tiled.constScanLine(y));
+        for (int x = 0; x < size.width(); ++x) {
+            worst = qMax(worst, qAbs(qAlpha(a[x]) - qAlpha(b[x])));
+            worst = qMax(worst, qAbs(qRed(a[x]) - qRed(b[x])));
+        }
+    }
+    if (worst > 8) {
+        qDebug() << "FAIL: tiled render differs by up to" << worst;
+        success = false;
+    }
+    
+    if (success) {
+        qDebug() << "PASS: Stroke cache rasterizer tests successful!";
+    }
+    
+    return success;
+}
+
+/**
+ * @brief Test the translucent stroke scratch buffer: capped, budgeted, and
+ *        not kept by the rasterizer's pool threads.
+ */
+inline bool testTranslucentScratch()
+{
+    qDebug() << "=== Test: Translucent Stroke Scratch ===";
+    
+    bool success = true;
+    VectorStroke stroke;
+    stroke.color = QColor(255, 220, 0, 100);
+    stroke.baseThickness = 12.0;
+    for (int i = 0; i < 20; ++i) {
+        stroke.points.append({QPointF(i * 40.0, 200 + qSin(i * 0.5) * 80.0), 0.8});
+    }
+    stroke.updateBoundingBox();
+    
+    // Oversized requests get no shared buffer
+    if (TranslucentScratch::acquire(TranslucentScratch::MAX_DIM + 1, 10)) {
+        qDebug() << "FAIL: scratch grew past MAX_DIM";
+        success = false;
+    }
+    
+    // GUI thread: kept between strokes and reported to the budget
+    TranslucentScratch::release();
+    QImage target(900, 400, QImage::Format_ARGB32_Premultiplied);
+    target.fill(Qt::white);
+    {
+        QPainter p(&target);
+        VectorLayer::renderStroke(p, stroke);
+    }
+    QVector<CacheBudget::Item> items;
+    TranslucentScratch::instance()->collectCacheItems(items);
+    if (TranslucentScratch::threadBytes() == 0 || items.size() != 1
+        || items.first().bytes != TranslucentScratch::threadBytes()) {
+        qDebug() << "FAIL: GUI thread scratch not reported to the budget";
+        success = false;
+    }
+    TranslucentScratch::instance()->evictCacheItems({items.isEmpty() ? 0 : items.first().key});
+    if (TranslucentScratch::threadBytes() != 0) {
+        qDebug() << "FAIL: budget eviction did not free the scratch";
+        success = false;
+    }
+    
+    // Rasterizer workers release theirs after each tile
+    StrokeCacheRasterizer::render({stroke}, QSize(1600, 900), 2.0);
+    if (TranslucentScratch::totalBytes() != TranslucentScratch::threadBytes()) {
+        qDebug() << "FAIL: pool threads kept" << TranslucentScratch::totalBytes()
+                 << "bytes of scratch";
+        success = false;
+    }
+    
+    if (success) {
+        qDebug() << "PASS: Translucent stroke scratch tests successful!";
+    }
+    
+    return success;
+}
+
+/**
+ * @brief Test that CacheBudget merges items several clients share: counted
+ *        once, protected by the most recent use, evicted from every client.
+ */
+inline bool testCacheBudgetSharedItems()
+{
+    qDebug() << "=== Test: Cache Budget Shared Items ===";
+    
+    bool success = true;
+    
+    struct FakeClient : CacheBudget::Client {
+        QVector<CacheBudget::Item> reported;
+        QVector<quint64> evicted;
+        QString cacheName() const override { return QStringLiteral("test"); }
+        void collectCacheItems(QVector<CacheBudget::Item>& items) const override {
+            items += reported;
+        }
+        void evictCacheItems(const QVector<quint64>& keys) override { evicted += keys; }
+    };
+    auto item = [](quint64 key, qint64 sharedKey, qint64 mb, qint64 lastUse) {
+        CacheBudget::Item it;
+        it.key = key;
+        it.sharedKey = sharedKey;
+        it.bytes = mb << 20;
+        it.lastUse = lastUse;
+        return it;
+    };
+    
+    CacheBudget* budget = CacheBudget::instance();
+    const qint64 savedCeiling = budget->ceilingBytes();
+    const qint64 ceiling = qint64(CacheBudget::MIN_CEILING_MB) << 20;
+    const qint64 idle = CacheBudget::nowMs() - 100000;
+    const qint64 recent = CacheBudget::nowMs() + 100000;  // Still recent when enforce() runs
+    
+    FakeClient a;
+    FakeClient b;
+    budget->addClient(&a);
+    budget->addClient(&b);
+    budget->setCeilingBytes(ceiling);
+    
+    // One page seen by both views: idle in A, just drawn in B
+    const qint64 shared = 4242;
+    a.reported = {item(1, shared, CacheBudget::MIN_CEILING_MB, idle),
+                  item(2, 0, CacheBudget::MIN_CEILING_MB, idle)};
+    b.reported = {item(7, shared, CacheBudget::MIN_CEILING_MB, recent)};
+    a.evicted.clear();
+    b.evicted.clear();
+    budget->enforce();
+    if (a.evicted != QVector<quint64>({2}) || !b.evicted.isEmpty()) {
+        qDebug() << "FAIL: shared item lost the protection of its recent use"
+                 << a.evicted << b.evicted;
+        success = false;
+    }
+    
+    // Idle everywhere: evicted from both views, or nothing would be freed
+    a.reported = {item(1, shared, CacheBudget::MIN_CEILING_MB, idle)};
+    b.reported = {item(7, shared, CacheBudget::MIN_CEILING_MB, idle),
+                  item(8, 0, CacheBudget::MIN_CEILING_MB, recent)};
+    a.evicted.clear();
+    b.evicted.clear();
+    budget->enforce();
+    if (a.evicted != QVector<quint64>({1}) || b.evicted != QVector<quint64>({7})) {
+        qDebug() << "FAIL: shared item not evicted from every client"
+                 << a.evicted << b.evicted;
+        success = false;
+    }
+    
+    budget->removeClient(&a);
+    budget->removeClient(&b);
+    budget->setCeilingBytes(savedCeiling);
+    
+    // Outline caches are budget items too, keyed apart from pixmaps
+    VectorLayer first;
+    VectorLayer second;
+    if (first.outlineCacheKey() >= 0 || first.outlineCacheKey() == second.outlineCacheKey()) {
+        qDebug() << "FAIL: outline cache keys are not unique negative keys";
+        success = false;
+    }
+    
+    if (success) {
+        qDebug() << "PASS: Cache budget shared item tests successful!";
+    }
+    
+    return success;
+}
+
+/**
+ * @brief Test the persistent trigram search index: pruning, invalidation
+ *        and the save/load round-trip.
+ */
+inline bool testPdfSearchIndex()
+{
+    qDebug() << "=== Test: PDF Search Index ===";
+    
+    bool success = true;
+    
+    // Case and whitespace must not matter; short queries are never pruned
+    if (PdfSearchIndex::trigrams("Hello World") != PdfSearchIndex::trigrams("hellowor  LD")) {
+        qDebug() << "FAIL: trigrams depend on case or whitespace";
+        success = false;
+    }
+    if (!PdfSearchIndex::trigrams("a b").isEmpty()) {
+        qDebug() << "FAIL: short text should have no trigrams";
+        success = false;
+    }
+    
+    PdfSearchIndex index;
+    const QString pdfKey = PdfSearchIndex::pdfKey(QString(), 3);
+    const QString pageKey = PdfSearchIndex::pageKey("uuid-1");
+    index.setText(pdfKey, "The quick brown fox");
+    index.setText(pageKey, "handwritten notes");
+    index.syncSourceHashes({{QString(), "hash-a"}});
+    
+    using Lookup = PdfSearchIndex::Lookup;
+    if (index.lookup(pdfKey, PdfSearchIndex::trigrams("QUICK brown")) != Lookup::Possible
+        || index.lookup(pdfKey, PdfSearchIndex::trigrams("notes")) != Lookup::Absent
+        || index.lookup(pageKey, PdfSearchIndex::trigrams("notes")) != Lookup::Possible
+        || index.lookup("page:other", PdfSearchIndex::trigrams("notes")) != Lookup::Unknown) {
+        qDebug() << "FAIL: wrong lookup result";
+        success = false;
+    }
+    
+    // Save/load round-trip
+    QDir tempDir(QDir::temp().filePath("speedynote_test_search_index"));
+    tempDir.mkpath(".");
+    if (!index.save(tempDir.path())) {
+        qDebug() << "FAIL: could not save index";
+        success = false;
+    }
+    PdfSearchIndex loaded;
+    if (!loaded.load(tempDir.path()) || loaded.entryCount() != 2
+        || loaded.isDirty()
+        || loaded.lookup(pdfKey, PdfSearchIndex::trigrams("brown fox")) != Lookup::Possible
+        || loaded.lookup(pageKey, PdfSearchIndex::trigrams("fox")) != Lookup::Absent) {
+        qDebug() << "FAIL: index did not survive save/load";
+        success = false;
+    }
+    tempDir.removeRecursively();
+    
+    // A changed PDF drops its entries but keeps the page's own text
+    loaded.syncSourceHashes({{QString(), "hash-b"}});
+    if (loaded.lookup(pdfKey, PdfSearchIndex::trigrams("fox")) != Lookup::Unknown
+        || loaded.lookup(pageKey, PdfSearchIndex::trigrams("notes")) != Lookup::Possible) {
+        qDebug() << "FAIL: source hash change not handled";
+        success = false;
+    }
+    
+    loaded.remove(pageKey);
+    if (loaded.lookup(pageKey, PdfSearchIndex::trigrams("notes")) != Lookup::Unknown
+        || loaded.entryCount() != 0) {
+        qDebug() << "FAIL: remove() left the entry behind";
+        success = false;
+    }
+    
+    if (success) {
+        qDebug() << "PASS: PDF search index tests successful!";
+    }
+    
+    return success;
+}
+
+/**
+ * @brief Write a small valid PDF whose pages each fill a few rectangles.
+ */
+inline QByteArray minimalPdf(int pageCount)
+{
+    QByteArray pdf = "%PDF-1.4\n";
+    QVector<int> offsets;
+    auto addObject = [&](const QByteArray& body) {
+        offsets.append(pdf.size());
+        pdf += QByteArray::number(offsets.size()) + " 0 obj\n" + body + "\nendobj\n";
+    };
+    
+    QByteArray kids;
+    for (int i = 0; i < pageCount; ++i) {
+        kids += QByteArray::number(3 + 2 * i) + " 0 R ";
+    }
+    addObject("<< /Type /Catalog /Pages 2 0 R >>");
+    addObject("<< /Type /Pages /Kids [" + kids + "] /Count "
+              + QByteArray::number(pageCount) + " >>");
+    for (int i = 0; i < pageCount; ++i) {
+        QByteArray content;
+        for (int r = 0; r < 50; ++r) {
+            content += QByteArray::number((r * 37 + i * 11) % 255 / 255.0, 'f', 2) + " 0 0.5 rg "
+                     + QByteArray::number(20 + r * 10) + " " + QByteArray::number(40 + r * 12)
+                     + " 60 40 re f\n";
+        }
+        addObject("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] /Contents "
+                  + QByteArray::number(4 + 2 * i) + " 0 R >>");
+        addObject("<< /Length " + QByteArray::number(content.size()) + " >>\nstream\n"
+                  + content + "endstream");
+    }
+    
+    const int xref = pdf.size();
+    pdf += "xref\n0 " + QByteArray::number(offsets.size() + 1) + "\n0000000000 65535 f \n";
+    for (int offset : offsets) {
+        pdf += QByteArray::number(offset).rightJustified(10, '0') + " 00000 n \n";
+    }
+    pdf += "trailer\n<< /Size " + QByteArray::number(offsets.size() + 1)
+         + " /Root 1 0 R >>\nstartxref\n" + QByteArray::number(xref) + "\n%%EOF\n";
+    return pdf;
+}
+
+/**
+ * @brief Test that PDF display lists are measured in bytes and that the
+ *        memory budget, not rendering, drops them and trims the store.
+ */
+inline bool testPdfDisplayListCache()
+{
+    qDebug() << "=== Test: PDF Display List Cache ===";
+    
+    bool success = true;
+    
+    QTemporaryDir tempDir;
+    const QString path = tempDir.filePath("lists.pdf");
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(minimalPdf(3)) < 0) {
+        qDebug() << "FAIL: could not write the test PDF";
+        return false;
+    }
+    file.close();
+    
+    std::shared_ptr<PdfProvider> provider = PdfProvider::shared(path);
+    if (!provider || provider->pageCount() != 3) {
+        qDebug() << "FAIL: test PDF did not open";
+        return false;
+    }
+    
+    auto listPages = [&]() {
+        QVector<PdfProvider::DisplayListUsage> lists;
+        provider->collectDisplayLists(lists);
+        QVector<int> pages;
+        for (const PdfProvider::DisplayListUsage& list : lists) {
+            if (list.bytes <= 0 || list.lastUse <= 0) {
+                qDebug() << "FAIL: display list of page" << list.pageIndex
+                         << "has no size or use time";
+                success = false;
+            }
+            pages.append(list.pageIndex);
+        }
+        std::sort(pages.begin(), pages.end());
+        return pages;
+    };
+    
+    // Rendering records a list per page, and a second render reuses it
+    provider->renderPageToImage(0, 72.0);
+    provider->renderPageToImage(1, 72.0);
+    provider->renderPageToImage(0, 144.0);
+    if (listPages() != QVector<int>({0, 1})) {
+        qDebug() << "FAIL: expected display lists for pages 0 and 1, got" << listPages();
+        success = false;
+    }
+    
+    // Rendering never trims; the budget's store trim keeps the lists
+    provider->trimStore();
+    if (provider->storeBytes() != 0) {
+        qDebug() << "FAIL: store still reports" << provider->storeBytes() << "bytes after a trim";
+        success = false;
+    }
+    if (listPages() != QVector<int>({0, 1})) {
+        qDebug() << "FAIL: trimming the store dropped display lists";
+        success = false;
+    }
+    
+    // Every list is a budget item; evicting one drops only that list
+    QVector<CacheBudget::Item> items;
+    PdfProviderCache::instance()->collectCacheItems(items);
+    QVector<quint64> listKeys;
+    qint64 listBytes = 0;
+    for (const CacheBudget::Item& item : items) {
+        if (item.rebuildCost == CacheBudget::COST_DISPLAY_LIST) {
+            listKeys.append(item.key);
+            listBytes += item.bytes;
+        }
+    }
+    if (listKeys.size() < 2 || listBytes <= 0) {
+        qDebug() << "FAIL: display lists not reported to the budget";
+        success = false;
+    }
+    PdfProviderCache::instance()->evictCacheItems(listKeys);
+    if (!listPages().isEmpty()) {
+        qDebug() << "FAIL: budget eviction left display lists" << listPages();
+        success = false;
+    }
+    
+    // The local cap is in bytes, so the last page always fits
+    provider->renderPageToImage(2, 72.0);
+    if (listPages() != QVector<int>({2})) {
+        qDebug() << "FAIL: page 2 was not cached after eviction";
+        success = false;
+    }
+    
+    if (success) {
+        qDebug() << "PASS: PDF display list cache tests successful!";
+    }
+    
+    return success;
+}
+
+/**
+ * @brief Test image mip level selection and lazy, downsampled decoding.
+ */
+inline bool testImageMipLevels()
+{
+    qDebug() << "=== Test: Image Mip Levels ===";
+    
+    bool success = true;
+    const QSize photo(4000, 3000);
+    
+    // Full resolution only when the screen needs it
+    if (ImageMipCache::levelFor(photo, QSizeF(4000, 3000)) != 0
+        || ImageMipCache::levelFor(photo, QSizeF(2100, 1500)) != 0) {
+        qDebug() << "FAIL: zoomed-in render does not use full resolution";
+        success = false;
+    }
+    if (ImageMipCache::levelFor(photo, QSizeF(1000, 750)) != 2
+        || ImageMipCache::levelSize(photo, 2) != QSize(1000, 750)) {
+        qDebug() << "FAIL: wrong level for a quarter-size render";
+        success = false;
+    }
+    // Thumbnails stop at the coarsest level, never below MIN_LEVEL_EDGE
+    const int coarsest = ImageMipCache::levelFor(photo, QSizeF(10, 8));
+    if (coarsest != ImageMipCache::levelCount(photo) - 1
+        || ImageMipCache::levelSize(photo, coarsest).height() < 64) {
+        qDebug() << "FAIL: wrong coarsest level" << coarsest;
+        success = false;
+    }
+    
+    // A file-backed image keeps its bytes and decodes on demand
+    const QString basePath = QDir::temp().filePath("speedynote_test_mip_bundle");
+    QDir(basePath).removeRecursively();
+    QDir().mkpath(basePath + "/assets/images");
+    QImage source(800, 400, QImage::Format_RGB32);
+    source.fill(QColor(20, 120, 220));
+    source.save(basePath + "/assets/images/mip.png", "PNG");
+    
+    ImageObject img;
+    img.imagePath = QStringLiteral("mip.png");
+    img.size = QSizeF(800, 400);
+    if (!img.loadImage(basePath) || img.pixelSize() != QSize(800, 400)
+        || img.pixmap().size() != QSize(800, 400)) {
+        qDebug() << "FAIL: lazy image load";
+        success = false;
+    }
+    
+    // Outside an AsyncScope a render is complete: a quarter-size render
+    // draws the picture (from a downsampled level), not a placeholder
+    QImage target(200, 100, QImage::Format_ARGB32_Premultiplied);
+    target.fill(Qt::white);
+    {
+        QPainter painter(&target);
+        img.render(painter, 0.25);
+    }
+    if (target.pixelColor(100, 50) != QColor(20, 120, 220)) {
+        qDebug() << "FAIL: downsampled render drew" << target.pixelColor(100, 50);
+        success = false;
+    }
+    
+    img.unloadImage();
+    if (img.isLoaded()) {
+        qDebug() << "FAIL: unloadImage() kept the image";
+        success = false;
+    }
+    QDir(basePath).removeRecursively();
+    
+    if (success) {
+        qDebug() << "PASS: Image mip level tests successful!";
+    }
+    
+    return success;
+}
+
 /**
  * @brief Render a test page to PNG for visual verification.
  * @param outputPath Path to save the PNG file.
@@ -420,6 +1120,33 @@ inline bool runAllTests()
     allPass &= testObjectManagement();
     qDebug() << "";
     
+    allPass &= testStrokePointStore();
+    qDebug() << "";
+    
+    allPass &= testStrokeSpatialIndex();
+    qDebug() << "";
+    
+    allPass &= testStrokeOutlineCache();
+    qDebug() << "";
+    
+    allPass &= testStrokeCacheRasterizer();
+    qDebug() << "";
+    
+    allPass &= testTranslucentScratch();
+    qDebug() << "";
+    
+    allPass &= testCacheBudgetSharedItems();
+    qDebug() << "";
+    
+    allPass &= testPdfSearchIndex();
+    qDebug() << "";
+    
+    allPass &= testPdfDisplayListCache();
+    qDebug() << "";
+    
+    allPass &= testImageMipLevels();
+    qDebug() << "";
+    
     // Smoke test for Page::render(). Written to a temporary file and removed
     // again so a test run leaves nothing behind in the working directory.
     const QString renderPath = QDir::temp().filePath("speedynote_test_page_render.png");
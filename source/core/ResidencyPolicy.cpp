@@ -0,0 +1,106 @@
+// ============================================================================
+// ResidencyPolicy - Implementation
+// ============================================================================
+
+#include "ResidencyPolicy.h"
+
+#include <QtGlobal>
+
+#include <cmath>
+
+namespace {
+int signOf(qreal value)
+{
+    return (value > 0) - (value < 0);
+}
+}
+
+void ResidencyPolicy::noteScroll(QPointF delta, QSizeF viewExtent, qint64 nowMs)
+{
+    const qreal absX = std::abs(delta.x());
+    const qreal absY = std::abs(delta.y());
+    const qreal major = qMax(absX, absY);
+    if (major <= 0) {
+        return;
+    }
+
+    // Direction per axis; a small sideways drift during vertical reading
+    // should not shrink the horizontal window behind the reader.
+    m_dirX = (absX >= major * AXIS_SHARE) ? signOf(delta.x()) : 0;
+    m_dirY = (absY >= major * AXIS_SHARE) ? signOf(delta.y()) : 0;
+
+    const bool jump = (viewExtent.width() > 0 && absX > viewExtent.width() * JUMP_VIEWS)
+                   || (viewExtent.height() > 0 && absY > viewExtent.height() * JUMP_VIEWS);
+    const qint64 dt = (m_lastSampleMs < 0) ? -1 : nowMs - m_lastSampleMs;
+    m_lastSampleMs = nowMs;
+
+    if (jump || dt < 0 || dt > GESTURE_GAP_MS) {
+        // First sample of a gesture (or a jump): the distance is known, the
+        // time it took is not.
+        m_velocity = QPointF();
+        return;
+    }
+
+    // Events can arrive in bursts; don't let a 0-1 ms gap read as a huge speed.
+    const qreal seconds = qMax<qint64>(dt, 8) / 1000.0;
+    const QPointF sample = delta / seconds;
+    m_velocity = m_velocity * (1.0 - SMOOTHING) + sample * SMOOTHING;
+}
+
+void ResidencyPolicy::reset()
+{
+    m_velocity = QPointF();
+    m_lastSampleMs = -1;
+    m_dirX = 0;
+    m_dirY = 0;
+}
+
+QPointF ResidencyPolicy::velocity(qint64 nowMs) const
+{
+    if (m_lastSampleMs < 0 || nowMs - m_lastSampleMs > STALE_MS) {
+        return QPointF();
+    }
+    return m_velocity;
+}
+
+void ResidencyPolicy::axisSpan(int direction, qreal speed, int baseBuffer, int maxAhead,
+                               qreal extent, int& low, int& high)
+{
+    if (direction == 0) {
+        low = baseBuffer;
+        high = baseBuffer;
+        return;
+    }
+
+    // Distance covered in LOOKAHEAD_MS at the current speed, in pages/tiles;
+    // at rest still one step ahead so idle time warms the next page.
+    int extra = 1;
+    if (extent > 0 && speed > 0) {
+        const qreal steps = speed * LOOKAHEAD_MS / 1000.0 / extent;
+        extra = qMax(extra, static_cast<int>(std::ceil(steps)));
+    }
+    const int ahead = qMax(baseBuffer, qMin(baseBuffer + extra, maxAhead));
+    const int behind = baseBuffer / 2;
+
+    low = (direction < 0) ? ahead : behind;
+    high = (direction < 0) ? behind : ahead;
+}
+
+ResidencyPolicy::Span ResidencyPolicy::pageSpan(int baseBuffer, int maxAhead, qreal pageExtent,
+                                                qint64 nowMs) const
+{
+    Span span;
+    axisSpan(m_dirY, std::abs(velocity(nowMs).y()), baseBuffer, maxAhead, pageExtent,
+             span.before, span.after);
+    return span;
+}
+
+QMargins ResidencyPolicy::tileMargins(int baseMargin, int maxAhead, qreal tileExtent,
+                                      qint64 nowMs) const
+{
+    const QPointF v = velocity(nowMs);
+    int left = 0, right = 0, top = 0, bottom = 0;
+    axisSpan(m_dirX, std::abs(v.x()), baseMargin, maxAhead, tileExtent, left, right);
+    axisSpan(m_dirY, std::abs(v.y()), baseMargin, maxAhead, tileExtent, top, bottom);
+    return QMargins(left, top, right, bottom);
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+// ============================================================================
+// ResidencyPolicy - Which pages/tiles a viewport keeps warm around the view
+// ============================================================================
+// The viewport used fixed keep windows (±2/±1/0 pages or tiles, chosen only by
+// effective scale) and filled them only after scrolling settled. A fast flick
+// through a long notebook then always lands on cold pages, while slow forward
+// reading keeps pages the reader has already left.
+//
+// ResidencyPolicy follows the scroll motion instead:
+// - noteScroll() feeds every pan delta; the policy keeps a smoothed velocity
+//   (document units per second) and the direction of travel per axis
+// - The window AHEAD of the view grows with velocity: it covers what the view
+//   reaches within LOOKAHEAD_MS at the current speed (capped by the caller),
+//   and keeps one extra page ahead at rest so idle time warms the next page
+// - The window BEHIND the view shrinks to half the base buffer once the
+//   direction is known; with no direction (fresh view, zoom) it is symmetric
+// - A jump (outline link, go-to-page) resets the velocity, so it does not
+//   read as a very fast scroll
+// - Hit/miss counters record whether pages/tiles coming into view were
+//   already resident, to tune the constants
+//
+// Plain value class, GUI thread only. Time comes from the caller (ms).
+// ============================================================================
+
+#include <QMargins>
+#include <QPointF>
+#include <QSizeF>
+
+class ResidencyPolicy {
+public:
+    /**
+     * @brief Pages to keep around the visible range.
+     */
+    struct Span {
+        int before = 0;   ///< Pages kept at lower indices than the visible range
+        int after = 0;    ///< Pages kept at higher indices than the visible range
+    };
+
+    /**
+     * @brief Residency counters (see noteHit()/noteMiss()).
+     */
+    struct Stats {
+        quint64 hits = 0;        ///< Came into view already resident
+        quint64 misses = 0;      ///< Came into view cold (loaded/rendered on demand)
+        quint64 prefetched = 0;  ///< Pages/tiles loaded ahead of the view
+
+        /// Hits / (hits + misses), or 1.0 before anything was counted.
+        qreal hitRate() const
+        {
+            const quint64 total = hits + misses;
+            return total == 0 ? 1.0 : static_cast<qreal>(hits) / static_cast<qreal>(total);
+        }
+    };
+
+    static constexpr int LOOKAHEAD_MS = 600;        ///< How far ahead (in time) to keep warm
+    static constexpr int GESTURE_GAP_MS = 300;      ///< Longer pause starts a new gesture
+    static constexpr int STALE_MS = 400;            ///< No samples for this long: speed is 0
+    static constexpr qreal SMOOTHING = 0.5;         ///< Weight of the newest velocity sample
+    static constexpr qreal JUMP_VIEWS = 2.0;        ///< A delta this many views long is a jump
+    static constexpr qreal AXIS_SHARE = 0.25;       ///< Minor axis below this share of the
+                                                    ///< major one has no direction
+
+    /**
+     * @brief Record a pan.
+     * @param delta Pan offset change in document units (positive = towards
+     *        higher page indices / larger tile coordinates).
+     * @param viewExtent Visible area in document units, to recognise jumps.
+     * @param nowMs Monotonic time of the pan.
+     */
+    void noteScroll(QPointF delta, QSizeF viewExtent, qint64 nowMs);
+
+    /// Forget velocity and direction (zoom change, new document).
+    void reset();
+
+    /// Smoothed velocity in document units per second; zero once stale.
+    QPointF velocity(qint64 nowMs) const;
+
+    /// Direction of travel per axis: -1, 0 (unknown) or +1.
+    int directionX() const { return m_dirX; }
+    int directionY() const { return m_dirY; }
+
+    /**
+     * @brief Keep window along the vertical (page) axis.
+     * @param baseBuffer The symmetric buffer the caller used before.
+     * @param maxAhead Upper bound for the ahead side (memory at this zoom).
+     * @param pageExtent Document units per page step (page height + gap,
+     *        divided by pages per row).
+     */
+    Span pageSpan(int baseBuffer, int maxAhead, qreal pageExtent, qint64 nowMs) const;
+
+    /**
+     * @brief Keep margins in tiles around the visible rect (edgeless).
+     * @param baseMargin The symmetric margin the caller used before.
+     * @param maxAhead Upper bound for the ahead side of each axis.
+     * @param tileExtent Tile edge in document units.
+     */
+    QMargins tileMargins(int baseMargin, int maxAhead, qreal tileExtent, qint64 nowMs) const;
+
+    void noteHit() { ++m_stats.hits; }
+    void noteMiss() { ++m_stats.misses; }
+    void notePrefetched(int count = 1) { m_stats.prefetched += static_cast<quint64>(count); }
+
+    const Stats& stats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
+private:
+    /// Ahead/behind extent on one axis. @p speed is in units per second.
+    static void axisSpan(int direction, qreal speed, int baseBuffer, int maxAhead,
+                         qreal extent, int& low, int& high);
+
+    QPointF m_velocity;
+    qint64 m_lastSampleMs = -1;
+    int m_dirX = 0;
+    int m_dirY = 0;
+    Stats m_stats;
+};
@@ -0,0 +1,210 @@
+// ============================================================================
+// StrokeJournal - Implementation
+// ============================================================================
+
+#include "StrokeJournal.h"
+#include "../strokes/StrokeBinaryCodec.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QSaveFile>
+
+namespace {
+const QByteArray MAGIC("SNJ1");
+constexpr int RECORD_HEADER_BYTES = 8;   // u32 length + u32 checksum
+
+quint32 fnv1a(const QByteArray& data)
+{
+    quint32 hash = 2166136261u;
+    for (const char c : data) {
+        hash ^= static_cast<quint8>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void putU32(QByteArray& out, quint32 value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out.append(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+quint32 getU32(const char* data)
+{
+    quint32 value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<quint32>(static_cast<quint8>(data[i])) << (8 * i);
+    }
+    return value;
+}
+}
+
+StrokeJournal::StrokeJournal(const QString& bundlePath)
+    : m_bundlePath(bundlePath)
+{
+    m_file.setFileName(bundlePath + "/" + QLatin1String(FILE_NAME));
+    if (m_file.exists()) {
+        read(bundlePath, &m_size);
+    }
+}
+
+bool StrokeJournal::open()
+{
+    if (m_file.isOpen()) {
+        return true;
+    }
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qWarning() << "StrokeJournal: cannot open" << m_file.fileName();
+        return false;
+    }
+
+    // Cut a torn tail off, or start a new file
+    if (m_size < MAGIC.size()) {
+        m_file.resize(0);
+        m_file.write(MAGIC);
+        m_size = MAGIC.size();
+    } else if (m_file.size() > m_size) {
+        m_file.resize(m_size);
+    }
+    m_file.seek(m_size);
+    return true;
+}
+
+bool StrokeJournal::append(Op op, const QString& container, const QString& layerId,
+                           const QVector<VectorStroke>& strokes)
+{
+    if (strokes.isEmpty() || !open()) {
+        return false;
+    }
+
+    QByteArray payload;
+    {
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_12);
+        stream << static_cast<quint8>(op) << container << layerId;
+        if (op == Op::Remove) {
+            QStringList ids;
+            ids.reserve(strokes.size());
+            for (const VectorStroke& stroke : strokes) {
+                ids.append(stroke.id);
+            }
+            stream << ids;
+        } else {
+            stream << StrokeBinaryCodec::encode({StrokeBinaryCodec::LayerBlock{layerId, &strokes}});
+        }
+    }
+
+    QByteArray record;
+    record.reserve(RECORD_HEADER_BYTES + payload.size());
+    putU32(record, static_cast<quint32>(payload.size()));
+    putU32(record, fnv1a(payload));
+    record.append(payload);
+
+    if (m_file.write(record) != record.size() || !m_file.flush()) {
+        qWarning() << "StrokeJournal: cannot append to" << m_file.fileName();
+        // Whatever made it to disk is a torn record; open() cuts it off
+        m_file.close();
+        return false;
+    }
+    m_size += record.size();
+    return true;
+}
+
+void StrokeJournal::dropBefore(qint64 offset)
+{
+    if (offset <= MAGIC.size()) {
+        return;   // Nothing covered
+    }
+    if (offset >= m_size) {
+        discard();
+        return;
+    }
+
+    // Records appended after the save's snapshot stay
+    if (!open()) {
+        return;
+    }
+    m_file.seek(offset);
+    const QByteArray tail = m_file.read(m_size - offset);
+    m_file.close();
+
+    QSaveFile out(m_file.fileName());
+    if (!out.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    out.write(MAGIC);
+    out.write(tail);
+    if (!out.commit()) {
+        qWarning() << "StrokeJournal: cannot compact" << m_file.fileName();
+        return;
+    }
+    m_size = MAGIC.size() + tail.size();
+}
+
+void StrokeJournal::discard()
+{
+    m_file.close();
+    m_file.remove();
+    m_size = 0;
+}
+
+QVector<StrokeJournal::Entry> StrokeJournal::read(const QString& bundlePath, qint64* validBytes)
+{
+    QVector<Entry> entries;
+    if (validBytes) {
+        *validBytes = 0;
+    }
+
+    QFile file(bundlePath + "/" + QLatin1String(FILE_NAME));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return entries;
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+    if (!data.startsWith(MAGIC)) {
+        return entries;
+    }
+
+    qint64 pos = MAGIC.size();
+    while (pos + RECORD_HEADER_BYTES <= data.size()) {
+        const quint32 length = getU32(data.constData() + pos);
+        const quint32 checksum = getU32(data.constData() + pos + 4);
+        if (length > MAX_RECORD_BYTES || pos + RECORD_HEADER_BYTES + length > data.size()) {
+            break;   // Torn tail
+        }
+        const QByteArray payload = data.mid(pos + RECORD_HEADER_BYTES, length);
+        if (fnv1a(payload) != checksum) {
+            break;
+        }
+
+        Entry entry;
+        quint8 op = 0;
+        QDataStream stream(payload);
+        stream.setVersion(QDataStream::Qt_5_12);
+        stream >> op >> entry.container >> entry.layerId;
+        entry.op = static_cast<Op>(op);
+        if (entry.op == Op::Remove) {
+            stream >> entry.strokeIds;
+        } else {
+            QByteArray encoded;
+            stream >> encoded;
+            StrokeBinaryCodec::LayerStrokes decoded;
+            if (StrokeBinaryCodec::decode(encoded, decoded)) {
+                entry.strokes = decoded.value(entry.layerId);
+            }
+        }
+        if (stream.status() != QDataStream::Ok
+            || op < static_cast<quint8>(Op::Add) || op > static_cast<quint8>(Op::Replace)) {
+            break;
+        }
+
+        entries.append(entry);
+        pos += RECORD_HEADER_BYTES + length;
+    }
+
+    if (validBytes) {
+        *validBytes = pos;
+    }
+    return entries;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+// ============================================================================
+// StrokeJournal - Append-only log of stroke edits inside a bundle
+// ============================================================================
+// Strokes used to reach disk only when a save rewrote their whole page or
+// tile file, so a crash lost everything since the last autosave. The journal
+// records each stroke change as it happens - one small append per undoable
+// action - and saves fold it back into the page/tile files.
+//
+// Design:
+// - strokes.journal in the bundle: magic "SNJ1", then records of
+//   u32 length | u32 checksum (FNV-1a) | payload
+// - A payload is one operation on one layer of one container (page UUID or
+//   "x,y" tile key): Add / Replace carry the strokes (StrokeBinaryCodec
+//   container), Remove carries stroke ids
+// - Document::loadBundle() replays it on top of the page/tile files; a torn
+//   or corrupt tail (crash mid-append) ends the replay and is cut off before
+//   the next append
+// - A save that wrote every page/tile touched so far drops the records it
+//   covers (dropBefore()); records appended while a background save was
+//   writing are kept
+// - Replay is tolerant of records the files already contain (a crash after
+//   a save wrote its files but before it dropped the journal): adding an
+//   existing stroke id or removing a missing one is a no-op
+//
+// Appends are flushed to the OS but not fsync'ed: cheap enough to do per
+// stroke, and it survives an application crash.
+//
+// Thread safety: GUI thread only.
+// ============================================================================
+
+#include "../strokes/VectorStroke.h"
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class StrokeJournal {
+public:
+    /// File name inside the bundle directory.
+    static constexpr const char* FILE_NAME = "strokes.journal";
+
+    /// Largest payload accepted when reading; anything larger is corruption.
+    static constexpr quint32 MAX_RECORD_BYTES = 64u * 1024u * 1024u;
+
+    enum class Op : quint8 {
+        Add = 1,        ///< Append strokes to the layer
+        Remove = 2,     ///< Remove strokes by id
+        Replace = 3     ///< Overwrite strokes in place by id (same geometry, e.g. recolor)
+    };
+
+    /**
+     * @brief One decoded journal record.
+     */
+    struct Entry {
+        Op op = Op::Add;
+        QString container;              ///< Page UUID, or "x,y" tile key
+        QString layerId;
+        QVector<VectorStroke> strokes;  ///< Add / Replace
+        QStringList strokeIds;          ///< Remove
+    };
+
+    explicit StrokeJournal(const QString& bundlePath);
+
+    /// Bundle this journal belongs to.
+    const QString& bundlePath() const { return m_bundlePath; }
+
+    /**
+     * @brief Append one operation and flush it.
+     * @return False if the journal file cannot be written.
+     */
+    bool append(Op op, const QString& container, const QString& layerId,
+                const QVector<VectorStroke>& strokes);
+
+    /// Current length in bytes (0 before the first append).
+    qint64 size() const { return m_size; }
+
+    /**
+     * @brief Drop the records before @p offset (a size() taken when a save
+     *        snapshotted the document); the file is removed if none remain.
+     */
+    void dropBefore(qint64 offset);
+
+    /// Delete the journal file (changes were discarded).
+    void discard();
+
+    /**
+     * @brief Read the journal of a bundle.
+     * @param validBytes Receives the length of the intact prefix.
+     * @return Records in order, up to the first torn or corrupt one.
+     */
+    static QVector<Entry> read(const QString& bundlePath, qint64* validBytes = nullptr);
+
+private:
+    bool open();
+
+    QString m_bundlePath;
+    QFile m_file;
+    qint64 m_size = 0;
+};
@@ -0,0 +1,82 @@
+#include "StrokeCacheRasterizer.h"
+#include "VectorLayer.h"
+#include "TranslucentScratch.h"
+
+#include <QPainter>
+#include <QtConcurrent>
+
+namespace StrokeCacheRasterizer {
+
+QImage render(const QVector<VectorStroke>& strokes, const QSize& physicalSize,
+              qreal scale, const std::atomic<bool>* cancelled)
+{
+    QImage image(physicalSize, QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull()) {
+        return QImage();
+    }
+    image.fill(Qt::transparent);
+    if (strokes.isEmpty() || scale <= 0) {
+        return image;
+    }
+
+    QVector<QRect> tiles;
+    for (int y = 0; y < physicalSize.height(); y += TILE_SIZE) {
+        for (int x = 0; x < physicalSize.width(); x += TILE_SIZE) {
+            tiles.append(QRect(x, y, qMin(TILE_SIZE, physicalSize.width() - x),
+                               qMin(TILE_SIZE, physicalSize.height() - y)));
+        }
+    }
+
+    // bits() detaches once here; the workers below only write through
+    // non-owning views of disjoint regions of this buffer.
+    uchar* const bits = image.bits();
+    const auto bytesPerLine = image.bytesPerLine();
+
+    QtConcurrent::blockingMap(tiles, [&](const QRect& tile) {
+        if (cancelled && cancelled->load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        // Tile bounds in page units, for culling
+        const QRectF pageRect(tile.x() / scale, tile.y() / scale,
+                              tile.width() / scale, tile.height() / scale);
+
+        QImage view(bits + tile.y() * bytesPerLine + tile.x() * 4,
+                    tile.width(), tile.height(), bytesPerLine,
+                    QImage::Format_ARGB32_Premultiplied);
+        QPainter painter;
+        for (const VectorStroke& stroke : strokes) {
+            if (!stroke.boundingBox.intersects(pageRect)) {
+                continue;
+            }
+            if (!painter.isActive()) {
+                painter.begin(&view);
+                painter.setRenderHint(QPainter::Antialiasing, true);
+                // The clip also bounds translucent strokes' scratch buffers
+                // to the tile (see VectorLayer::renderStroke)
+                painter.setClipRect(QRect(QPoint(0, 0), tile.size()));
+                painter.translate(-tile.x(), -tile.y());
+                painter.scale(scale, scale);
+            }
+            VectorLayer::renderStroke(painter, stroke);
+        }
+        if (painter.isActive()) {
+            painter.end();
+        }
+        // Pool threads must not each keep a scratch buffer alive
+        TranslucentScratch::release();
+    });
+
+    return image;
+}
+
+QFuture<QImage> renderAsync(QVector<VectorStroke> strokes, const QSize& physicalSize,
+                            qreal scale, std::shared_ptr<std::atomic<bool>> cancelled)
+{
+    return QtConcurrent::run([strokes = std::move(strokes), physicalSize, scale,
+                              cancelled = std::move(cancelled)]() {
+        return render(strokes, physicalSize, scale, cancelled.get());
+    });
+}
+
+} // namespace StrokeCacheRasterizer
@@ -0,0 +1,52 @@
+#pragma once
+
+// ============================================================================
+// StrokeCacheRasterizer - Tiled, multi-threaded stroke cache rendering
+// ============================================================================
+// Renders a snapshot of a layer's strokes into a stroke-cache image on the
+// global thread pool. The image is split into TILE_SIZE squares; each tile
+// paints straight into its own region of the shared buffer (tiles never
+// overlap, so workers need no locking) and skips strokes whose bounding box
+// misses it.
+//
+// Used by VectorLayer's background cache rebuild: the stroke list is copied
+// on the GUI thread (implicitly shared, so the copy is O(1) and later edits
+// to the layer detach instead of racing the workers), the image is rendered
+// off-thread, and the GUI thread turns it into the cache QPixmap.
+// ============================================================================
+
+#include "../strokes/VectorStroke.h"
+
+#include <QFuture>
+#include <QImage>
+#include <QSize>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+
+namespace StrokeCacheRasterizer {
+
+/// Tile edge in physical pixels. A capped 4096x4096 cache is 64 tiles.
+constexpr int TILE_SIZE = 512;
+
+/**
+ * @brief Render @p strokes into a new transparent image, tiles in parallel.
+ * @param strokes Strokes in page/tile coordinates, in paint order.
+ * @param physicalSize Image size in pixels.
+ * @param scale Page units -> pixels (zoom * dpr / divisor).
+ * @param cancelled Optional flag; once set, remaining tiles are skipped and
+ *        the (incomplete) image should be discarded.
+ * @return ARGB32_Premultiplied image, or a null image on allocation failure.
+ */
+QImage render(const QVector<VectorStroke>& strokes, const QSize& physicalSize,
+              qreal scale, const std::atomic<bool>* cancelled = nullptr);
+
+/**
+ * @brief Run render() on the global thread pool.
+ * @param cancelled Shared with the caller so it can abandon the job.
+ */
+QFuture<QImage> renderAsync(QVector<VectorStroke> strokes, const QSize& physicalSize,
+                            qreal scale, std::shared_ptr<std::atomic<bool>> cancelled);
+
+} // namespace StrokeCacheRasterizer
@@ -0,0 +1,100 @@
+// ============================================================================
+// TranslucentScratch - Implementation
+// ============================================================================
+
+#include "TranslucentScratch.h"
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <atomic>
+
+namespace {
+struct ThreadScratch {
+    QImage image;
+    qint64 lastUse = 0;
+};
+
+thread_local ThreadScratch t_scratch;
+std::atomic<qint64> s_totalBytes{0};
+
+bool onGuiThread()
+{
+    const QCoreApplication* app = QCoreApplication::instance();
+    return app && QThread::currentThread() == app->thread();
+}
+}
+
+TranslucentScratch::TranslucentScratch()
+{
+    CacheBudget::instance()->addClient(this);
+}
+
+TranslucentScratch* TranslucentScratch::instance()
+{
+    static TranslucentScratch* s_instance = new TranslucentScratch();
+    return s_instance;
+}
+
+QImage* TranslucentScratch::acquire(int w, int h)
+{
+    if (w > MAX_DIM || h > MAX_DIM) {
+        return nullptr;
+    }
+    QImage& scratch = t_scratch.image;
+    if (scratch.width() < w || scratch.height() < h) {
+        auto roundUp = [](int v) { return (v + 255) & ~255; };
+        const qint64 oldBytes = scratch.sizeInBytes();
+        scratch = QImage(qMin(MAX_DIM, roundUp(qMax(w, scratch.width()))),
+                         qMin(MAX_DIM, roundUp(qMax(h, scratch.height()))),
+                         QImage::Format_ARGB32_Premultiplied);
+        s_totalBytes += scratch.sizeInBytes() - oldBytes;
+        if (scratch.isNull()) {
+            return nullptr;
+        }
+        if (onGuiThread()) {
+            instance();
+            CacheBudget::instance()->requestEnforce();
+        }
+    }
+    t_scratch.lastUse = CacheBudget::nowMs();
+    return &scratch;
+}
+
+void TranslucentScratch::release()
+{
+    s_totalBytes -= t_scratch.image.sizeInBytes();
+    t_scratch.image = QImage();
+}
+
+qint64 TranslucentScratch::threadBytes()
+{
+    return t_scratch.image.sizeInBytes();
+}
+
+qint64 TranslucentScratch::totalBytes()
+{
+    return s_totalBytes.load();
+}
+
+// ===== CacheBudget::Client =====
+
+void TranslucentScratch::collectCacheItems(QVector<CacheBudget::Item>& items) const
+{
+    if (t_scratch.image.isNull()) {
+        return;
+    }
+    CacheBudget::Item item;
+    item.key = 1;
+    item.bytes = t_scratch.image.sizeInBytes();
+    item.lastUse = t_scratch.lastUse;
+    item.rebuildCost = CacheBudget::COST_SCRATCH;
+    items.append(item);
+}
+
+void TranslucentScratch::evictCacheItems(const QVector<quint64>& keys)
+{
+    if (keys.contains(1)) {
+        release();
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+// ============================================================================
+// TranslucentScratch - Reusable compositing buffer for translucent strokes
+// ============================================================================
+// A translucent stroke is drawn opaque into a scratch image and blitted with
+// the stroke's alpha, so its overlapping parts do not darken. Allocating that
+// image per stroke made highlighter-heavy pages allocate thousands of buffers
+// per cache rebuild, so each thread reuses one, grown in 256px steps.
+//
+// Bounds on what is held:
+// - Edges are capped at MAX_DIM (16 MB); bigger strokes get a throwaway buffer
+// - The GUI thread keeps its buffer between frames and reports it to
+//   CacheBudget, which frees it like any other idle cache
+// - Worker threads call release() when their job is done
+//   (StrokeCacheRasterizer releases after every tile), so pool threads do
+//   not keep one each
+//
+// Thread safety: acquire()/release() touch only the calling thread's buffer.
+// The budget client runs on the GUI thread and sees the GUI thread's buffer.
+// ============================================================================
+
+#include "../core/CacheBudget.h"
+
+#include <QImage>
+
+class TranslucentScratch : public CacheBudget::Client {
+public:
+    /// Largest buffer edge kept alive between strokes.
+    static constexpr int MAX_DIM = 2048;
+
+    /**
+     * @brief The calling thread's scratch image.
+     * @return A buffer of at least @p w x @p h pixels (contents undefined),
+     *         or nullptr if that exceeds MAX_DIM or allocation fails.
+     */
+    static QImage* acquire(int w, int h);
+
+    /// Free the calling thread's buffer.
+    static void release();
+
+    /// Bytes held by the calling thread's buffer.
+    static qint64 threadBytes();
+
+    /// Bytes held by all threads' buffers.
+    static qint64 totalBytes();
+
+    /// The budget client (GUI thread; registered on first GUI-thread use).
+    static TranslucentScratch* instance();
+
+    // ===== CacheBudget::Client =====
+    QString cacheName() const override { return QStringLiteral("Translucent stroke scratch"); }
+    void collectCacheItems(QVector<CacheBudget::Item>& items) const override;
+    void evictCacheItems(const QVector<quint64>& keys) override;
+
+private:
+    TranslucentScratch();
+};
@@ -9,17 +9,30 @@
 // ============================================================================
 
 #include "../strokes/VectorStroke.h"
+#include "../strokes/StrokeOutlineKernel.h"
+#include "../strokes/StrokeSpatialIndex.h"
+#include "StrokeCacheRasterizer.h"
+#include "TranslucentScratch.h"
 
 #include <QString>
 #include <QVector>
+#include <QHash>
+#include <QPair>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QUuid>
 #include <QPainter>
 #include <QPolygonF>
 #include <QPixmap>
+#include <QImage>
+#include <QFuture>
 #include <QtMath>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
 /**
  * @brief A single vector layer containing strokes.
  * 
@@ -67,6 +80,7 @@ public:
      */
     void addStroke(const VectorStroke& stroke) {
         m_strokes.append(stroke);
+        m_spatialIndex.append(m_strokes.last());
         markStrokePending();
     }
     
@@ -76,6 +90,7 @@ public:
      */
     void addStroke(VectorStroke&& stroke) {
         m_strokes.append(std::move(stroke));
+        m_spatialIndex.append(m_strokes.last());
         markStrokePending();
     }
     
@@ -88,17 +103,19 @@ public:
      * incrementally (clear + re-render overlapping strokes) instead of
      * rebuilding the entire cache. This makes eraser O(k) where k is the
      * number of strokes overlapping the erased one, instead of O(n) for all.
+     * The stroke is located through the spatial index's id lookup.
      */
     bool removeStroke(const QString& strokeId) {
-        for (int i = static_cast<int>(m_strokes.size()) - 1; i >= 0; --i) {
-            if (m_strokes[i].id == strokeId) {
-                QRectF removedBounds = m_strokes[i].boundingBox;
-                m_strokes.removeAt(i);
-                patchCacheAfterRemoval(removedBounds);
-                return true;
-            }
+        const int i = indexOfStroke(strokeId);
+        if (i < 0) {
+            return false;
         }
-        return false;
+        QRectF removedBounds = m_strokes[i].boundingBox;
+        m_spatialIndex.remove(i, m_strokes[i]);
+        dropCachedOutline(strokeId);
+        m_strokes.removeAt(i);
+        patchCacheAfterRemoval(removedBounds);
+        return true;
     }
     
     /**
@@ -110,9 +127,44 @@ public:
     /**
      * @brief Get all strokes (mutable reference for modification).
      * @return Mutable vector of strokes.
+     * 
+     * Callers that add, remove or move strokes through this reference must
+     * call invalidateStrokeCache() afterwards, which also marks the spatial
+     * index stale.
      */
     QVector<VectorStroke>& strokes() { return m_strokes; }
     
+    /**
+     * @brief Find a stroke's position by ID.
+     * @return Index into strokes(), or -1 if no stroke has this ID.
+     */
+    int indexOfStroke(const QString& strokeId) const {
+        return ensureSpatialIndex().indexOf(strokeId);
+    }
+    
+    /**
+     * @brief Find a stroke by ID.
+     * @return Pointer into strokes() (invalidated by any modification), or nullptr.
+     */
+    const VectorStroke* strokeById(const QString& strokeId) const {
+        const int i = indexOfStroke(strokeId);
+        return i >= 0 ? &m_strokes[i] : nullptr;
+    }
+    
+    /**
+     * @brief Find strokes whose bounding box intersects a rectangle.
+     * @param rect Page/tile-local rectangle.
+     * @return Indices into strokes(), ascending (paint order).
+     */
+    QVector<int> strokeIndicesIntersecting(const QRectF& rect) const {
+        QVector<int> result = ensureSpatialIndex().candidates(rect);
+        result.erase(std::remove_if(result.begin(), result.end(), [&](int i) {
+                         return !m_strokes[i].boundingBox.intersects(rect);
+                     }),
+                     result.end());
+        return result;
+    }
+    
     /**
      * @brief Get the number of strokes in this layer.
      */
@@ -123,11 +175,22 @@ public:
      */
     bool isEmpty() const { return m_strokes.isEmpty(); }
     
+    /**
+     * @brief Replace all strokes in this layer (used by bulk loaders).
+     * @param strokes The new stroke list; bounding boxes must be up to date.
+     */
+    void setStrokes(QVector<VectorStroke> strokes) {
+        m_strokes = std::move(strokes);
+        releaseOutlineCache();
+        invalidateStrokeCache();
+    }
+    
     /**
      * @brief Clear all strokes from this layer.
      */
     void clear() { 
         m_strokes.clear(); 
+        releaseOutlineCache();
         invalidateStrokeCache();  // Cache needs rebuild
     }
     
@@ -141,7 +204,10 @@ public:
      */
     QVector<QString> strokesAtPoint(const QPointF& pt, qreal tolerance) const {
         QVector<QString> result;
-        for (const auto& stroke : m_strokes) {
+        const QRectF probe(pt.x() - tolerance, pt.y() - tolerance,
+                           tolerance * 2, tolerance * 2);
+        for (int i : ensureSpatialIndex().candidates(probe)) {
+            const VectorStroke& stroke = m_strokes[i];
             if (stroke.containsPoint(pt, tolerance)) {
                 result.append(stroke.id);
             }
@@ -192,9 +258,11 @@ public:
      * - QPainter rendering (VectorLayer::renderStroke)
      * - PDF export (MuPdfExporter - converts to MuPDF paths)
      * 
-     * The stored stroke points are first smoothed with Catmull-Rom interpolation
-     * (see catmullRomSubdivide) to produce a dense, smooth point sequence. This
-     * eliminates the visible polyline edges that would otherwise appear at high zoom.
+     * The stored stroke points are smoothed with Catmull-Rom interpolation
+     * (StrokeOutlineKernel::SUBDIVISIONS samples per segment) to eliminate the
+     * visible polyline edges that would otherwise appear at high zoom. The
+     * smoothing, normals and edge emission run as one vectorized pass in
+     * StrokeOutlineKernel.
      * 
      * The polygon represents the variable-width stroke outline:
      * - Left edge goes forward along the stroke
@@ -204,95 +272,35 @@ public:
      */
     static StrokePolygonResult buildStrokePolygon(const VectorStroke& stroke) {
         StrokePolygonResult result;
+        const int n = stroke.points.size();
         
-        if (stroke.points.size() < 2) {
+        if (n < 2) {
             // Single point - just a dot
-            if (stroke.points.size() == 1) {
+            if (n == 1) {
                 result.isSinglePoint = true;
-                result.startCapCenter = stroke.points[0].pos;
+                result.startCapCenter = stroke.points.pos(0);
                 // Minimum stroke width is now enforced at capture time in
                 // DocumentViewport (per pen preset), so the stored per-point
                 // pressure already embeds the floor.  No qMax() needed here.
-                qreal width = stroke.baseThickness * stroke.points[0].pressure;
+                qreal width = stroke.baseThickness * stroke.points.pressure(0);
                 result.startCapRadius = width / 2.0;
             }
             return result;
         }
         
-        // Smooth the stroke points with Catmull-Rom interpolation.
-        // This inserts intermediate points along a smooth curve between each
-        // pair of stored points, eliminating the visible polyline edges that
-        // appear when zoomed in. For 2-point strokes (straight lines),
-        // catmullRomSubdivide returns them unchanged.
-        const QVector<StrokePoint>& pts = catmullRomSubdivide(stroke.points);
-        const int n = static_cast<int>(pts.size());
-        
-        // Pre-calculate half-widths for each point
-        QVector<qreal> halfWidths(n);
-        for (int i = 0; i < n; ++i) {
-            // See comment above: minimum-width floor is applied in
-            // DocumentViewport at capture time, not here.
-            qreal width = stroke.baseThickness * pts[i].pressure;
-            halfWidths[i] = width / 2.0;
-        }
-        
-        // Build the stroke outline polygon
-        // Left edge goes forward, right edge goes backward
-        QVector<QPointF> leftEdge(n);
-        QVector<QPointF> rightEdge(n);
-        
-        for (int i = 0; i < n; ++i) {
-            const QPointF& pos = pts[i].pos;
-            qreal hw = halfWidths[i];
-            
-            // Calculate perpendicular direction
-            QPointF tangent;
-            if (i == 0) {
-                // First point: use direction to next point
-                tangent = pts[1].pos - pos;
-            } else if (i == n - 1) {
-                // Last point: use direction from previous point
-                tangent = pos - pts[n - 2].pos;
-            } else {
-                // Middle points: average of incoming and outgoing directions
-                tangent = pts[i + 1].pos - pts[i - 1].pos;
-            }
-            
-            // Normalize tangent
-            qreal len = qSqrt(tangent.x() * tangent.x() + tangent.y() * tangent.y());
-            if (len < 0.0001) {
-                // Degenerate case: use arbitrary perpendicular
-                tangent = QPointF(1.0, 0.0);
-                len = 1.0;
-            }
-            tangent /= len;
-            
-            // Perpendicular vector (rotate 90 degrees)
-            QPointF perp(-tangent.y(), tangent.x());
-            
-            // Calculate left and right edge points
-            leftEdge[i] = pos + perp * hw;
-            rightEdge[i] = pos - perp * hw;
-        }
-        
-        // Build polygon: left edge forward, then right edge backward
-        result.polygon.reserve(n * 2);
-        
-        for (int i = 0; i < n; ++i) {
-            result.polygon << leftEdge[i];
-        }
-        for (int i = n - 1; i >= 0; --i) {
-            result.polygon << rightEdge[i];
-        }
+        // Minimum-width floor is applied in DocumentViewport at capture
+        // time, so the kernel uses the stored pressure as-is.
+        result.polygon.resize(StrokeOutlineKernel::vertexCount(n));
+        StrokeOutlineKernel::Caps caps;
+        StrokeOutlineKernel::build(stroke.points.xData(), stroke.points.yData(),
+                                   stroke.points.pressureData(), n,
+                                   stroke.baseThickness, result.polygon.data(), caps);
         
-        // Set up round cap information
-        // Use first/last smoothed points (which equal the original stroke endpoints,
-        // since Catmull-Rom passes through its control points)
         result.hasRoundCaps = true;
-        result.startCapCenter = pts.first().pos;
-        result.startCapRadius = halfWidths[0];
-        result.endCapCenter = pts.last().pos;
-        result.endCapRadius = halfWidths[n - 1];
+        result.startCapCenter = caps.startCenter;
+        result.startCapRadius = caps.startRadius;
+        result.endCapCenter = caps.endCenter;
+        result.endCapRadius = caps.endRadius;
         
         return result;
     }
@@ -315,7 +323,7 @@ public:
         // matching the contract of renderExcluding.
         painter.save();
         for (const auto& stroke : m_strokes) {
-            renderStroke(painter, stroke);
+            renderCachedStroke(painter, stroke);
         }
         painter.restore();
     }
@@ -333,8 +341,15 @@ public:
      * where the caps overlap the stroke body.
      */
     static void renderStroke(QPainter& painter, const VectorStroke& stroke) {
-        StrokePolygonResult poly = buildStrokePolygon(stroke);
-        
+        renderStroke(painter, stroke, buildStrokePolygon(stroke));
+    }
+    
+    /**
+     * @brief Render a single stroke from an already built outline.
+     * @param poly Result of buildStrokePolygon(stroke) (or outlineFor()).
+     */
+    static void renderStroke(QPainter& painter, const VectorStroke& stroke,
+                             const StrokePolygonResult& poly) {
         if (poly.isSinglePoint) {
             // Single point - draw a dot (no alpha compounding issue)
             painter.setPen(Qt::NoPen);
@@ -369,6 +384,16 @@ public:
             QTransform xform = painter.transform();
             QRectF mappedBounds = xform.mapRect(bounds);
             
+            // Only the part inside the clip can reach the target. Clipped
+            // renders (eraser patches, focus cache, tiled rebuilds) thus get
+            // a buffer the size of the visible piece, not the whole stroke.
+            if (painter.hasClipping()) {
+                mappedBounds &= xform.mapRect(painter.clipBoundingRect()).adjusted(-1, -1, 1, 1);
+                if (mappedBounds.isEmpty()) {
+                    return;
+                }
+            }
+            
             qreal dpr = painter.device() ? painter.device()->devicePixelRatioF() : 1.0;
             int bufW = static_cast<int>(mappedBounds.width() * dpr) + 2;
             int bufH = static_cast<int>(mappedBounds.height() * dpr) + 2;
@@ -382,13 +407,22 @@ public:
                 return;
             }
             
-            QPixmap tempBuffer(bufW, bufH);
-            tempBuffer.setDevicePixelRatio(dpr);
-            tempBuffer.fill(Qt::transparent);
+            // Reuse this thread's scratch buffer; only the bufW x bufH corner
+            // is cleared and composited.
+            QImage oversized;
+            QImage* tempBuffer = TranslucentScratch::acquire(bufW, bufH);
+            if (!tempBuffer) {
+                oversized = QImage(bufW, bufH, QImage::Format_ARGB32_Premultiplied);
+                tempBuffer = &oversized;
+            }
+            for (int y = 0; y < bufH; ++y) {
+                std::memset(tempBuffer->scanLine(y), 0, static_cast<size_t>(bufW) * 4);
+            }
+            tempBuffer->setDevicePixelRatio(dpr);
             
             // Transform chain: input coords → device logical coords (xform)
             //                  → buffer coords (translate by -mappedBounds.topLeft)
-            QPainter tempPainter(&tempBuffer);
+            QPainter tempPainter(tempBuffer);
             tempPainter.setRenderHint(QPainter::Antialiasing, true);
             tempPainter.translate(-mappedBounds.topLeft());
             tempPainter.setTransform(xform, true);
@@ -407,7 +441,8 @@ public:
             painter.save();
             painter.resetTransform();
             painter.setOpacity(strokeAlpha / 255.0);
-            painter.drawPixmap(mappedBounds.topLeft(), tempBuffer);
+            painter.drawImage(QRectF(mappedBounds.topLeft(), QSizeF(bufW / dpr, bufH / dpr)),
+                              *tempBuffer, QRectF(0, 0, bufW, bufH));
             painter.restore();
         } else {
             // Standard rendering for opaque strokes (no alpha compounding issue)
@@ -429,9 +464,11 @@ public:
     
     /**
      * @brief Serialize layer to JSON.
+     * @param includeStrokes If false, the "strokes" array is omitted (used when
+     *        strokes are persisted in a binary sidecar, see StrokeBinaryCodec).
      * @return JSON object containing layer data.
      */
-    QJsonObject toJson() const {
+    QJsonObject toJson(bool includeStrokes = true) const {
         QJsonObject obj;
         obj["id"] = id;
         obj["name"] = name;
@@ -439,11 +476,13 @@ public:
         obj["opacity"] = opacity;
         obj["locked"] = locked;
         
-        QJsonArray strokesArray;
-        for (const auto& stroke : m_strokes) {
-            strokesArray.append(stroke.toJson());
+        if (includeStrokes) {
+            QJsonArray strokesArray;
+            for (const auto& stroke : m_strokes) {
+                strokesArray.append(stroke.toJson());
+            }
+            obj["strokes"] = strokesArray;
         }
-        obj["strokes"] = strokesArray;
         
         return obj;
     }
@@ -496,6 +535,16 @@ public:
     ///   (avoids rebuilding the focus pixmap every frame).
     enum class RenderTier { Capped, Focus, Direct };
 
+    /// How ensureStrokeCacheValid() rebuilds the capped cache.
+    /// - Sync: render on the calling thread before returning (exports,
+    ///   thumbnails, anything that needs the final pixels now).
+    /// - Background: when only the resolution changed (zoom/DPR/size) and
+    ///   the current cache content is still correct, keep it and render the
+    ///   new one on the thread pool (StrokeCacheRasterizer); the finished
+    ///   image is swapped in by a later ensureStrokeCacheValid() call.
+    ///   Content changes still rebuild synchronously.
+    enum class CacheRebuild { Sync, Background };
+
     /**
      * @brief Ensure stroke cache is valid for the given size, zoom, and DPI.
      * @param size The target size in logical pixels (page size).
@@ -507,12 +556,16 @@ public:
      * to prevent extreme memory usage at high zoom levels.
      * If the cache is valid but has pending strokes (from addStroke), those are
      * rendered incrementally without rebuilding the entire cache.
-     * If cache is invalid, wrong size, or wrong zoom, rebuilds from scratch.
+     * If cache is invalid, wrong size, or wrong zoom, rebuilds from scratch
+     * (possibly in the background, see CacheRebuild).
      */
-    void ensureStrokeCacheValid(const QSizeF& size, qreal zoom, qreal dpr) {
+    void ensureStrokeCacheValid(const QSizeF& size, qreal zoom, qreal dpr,
+                                CacheRebuild mode = CacheRebuild::Sync) {
         int divisor = computeCacheDivisor(size, zoom, dpr);
         QSize physicalSize = cappedPhysicalSize(size, zoom, dpr, divisor);
         
+        collectBackgroundRebuild();
+        
         // Fast path: cache is valid and has pending strokes to append
         if (m_pendingStrokeStart >= 0 && !m_strokeCacheDirty &&
             m_strokeCache.size() == physicalSize &&
@@ -532,7 +585,19 @@ public:
             return;  // Cache is valid
         }
         
+        // Only the resolution is off: the cached strokes are still right, so
+        // keep them on screen (scaled) while the new cache renders off-thread.
+        // A cache covering another page/tile size cannot be stretched over
+        // this one and is rebuilt right away.
+        if (mode == CacheRebuild::Background &&
+            !m_strokeCacheDirty && !m_strokeCache.isNull() && m_cacheSize == size) {
+            appendPendingStrokes();
+            startBackgroundRebuild(size, zoom, dpr, divisor, physicalSize);
+            return;
+        }
+        
         // Full rebuild needed (dirty, size changed, or zoom changed)
+        cancelBackgroundRebuild();
         m_pendingStrokeStart = -1;
         rebuildStrokeCache(size, zoom, dpr);
     }
@@ -556,12 +621,23 @@ public:
         return !m_strokeCacheDirty && !m_strokeCache.isNull() && qFuzzyCompare(m_cacheZoom, zoom);
     }
     
+    /**
+     * @brief True while a background cache rebuild is running or waiting to
+     *        be swapped in (the viewport keeps repainting until it lands).
+     */
+    bool isBackgroundRebuildPending() const { return m_cacheRebuild.active; }
+    
     /**
      * @brief Invalidate stroke cache (call when strokes change destructively).
      * Note: This only marks the cache dirty, it does NOT free memory.
-     * Used by removeStroke() and clear(). addStroke() uses incremental updates instead.
+     * Used by setStrokes() and clear(). addStroke()/removeStroke() use
+     * incremental updates instead.
      */
     void invalidateStrokeCache() {
+        // Strokes may have been added, removed or moved behind our back
+        // (see strokes()), so the spatial index is stale as well.
+        m_spatialIndex.invalidate();
+        cancelBackgroundRebuild();
         m_strokeCacheDirty = true;
         m_pendingStrokeStart = -1;  // Incremental update no longer possible
         // The focus cache is sourced from the same stroke list, so any
@@ -575,12 +651,14 @@ public:
      * The cache will be rebuilt lazily when the page becomes visible again.
      */
     void releaseStrokeCache() {
+        cancelBackgroundRebuild();
         m_strokeCache = QPixmap();  // Actually free the pixmap memory
         m_strokeCacheDirty = true;
         m_pendingStrokeStart = -1;
         m_cacheZoom = 0;
         m_cacheDpr = 0;
         m_cacheDivisor = 1;
+        m_cacheSize = QSizeF();
     }
 
     /**
@@ -589,6 +667,85 @@ public:
      */
     bool hasStrokeCacheAllocated() const { return !m_strokeCache.isNull(); }
 
+    /// QPixmap::cacheKey() of the capped cache; identifies it to CacheBudget.
+    qint64 strokeCacheKey() const { return m_strokeCache.cacheKey(); }
+
+    /// Bytes held by the capped cache pixmap.
+    qint64 strokeCacheBytes() const { return pixmapBytes(m_strokeCache); }
+
+    /**
+     * @brief Record that a paint used this layer's caches.
+     * @param nowMs CacheBudget::nowMs() of the paint.
+     *
+     * Stamped by DocumentViewport; orders eviction under the global budget.
+     */
+    void markCacheUsed(qint64 nowMs) const { m_cacheLastUse = nowMs; }
+
+    /// Time of the last markCacheUsed() (0 = never).
+    qint64 cacheLastUse() const { return m_cacheLastUse; }
+
+    // ===== Outline Cache =====
+
+    /// Per-layer budget for cached stroke outlines. A typical 30-point
+    /// handwriting stroke costs ~4 KB, so this holds a few thousand strokes.
+    static constexpr qint64 OUTLINE_CACHE_BUDGET = 16 * 1024 * 1024;
+
+    /**
+     * @brief Outline of @p stroke, served from the layer's outline cache.
+     * @param stroke A stroke of this layer.
+     *
+     * Outlines are built in page/tile space, so one entry serves every zoom
+     * level, DPR and cache tier. An entry is reused as long as the stroke's
+     * point revision (StrokePointStore::revision) and thickness match, so
+     * moving, transforming or editing a stroke through strokes() is picked
+     * up without an explicit invalidation. Least recently used entries are
+     * evicted once OUTLINE_CACHE_BUDGET is exceeded.
+     *
+     * Not thread-safe: worker threads should call buildStrokePolygon().
+     */
+    StrokePolygonResult outlineFor(const VectorStroke& stroke) const {
+        auto it = m_outlineCache.find(stroke.id);
+        if (it != m_outlineCache.end() &&
+            it->revision == stroke.points.revision() &&
+            it->thickness == stroke.baseThickness) {
+            it->lastUse = ++m_outlineCacheTick;
+            return it->poly;
+        }
+
+        StrokePolygonResult poly = buildStrokePolygon(stroke);
+        if (it != m_outlineCache.end()) {
+            m_outlineCacheBytes -= it->bytes;
+        } else {
+            it = m_outlineCache.insert(stroke.id, CachedOutline());
+        }
+        it->revision = stroke.points.revision();
+        it->thickness = stroke.baseThickness;
+        it->lastUse = ++m_outlineCacheTick;
+        it->bytes = outlineBytes(stroke.id, poly);
+        it->poly = poly;
+        m_outlineCacheBytes += it->bytes;
+
+        if (m_outlineCacheBytes > OUTLINE_CACHE_BUDGET) {
+            evictOutlines();
+        }
+        return poly;
+    }
+
+    /**
+     * @brief Free all cached outlines (pages far from the viewport).
+     */
+    void releaseOutlineCache() {
+        m_outlineCache.clear();
+        m_outlineCacheBytes = 0;
+    }
+
+    /// Bytes currently held by the outline cache (approximate).
+    qint64 outlineCacheBytes() const { return m_outlineCacheBytes; }
+
+    /// Identifies the outline cache to CacheBudget. Negative, so it never
+    /// equals a QPixmap::cacheKey().
+    qint64 outlineCacheKey() const { return m_outlineCacheKey; }
+
     // ===== Focus Cache (viewport-clipped, high-zoom path) =====
 
     /**
@@ -596,6 +753,12 @@ public:
      */
     bool hasFocusCacheAllocated() const { return !m_focusCache.isNull(); }
 
+    /// QPixmap::cacheKey() of the focus cache; identifies it to CacheBudget.
+    qint64 focusCacheKey() const { return m_focusCache.cacheKey(); }
+
+    /// Bytes held by the focus cache pixmap.
+    qint64 focusCacheBytes() const { return pixmapBytes(m_focusCache); }
+
     /**
      * @brief Mark the focus cache dirty without freeing the pixmap.
      */
@@ -697,8 +860,8 @@ public:
         p.fillRect(clearRect, Qt::transparent);
         p.setCompositionMode(QPainter::CompositionMode_SourceOver);
         p.setClipRect(clearRect);
-        for (const auto& s : m_strokes) {
-            if (s.boundingBox.intersects(clearRect)) renderStroke(p, s);
+        for (int i : strokeIndicesIntersecting(clearRect)) {
+            renderCachedStroke(p, m_strokes[i]);
         }
     }
     
@@ -714,15 +877,34 @@ public:
      * If the painter is pre-scaled by zoom, the result is that each cache pixel maps
      * to exactly one physical screen pixel, giving sharp rendering at any zoom level.
      * New strokes are rendered incrementally to the existing cache (no full rebuild).
+     * In CacheRebuild::Background mode a cache built at the previous zoom is
+     * stretched over the page until the rebuilt one is swapped in.
      */
-    void renderWithZoomCache(QPainter& painter, const QSizeF& size, qreal zoom, qreal dpr) {
+    void renderWithZoomCache(QPainter& painter, const QSizeF& size, qreal zoom, qreal dpr,
+                             CacheRebuild mode = CacheRebuild::Sync) {
         if (!visible || m_strokes.isEmpty()) {
             return;
         }
         
-        ensureStrokeCacheValid(size, zoom, dpr);
+        ensureStrokeCacheValid(size, zoom, dpr, mode);
+        
+        // Drawn 1:1 only if built for exactly these parameters: the same
+        // zoom can still need another divisor or target size (resize)
+        const int divisor = computeCacheDivisor(size, zoom, dpr);
+        const bool exactCache = m_strokeCache.size() == cappedPhysicalSize(size, zoom, dpr, divisor) &&
+                                m_cacheDivisor == divisor &&
+                                qFuzzyCompare(m_cacheZoom, zoom) &&
+                                qFuzzyCompare(m_cacheDpr, dpr);
         
-        if (!m_strokeCache.isNull()) {
+        if (!m_strokeCache.isNull() && !exactCache) {
+            // Stale resolution while the background rebuild runs (same
+            // page/tile size, see ensureStrokeCacheValid)
+            painter.save();
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+            painter.drawPixmap(QRectF(QPointF(0, 0), size), m_strokeCache,
+                               QRectF(m_strokeCache.rect()));
+            painter.restore();
+        } else if (!m_strokeCache.isNull()) {
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
             // Qt5: cache DPR is clamped to max(1.0, rawScale). When the
             // cache DPR was NOT clamped (rawScale >= 1.0), the pixmap's
@@ -735,7 +917,6 @@ public:
             // Only fall back to the QRectF overload when DPR was clamped
             // (rawScale < 1.0, i.e. zoomed out) where the logical size
             // mismatch requires explicit rect mapping.
-            int divisor = computeCacheDivisor(size, zoom, dpr);
             if (zoom * dpr / divisor >= 1.0) {
                 painter.drawPixmap(0, 0, m_strokeCache);
             } else {
@@ -784,7 +965,7 @@ public:
         painter.setRenderHint(QPainter::Antialiasing, true);
         for (const VectorStroke& stroke : m_strokes) {
             if (!excludeIds.contains(stroke.id)) {
-                renderStroke(painter, stroke);
+                renderCachedStroke(painter, stroke);
             }
         }
         painter.restore();
@@ -805,10 +986,8 @@ public:
     void renderDirectClipped(QPainter& painter, const QRectF& clipRect) const {
         if (!visible || m_strokes.isEmpty()) return;
         painter.setRenderHint(QPainter::Antialiasing, true);
-        for (const auto& s : m_strokes) {
-            if (s.boundingBox.intersects(clipRect)) {
-                renderStroke(painter, s);
-            }
+        for (int i : strokeIndicesIntersecting(clipRect)) {
+            renderCachedStroke(painter, m_strokes[i]);
         }
     }
 
@@ -817,20 +996,18 @@ public:
      *        IDs in excludeIds skipped.
      *
      * Replaces the unbounded `renderExcluding` path on the lasso source layer
-     * at high zoom. Same complexity class as `renderExcluding` (one bbox test
-     * per stroke), but stroke rasterisation only fires for strokes inside the
-     * focus rect.
+     * at high zoom. Only strokes the spatial index places inside the focus
+     * rect are visited.
      */
     void renderDirectExcludingClipped(QPainter& painter,
                                       const QSet<QString>& excludeIds,
                                       const QRectF& clipRect) const {
         if (!visible || m_strokes.isEmpty()) return;
         painter.setRenderHint(QPainter::Antialiasing, true);
-        for (const auto& s : m_strokes) {
+        for (int i : strokeIndicesIntersecting(clipRect)) {
+            const VectorStroke& s = m_strokes[i];
             if (excludeIds.contains(s.id)) continue;
-            if (s.boundingBox.intersects(clipRect)) {
-                renderStroke(painter, s);
-            }
+            renderCachedStroke(painter, s);
         }
     }
 
@@ -850,7 +1027,8 @@ public:
     void renderTiered(QPainter& painter, const QSizeF& size,
                       qreal zoom, qreal dpr,
                       RenderTier tier,
-                      const QRectF& focusRect = QRectF()) {
+                      const QRectF& focusRect = QRectF(),
+                      CacheRebuild mode = CacheRebuild::Sync) {
         if (!visible || m_strokes.isEmpty()) return;
         // Symmetric to DocumentViewport releasing the capped cache before
         // calling us with tier != Capped: when the dispatcher picks Capped,
@@ -863,7 +1041,7 @@ public:
         case RenderTier::Capped:
             // Delegate to the existing path; preserves the Qt5 rect-mapping
             // sub-pixel correction (see renderWithZoomCache).
-            renderWithZoomCache(painter, size, zoom, dpr);
+            renderWithZoomCache(painter, size, zoom, dpr, mode);
             break;
         case RenderTier::Focus: {
             ensureFocusCacheValid(size, zoom, dpr, focusRect);
@@ -920,80 +1098,106 @@ public:
 private:
     QVector<VectorStroke> m_strokes;  ///< All strokes in this layer
     
-    // ===== Curve Smoothing =====
+    // ===== Spatial Index =====
+    
+    /// Grid + id lookup over m_strokes. Maintained incrementally by
+    /// addStroke()/removeStroke(); anything else marks it stale and it is
+    /// rebuilt lazily by the next query. Mutable because queries are const.
+    mutable StrokeSpatialIndex m_spatialIndex;
+    
+    const StrokeSpatialIndex& ensureSpatialIndex() const {
+        if (!m_spatialIndex.isValid()) {
+            m_spatialIndex.rebuild(m_strokes);
+        }
+        return m_spatialIndex;
+    }
+    
+    // ===== Outline Cache (see outlineFor) =====
+    
+    struct CachedOutline {
+        quint64 revision = 0;   ///< StrokePointStore::revision() it was built from
+        qreal thickness = 0;    ///< baseThickness it was built with
+        quint64 lastUse = 0;    ///< m_outlineCacheTick at last hit (LRU order)
+        qint64 bytes = 0;       ///< Accounted size
+        StrokePolygonResult poly;
+    };
+    
+    /// Keyed by stroke id. Entries of strokes deleted through strokes() are
+    /// not dropped eagerly; they age out through LRU eviction.
+    mutable QHash<QString, CachedOutline> m_outlineCache;
+    mutable qint64 m_outlineCacheBytes = 0;
+    mutable quint64 m_outlineCacheTick = 0;
+    qint64 m_outlineCacheKey = -s_nextOutlineCacheKey.fetch_add(1);
+    static inline std::atomic<qint64> s_nextOutlineCacheKey{1};
     
-    /// Number of interpolated points to insert between each pair of stored points.
-    /// Higher values produce smoother curves at high zoom, at the cost of more
-    /// polygon vertices (which are cached, so the per-frame cost is zero).
-    /// 4 subdivisions keeps segments under ~4 screen pixels at 10x zoom.
-    static constexpr int CURVE_SUBDIVISIONS = 4;
+    static qint64 outlineBytes(const QString& id, const StrokePolygonResult& poly) {
+        return static_cast<qint64>(poly.polygon.capacity()) * sizeof(QPointF)
+             + id.size() * sizeof(QChar)
+             + sizeof(CachedOutline) + 32;  // hash node overhead
+    }
+    
+    void renderCachedStroke(QPainter& painter, const VectorStroke& stroke) const {
+        renderStroke(painter, stroke, outlineFor(stroke));
+    }
+    
+    void dropCachedOutline(const QString& strokeId) {
+        auto it = m_outlineCache.find(strokeId);
+        if (it != m_outlineCache.end()) {
+            m_outlineCacheBytes -= it->bytes;
+            m_outlineCache.erase(it);
+        }
+    }
     
     /**
-     * @brief Subdivide stroke points using uniform Catmull-Rom interpolation.
-     * @param points The original (decimated) stroke points.
-     * @return A denser point sequence following a smooth curve through the originals.
-     * 
-     * Interpolates both position and pressure. Endpoint tangents are computed
-     * by duplicating the first/last control point (zero-acceleration boundary).
-     * Interpolated pressure is clamped to [0.1, 1.0] to prevent overshoot.
+     * @brief Evict least recently used outlines down to 3/4 of the budget.
+     *
+     * Evicting in one batch keeps the sort off the per-stroke path: a full
+     * rebuild of an over-budget layer sorts once per quarter budget.
      */
-    static QVector<StrokePoint> catmullRomSubdivide(const QVector<StrokePoint>& points) {
-        const int n = static_cast<int>(points.size());
-        if (n < 3) return points;  // Straight lines don't benefit from smoothing
-        
-        QVector<StrokePoint> result;
-        result.reserve((n - 1) * CURVE_SUBDIVISIONS + 1);
-        
-        for (int i = 0; i < n - 1; ++i) {
-            // Four control points: P0, P1, P2, P3
-            // Clamp at boundaries (duplicate endpoint)
-            const StrokePoint& p0 = points[qMax(0, i - 1)];
-            const StrokePoint& p1 = points[i];
-            const StrokePoint& p2 = points[i + 1];
-            const StrokePoint& p3 = points[qMin(n - 1, i + 2)];
-            
-            // Include start point of the first segment
-            if (i == 0) {
-                result.append(p1);
-            }
-            
-            // Interpolate CURVE_SUBDIVISIONS points between p1 and p2
-            for (int s = 1; s <= CURVE_SUBDIVISIONS; ++s) {
-                qreal t = static_cast<qreal>(s) / CURVE_SUBDIVISIONS;
-                qreal t2 = t * t;
-                qreal t3 = t2 * t;
-                
-                // Uniform Catmull-Rom: q(t) = 0.5 * [ (2·P1) + (-P0+P2)·t
-                //   + (2·P0 - 5·P1 + 4·P2 - P3)·t² + (-P0 + 3·P1 - 3·P2 + P3)·t³ ]
-                qreal x = 0.5 * (2.0 * p1.pos.x()
-                    + (-p0.pos.x() + p2.pos.x()) * t
-                    + (2.0 * p0.pos.x() - 5.0 * p1.pos.x() + 4.0 * p2.pos.x() - p3.pos.x()) * t2
-                    + (-p0.pos.x() + 3.0 * p1.pos.x() - 3.0 * p2.pos.x() + p3.pos.x()) * t3);
-                qreal y = 0.5 * (2.0 * p1.pos.y()
-                    + (-p0.pos.y() + p2.pos.y()) * t
-                    + (2.0 * p0.pos.y() - 5.0 * p1.pos.y() + 4.0 * p2.pos.y() - p3.pos.y()) * t2
-                    + (-p0.pos.y() + 3.0 * p1.pos.y() - 3.0 * p2.pos.y() + p3.pos.y()) * t3);
-                qreal pr = 0.5 * (2.0 * p1.pressure
-                    + (-p0.pressure + p2.pressure) * t
-                    + (2.0 * p0.pressure - 5.0 * p1.pressure + 4.0 * p2.pressure - p3.pressure) * t2
-                    + (-p0.pressure + 3.0 * p1.pressure - 3.0 * p2.pressure + p3.pressure) * t3);
-                
-                StrokePoint pt;
-                pt.pos = QPointF(x, y);
-                pt.pressure = qBound(0.1, pr, 1.0);
-                result.append(pt);
-            }
+    void evictOutlines() const {
+        QVector<QPair<quint64, QString>> byAge;
+        byAge.reserve(m_outlineCache.size());
+        for (auto it = m_outlineCache.cbegin(); it != m_outlineCache.cend(); ++it) {
+            byAge.append(qMakePair(it->lastUse, it.key()));
         }
+        std::sort(byAge.begin(), byAge.end());
         
-        return result;
+        const qint64 target = OUTLINE_CACHE_BUDGET * 3 / 4;
+        for (const auto& entry : byAge) {
+            if (m_outlineCacheBytes <= target) break;
+            auto it = m_outlineCache.find(entry.second);
+            m_outlineCacheBytes -= it->bytes;
+            m_outlineCache.erase(it);
+        }
     }
     
+    static qint64 pixmapBytes(const QPixmap& pixmap) {
+        return static_cast<qint64>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    }
+
+    mutable qint64 m_cacheLastUse = 0;      ///< Last paint using the caches (CacheBudget::nowMs())
+
     // Stroke cache for performance (Task 1.3.7 + Zoom-Aware + Incremental)
     mutable QPixmap m_strokeCache;          ///< Cached rendered strokes at current zoom
     mutable bool m_strokeCacheDirty = true; ///< Whether cache needs full rebuild
     mutable qreal m_cacheZoom = 1.0;        ///< Zoom level cache was built at
     mutable qreal m_cacheDpr = 1.0;         ///< DPI ratio cache was built at
     mutable int m_cacheDivisor = 1;         ///< Integer divisor applied for resolution cap
+    mutable QSizeF m_cacheSize;             ///< Page/tile size the cache covers
+
+    /// Capped-cache rebuild running on the thread pool (CacheRebuild::Background).
+    struct BackgroundRebuild {
+        bool active = false;
+        QFuture<QImage> image;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        QSize physicalSize;
+        QSizeF size;
+        qreal zoom = 0;
+        qreal dpr = 0;
+        int divisor = 1;
+        int strokeCount = 0;                ///< m_strokes.size() at snapshot time
+    };
+    mutable BackgroundRebuild m_cacheRebuild;
 
     // Viewport-clipped focus cache (high-zoom path). When the capped cache
     // would have to apply a divisor > 1 (effective scale * pageMaxDim >
@@ -1084,7 +1288,7 @@ private:
         applyCachePainterScale(cachePainter, m_cacheZoom * m_cacheDpr / m_cacheDivisor);
         
         for (int i = m_pendingStrokeStart; i < m_strokes.size(); ++i) {
-            renderStroke(cachePainter, m_strokes[i]);
+            renderCachedStroke(cachePainter, m_strokes[i]);
         }
         
         m_pendingStrokeStart = -1;
@@ -1103,6 +1307,9 @@ private:
         // Patch (or invalidate) the focus cache regardless of capped-cache
         // state - the two caches are independent.
         patchFocusCacheAfterRemoval(removedBounds);
+        
+        // A background rebuild snapshotted the stroke list before the removal
+        cancelBackgroundRebuild();
 
         // Cannot patch if cache is not in a usable state
         if (m_strokeCacheDirty || m_strokeCache.isNull() ||
@@ -1128,10 +1335,8 @@ private:
         cachePainter.setClipRect(removedBounds);
         cachePainter.setRenderHint(QPainter::Antialiasing, true);
         
-        for (const auto& stroke : m_strokes) {
-            if (stroke.boundingBox.intersects(removedBounds)) {
-                renderStroke(cachePainter, stroke);
-            }
+        for (int i : strokeIndicesIntersecting(removedBounds)) {
+            renderCachedStroke(cachePainter, m_strokes[i]);
         }
     }
     
@@ -1187,10 +1392,8 @@ private:
         beginFocusPainter(p);
         // Cull to the visible rect so per-stroke renderStroke can early-exit.
         p.setClipRect(focusRect);
-        for (const auto& stroke : m_strokes) {
-            if (stroke.boundingBox.intersects(focusRect)) {
-                renderStroke(p, stroke);
-            }
+        for (int i : strokeIndicesIntersecting(focusRect)) {
+            renderCachedStroke(p, m_strokes[i]);
         }
     }
 
@@ -1204,12 +1407,81 @@ private:
         p.setClipRect(m_focusRect);
         for (int i = m_focusPendingStrokeStart; i < m_strokes.size(); ++i) {
             if (m_strokes[i].boundingBox.intersects(m_focusRect)) {
-                renderStroke(p, m_strokes[i]);
+                renderCachedStroke(p, m_strokes[i]);
             }
         }
         m_focusPendingStrokeStart = -1;
     }
 
+    /**
+     * @brief Start rendering the capped cache for new parameters off-thread.
+     *
+     * The stroke list is snapshotted by implicit-sharing copy. Any change
+     * that is not a plain append (removal, invalidateStrokeCache) cancels
+     * the job; appends made meanwhile are replayed onto the new cache as
+     * pending strokes when it is swapped in.
+     */
+    void startBackgroundRebuild(const QSizeF& size, qreal zoom, qreal dpr, int divisor,
+                                const QSize& physicalSize) const {
+        if (m_cacheRebuild.active && m_cacheRebuild.physicalSize == physicalSize &&
+            m_cacheRebuild.divisor == divisor &&
+            qFuzzyCompare(m_cacheRebuild.zoom, zoom) &&
+            qFuzzyCompare(m_cacheRebuild.dpr, dpr)) {
+            return;  // Already rendering these parameters
+        }
+        cancelBackgroundRebuild();
+        
+        m_cacheRebuild.active = true;
+        m_cacheRebuild.cancelled = std::make_shared<std::atomic<bool>>(false);
+        m_cacheRebuild.physicalSize = physicalSize;
+        m_cacheRebuild.size = size;
+        m_cacheRebuild.zoom = zoom;
+        m_cacheRebuild.dpr = dpr;
+        m_cacheRebuild.divisor = divisor;
+        m_cacheRebuild.strokeCount = static_cast<int>(m_strokes.size());
+        m_cacheRebuild.image = StrokeCacheRasterizer::renderAsync(
+            m_strokes, physicalSize, zoom * dpr / divisor, m_cacheRebuild.cancelled);
+    }
+    
+    void cancelBackgroundRebuild() const {
+        if (!m_cacheRebuild.active) return;
+        // The worker keeps its own snapshot; the flag just stops it early.
+        m_cacheRebuild.cancelled->store(true, std::memory_order_relaxed);
+        m_cacheRebuild = BackgroundRebuild();
+    }
+    
+    /**
+     * @brief Swap in a finished background rebuild (GUI thread only:
+     *        converts the image to the cache QPixmap).
+     */
+    void collectBackgroundRebuild() const {
+        if (!m_cacheRebuild.active || !m_cacheRebuild.image.isFinished()) return;
+        BackgroundRebuild job = m_cacheRebuild;
+        m_cacheRebuild = BackgroundRebuild();
+        
+        QImage image = job.image.result();
+        if (image.isNull() || m_strokeCacheDirty) return;
+        
+        QPixmap pixmap = QPixmap::fromImage(std::move(image));
+        if (pixmap.isNull()) return;
+        const qreal rawScale = job.zoom * job.dpr / job.divisor;
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+        // Same DPR clamp as rebuildStrokeCache (the rasterizer already
+        // applied the full scale to the pixels).
+        pixmap.setDevicePixelRatio(qMax(1.0, rawScale));
+#else
+        pixmap.setDevicePixelRatio(rawScale);
+#endif
+        m_strokeCache = pixmap;
+        m_cacheZoom = job.zoom;
+        m_cacheDpr = job.dpr;
+        m_cacheDivisor = job.divisor;
+        m_cacheSize = job.size;
+        // Strokes added since the snapshot were painted onto the old cache;
+        // replay them onto the new one.
+        m_pendingStrokeStart = m_strokes.size() > job.strokeCount ? job.strokeCount : -1;
+    }
+
     void rebuildStrokeCache(const QSizeF& size, qreal zoom, qreal dpr) const {
         int divisor = computeCacheDivisor(size, zoom, dpr);
         QSize physicalSize = cappedPhysicalSize(size, zoom, dpr, divisor);
@@ -1235,6 +1507,7 @@ private:
             m_cacheZoom = zoom;
             m_cacheDpr = dpr;
             m_cacheDivisor = divisor;
+            m_cacheSize = size;
             return;
         }
         
@@ -1243,13 +1516,14 @@ private:
         applyCachePainterScale(cachePainter, rawScale);
         
         for (const auto& stroke : m_strokes) {
-            renderStroke(cachePainter, stroke);
+            renderCachedStroke(cachePainter, stroke);
         }
         
         m_strokeCacheDirty = false;
         m_cacheZoom = zoom;
         m_cacheDpr = dpr;
         m_cacheDivisor = divisor;
+        m_cacheSize = size;
     }
     
     static int computeCacheDivisor(const QSizeF& size, qreal zoom, qreal dpr) {
@@ -0,0 +1,291 @@
+// ============================================================================
+// ImageMipCache - Implementation
+// ============================================================================
+
+#include "ImageMipCache.h"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QtConcurrent>
+
+#include <atomic>
+
+ImageMipCache* ImageMipCache::s_instance = nullptr;
+int ImageMipCache::s_asyncDepth = 0;
+
+ImageMipCache::ImageMipCache(QObject* parent)
+    : QObject(parent)
+{
+    CacheBudget::instance()->addClient(this);
+}
+
+ImageMipCache* ImageMipCache::instance()
+{
+    if (!s_instance) {
+        s_instance = new ImageMipCache();
+    }
+    return s_instance;
+}
+
+quint64 ImageMipCache::newSourceId()
+{
+    static std::atomic<quint64> s_nextId{1};
+    return s_nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ===== Level Geometry =====
+
+QSize ImageMipCache::levelSize(const QSize& sourceSize, int level)
+{
+    if (level <= 0) {
+        return sourceSize;
+    }
+    const int divisor = 1 << level;
+    return QSize(qMax(1, (sourceSize.width() + divisor - 1) / divisor),
+                 qMax(1, (sourceSize.height() + divisor - 1) / divisor));
+}
+
+int ImageMipCache::levelCount(const QSize& sourceSize)
+{
+    int count = 1;
+    while (count < 16) {
+        const QSize next = levelSize(sourceSize, count);
+        if (next.width() < MIN_LEVEL_EDGE || next.height() < MIN_LEVEL_EDGE) {
+            break;
+        }
+        ++count;
+    }
+    return count;
+}
+
+int ImageMipCache::levelFor(const QSize& sourceSize, const QSizeF& devicePixels)
+{
+    // Allow a sliver of upscaling so rounding never forces the next finer level
+    const qreal needW = devicePixels.width() * 0.98;
+    const qreal needH = devicePixels.height() * 0.98;
+
+    const int count = levelCount(sourceSize);
+    int level = 0;
+    for (int k = 1; k < count; ++k) {
+        const QSize size = levelSize(sourceSize, k);
+        if (size.width() < needW || size.height() < needH) {
+            break;
+        }
+        level = k;
+    }
+    return level;
+}
+
+// ===== Decoding =====
+
+QImage ImageMipCache::decode(const Source& source, const QSize& sourceSize, int level)
+{
+    const QSize target = levelSize(sourceSize, level);
+    QImage result;
+
+    if (!source.encoded.isEmpty()) {
+        QByteArray data = source.encoded;   // Shallow copy; QBuffer needs non-const
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer);
+        if (level > 0) {
+            // The scaled size applies before any orientation transform
+            QSize scaled = target;
+            if (reader.autoTransform()
+                && (reader.transformation() & QImageIOHandler::TransformationRotate90)) {
+                scaled.transpose();
+            }
+            reader.setScaledSize(scaled);
+        }
+        result = reader.read();
+        if (result.isNull()) {
+            qWarning() << "ImageMipCache: decode failed:" << reader.errorString();
+        }
+    } else if (!source.image.isNull()) {
+        result = (level > 0)
+            ? source.image.scaled(target, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+            : source.image;
+    }
+
+    if (result.isNull()) {
+        return result;
+    }
+
+    // Formats the raster paint engine blits without conversion
+    const QImage::Format format = result.hasAlphaChannel()
+        ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    if (result.format() != format) {
+        result = result.convertToFormat(format);
+    }
+    return result;
+}
+
+// ===== Lookup =====
+
+QImage ImageMipCache::image(quint64 sourceId, const QSize& sourceSize, int level,
+                            const std::function<Source()>& source)
+{
+    const Key key(sourceId, level);
+
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        it->lastUsed = CacheBudget::nowMs();
+        return it->image;
+    }
+
+    if (s_asyncDepth == 0) {
+        const QImage decoded = decode(source(), sourceSize, level);
+        if (!decoded.isNull()) {
+            insert(key, decoded);
+        }
+        return decoded;
+    }
+
+    if (!m_pending.contains(key)) {
+        startDecode(key, source(), sourceSize);
+    }
+
+    // Fallback while decoding: the closest finer level looks sharp, a
+    // coarser one at least shows the picture
+    const QSet<int> levels = m_levelsBySource.value(sourceId);
+    int best = -1;
+    for (int cached : levels) {
+        const bool finer = cached < level;
+        const bool bestFiner = best >= 0 && best < level;
+        if (best < 0
+            || (finer && !bestFiner)
+            || (finer && bestFiner && cached > best)
+            || (!finer && !bestFiner && cached < best)) {
+            best = cached;
+        }
+    }
+    if (best < 0) {
+        return QImage();
+    }
+    Entry& entry = m_entries[Key(sourceId, best)];
+    entry.lastUsed = CacheBudget::nowMs();
+    return entry.image;
+}
+
+void ImageMipCache::startDecode(const Key& key, const Source& source, const QSize& sourceSize)
+{
+    m_pending.insert(key);
+
+    auto* watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, key]() {
+        const QImage decoded = watcher->result();
+        watcher->deleteLater();
+
+        // Released (object unloaded or its image replaced) while decoding
+        if (!m_pending.remove(key) || decoded.isNull()) {
+            return;
+        }
+        insert(key, decoded);
+        emit imageReady();
+    });
+    watcher->setFuture(QtConcurrent::run([source, sourceSize, level = key.second]() {
+        return decode(source, sourceSize, level);
+    }));
+}
+
+// ===== Budget =====
+
+void ImageMipCache::insert(const Key& key, const QImage& image)
+{
+    Entry& entry = m_entries[key];
+    m_usedBytes -= entry.image.sizeInBytes();
+    entry.image = image;
+    entry.lastUsed = CacheBudget::nowMs();
+    m_usedBytes += image.sizeInBytes();
+    m_levelsBySource[key.first].insert(key.second);
+
+    evictToBudget(key);
+    CacheBudget::instance()->requestEnforce();
+}
+
+void ImageMipCache::remove(const Key& key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return;
+    }
+    m_usedBytes -= it->image.sizeInBytes();
+    m_entries.erase(it);
+
+    auto levels = m_levelsBySource.find(key.first);
+    if (levels != m_levelsBySource.end()) {
+        levels->remove(key.second);
+        if (levels->isEmpty()) {
+            m_levelsBySource.erase(levels);
+        }
+    }
+}
+
+void ImageMipCache::evictToBudget(const Key& keep)
+{
+    while (m_usedBytes > m_budgetBytes && !m_entries.isEmpty()) {
+        auto victim = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it.key() != keep
+                && (victim == m_entries.end() || it->lastUsed < victim->lastUsed)) {
+                victim = it;
+            }
+        }
+        if (victim == m_entries.end()) {
+            break;
+        }
+
+        remove(victim.key());
+    }
+}
+
+void ImageMipCache::setBudgetBytes(qint64 bytes)
+{
+    m_budgetBytes = qMax<qint64>(0, bytes);
+    evictToBudget(Key(0, -1));
+}
+
+void ImageMipCache::release(quint64 sourceId)
+{
+    if (sourceId == 0) {
+        return;
+    }
+
+    const QSet<int> levels = m_levelsBySource.value(sourceId);
+    for (int level : levels) {
+        remove(Key(sourceId, level));
+    }
+
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (it->first == sourceId) {
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// ===== CacheBudget::Client =====
+
+// Item keys pack (source id, level); levels are < 16, ids stay far below 2^56.
+
+void ImageMipCache::collectCacheItems(QVector<CacheBudget::Item>& items) const
+{
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        CacheBudget::Item item;
+        item.key = (it.key().first << 8) | static_cast<quint64>(it.key().second);
+        item.bytes = it->image.sizeInBytes();
+        item.lastUse = it->lastUsed;
+        item.rebuildCost = CacheBudget::COST_IMAGE_LEVEL;
+        items.append(item);
+    }
+}
+
+void ImageMipCache::evictCacheItems(const QVector<quint64>& keys)
+{
+    for (quint64 key : keys) {
+        remove(Key(key >> 8, static_cast<int>(key & 0xff)));
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+// ============================================================================
+// ImageMipCache - Shared, budgeted cache of downsampled image object pixels
+// ============================================================================
+// ImageObjects keep only their encoded file bytes (or, for clipboard images,
+// the one full-resolution pixmap). What is actually drawn comes from here:
+// mip levels decoded at the resolution the current zoom needs.
+//
+// Design:
+// - Level k of a source is its pixel size divided by 2^k (rounded up);
+//   level 0 is full resolution and is only decoded when zoomed in that far
+// - Entries are keyed by (source id, level). Every image source gets a
+//   process-unique id, so a reloaded or replaced image never sees stale pixels
+// - All levels of all images share one byte budget; the least recently
+//   drawn levels are evicted first. The cache is also a CacheBudget client,
+//   so the global ceiling can take levels back when other caches need room
+// - Decoding runs on the thread pool when an AsyncScope is active (the
+//   viewport's paintEvent). Meanwhile the nearest cached level is drawn and
+//   imageReady() asks for a repaint. Without a scope (thumbnails, export,
+//   drag caches) a missing level is decoded synchronously, so those renders
+//   are never incomplete
+//
+// Thread safety: GUI thread only. Decoding works on copies of the source.
+// ============================================================================
+
+#include "../core/CacheBudget.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPair>
+#include <QSet>
+#include <QSize>
+
+#include <functional>
+
+class ImageMipCache : public QObject, public CacheBudget::Client {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Pixels to decode one level from.
+     *
+     * Either the encoded file bytes (preferred: scaled decoding is much
+     * cheaper for JPEG) or an already decoded full-resolution image.
+     * Both are implicitly shared, so copying a Source is cheap.
+     */
+    struct Source {
+        QByteArray encoded;
+        QImage image;
+    };
+
+    /**
+     * @brief Makes cache misses decode on the thread pool while alive.
+     *
+     * Scopes nest. Only for renders that are repeated once imageReady()
+     * fires (the viewport); everything else wants complete pixels now.
+     */
+    class AsyncScope {
+    public:
+        AsyncScope() { ++s_asyncDepth; }
+        ~AsyncScope() { --s_asyncDepth; }
+        AsyncScope(const AsyncScope&) = delete;
+        AsyncScope& operator=(const AsyncScope&) = delete;
+    };
+
+    /// The shared instance.
+    static ImageMipCache* instance();
+
+    /// A new process-unique source id (never 0).
+    static quint64 newSourceId();
+
+    /// Number of levels for an image of @p sourceSize (at least 1).
+    static int levelCount(const QSize& sourceSize);
+
+    /// Pixel size of level @p level of an image of @p sourceSize.
+    static QSize levelSize(const QSize& sourceSize, int level);
+
+    /**
+     * @brief Coarsest level that still has at least @p devicePixels.
+     * @param devicePixels On-screen size of the image in device pixels.
+     */
+    static int levelFor(const QSize& sourceSize, const QSizeF& devicePixels);
+
+    /// Decode @p level of @p source (any thread).
+    static QImage decode(const Source& source, const QSize& sourceSize, int level);
+
+    /**
+     * @brief Get pixels for drawing @p level of a source.
+     *
+     * Returns the level itself when cached. Otherwise, inside an AsyncScope,
+     * the decode is queued and the closest cached level is returned (finer
+     * levels first); that may be a null image if none is cached yet. Outside
+     * a scope the level is decoded before returning.
+     * @param source Called only on a miss, to get the pixels to decode from.
+     */
+    QImage image(quint64 sourceId, const QSize& sourceSize, int level,
+                 const std::function<Source()>& source);
+
+    /// Drop every level of a source, and any decode still queued for it.
+    void release(quint64 sourceId);
+
+    /// Budget for all levels together, in bytes.
+    qint64 budgetBytes() const { return m_budgetBytes; }
+    void setBudgetBytes(qint64 bytes);
+
+    /// Bytes currently held.
+    qint64 usedBytes() const { return m_usedBytes; }
+
+    // ===== CacheBudget::Client =====
+    QString cacheName() const override { return QStringLiteral("image levels"); }
+    void collectCacheItems(QVector<CacheBudget::Item>& items) const override;
+    void evictCacheItems(const QVector<quint64>& keys) override;
+
+signals:
+    /// A queued decode finished; renders that used a fallback should repeat.
+    void imageReady();
+
+private:
+    using Key = QPair<quint64, int>;   ///< (source id, level)
+
+    struct Entry {
+        QImage image;
+        qint64 lastUsed = 0;   ///< CacheBudget::nowMs()
+    };
+
+    static constexpr qint64 DEFAULT_BUDGET_BYTES = 256LL * 1024 * 1024;
+    static constexpr int MIN_LEVEL_EDGE = 64;   ///< No levels below this edge length (px)
+
+    explicit ImageMipCache(QObject* parent = nullptr);
+
+    void insert(const Key& key, const QImage& image);
+    void remove(const Key& key);
+    void evictToBudget(const Key& keep);
+    void startDecode(const Key& key, const Source& source, const QSize& sourceSize);
+
+    static ImageMipCache* s_instance;
+    static int s_asyncDepth;
+
+    QHash<Key, Entry> m_entries;
+    QHash<quint64, QSet<int>> m_levelsBySource;   ///< Source id -> cached levels
+    QSet<Key> m_pending;                          ///< Queued decodes
+    qint64 m_budgetBytes = DEFAULT_BUDGET_BYTES;
+    qint64 m_usedBytes = 0;
+};
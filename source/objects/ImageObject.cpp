@@ -5,11 +5,32 @@
 // ============================================================================
 
 #include "ImageObject.h"
+#include "ImageMipCache.h"
+#include <QFile>
 #include <QFileInfo>
 #include <QDir>
 #include <QCryptographicHash>
 #include <QBuffer>
+#include <QImageReader>
 #include <QPainter>
+#include <QtMath>
+
+ImageObject::~ImageObject()
+{
+    // Nothing was ever decoded (e.g. objects created by a background load)
+    // when the id is still 0, so the cache is only touched from the GUI thread.
+    if (m_sourceId != 0) {
+        ImageMipCache::instance()->release(m_sourceId);
+    }
+}
+
+void ImageObject::resetSource()
+{
+    if (m_sourceId != 0) {
+        ImageMipCache::instance()->release(m_sourceId);
+        m_sourceId = 0;
+    }
+}
 
 void ImageObject::render(QPainter& painter, qreal zoom) const
 {
@@ -25,7 +46,7 @@ void ImageObject::render(QPainter& painter, qreal zoom) const
         size.height() * zoom
     );
 
-    if (cachedPixmap.isNull()) {
+    if (!isLoaded()) {
         // The asset failed to load (file missing / unreadable). Draw a visible
         // "missing image" placeholder instead of nothing, so the user can see
         // which image is broken. The object and its imagePath are preserved,
@@ -51,7 +72,46 @@ void ImageObject::render(QPainter& painter, qreal zoom) const
         return;
     }
 
-    QRectF sourceRect(cachedPixmap.rect());
+    // Pick the mip level from the size the image covers in device pixels:
+    // zoom x whatever scale the caller put on the painter x device pixel ratio
+    qreal deviceScale = zoom * qSqrt(qAbs(painter.combinedTransform().determinant()));
+    if (painter.device()) {
+        deviceScale *= painter.device()->devicePixelRatioF();
+    }
+    const int level = ImageMipCache::levelFor(m_sourceSize, size * deviceScale);
+
+    // Full resolution of an in-memory image is the pixmap itself; everything
+    // else comes from the shared cache
+    QImage levelImage;
+    const bool drawPixmap = (level == 0 && !cachedPixmap.isNull());
+    if (!drawPixmap) {
+        if (m_sourceId == 0) {
+            m_sourceId = ImageMipCache::newSourceId();
+        }
+        levelImage = ImageMipCache::instance()->image(m_sourceId, m_sourceSize, level, [this]() {
+            ImageMipCache::Source source;
+            source.encoded = m_encoded;
+            if (m_encoded.isEmpty()) {
+                source.image = cachedPixmap.toImage();
+            }
+            return source;
+        });
+
+        if (levelImage.isNull()) {
+            // Still decoding in the background (the viewport repaints when it
+            // is done): show a faint box where the image will appear.
+            painter.fillRect(targetRect, QColor(128, 128, 128, 40));
+            return;
+        }
+    }
+
+    auto draw = [&]() {
+        if (drawPixmap) {
+            painter.drawPixmap(targetRect, cachedPixmap, QRectF(cachedPixmap.rect()));
+        } else {
+            painter.drawImage(targetRect, levelImage, QRectF(levelImage.rect()));
+        }
+    };
 
     if (rotation != 0.0) {
         painter.save();
@@ -60,12 +120,12 @@ void ImageObject::render(QPainter& painter, qreal zoom) const
         painter.rotate(rotation);
         painter.translate(-centerPoint);
         painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
-        painter.drawPixmap(targetRect, cachedPixmap, sourceRect);
+        draw();
         painter.restore();
     } else {
         bool hadSmooth = painter.testRenderHint(QPainter::SmoothPixmapTransform);
         painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
-        painter.drawPixmap(targetRect, cachedPixmap, sourceRect);
+        draw();
         if (!hadSmooth) {
             painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
         }
@@ -88,11 +148,11 @@ QJsonObject ImageObject::toJson() const
     // undo/redo) AND the case where imagePath is set but the asset file is not
     // known to exist - so a later orphan cleanup or lost file can never turn the
     // reference into permanent data loss.
-    if (!cachedPixmap.isNull() && (imagePath.isEmpty() || !m_assetPersisted)) {
+    if (isLoaded() && (imagePath.isEmpty() || !m_assetPersisted)) {
         QByteArray imageData;
         QBuffer buffer(&imageData);
         buffer.open(QIODevice::WriteOnly);
-        cachedPixmap.save(&buffer, "PNG");
+        pixmap().save(&buffer, "PNG");
         obj["embeddedImageData"] = QString::fromLatin1(imageData.toBase64());
     }
     
@@ -112,15 +172,15 @@ void ImageObject::loadFromJson(const QJsonObject& obj)
     
     // BF.7: Check for embedded image data (unsaved document case)
     // This allows undo/redo to work even when the document hasn't been saved yet
+    // Pages may be parsed on a worker thread (Document::readPageData), so the
+    // PNG stays encoded; render() and pixmap() decode it on demand.
     if (obj.contains("embeddedImageData")) {
         QString base64Data = obj["embeddedImageData"].toString();
         QByteArray imageData = QByteArray::fromBase64(base64Data.toLatin1());
-        QPixmap pixmap;
-        if (pixmap.loadFromData(imageData, "PNG")) {
-            cachedPixmap = pixmap;
+        if (adoptEncoded(imageData)) {
             // Update size if not already set
-            if (size.isEmpty() && !cachedPixmap.isNull()) {
-                size = cachedPixmap.size();
+            if (size.isEmpty()) {
+                size = m_sourceSize;
             }
         }
     }
@@ -135,35 +195,96 @@ bool ImageObject::loadImage(const QString& basePath)
     
     QString path = fullPath(basePath);
     
-    // Try to load the image
-    QImage image(path);
-    if (image.isNull()) {
+    // Keep the encoded bytes and read only the header here. Pixels are
+    // decoded by render() at the resolution it needs, off the GUI thread.
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
         return false;
     }
+    QByteArray bytes = file.readAll();
+    file.close();
     
-    // Convert to pixmap and cache
-    cachedPixmap = QPixmap::fromImage(image);
+    if (!adoptEncoded(bytes)) {
+        return false;
+    }
 
     // The file we just read exists, so the asset is confirmed persisted.
     m_assetPersisted = true;
 
     // Update aspect ratio if this is the first load
-    if (originalAspectRatio <= 0.0 && !cachedPixmap.isNull() && cachedPixmap.height() > 0) {
-        originalAspectRatio = static_cast<qreal>(cachedPixmap.width()) / 
-                              static_cast<qreal>(cachedPixmap.height());
+    if (originalAspectRatio <= 0.0 && m_sourceSize.height() > 0) {
+        originalAspectRatio = static_cast<qreal>(m_sourceSize.width()) / 
+                              static_cast<qreal>(m_sourceSize.height());
     }
     
     // Update size if not set
-    if (size.isEmpty() && !cachedPixmap.isNull()) {
-        size = cachedPixmap.size();
+    if (size.isEmpty()) {
+        size = m_sourceSize;
     }
     
     return true;
 }
 
+void ImageObject::unloadImage()
+{
+    resetSource();
+    cachedPixmap = QPixmap();
+    m_encoded.clear();
+    m_sourceSize = QSize();
+}
+
+bool ImageObject::adoptEncoded(const QByteArray& bytes)
+{
+    QSize pixelSize;
+    {
+        QByteArray header = bytes;  // Shared, not copied
+        QBuffer buffer(&header);
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer);
+        if (reader.canRead()) {
+            pixelSize = reader.size();
+            if (reader.autoTransform()
+                && (reader.transformation() & QImageIOHandler::TransformationRotate90)) {
+                pixelSize.transpose();
+            }
+        }
+    }
+    if (pixelSize.isEmpty()) {
+        // Unreadable, or a format that cannot report its size without decoding
+        const QImage image = QImage::fromData(bytes);
+        if (image.isNull()) {
+            return false;
+        }
+        pixelSize = image.size();
+    }
+    
+    // A freshly parsed object has neither, and may be loading on a worker
+    // thread (Document::readPageData), where pixmaps must not be touched
+    resetSource();
+    if (!cachedPixmap.isNull()) {
+        cachedPixmap = QPixmap();
+    }
+    m_encoded = bytes;
+    m_sourceSize = pixelSize;
+    return true;
+}
+
+QPixmap ImageObject::pixmap() const
+{
+    if (!cachedPixmap.isNull() || m_encoded.isEmpty()) {
+        return cachedPixmap;
+    }
+    ImageMipCache::Source source;
+    source.encoded = m_encoded;
+    return QPixmap::fromImage(ImageMipCache::decode(source, m_sourceSize, 0));
+}
+
 void ImageObject::setPixmap(const QPixmap& pixmap)
 {
+    resetSource();
+    m_encoded.clear();
     cachedPixmap = pixmap;
+    m_sourceSize = cachedPixmap.size();
 
     // A freshly supplied pixmap (clipboard/memory) is not yet on disk.
     m_assetPersisted = false;
@@ -184,7 +305,8 @@ void ImageObject::setPixmap(const QPixmap& pixmap)
 
 void ImageObject::calculateHash()
 {
-    if (cachedPixmap.isNull()) {
+    const QPixmap full = pixmap();
+    if (full.isNull()) {
         imageHash.clear();
         return;
     }
@@ -193,7 +315,7 @@ void ImageObject::calculateHash()
     QByteArray bytes;
     QBuffer buffer(&bytes);
     buffer.open(QIODevice::WriteOnly);
-    cachedPixmap.save(&buffer, "PNG");
+    full.save(&buffer, "PNG");
     buffer.close();
     
     // Calculate SHA-256 hash
@@ -251,7 +373,7 @@ bool ImageObject::saveToAssets(const QString& bundlePath)
         return false;
     }
     
-    if (cachedPixmap.isNull()) {
+    if (!isLoaded()) {
         qWarning() << "ImageObject::saveToAssets: no image loaded";
         return false;
     }
@@ -289,7 +411,7 @@ bool ImageObject::saveToAssets(const QString& bundlePath)
     }
     
     // Save image to assets folder
-    if (!cachedPixmap.save(fullFilePath, "PNG")) {
+    if (!pixmap().save(fullFilePath, "PNG")) {
         qWarning() << "ImageObject::saveToAssets: failed to save" << fullFilePath;
         return false;
     }
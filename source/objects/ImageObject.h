@@ -6,18 +6,24 @@
 // Part of the new SpeedyNote document architecture (Phase 1.1.2)
 // 
 // ImageObject represents an image that has been inserted onto a page.
-// It stores the path to the image file and caches the pixmap for rendering.
+// It stores the path to the image file. Images loaded from a file keep only
+// the encoded bytes; rendering draws a downsampled level from ImageMipCache
+// that matches the on-screen size, so full resolution is decoded only when
+// zoomed in that far.
 // ============================================================================
 
 #include "InsertedObject.h"
+#include <QByteArray>
 #include <QPixmap>
 #include <QImage>
 
 /**
  * @brief An image object that can be inserted onto a page.
  * 
- * Stores the path to an image file (relative to the notebook directory)
- * and caches the loaded pixmap for efficient rendering.
+ * Stores the path to an image file (relative to the notebook directory).
+ * File-backed images hold their encoded bytes and decode lazily, at the
+ * resolution each render needs; images created from memory hold one
+ * full-resolution pixmap.
  */
 class ImageObject : public InsertedObject {
 public:
@@ -38,12 +44,21 @@ public:
      */
     explicit ImageObject(const QString& path) : imagePath(path) {}
     
+    /**
+     * @brief Destructor. Frees this image's decoded levels.
+     */
+    ~ImageObject() override;
+    
     // ===== InsertedObject Interface =====
     
     /**
      * @brief Render this image.
      * @param painter The QPainter to render to.
      * @param zoom Current zoom level (1.0 = 100%).
+     * 
+     * Draws the mip level matching zoom x painter scale x device pixel
+     * ratio. Inside an ImageMipCache::AsyncScope a missing level is decoded
+     * in the background and the nearest cached level is drawn meanwhile.
      */
     void render(QPainter& painter, qreal zoom) const override;
     
@@ -86,10 +101,10 @@ public:
     bool saveAssets(const QString& bundlePath) override;
     
     /**
-     * @brief Check if the image pixmap is loaded and ready to render.
-     * @return True if cachedPixmap is valid.
+     * @brief Check if the image data is loaded and ready to render.
+     * @return True if the encoded bytes or a pixmap are held.
      */
-    bool isAssetLoaded() const override { return !cachedPixmap.isNull(); }
+    bool isAssetLoaded() const override { return isLoaded(); }
     
     // ===== Image-specific Methods =====
     
@@ -98,27 +113,35 @@ public:
      * @param basePath Base directory for resolving relative paths.
      * @return True if image loaded successfully.
      * 
-     * Call this after creating/loading to populate cachedPixmap.
-     * If imagePath is absolute, basePath is ignored.
+     * Reads the file's bytes and its pixel size; pixels are decoded on
+     * demand. If imagePath is absolute, basePath is ignored.
      */
     bool loadImage(const QString& basePath = QString());
     
     /**
      * @brief Check if the image is loaded.
-     * @return True if cachedPixmap is valid.
+     * @return True if the encoded bytes or a pixmap are held.
+     */
+    bool isLoaded() const { return !cachedPixmap.isNull() || !m_encoded.isEmpty(); }
+    
+    /**
+     * @brief Drop the image data and its decoded levels to free memory.
      */
-    bool isLoaded() const { return !cachedPixmap.isNull(); }
+    void unloadImage();
     
     /**
-     * @brief Clear the cached pixmap to free memory.
+     * @brief Get the full-resolution pixmap.
+     * @return The pixmap (null if not loaded).
+     * 
+     * File-backed images are decoded for this call and not kept, so use it
+     * for export and copying, not for drawing.
      */
-    void unloadImage() { cachedPixmap = QPixmap(); }
+    QPixmap pixmap() const;
     
     /**
-     * @brief Get the cached pixmap.
-     * @return The cached pixmap (may be null if not loaded).
+     * @brief Pixel size of the full-resolution image.
      */
-    const QPixmap& pixmap() const { return cachedPixmap; }
+    QSize pixelSize() const { return m_sourceSize; }
     
     /**
      * @brief Set the pixmap directly (for images created from clipboard/memory).
@@ -178,7 +201,20 @@ public:
     bool saveToAssets(const QString& bundlePath);
     
 private:
-    QPixmap cachedPixmap;  ///< Cached pixmap for rendering
+    /// Reset the decode source; drops levels decoded from the old one.
+    void resetSource();
+
+    /**
+     * @brief Use @p bytes (an encoded image) as the source, reading only
+     *        its header. Safe on worker threads: no pixmap is created.
+     * @return False if the bytes are not a readable image.
+     */
+    bool adoptEncoded(const QByteArray& bytes);
+
+    QPixmap cachedPixmap;             ///< Full-resolution pixmap (images created from memory)
+    QByteArray m_encoded;             ///< Encoded file bytes (images loaded from disk)
+    QSize m_sourceSize;               ///< Full-resolution pixel size
+    mutable quint64 m_sourceId = 0;   ///< ImageMipCache key; 0 = nothing decoded yet
 
     /**
      * @brief Transient flag: true once the asset PNG is confirmed on disk.
@@ -158,7 +158,7 @@ public:
      * @return True if ready (or no assets needed).
      * 
      * Default returns true (objects without external assets are always ready).
-     * ImageObject returns !cachedPixmap.isNull().
+     * ImageObject returns true while it holds encoded bytes or a pixmap.
      */
     virtual bool isAssetLoaded() const { return true; }
     
@@ -11,6 +11,7 @@
 #include "../core/Page.h"
 #include "../layers/VectorLayer.h"
 #include "../objects/ImageObject.h"
+#include "PdfProvider.h"
 
 #include <mupdf/fitz.h>
 #include <mupdf/pdf.h>
@@ -22,19 +23,21 @@
 #include <QPainter>
 #include <QRegularExpression>
 #include <QSet>
+#include <QThreadPool>
+#include <QtConcurrent>
 
 #include <algorithm> // for std::sort
 #include <cmath>     // for cosf, sinf, M_PI
+#include <deque>     // for the in-flight page pipeline
 #include <functional> // OUT2: std::function for the outline export-index resolver
 #include <map>       // for ExtGState alpha cache
 #include <unordered_map> // OUT2: notebook-page -> export-index lookup
 #include <vector>    // for content stream tokenizer
 
 // Forward declarations for static helper functions defined later in this file
-static void appendLayerStrokesToBuffer(fz_context* ctx, pdf_document* outputDoc,
-                                       fz_buffer* buf, pdf_obj* resources,
-                                       const VectorLayer* layer, qreal pageHeightSn,
-                                       int& gsIndex, std::map<int, QString>& alphaToGsName,
+static void appendLayerStrokesToBuffer(QByteArray& buf, QVector<QPair<QByteArray, float>>& extGStates,
+                                       const QVector<VectorStroke>& strokes, float layerOpacity,
+                                       qreal pageHeightSn, std::map<int, QByteArray>& alphaToGsName,
                                        bool darkenStrokes = false);
 static int getSourcePageRotation(fz_context* ctx, pdf_document* srcPdf, int pageIndex);
 static fz_rect getSourcePageBBox(fz_context* ctx, pdf_document* srcPdf, int pageIndex);
@@ -45,10 +48,16 @@ static fz_rect getSourcePageBBox(fz_context* ctx, pdf_document* srcPdf, int page
 static pdf_obj* buildAggregatedOutline(fz_context* ctx, pdf_document* outputDoc,
                                        const QVector<PdfOutlineItem>& items,
                                        const std::function<int(const PdfOutlineItem&)>& exportIndexOf);
-static bool addImageToPage(fz_context* ctx, pdf_document* outputDoc,
-                           const ImageObject* img, fz_buffer* contentBuf,
-                           pdf_obj* resources, int imageIndex, float pageHeightPt,
-                           const PdfExportOptions& options);
+static void appendImageToContent(QByteArray& contentBuf, const QByteArray& imgName,
+                                 const QPointF& position, const QSizeF& size, qreal rotation,
+                                 float pageHeightPt);
+static QByteArray imageResourceKey(const QByteArray& contentId, const QSize& pixelSize,
+                                   bool hasAlpha);
+static pdf_obj* embedImage(fz_context* ctx, pdf_document* outputDoc, const QByteArray& compressedData);
+static void putXObject(fz_context* ctx, pdf_document* outputDoc, pdf_obj* resources,
+                       const char* name, pdf_obj* xobject);
+static QByteArray renderDarkBackground(PdfProvider* provider, int providerPage,
+                                       const QSizeF& pageSizePt, const PdfExportOptions& options);
 
 /**
  * @brief Scale factor from SpeedyNote units (96 DPI) to PDF points (72 DPI).
@@ -58,6 +67,58 @@ static bool addImageToPage(fz_context* ctx, pdf_document* outputDoc,
  */
 static constexpr float SN_TO_PDF_SCALE = 72.0f / 96.0f;
 
+// ============================================================================
+// Page Pipeline Data
+// ============================================================================
+
+struct MuPdfExporter::PageJob {
+    /// One visible stroke layer or image object, in drawing order
+    struct Item {
+        bool isImage = false;
+        
+        // Stroke layer
+        QVector<VectorStroke> strokes;  ///< Implicitly shared copy of the layer's strokes
+        float opacity = 1.0f;
+        
+        // Image object
+        QByteArray resourceKey;         ///< Shared image resource (see imageResourceKey())
+        QImage image;                   ///< Null when an earlier page compresses this resource
+        QPointF position;
+        QSizeF size;
+        qreal rotation = 0.0;
+    };
+    
+    int pageIndex = -1;
+    qreal pageHeightSn = 0;
+    float widthPt = 0;
+    float heightPt = 0;
+    QVector<Item> items;
+    
+    QByteArray customBackgroundKey;     ///< Empty unless exported with a custom background
+    QImage customBackground;            ///< Null when an earlier page compresses this resource
+    
+    // Dark-mode raster background (skipImageMasking). PdfProvider renders
+    // under its own lock, so the worker may use it directly.
+    PdfProvider* darkProvider = nullptr;
+    int darkProviderPage = -1;
+};
+
+struct MuPdfExporter::PreparedPage {
+    /// Image XObject referenced by the content stream
+    struct Image {
+        QByteArray name;    ///< XObject name within the page
+        QByteArray key;     ///< Shared image resource
+        QByteArray data;    ///< Compressed image; empty = embedded by an earlier page
+    };
+    
+    QByteArray content;                             ///< Strokes and images in drawing order
+    QVector<Image> images;
+    QVector<QPair<QByteArray, float>> extGStates;   ///< ExtGState name, fill alpha
+    QByteArray customBackgroundKey;                 ///< Empty = no custom background
+    QByteArray customBackground;                    ///< Compressed; empty = embedded earlier
+    QByteArray darkBackground;                      ///< Compressed dark-mode raster of the PDF page
+};
+
 // ============================================================================
 // Content Stream Color Rewriting (for vector-preserving dark mode export)
 // ============================================================================
@@ -756,10 +817,18 @@ PdfExportResult MuPdfExporter::exportPdf(const PdfExportOptions& options)
         return result;
     }
     
-    // Process each page
+    // Process each page. Workers prepare page content (stroke paths, image
+    // compression, dark-mode rasters) ahead of this thread, which owns all
+    // MuPDF objects and writes the pages in order.
+    QThreadPool pool;
+    const int pipelineDepth = qMax(1, pool.maxThreadCount()) * PIPELINE_DEPTH_PER_THREAD;
+    std::deque<QFuture<PreparedPage>> inFlight;
+    int planned = 0;
+    
     int total = static_cast<int>(pageIndices.size());
     for (int i = 0; i < total; ++i) {
         if (m_cancelled.load()) {
+            pool.clear();
             result.errorMessage = tr("Export cancelled");
             cleanup();
             emit exportCancelled();
@@ -767,10 +836,26 @@ PdfExportResult MuPdfExporter::exportPdf(const PdfExportOptions& options)
             return result;
         }
         
+        // Keep the workers PIPELINE_DEPTH_PER_THREAD pages ahead
+        while (planned < total && static_cast<int>(inFlight.size()) < pipelineDepth) {
+            PageJob job;
+            if (planPage(pageIndices[planned], job)) {
+                inFlight.push_back(QtConcurrent::run(&pool, [job = std::move(job), options]() {
+                    return preparePage(job, options);
+                }));
+            } else {
+                inFlight.push_back(QFuture<PreparedPage>());  // Reported when its turn comes
+            }
+            ++planned;
+        }
+        QFuture<PreparedPage> prepared = inFlight.front();
+        inFlight.pop_front();
+        
         int pageIndex = pageIndices[i];
         emit progressUpdated(i + 1, total);
         
         bool pageSuccess = false;
+        PreparedPage content;
         
         // Determine how to handle this page
         Page* currentPage = m_document->page(pageIndex);
@@ -778,6 +863,8 @@ PdfExportResult MuPdfExporter::exportPdf(const PdfExportOptions& options)
             qWarning() << "[MuPdfExporter] Failed to get page" << pageIndex;
             pageSuccess = false;
         } else {
+            content = prepared.result();
+            
             // Point the active-source aliases at THIS page's own PDF source so that
             // graft/render/import operate on the correct source (multi-source docs).
             QString srcId;
@@ -790,26 +877,27 @@ PdfExportResult MuPdfExporter::exportPdf(const PdfExportOptions& options)
                 // Page has annotations - need to render
                 if (currentPage->pdfPageNumber >= 0 && m_sourcePdf) {
                     // Modified page with PDF background
-                    pageSuccess = renderModifiedPage(pageIndex);
+                    pageSuccess = renderModifiedPage(pageIndex, content);
                 } else {
                     // No PDF background (blank notebook page)
-                    pageSuccess = renderBlankPage(pageIndex);
+                    pageSuccess = renderBlankPage(pageIndex, content);
                 }
             } else if (m_sourcePdf && currentPage->pdfPageNumber >= 0) {
                 // Unmodified page with PDF
                 if (m_options.darkModeBackground) {
                     // Dark mode export requires color rewriting, can't byte-copy
-                    pageSuccess = renderModifiedPage(pageIndex);
+                    pageSuccess = renderModifiedPage(pageIndex, content);
                 } else {
                     pageSuccess = graftPage(pageIndex);
                 }
             } else {
                 // Unmodified blank page - still need to render
-                pageSuccess = renderBlankPage(pageIndex);
+                pageSuccess = renderBlankPage(pageIndex, content);
             }
         }
         
         if (!pageSuccess) {
+            pool.clear();
             result.errorMessage = tr("Failed to export page %1").arg(pageIndex + 1);
             cleanup();
             emit exportFailed(result.errorMessage);
@@ -817,6 +905,7 @@ PdfExportResult MuPdfExporter::exportPdf(const PdfExportOptions& options)
             return result;
         }
         
+        keepUnembeddedImages(content);
         result.pagesExported++;
     }
     
@@ -1040,6 +1129,14 @@ void MuPdfExporter::cleanup()
     m_sourcePdf = nullptr;
     m_graftMap = nullptr;
     
+    // Shared image XObject references (the objects themselves live in the output)
+    for (pdf_obj* xobject : m_imageXObjects) {
+        pdf_drop_obj(m_ctx, xobject);
+    }
+    m_imageXObjects.clear();
+    m_unembeddedImages.clear();
+    m_plannedImageKeys.clear();
+    
     if (m_outputDoc) {
         pdf_drop_document(m_ctx, m_outputDoc);
         m_outputDoc = nullptr;
@@ -1212,6 +1309,240 @@ bool MuPdfExporter::isPageModified(int pageIndex) const
     return page->hasContent();
 }
 
+bool MuPdfExporter::planPage(int pageIndex, PageJob& job)
+{
+    Page* page = m_document->page(pageIndex);
+    if (!page) return false;
+    
+    job.pageIndex = pageIndex;
+    job.pageHeightSn = page->size.height();
+    job.widthPt = page->size.width() * SN_TO_PDF_SCALE;
+    job.heightPt = page->size.height() * SN_TO_PDF_SCALE;
+    
+    // Content with proper layer affinity ordering:
+    // 1. Objects with affinity -1 (below all strokes)
+    // 2. Layer 0 strokes
+    // 3. Objects with affinity 0
+    // 4. Layer 1 strokes
+    // 5. Objects with affinity 1
+    // ... and so on
+    // N. Objects with affinity >= numLayers (always on top)
+    //
+    // Pixels and strokes are copied here (implicitly shared) so the worker
+    // never reads the live page. Images repeated across pages (same content,
+    // compressed size and alpha) are compressed only for their first page.
+    auto addObjects = [this, &job](const std::vector<InsertedObject*>& objects) {
+        // Sort by zOrder (the map stores pointers, not owned objects)
+        std::vector<InsertedObject*> sorted = objects;
+        std::sort(sorted.begin(), sorted.end(), 
+                  [](const InsertedObject* a, const InsertedObject* b) {
+                      return a->zOrder < b->zOrder;
+                  });
+        
+        for (const InsertedObject* obj : sorted) {
+            if (obj->type() != QStringLiteral("image")) {
+                continue;
+            }
+            const ImageObject* imgObj = dynamic_cast<const ImageObject*>(obj);
+            if (!imgObj || !imgObj->isLoaded() || !imgObj->visible) {
+                continue;
+            }
+            const QPixmap pixmap = imgObj->pixmap();
+            if (pixmap.isNull()) {
+                qWarning() << "[MuPdfExporter] Image not loaded:" << imgObj->imagePath;
+                continue;
+            }
+            
+            // Skip zero-size images (would cause invalid transformation matrix)
+            const QSizeF displaySizePt(imgObj->size.width() * SN_TO_PDF_SCALE,
+                                       imgObj->size.height() * SN_TO_PDF_SCALE);
+            if (displaySizePt.width() <= 0 || displaySizePt.height() <= 0) {
+                qWarning() << "[MuPdfExporter] Skipping zero-size image";
+                continue;
+            }
+            
+            PageJob::Item item;
+            item.isImage = true;
+            item.resourceKey = imageResourceKey(
+                imgObj->imageHash.isEmpty()
+                    ? "pixmap:" + QByteArray::number(pixmap.cacheKey())
+                    : imgObj->imageHash.toLatin1(),
+                compressedPixelSize(pixmap.size(), displaySizePt, m_options.dpi),
+                pixmap.hasAlphaChannel());
+            if (!m_plannedImageKeys.contains(item.resourceKey)) {
+                // First use: this page's worker compresses it
+                m_plannedImageKeys.insert(item.resourceKey);
+                item.image = pixmap.toImage();
+            }
+            item.position = imgObj->position;
+            item.size = imgObj->size;
+            item.rotation = imgObj->rotation;
+            job.items.append(std::move(item));
+        }
+    };
+    auto addObjectsWithAffinity = [&](int affinity) {
+        auto it = page->objectsByAffinity.find(affinity);
+        if (it != page->objectsByAffinity.end()) {
+            addObjects(it->second);
+        }
+    };
+    
+    int numLayers = static_cast<int>(page->vectorLayers.size());
+    addObjectsWithAffinity(-1);
+    for (int layerIdx = 0; layerIdx < numLayers; ++layerIdx) {
+        const VectorLayer* layer = page->vectorLayers[layerIdx].get();
+        if (layer && layer->visible && !layer->strokes().isEmpty()) {
+            PageJob::Item item;
+            item.strokes = layer->strokes();
+            item.opacity = static_cast<float>(layer->opacity);
+            job.items.append(std::move(item));
+        }
+        addObjectsWithAffinity(layerIdx);
+    }
+    for (const auto& [affinity, objects] : page->objectsByAffinity) {
+        if (affinity >= numLayers) {
+            addObjects(objects);
+        }
+    }
+    
+    // Custom background image (blank pages; skipped in annotations-only mode)
+    if (!m_options.annotationsOnly && page->backgroundType == Page::BackgroundType::Custom
+        && !page->customBackground.isNull()) {
+        const QPixmap& background = page->customBackground;
+        job.customBackgroundKey = imageResourceKey(
+            "background:" + QByteArray::number(background.cacheKey()),
+            compressedPixelSize(background.size(), QSizeF(job.widthPt, job.heightPt), m_options.dpi),
+            background.hasAlphaChannel());
+        if (!m_plannedImageKeys.contains(job.customBackgroundKey)) {
+            m_plannedImageKeys.insert(job.customBackgroundKey);
+            job.customBackground = background.toImage();
+        }
+    }
+    
+    // Dark-mode raster of the PDF background (image masking bypassed: the
+    // vector color rewrite cannot invert embedded images)
+    if (!m_options.annotationsOnly && m_options.darkModeBackground && m_options.skipImageMasking
+        && page->pdfPageNumber >= 0) {
+        QString srcId;
+        int pdfPage = -1;
+        if (m_document->pdfBindingForNotebookPage(pageIndex, srcId, pdfPage)) {
+            job.darkProvider = m_document->providerForSource(srcId);
+            job.darkProviderPage = m_document->resolveSourcePageIndex(srcId, page->pdfPageNumber);
+        }
+    }
+    return true;
+}
+
+MuPdfExporter::PreparedPage MuPdfExporter::preparePage(const PageJob& job,
+                                                       const PdfExportOptions& options)
+{
+    PreparedPage prepared;
+    std::map<int, QByteArray> alphaToGsName;  // Cache: alpha (0-100) -> GS name
+    
+    for (const PageJob::Item& item : job.items) {
+        if (item.isImage) {
+            PreparedPage::Image image;
+            image.name = "Img" + QByteArray::number(prepared.images.size());
+            image.key = item.resourceKey;
+            if (!item.image.isNull()) {
+                // Compress with downsampling
+                const QSizeF displaySizePt(item.size.width() * SN_TO_PDF_SCALE,
+                                           item.size.height() * SN_TO_PDF_SCALE);
+                image.data = compressImage(item.image, item.image.hasAlphaChannel(),
+                                           displaySizePt, options.dpi);
+                if (image.data.isEmpty()) {
+                    qWarning() << "[MuPdfExporter] Failed to compress image";
+                    continue;
+                }
+            }
+            appendImageToContent(prepared.content, image.name, item.position, item.size,
+                                 item.rotation, job.heightPt);
+            prepared.images.append(std::move(image));
+        } else {
+            appendLayerStrokesToBuffer(prepared.content, prepared.extGStates, item.strokes,
+                                       item.opacity, job.pageHeightSn, alphaToGsName,
+                                       options.darkenStrokes);
+        }
+    }
+    
+    const QSizeF pageSizePt(job.widthPt, job.heightPt);
+    prepared.customBackgroundKey = job.customBackgroundKey;
+    if (!job.customBackground.isNull()) {
+        prepared.customBackground = compressImage(job.customBackground,
+                                                  job.customBackground.hasAlphaChannel(),
+                                                  pageSizePt, options.dpi);
+    }
+    if (job.darkProvider) {
+        prepared.darkBackground = renderDarkBackground(job.darkProvider, job.darkProviderPage,
+                                                       pageSizePt, options);
+    }
+    return prepared;
+}
+
+void MuPdfExporter::addPreparedResources(pdf_obj* resources, const PreparedPage& prepared)
+{
+    for (const PreparedPage::Image& image : prepared.images) {
+        fz_try(m_ctx) {
+            if (!addSharedImage(resources, image.name.constData(), image.key, image.data)) {
+                qWarning() << "[MuPdfExporter] Image missing from output:" << image.key;
+            }
+        }
+        fz_catch(m_ctx) {
+            // Non-fatal: the page keeps its other content
+            qWarning() << "[MuPdfExporter] Failed to add image:" << fz_caught_message(m_ctx);
+        }
+    }
+    
+    if (prepared.extGStates.isEmpty()) {
+        return;
+    }
+    
+    // Get or create ExtGState dictionary in resources
+    pdf_obj* extGStateDict = pdf_dict_get(m_ctx, resources, PDF_NAME(ExtGState));
+    if (!extGStateDict) {
+        extGStateDict = pdf_new_dict(m_ctx, m_outputDoc, 4);
+        pdf_dict_put(m_ctx, resources, PDF_NAME(ExtGState), extGStateDict);
+    }
+    for (const auto& gs : prepared.extGStates) {
+        // Create the graphics state dictionary
+        pdf_obj* gsDict = pdf_new_dict(m_ctx, m_outputDoc, 2);
+        pdf_dict_put(m_ctx, gsDict, PDF_NAME(Type), PDF_NAME(ExtGState));
+        pdf_dict_put_real(m_ctx, gsDict, PDF_NAME(ca), gs.second);  // Fill alpha (lowercase 'ca')
+        pdf_dict_put(m_ctx, extGStateDict, pdf_new_name(m_ctx, gs.first.constData()), gsDict);
+    }
+}
+
+bool MuPdfExporter::addSharedImage(pdf_obj* resources, const char* name, const QByteArray& key,
+                                   const QByteArray& data)
+{
+    pdf_obj* xobject = m_imageXObjects.value(key);
+    if (!xobject) {
+        const QByteArray compressed = data.isEmpty() ? m_unembeddedImages.value(key) : data;
+        if (compressed.isEmpty()) {
+            return false;
+        }
+        xobject = embedImage(m_ctx, m_outputDoc, compressed);
+        m_imageXObjects.insert(key, xobject);
+        m_unembeddedImages.remove(key);
+    }
+    putXObject(m_ctx, m_outputDoc, resources, name, xobject);
+    return true;
+}
+
+void MuPdfExporter::keepUnembeddedImages(const PreparedPage& prepared)
+{
+    // E.g. a custom background on a page exported over its PDF instead
+    auto keep = [this](const QByteArray& key, const QByteArray& data) {
+        if (!data.isEmpty() && !m_imageXObjects.contains(key)) {
+            m_unembeddedImages.insert(key, data);
+        }
+    };
+    for (const PreparedPage::Image& image : prepared.images) {
+        keep(image.key, image.data);
+    }
+    keep(prepared.customBackgroundKey, prepared.customBackground);
+}
+
 bool MuPdfExporter::graftPage(int pageIndex)
 {
     if (!m_sourcePdf || !m_outputDoc || !m_ctx) {
@@ -1260,7 +1591,7 @@ bool MuPdfExporter::graftPage(int pageIndex)
     return true;
 }
 
-bool MuPdfExporter::renderModifiedPage(int pageIndex)
+bool MuPdfExporter::renderModifiedPage(int pageIndex, const PreparedPage& prepared)
 {
     if (!m_outputDoc || !m_ctx || !m_document) {
         return false;
@@ -1277,7 +1608,7 @@ bool MuPdfExporter::renderModifiedPage(int pageIndex)
     int pdfPageNum = m_document->resolveSourcePageIndex(page->pdfSourceId, origPageNum);
     if (origPageNum < 0 || pdfPageNum < 0 || !m_sourcePdf) {
         // No PDF background - use blank page rendering
-        return renderBlankPage(pageIndex);
+        return renderBlankPage(pageIndex, prepared);
     }
     
     QSizeF pageSize = page->size;
@@ -1309,7 +1640,7 @@ bool MuPdfExporter::renderModifiedPage(int pageIndex)
             bgXObject = importPageAsXObject(pdfPageNum);
             if (!bgXObject) {
                 qWarning() << "[MuPdfExporter] Failed to import PDF page as XObject, falling back to blank";
-                return renderBlankPage(pageIndex);
+                return renderBlankPage(pageIndex, prepared);
             }
         }
     }
@@ -1327,40 +1658,26 @@ bool MuPdfExporter::renderModifiedPage(int pageIndex)
         
         // Dark mode background: rasterize PDF page, invert, embed as image
         if (bgIsRasterDarkMode && m_sourceDoc) {
-            QImage bgImage = m_document->renderPdfPageToImage(m_currentSourceId, origPageNum, static_cast<qreal>(m_options.dpi));
-            if (!bgImage.isNull()) {
-                QVector<QRect> imgRegions;
-                if (!m_options.skipImageMasking) {
-                    imgRegions = m_document->pdfImageRegions(m_currentSourceId, origPageNum, static_cast<qreal>(m_options.dpi));
-                }
-                DarkModeUtils::invertImageLightness(bgImage, imgRegions);
-
-                QByteArray compressed = compressImage(bgImage, false,
-                    QSizeF(widthPt, heightPt), m_options.dpi);
-                if (!compressed.isEmpty()) {
-                    fz_buffer* imgBuf = fz_new_buffer_from_copied_data(m_ctx,
-                        reinterpret_cast<const unsigned char*>(compressed.constData()),
-                        compressed.size());
-                    fz_image* fzImg = fz_new_image_from_buffer(m_ctx, imgBuf);
-                    fz_drop_buffer(m_ctx, imgBuf);
-
-                    pdf_obj* imgXObj = pdf_add_image(m_ctx, m_outputDoc, fzImg);
-                    fz_drop_image(m_ctx, fzImg);
-
-                    pdf_obj* xobjectDict = pdf_dict_get(m_ctx, resources, PDF_NAME(XObject));
-                    if (!xobjectDict) {
-                        xobjectDict = pdf_new_dict(m_ctx, m_outputDoc, 4);
-                        pdf_dict_put(m_ctx, resources, PDF_NAME(XObject), xobjectDict);
-                    }
-                    pdf_dict_put(m_ctx, xobjectDict, pdf_new_name(m_ctx, "BGDark"), imgXObj);
-
-                    char cmd[128];
-                    fz_append_string(m_ctx, combinedContent, "q\n");
-                    snprintf(cmd, sizeof(cmd), "%.4f 0 0 %.4f 0 0 cm\n", widthPt, heightPt);
-                    fz_append_string(m_ctx, combinedContent, cmd);
-                    fz_append_string(m_ctx, combinedContent, "/BGDark Do\n");
-                    fz_append_string(m_ctx, combinedContent, "Q\n");
-                }
+            // Normally rendered ahead by a worker; not when the vector
+            // import above failed and fell back to the raster
+            QByteArray compressed = prepared.darkBackground;
+            if (compressed.isEmpty()) {
+                compressed = renderDarkBackground(
+                    m_document->providerForSource(m_currentSourceId),
+                    m_document->resolveSourcePageIndex(m_currentSourceId, origPageNum),
+                    QSizeF(widthPt, heightPt), m_options);
+            }
+            if (!compressed.isEmpty()) {
+                pdf_obj* imgXObj = embedImage(m_ctx, m_outputDoc, compressed);
+                putXObject(m_ctx, m_outputDoc, resources, "BGDark", imgXObj);
+                pdf_drop_obj(m_ctx, imgXObj);
+
+                char cmd[128];
+                fz_append_string(m_ctx, combinedContent, "q\n");
+                snprintf(cmd, sizeof(cmd), "%.4f 0 0 %.4f 0 0 cm\n", widthPt, heightPt);
+                fz_append_string(m_ctx, combinedContent, cmd);
+                fz_append_string(m_ctx, combinedContent, "/BGDark Do\n");
+                fz_append_string(m_ctx, combinedContent, "Q\n");
             }
         }
 
@@ -1442,83 +1759,12 @@ bool MuPdfExporter::renderModifiedPage(int pageIndex)
             pdf_dict_put(m_ctx, resources, PDF_NAME(XObject), xobjectDict);
         }
         
-        // Render content with proper layer affinity ordering:
-        // 1. Objects with affinity -1 (below all strokes)
-        // 2. Layer 0 strokes
-        // 3. Objects with affinity 0
-        // 4. Layer 1 strokes
-        // 5. Objects with affinity 1
-        // ... and so on
-        // N. Objects with affinity >= numLayers (always on top)
-        
-        int imageIndex = 0;
-        int gsIndex = 0;  // Counter for ExtGState names (for stroke transparency)
-        std::map<int, QString> alphaToGsName;  // Cache: alpha (0-100) -> GS name
-        int numLayers = static_cast<int>(page->vectorLayers.size());
-        qreal pageHeightSn = page->size.height();
-        
-        // Save graphics state for strokes/objects
+        // Strokes and images in layer/affinity order (built by preparePage())
         fz_append_string(m_ctx, combinedContent, "q\n");
-        
-        // Helper lambda to add objects with a specific affinity (sorted by zOrder)
-        auto addObjectsWithAffinity = [&](int affinity) {
-            auto it = page->objectsByAffinity.find(affinity);
-            if (it == page->objectsByAffinity.end()) return;
-            
-            // Sort by zOrder (the map stores pointers, not owned objects)
-            std::vector<InsertedObject*> sorted = it->second;
-            std::sort(sorted.begin(), sorted.end(), 
-                      [](const InsertedObject* a, const InsertedObject* b) {
-                          return a->zOrder < b->zOrder;
-                      });
-            
-            for (const InsertedObject* obj : sorted) {
-                if (obj->type() == QStringLiteral("image")) {
-                    const ImageObject* imgObj = dynamic_cast<const ImageObject*>(obj);
-                    if (imgObj && imgObj->isLoaded()) {
-                        addImageToPage(m_ctx, m_outputDoc, imgObj, combinedContent, resources, imageIndex++, heightPt, m_options);
-                    }
-                }
-            }
-        };
-        
-        // 1. Objects with affinity -1 (below all strokes)
-        addObjectsWithAffinity(-1);
-        
-        // 2. Interleave layers and objects
-        for (int layerIdx = 0; layerIdx < numLayers; ++layerIdx) {
-            // Render this layer's strokes (with transparency support)
-            appendLayerStrokesToBuffer(m_ctx, m_outputDoc, combinedContent, resources,
-                                      page->vectorLayers[layerIdx].get(), pageHeightSn, gsIndex, alphaToGsName,
-                                      m_options.darkenStrokes);
-            
-            // Render objects with affinity = layerIdx (above this layer, below next)
-            addObjectsWithAffinity(layerIdx);
-        }
-        
-        // 3. Objects with affinity >= numLayers (always on top of all strokes)
-        for (const auto& [affinity, objects] : page->objectsByAffinity) {
-            if (affinity >= numLayers) {
-                // Sort by zOrder
-                std::vector<InsertedObject*> sorted = objects;
-                std::sort(sorted.begin(), sorted.end(), 
-                          [](const InsertedObject* a, const InsertedObject* b) {
-                              return a->zOrder < b->zOrder;
-                          });
-                
-                for (const InsertedObject* obj : sorted) {
-                    if (obj->type() == QStringLiteral("image")) {
-                        const ImageObject* imgObj = dynamic_cast<const ImageObject*>(obj);
-                        if (imgObj && imgObj->isLoaded()) {
-                            addImageToPage(m_ctx, m_outputDoc, imgObj, combinedContent, resources, imageIndex++, heightPt, m_options);
-                        }
-                    }
-                }
-            }
-        }
-        
-        // Restore graphics state
+        fz_append_data(m_ctx, combinedContent, prepared.content.constData(),
+                       static_cast<size_t>(prepared.content.size()));
         fz_append_string(m_ctx, combinedContent, "Q\n");
+        addPreparedResources(resources, prepared);
         
         // Create the page with our resources and content
         fz_rect mediabox = fz_make_rect(0, 0, widthPt, heightPt);
@@ -1661,7 +1907,7 @@ static fz_buffer* buildBackgroundContentStream(fz_context* ctx, const Page* page
     return buf;
 }
 
-bool MuPdfExporter::renderBlankPage(int pageIndex)
+bool MuPdfExporter::renderBlankPage(int pageIndex, const PreparedPage& prepared)
 {
     if (!m_outputDoc || !m_ctx) {
         return false;
@@ -1687,25 +1933,15 @@ bool MuPdfExporter::renderBlankPage(int pageIndex)
         backgroundContent = buildBackgroundContentStream(m_ctx, page, widthPt, heightPt, m_options.darkenStrokes);
     }
     
-    // Check if page has images to add
-    bool hasImages = !page->objects.empty();
+    // Custom background image (compressed by preparePage(); absent in
+    // annotations-only mode)
+    bool hasCustomBackground = !prepared.customBackgroundKey.isEmpty();
     
-    // Check for custom background image (also skip in annotations-only mode)
-    bool hasCustomBackground = !m_options.annotationsOnly &&
-                               (page->backgroundType == Page::BackgroundType::Custom && 
-                                !page->customBackground.isNull());
-    
-    // Check if page has strokes
-    bool hasStrokes = false;
-    for (const auto& layer : page->vectorLayers) {
-        if (layer && !layer->strokes().isEmpty()) {
-            hasStrokes = true;
-            break;
-        }
-    }
+    // Strokes and images (preparePage() skips hidden layers and objects)
+    bool hasAnnotations = !prepared.content.isEmpty();
     
     // Determine if we need a combined content buffer
-    bool needsCombined = (backgroundContent != nullptr) || hasImages || hasCustomBackground || hasStrokes;
+    bool needsCombined = (backgroundContent != nullptr) || hasCustomBackground || hasAnnotations;
     
     fz_buffer* finalContent = nullptr;
     pdf_obj* resources = nullptr;
@@ -1721,10 +1957,6 @@ bool MuPdfExporter::renderBlankPage(int pageIndex)
             // We create it whenever we have content, as strokes may need ExtGState for transparency
             resources = pdf_new_dict(m_ctx, m_outputDoc, 4);
             
-            int imageIndex = 0;
-            int gsIndex = 0;  // Counter for ExtGState names (for stroke transparency)
-            std::map<int, QString> alphaToGsName;  // Cache: alpha (0-100) -> GS name
-            
             // 1. Background color/grid/lines first
             if (backgroundContent) {
                 unsigned char* data;
@@ -1734,143 +1966,35 @@ bool MuPdfExporter::renderBlankPage(int pageIndex)
             
             // 2. Custom background image (covers entire page, before strokes)
             if (hasCustomBackground) {
-                // Convert QPixmap to QImage
-                QImage bgImage = page->customBackground.toImage();
-                if (!bgImage.isNull()) {
-                    // Compress the background image
-                    bool hasAlpha = bgImage.hasAlphaChannel();
-                    QSizeF displaySizePt(widthPt, heightPt);
-                    QByteArray compressedData = compressImage(bgImage, hasAlpha, displaySizePt, m_options.dpi);
-                    
-                    if (!compressedData.isEmpty()) {
-                        // Create image XObject with proper memory management
-                        fz_buffer* imgBuf = nullptr;
-                        fz_image* fzImage = nullptr;
+                fz_try(m_ctx) {
+                    if (addSharedImage(resources, "BGImg", prepared.customBackgroundKey,
+                                       prepared.customBackground)) {
+                        // Draw image covering entire page
+                        char cmd[128];
+                        fz_append_string(m_ctx, finalContent, "q\n");
+                        snprintf(cmd, sizeof(cmd), "%.4f 0 0 %.4f 0 0 cm\n", widthPt, heightPt);
+                        fz_append_string(m_ctx, finalContent, cmd);
+                        fz_append_string(m_ctx, finalContent, "/BGImg Do\n");
+                        fz_append_string(m_ctx, finalContent, "Q\n");
                         
-                        fz_try(m_ctx) {
-                            imgBuf = fz_new_buffer_from_copied_data(m_ctx,
-                                reinterpret_cast<const unsigned char*>(compressedData.constData()),
-                                compressedData.size());
-                            
-                            fzImage = fz_new_image_from_buffer(m_ctx, imgBuf);
-                            fz_drop_buffer(m_ctx, imgBuf);
-                            imgBuf = nullptr;  // Prevent double-drop
-                            
-                            pdf_obj* imgXObj = pdf_add_image(m_ctx, m_outputDoc, fzImage);
-                            fz_drop_image(m_ctx, fzImage);
-                            fzImage = nullptr;  // Prevent double-drop
-                            
-                            // Add to resources
-                            pdf_obj* xobjectDict = pdf_dict_get(m_ctx, resources, PDF_NAME(XObject));
-                            if (!xobjectDict) {
-                                xobjectDict = pdf_new_dict(m_ctx, m_outputDoc, 4);
-                                pdf_dict_put(m_ctx, resources, PDF_NAME(XObject), xobjectDict);
-                            }
-                            
-                            char imgName[16];
-                            snprintf(imgName, sizeof(imgName), "Img%d", imageIndex++);
-                            pdf_dict_put(m_ctx, xobjectDict, pdf_new_name(m_ctx, imgName), imgXObj);
-                            
-                            // Draw image covering entire page
-                            char cmd[128];
-                            fz_append_string(m_ctx, finalContent, "q\n");
-                            snprintf(cmd, sizeof(cmd), "%.4f 0 0 %.4f 0 0 cm\n", widthPt, heightPt);
-                            fz_append_string(m_ctx, finalContent, cmd);
-                            snprintf(cmd, sizeof(cmd), "/%s Do\n", imgName);
-                            fz_append_string(m_ctx, finalContent, cmd);
-                            fz_append_string(m_ctx, finalContent, "Q\n");
-                            
-                            #ifdef SPEEDYNOTE_DEBUG
-                            qDebug() << "[MuPdfExporter] Added custom background image";
-                            #endif
-                        }
-                        fz_always(m_ctx) {
-                            if (imgBuf) fz_drop_buffer(m_ctx, imgBuf);
-                            if (fzImage) fz_drop_image(m_ctx, fzImage);
-                        }
-                        fz_catch(m_ctx) {
-                            qWarning() << "[MuPdfExporter] Failed to add custom background:" 
-                                       << fz_caught_message(m_ctx);
-                            // Continue without background (non-fatal)
-                        }
-                    }
-                }
-            }
-            
-            // 3. Render content with proper layer affinity ordering:
-            //    - Objects with affinity -1 (below all strokes)
-            //    - Layer 0 strokes
-            //    - Objects with affinity 0
-            //    - Layer 1 strokes
-            //    - Objects with affinity 1
-            //    - ... and so on
-            //    - Objects with affinity >= numLayers (always on top)
-            
-            int numLayers = static_cast<int>(page->vectorLayers.size());
-            qreal pageHeightSn = page->size.height();
-            
-            // Save graphics state for strokes/objects
-            fz_append_string(m_ctx, finalContent, "q\n");
-            
-            // Helper lambda to add objects with a specific affinity (sorted by zOrder)
-            auto addObjectsWithAffinity = [&](int affinity) {
-                auto it = page->objectsByAffinity.find(affinity);
-                if (it == page->objectsByAffinity.end()) return;
-                
-                // Sort by zOrder
-                std::vector<InsertedObject*> sorted = it->second;
-                std::sort(sorted.begin(), sorted.end(), 
-                          [](const InsertedObject* a, const InsertedObject* b) {
-                              return a->zOrder < b->zOrder;
-                          });
-                
-                for (const InsertedObject* obj : sorted) {
-                    if (obj->type() == QStringLiteral("image")) {
-                        const ImageObject* imgObj = dynamic_cast<const ImageObject*>(obj);
-                        if (imgObj && imgObj->isLoaded()) {
-                            addImageToPage(m_ctx, m_outputDoc, imgObj, finalContent, resources, imageIndex++, heightPt, m_options);
-                        }
+                        #ifdef SPEEDYNOTE_DEBUG
+                        qDebug() << "[MuPdfExporter] Added custom background image";
+                        #endif
                     }
                 }
-            };
-            
-            // Objects with affinity -1 (below all strokes)
-            addObjectsWithAffinity(-1);
-            
-            // Interleave layers and objects
-            for (int layerIdx = 0; layerIdx < numLayers; ++layerIdx) {
-                // Render this layer's strokes (with transparency support)
-                appendLayerStrokesToBuffer(m_ctx, m_outputDoc, finalContent, resources,
-                                          page->vectorLayers[layerIdx].get(), pageHeightSn, gsIndex, alphaToGsName,
-                                          m_options.darkenStrokes);
-                
-                // Render objects with affinity = layerIdx (above this layer, below next)
-                addObjectsWithAffinity(layerIdx);
-            }
-            
-            // Objects with affinity >= numLayers (always on top of all strokes)
-            for (const auto& [affinity, objects] : page->objectsByAffinity) {
-                if (affinity >= numLayers) {
-                    // Sort by zOrder
-                    std::vector<InsertedObject*> sorted = objects;
-                    std::sort(sorted.begin(), sorted.end(), 
-                              [](const InsertedObject* a, const InsertedObject* b) {
-                                  return a->zOrder < b->zOrder;
-                              });
-                    
-                    for (const InsertedObject* obj : sorted) {
-                        if (obj->type() == QStringLiteral("image")) {
-                            const ImageObject* imgObj = dynamic_cast<const ImageObject*>(obj);
-                            if (imgObj && imgObj->isLoaded()) {
-                                addImageToPage(m_ctx, m_outputDoc, imgObj, finalContent, resources, imageIndex++, heightPt, m_options);
-                            }
-                        }
-                    }
+                fz_catch(m_ctx) {
+                    qWarning() << "[MuPdfExporter] Failed to add custom background:" 
+                               << fz_caught_message(m_ctx);
+                    // Continue without background (non-fatal)
                 }
             }
             
-            // Restore graphics state
+            // 3. Strokes and images in layer/affinity order (built by preparePage())
+            fz_append_string(m_ctx, finalContent, "q\n");
+            fz_append_data(m_ctx, finalContent, prepared.content.constData(),
+                           static_cast<size_t>(prepared.content.size()));
             fz_append_string(m_ctx, finalContent, "Q\n");
+            addPreparedResources(resources, prepared);
             
             // Create page with resources and combined content
             pdf_obj* pageObj = pdf_add_page(m_ctx, m_outputDoc, mediabox, 0, resources, finalContent);
@@ -1930,8 +2054,7 @@ static inline void transformPoint(float& x, float& y, qreal pageHeightSn)
  * body + round cap circles) are filled as one composite area without
  * double-compositing semi-transparent alpha.
  */
-static void appendPolygonToBuffer(fz_context* ctx, fz_buffer* buf, 
-                                   const QPolygonF& polygon, qreal pageHeightSn)
+static void appendPolygonToBuffer(QByteArray& buf, const QPolygonF& polygon, qreal pageHeightSn)
 {
     if (polygon.isEmpty()) return;
     
@@ -1942,7 +2065,7 @@ static void appendPolygonToBuffer(fz_context* ctx, fz_buffer* buf,
     float y = static_cast<float>(polygon[0].y());
     transformPoint(x, y, pageHeightSn);
     snprintf(cmd, sizeof(cmd), "%.4f %.4f m\n", x, y);
-    fz_append_string(ctx, buf, cmd);
+    buf.append(cmd);
     
     // Line to remaining points
     for (int i = 1; i < polygon.size(); ++i) {
@@ -1950,11 +2073,11 @@ static void appendPolygonToBuffer(fz_context* ctx, fz_buffer* buf,
         y = static_cast<float>(polygon[i].y());
         transformPoint(x, y, pageHeightSn);
         snprintf(cmd, sizeof(cmd), "%.4f %.4f l\n", x, y);
-        fz_append_string(ctx, buf, cmd);
+        buf.append(cmd);
     }
     
     // Close subpath (caller emits a single 'f' after all subpaths are written)
-    fz_append_string(ctx, buf, "h\n");
+    buf.append("h\n");
 }
 
 /**
@@ -1964,8 +2087,8 @@ static void appendPolygonToBuffer(fz_context* ctx, fz_buffer* buf,
  * Uses operators: m (moveto), c (curveto), h (closepath).
  * Does NOT emit f (fill) -- see appendPolygonToBuffer for rationale.
  */
-static void appendCircleToBuffer(fz_context* ctx, fz_buffer* buf,
-                                  const QPointF& center, qreal radius, qreal pageHeightSn)
+static void appendCircleToBuffer(QByteArray& buf, const QPointF& center, qreal radius,
+                                 qreal pageHeightSn)
 {
     if (radius <= 0) return;
     
@@ -1982,38 +2105,38 @@ static void appendCircleToBuffer(fz_context* ctx, fz_buffer* buf,
     
     // Start at right point of circle (3 o'clock)
     snprintf(cmd, sizeof(cmd), "%.4f %.4f m\n", cx + r, cy);
-    fz_append_string(ctx, buf, cmd);
+    buf.append(cmd);
     
     // Top-right quadrant (to 12 o'clock)
     snprintf(cmd, sizeof(cmd), "%.4f %.4f %.4f %.4f %.4f %.4f c\n",
              cx + r, cy + k,      // control point 1
              cx + k, cy + r,      // control point 2
              cx, cy + r);         // end point
-    fz_append_string(ctx, buf, cmd);
+    buf.append(cmd);
     
     // Top-left quadrant (to 9 o'clock)
     snprintf(cmd, sizeof(cmd), "%.4f %.4f %.4f %.4f %.4f %.4f c\n",
              cx - k, cy + r,
              cx - r, cy + k,
              cx - r, cy);
-    fz_append_string(ctx, buf, cmd);
+    buf.append(cmd);
     
     // Bottom-left quadrant (to 6 o'clock)
     snprintf(cmd, sizeof(cmd), "%.4f %.4f %.4f %.4f %.4f %.4f c\n",
              cx - r, cy - k,
              cx - k, cy - r,
              cx, cy - r);
-    fz_append_string(ctx, buf, cmd);
+    buf.append(cmd);
     
     // Bottom-right quadrant (back to 3 o'clock)
     snprintf(cmd, sizeof(cmd), "%.4f %.4f %.4f %.4f %.4f %.4f c\n",
              cx + k, cy - r,
              cx + r, cy - k,
              cx + r, cy);
-    fz_append_string(ctx, buf, cmd);
+    buf.append(cmd);
     
     // Close subpath (caller emits a single 'f' after all subpaths are written)
-    fz_append_string(ctx, buf, "h\n");
+    buf.append("h\n");
 }
 
 // NOTE: This function is currently unused. The implementation uses content stream operators
@@ -2059,31 +2182,26 @@ fz_path* MuPdfExporter::polygonToPath(const QPolygonF& polygon, qreal pageHeight
 }
 
 /**
- * @brief Get or create an ExtGState resource for a given alpha value.
- * @param ctx MuPDF context
- * @param outputDoc Output PDF document
- * @param resources Resources dictionary to add ExtGState to
+ * @brief Get or create an ExtGState resource name for a given alpha value.
+ * @param extGStates ExtGStates the page needs (name, fill alpha); new entries are appended
  * @param alpha The fill alpha value (0.0 to 1.0)
- * @param gsIndex Current graphics state index (will be incremented only if new entry created)
  * @param alphaToGsName Cache mapping alpha values to existing GS names (for reuse)
  * @return The name of the ExtGState (e.g., "GS0", "GS1", etc.) or empty if alpha is 1.0
  * 
- * Creates an ExtGState dictionary with:
+ * The writer turns each entry into an ExtGState dictionary with:
  *   /Type /ExtGState
  *   /ca <alpha>   (fill alpha)
- * 
- * The ExtGState is added to resources under /ExtGState/<name>.
+ * under /ExtGState/<name> in the page resources (addPreparedResources()).
  * 
  * OPTIMIZATION: Caches ExtGState entries by alpha value (quantized to 2 decimal places).
  * Multiple strokes with the same opacity reuse the same ExtGState entry.
  */
-static QString getOrCreateExtGState(fz_context* ctx, pdf_document* outputDoc,
-                                     pdf_obj* resources, float alpha, int& gsIndex,
-                                     std::map<int, QString>& alphaToGsName)
+static QByteArray getOrCreateExtGState(QVector<QPair<QByteArray, float>>& extGStates, float alpha,
+                                       std::map<int, QByteArray>& alphaToGsName)
 {
     // If fully opaque, no need for ExtGState
     if (alpha >= 0.999f) {
-        return QString();
+        return QByteArray();
     }
     
     // Clamp alpha to valid range
@@ -2100,23 +2218,8 @@ static QString getOrCreateExtGState(fz_context* ctx, pdf_document* outputDoc,
     }
     
     // Generate unique name for this graphics state
-    QString gsName = QStringLiteral("GS%1").arg(gsIndex++);
-    QByteArray gsNameUtf8 = gsName.toUtf8();
-    
-    // Get or create ExtGState dictionary in resources
-    pdf_obj* extGStateDict = pdf_dict_get(ctx, resources, PDF_NAME(ExtGState));
-    if (!extGStateDict) {
-        extGStateDict = pdf_new_dict(ctx, outputDoc, 4);
-        pdf_dict_put(ctx, resources, PDF_NAME(ExtGState), extGStateDict);
-    }
-    
-    // Create the graphics state dictionary
-    pdf_obj* gsDict = pdf_new_dict(ctx, outputDoc, 2);
-    pdf_dict_put(ctx, gsDict, PDF_NAME(Type), PDF_NAME(ExtGState));
-    pdf_dict_put_real(ctx, gsDict, PDF_NAME(ca), alpha);  // Fill alpha (lowercase 'ca')
-    
-    // Add to ExtGState dictionary
-    pdf_dict_put(ctx, extGStateDict, pdf_new_name(ctx, gsNameUtf8.constData()), gsDict);
+    QByteArray gsName = "GS" + QByteArray::number(extGStates.size());
+    extGStates.append(qMakePair(gsName, alpha));
     
     // Cache for reuse
     alphaToGsName[alphaKey] = gsName;
@@ -2126,57 +2229,44 @@ static QString getOrCreateExtGState(fz_context* ctx, pdf_document* outputDoc,
 
 /**
  * @brief Append a single layer's strokes to the content buffer.
- * @param ctx MuPDF context
- * @param outputDoc Output PDF document (for creating ExtGState resources)
- * @param buf Buffer to append to (must not be null)
- * @param resources Resources dictionary (for adding ExtGState entries)
- * @param layer The vector layer to render
+ * @param buf Content stream to append to
+ * @param extGStates ExtGStates the page needs (for stroke transparency)
+ * @param strokes The visible layer's strokes
+ * @param layerOpacity The layer's opacity
  * @param pageHeightSn Page height in SpeedyNote coordinates (for Y-flip)
- * @param gsIndex Current graphics state index counter (modified by function)
  * @param alphaToGsName Cache for ExtGState names by alpha value (for reuse)
  * 
  * This is used by the interleaved rendering to render layers one at a time,
  * allowing objects to be inserted between layers based on their affinity.
+ * Runs on export worker threads: touches no MuPDF state.
  * 
  * Opacity handling:
  * - Layer opacity is applied to all strokes in the layer
  * - Stroke color alpha is multiplied with layer opacity
- * - Total alpha < 1.0 creates an ExtGState with fill alpha (ca)
+ * - Total alpha < 1.0 uses an ExtGState with fill alpha (ca)
  */
-static void appendLayerStrokesToBuffer(fz_context* ctx, pdf_document* outputDoc,
-                                       fz_buffer* buf, pdf_obj* resources,
-                                       const VectorLayer* layer, qreal pageHeightSn,
-                                       int& gsIndex, std::map<int, QString>& alphaToGsName,
+static void appendLayerStrokesToBuffer(QByteArray& buf, QVector<QPair<QByteArray, float>>& extGStates,
+                                       const QVector<VectorStroke>& strokes, float layerOpacity,
+                                       qreal pageHeightSn, std::map<int, QByteArray>& alphaToGsName,
                                        bool darkenStrokes)
 {
-    if (!ctx || !buf || !layer) return;
-    
-    if (!layer->visible || layer->strokes().isEmpty()) {
-        return;
-    }
-    
-    // Get layer opacity
-    float layerOpacity = static_cast<float>(layer->opacity);
-    
-    for (const VectorStroke& stroke : layer->strokes()) {
+    for (const VectorStroke& stroke : strokes) {
         // Build the stroke polygon using existing VectorLayer logic
         VectorLayer::StrokePolygonResult polyResult = VectorLayer::buildStrokePolygon(stroke);
         
         // Calculate effective alpha (stroke alpha × layer opacity)
         float strokeAlpha = static_cast<float>(stroke.color.alphaF());
         float effectiveAlpha = strokeAlpha * layerOpacity;
-        bool needsTransparency = (effectiveAlpha < 0.999f) && resources && outputDoc;
+        bool needsTransparency = (effectiveAlpha < 0.999f);
         
         // Save graphics state if using transparency (so we can restore after)
         if (needsTransparency) {
-            fz_append_string(ctx, buf, "q\n");
+            buf.append("q\n");
             
             // Apply transparency via ExtGState (reuses existing entry if same alpha)
-            QString gsName = getOrCreateExtGState(ctx, outputDoc, resources, effectiveAlpha, gsIndex, alphaToGsName);
+            QByteArray gsName = getOrCreateExtGState(extGStates, effectiveAlpha, alphaToGsName);
             if (!gsName.isEmpty()) {
-                char gsCmd[32];
-                snprintf(gsCmd, sizeof(gsCmd), "/%s gs\n", gsName.toUtf8().constData());
-                fz_append_string(ctx, buf, gsCmd);
+                buf.append('/').append(gsName).append(" gs\n");
             }
         }
         
@@ -2191,29 +2281,29 @@ static void appendLayerStrokesToBuffer(fz_context* ctx, pdf_document* outputDoc,
         
         char colorCmd[64];
         snprintf(colorCmd, sizeof(colorCmd), "%.4f %.4f %.4f rg\n", r, g, b);
-        fz_append_string(ctx, buf, colorCmd);
+        buf.append(colorCmd);
         
         if (polyResult.isSinglePoint) {
-            appendCircleToBuffer(ctx, buf, polyResult.startCapCenter, 
-                                polyResult.startCapRadius, pageHeightSn);
-            fz_append_string(ctx, buf, "f\n");
+            appendCircleToBuffer(buf, polyResult.startCapCenter, 
+                                 polyResult.startCapRadius, pageHeightSn);
+            buf.append("f\n");
         } else if (!polyResult.polygon.isEmpty()) {
-            appendPolygonToBuffer(ctx, buf, polyResult.polygon, pageHeightSn);
+            appendPolygonToBuffer(buf, polyResult.polygon, pageHeightSn);
             
             if (polyResult.hasRoundCaps) {
-                appendCircleToBuffer(ctx, buf, polyResult.startCapCenter,
-                                    polyResult.startCapRadius, pageHeightSn);
-                appendCircleToBuffer(ctx, buf, polyResult.endCapCenter,
-                                    polyResult.endCapRadius, pageHeightSn);
+                appendCircleToBuffer(buf, polyResult.startCapCenter,
+                                     polyResult.startCapRadius, pageHeightSn);
+                appendCircleToBuffer(buf, polyResult.endCapCenter,
+                                     polyResult.endCapRadius, pageHeightSn);
             }
             // Single fill for all subpaths (polygon + caps) to prevent
             // double-opacity at cap/body overlap for semi-transparent strokes
-            fz_append_string(ctx, buf, "f\n");
+            buf.append("f\n");
         }
         
         // Restore graphics state if we saved it for transparency
         if (needsTransparency) {
-            fz_append_string(ctx, buf, "Q\n");
+            buf.append("Q\n");
         }
     }
 }
@@ -2409,176 +2499,229 @@ pdf_obj* MuPdfExporter::importPageAsXObject(int sourcePageIndex)
 // Image Handling (Phase 5 - TODO)
 // ============================================================================
 
-static bool addImageToPage(fz_context* ctx, pdf_document* outputDoc,
-                           const ImageObject* img, fz_buffer* contentBuf,
-                           pdf_obj* resources, int imageIndex, float pageHeightPt,
-                           const PdfExportOptions& options)
+/**
+ * @brief Append the commands that draw an image object.
+ * @param contentBuf Content stream to append to
+ * @param imgName XObject name of the image within the page
+ * @param position Top-left position in SpeedyNote coordinates
+ * @param size Display size in SpeedyNote coordinates (non-empty)
+ * @param rotation Rotation in degrees
+ * @param pageHeightPt Page height in PDF points (for Y-flip)
+ * 
+ * Runs on export worker threads: touches no MuPDF state.
+ */
+static void appendImageToContent(QByteArray& contentBuf, const QByteArray& imgName,
+                                 const QPointF& position, const QSizeF& size, qreal rotation,
+                                 float pageHeightPt)
 {
-    if (!img || !contentBuf || !resources || !ctx || !outputDoc) {
-        return false;
-    }
-    
-    // Check if image is loaded
-    if (!img->isLoaded() || img->pixmap().isNull()) {
-        qWarning() << "[MuPdfExporter] Image not loaded:" << img->imagePath;
-        return false;
-    }
-    
-    // Skip invisible images
-    if (!img->visible) {
-        return true;
-    }
-    
-    // Get image data
-    QImage qimg = img->pixmap().toImage();
-    if (qimg.isNull()) {
-        qWarning() << "[MuPdfExporter] Failed to convert pixmap to image";
-        return false;
-    }
-    
-    // Determine if image has alpha
-    bool hasAlpha = qimg.hasAlphaChannel();
-    
     // Calculate display size in PDF points
     // SpeedyNote uses 96 DPI, PDF uses 72 DPI
-    float displayWidthPt = static_cast<float>(img->size.width()) * SN_TO_PDF_SCALE;
-    float displayHeightPt = static_cast<float>(img->size.height()) * SN_TO_PDF_SCALE;
-    
-    // Skip zero-size images (would cause invalid transformation matrix)
-    if (displayWidthPt <= 0 || displayHeightPt <= 0) {
-        qWarning() << "[MuPdfExporter] Skipping zero-size image";
-        return true;
+    float displayWidthPt = static_cast<float>(size.width()) * SN_TO_PDF_SCALE;
+    float displayHeightPt = static_cast<float>(size.height()) * SN_TO_PDF_SCALE;
+    
+    // Build transformation matrix for position, scale, and rotation
+    // PDF image XObjects are 1x1 unit, so we need to scale to display size
+    // Position is relative to page origin (bottom-left in PDF)
+    
+    float posX = static_cast<float>(position.x()) * SN_TO_PDF_SCALE;
+    float posY = static_cast<float>(position.y()) * SN_TO_PDF_SCALE;
+    
+    // Convert Y from top-left origin to bottom-left origin
+    // The image's top-left corner in PDF coords
+    float pdfY = pageHeightPt - posY - displayHeightPt;
+    
+    // Append drawing commands to content buffer
+    contentBuf.append("q\n");  // Save graphics state
+    
+    if (rotation != 0.0) {
+        // For rotation, we need to:
+        // 1. Translate to image center
+        // 2. Rotate
+        // 3. Translate back
+        // 4. Scale and position
+        
+        float centerX = posX + displayWidthPt / 2.0f;
+        float centerY = pdfY + displayHeightPt / 2.0f;
+        
+        // Negate rotation angle to account for Y-axis flip
+        // SpeedyNote: Y increases downward, positive rotation = counterclockwise
+        // PDF: Y increases upward, so we need to negate to preserve visual rotation direction
+        float radians = static_cast<float>(-rotation * M_PI / 180.0);
+        float cosR = cosf(radians);
+        float sinR = sinf(radians);
+        
+        // Combined matrix: translate to center, rotate, translate back, then scale/position
+        // This is complex, so let's build it step by step in the content stream
+        char cmd[256];
+        
+        // Translate to center, rotate, translate back
+        snprintf(cmd, sizeof(cmd), 
+                 "1 0 0 1 %.4f %.4f cm\n",  // Translate to center
+                 centerX, centerY);
+        contentBuf.append(cmd);
+        
+        snprintf(cmd, sizeof(cmd),
+                 "%.4f %.4f %.4f %.4f 0 0 cm\n",  // Rotate
+                 cosR, sinR, -sinR, cosR);
+        contentBuf.append(cmd);
+        
+        snprintf(cmd, sizeof(cmd),
+                 "1 0 0 1 %.4f %.4f cm\n",  // Translate back
+                 -displayWidthPt / 2.0f, -displayHeightPt / 2.0f);
+        contentBuf.append(cmd);
+        
+        // Scale to display size (image XObject is 1x1)
+        snprintf(cmd, sizeof(cmd),
+                 "%.4f 0 0 %.4f 0 0 cm\n",
+                 displayWidthPt, displayHeightPt);
+        contentBuf.append(cmd);
+    } else {
+        // No rotation - simple scale and position
+        char cmd[128];
+        snprintf(cmd, sizeof(cmd),
+                 "%.4f 0 0 %.4f %.4f %.4f cm\n",
+                 displayWidthPt, displayHeightPt, posX, pdfY);
+        contentBuf.append(cmd);
     }
     
-    QSizeF displaySizePt(displayWidthPt, displayHeightPt);
+    // Draw the image
+    contentBuf.append('/').append(imgName).append(" Do\n");
     
-    // Compress with downsampling
-    QByteArray compressedData = MuPdfExporter::compressImage(qimg, hasAlpha, displaySizePt, options.dpi);
-    if (compressedData.isEmpty()) {
-        qWarning() << "[MuPdfExporter] Failed to compress image";
-        return false;
-    }
+    contentBuf.append("Q\n");  // Restore graphics state
     
-    fz_buffer* imgBuf = nullptr;
+    #ifdef SPEEDYNOTE_DEBUG
+    qDebug() << "[MuPdfExporter] Added image" << imgName 
+             << "at (" << posX << "," << pdfY << ")"
+             << "size" << displayWidthPt << "x" << displayHeightPt
+             << "rotation" << rotation;
+    #endif
+}
+
+/**
+ * @brief Resource key of a compressed image.
+ * @param contentId Identifies the pixels (ImageObject::imageHash, or a pixmap cache key)
+ * @param pixelSize Size after downsampling (MuPdfExporter::compressedPixelSize())
+ * @param hasAlpha Whether the image is compressed with alpha (PNG) or without (JPEG)
+ * 
+ * Equal keys compress to the same stream, so the export embeds one XObject
+ * per key and every page showing that image references it.
+ */
+static QByteArray imageResourceKey(const QByteArray& contentId, const QSize& pixelSize,
+                                   bool hasAlpha)
+{
+    return contentId + '|' + QByteArray::number(pixelSize.width()) + 'x'
+         + QByteArray::number(pixelSize.height()) + (hasAlpha ? "|alpha" : "|opaque");
+}
+
+/**
+ * @brief Embed compressed image data as an image XObject.
+ * @return The XObject reference (owned by the caller)
+ * 
+ * Writer thread only. Must be called inside fz_try(ctx); errors propagate.
+ */
+static pdf_obj* embedImage(fz_context* ctx, pdf_document* outputDoc, const QByteArray& compressedData)
+{
+    fz_buffer* imgBuf = fz_new_buffer_from_copied_data(ctx,
+        reinterpret_cast<const unsigned char*>(compressedData.constData()),
+        compressedData.size());
     fz_image* fzImage = nullptr;
+    pdf_obj* imgXObj = nullptr;
     
     fz_try(ctx) {
-        // Create image from compressed data
-        imgBuf = fz_new_buffer_from_copied_data(ctx, 
-            reinterpret_cast<const unsigned char*>(compressedData.constData()),
-            compressedData.size());
-        
         fzImage = fz_new_image_from_buffer(ctx, imgBuf);
-        fz_drop_buffer(ctx, imgBuf);
-        imgBuf = nullptr;  // Prevent double-drop in fz_always
-        
-        // Add image to PDF as XObject
-        pdf_obj* imgXObj = pdf_add_image(ctx, outputDoc, fzImage);
-        fz_drop_image(ctx, fzImage);
-        fzImage = nullptr;  // Prevent double-drop in fz_always
-        
-        // Get or create XObject dictionary in resources
-        pdf_obj* xobjectDict = pdf_dict_get(ctx, resources, PDF_NAME(XObject));
-        if (!xobjectDict) {
-            xobjectDict = pdf_new_dict(ctx, outputDoc, 4);
-            pdf_dict_put(ctx, resources, PDF_NAME(XObject), xobjectDict);
-        }
-        
-        // Add image XObject with unique name
-        char imgName[16];
-        snprintf(imgName, sizeof(imgName), "Img%d", imageIndex);
-        pdf_dict_put(ctx, xobjectDict, pdf_new_name(ctx, imgName), imgXObj);
-        
-        // Build transformation matrix for position, scale, and rotation
-        // PDF image XObjects are 1x1 unit, so we need to scale to display size
-        // Position is relative to page origin (bottom-left in PDF)
-        
-        float posX = static_cast<float>(img->position.x()) * SN_TO_PDF_SCALE;
-        float posY = static_cast<float>(img->position.y()) * SN_TO_PDF_SCALE;
-        
-        // Convert Y from top-left origin to bottom-left origin
-        // The image's top-left corner in PDF coords
-        float pdfY = pageHeightPt - posY - displayHeightPt;
-        
-        // Append drawing commands to content buffer
-        fz_append_string(ctx, contentBuf, "q\n");  // Save graphics state
-        
-        if (img->rotation != 0.0) {
-            // For rotation, we need to:
-            // 1. Translate to image center
-            // 2. Rotate
-            // 3. Translate back
-            // 4. Scale and position
-            
-            float centerX = posX + displayWidthPt / 2.0f;
-            float centerY = pdfY + displayHeightPt / 2.0f;
-            
-            // Negate rotation angle to account for Y-axis flip
-            // SpeedyNote: Y increases downward, positive rotation = counterclockwise
-            // PDF: Y increases upward, so we need to negate to preserve visual rotation direction
-            float radians = static_cast<float>(-img->rotation * M_PI / 180.0);
-            float cosR = cosf(radians);
-            float sinR = sinf(radians);
-            
-            // Combined matrix: translate to center, rotate, translate back, then scale/position
-            // This is complex, so let's build it step by step in the content stream
-            char cmd[256];
-            
-            // Translate to center, rotate, translate back
-            snprintf(cmd, sizeof(cmd), 
-                     "1 0 0 1 %.4f %.4f cm\n",  // Translate to center
-                     centerX, centerY);
-            fz_append_string(ctx, contentBuf, cmd);
-            
-            snprintf(cmd, sizeof(cmd),
-                     "%.4f %.4f %.4f %.4f 0 0 cm\n",  // Rotate
-                     cosR, sinR, -sinR, cosR);
-            fz_append_string(ctx, contentBuf, cmd);
-            
-            snprintf(cmd, sizeof(cmd),
-                     "1 0 0 1 %.4f %.4f cm\n",  // Translate back
-                     -displayWidthPt / 2.0f, -displayHeightPt / 2.0f);
-            fz_append_string(ctx, contentBuf, cmd);
-            
-            // Scale to display size (image XObject is 1x1)
-            snprintf(cmd, sizeof(cmd),
-                     "%.4f 0 0 %.4f 0 0 cm\n",
-                     displayWidthPt, displayHeightPt);
-            fz_append_string(ctx, contentBuf, cmd);
-        } else {
-            // No rotation - simple scale and position
-            char cmd[128];
-            snprintf(cmd, sizeof(cmd),
-                     "%.4f 0 0 %.4f %.4f %.4f cm\n",
-                     displayWidthPt, displayHeightPt, posX, pdfY);
-            fz_append_string(ctx, contentBuf, cmd);
-        }
-        
-        // Draw the image
-        char doCmd[32];
-        snprintf(doCmd, sizeof(doCmd), "/%s Do\n", imgName);
-        fz_append_string(ctx, contentBuf, doCmd);
-        
-        fz_append_string(ctx, contentBuf, "Q\n");  // Restore graphics state
-        
-        #ifdef SPEEDYNOTE_DEBUG
-        qDebug() << "[MuPdfExporter] Added image" << imageIndex 
-                 << "at (" << posX << "," << pdfY << ")"
-                 << "size" << displayWidthPt << "x" << displayHeightPt
-                 << "rotation" << img->rotation;
-        #endif
+        imgXObj = pdf_add_image(ctx, outputDoc, fzImage);
     }
     fz_always(ctx) {
-        // Clean up any resources that weren't transferred to the document
-        if (imgBuf) fz_drop_buffer(ctx, imgBuf);
-        if (fzImage) fz_drop_image(ctx, fzImage);
+        fz_drop_image(ctx, fzImage);
+        fz_drop_buffer(ctx, imgBuf);
     }
     fz_catch(ctx) {
-        qWarning() << "[MuPdfExporter] Failed to add image:" << fz_caught_message(ctx);
-        return false;
+        fz_rethrow(ctx);
+    }
+    return imgXObj;
+}
+
+/**
+ * @brief Register an XObject as /XObject/<name> in a resources dictionary.
+ * 
+ * Writer thread only. Must be called inside fz_try(ctx).
+ */
+static void putXObject(fz_context* ctx, pdf_document* outputDoc, pdf_obj* resources,
+                       const char* name, pdf_obj* xobject)
+{
+    // Get or create XObject dictionary in resources
+    pdf_obj* xobjectDict = pdf_dict_get(ctx, resources, PDF_NAME(XObject));
+    if (!xobjectDict) {
+        xobjectDict = pdf_new_dict(ctx, outputDoc, 4);
+        pdf_dict_put(ctx, resources, PDF_NAME(XObject), xobjectDict);
+    }
+    pdf_dict_put(ctx, xobjectDict, pdf_new_name(ctx, name), xobject);
+}
+
+/**
+ * @brief Rasterize a PDF page, invert its lightness and compress it.
+ * @param provider The page's PDF source (renders under its own lock)
+ * @param providerPage Provider-facing page index
+ * @param pageSizePt Page size in PDF points
+ * @param options Export options (DPI, image masking)
+ * @return Compressed background, or empty on failure
+ * 
+ * Used for dark-mode export when the vector background cannot be
+ * color-rewritten. Safe on export worker threads.
+ */
+static QByteArray renderDarkBackground(PdfProvider* provider, int providerPage,
+                                       const QSizeF& pageSizePt, const PdfExportOptions& options)
+{
+    if (!provider || !provider->isValid() || providerPage < 0) {
+        return QByteArray();
     }
     
-    return true;
+    QImage bgImage = provider->renderPageToImage(providerPage, static_cast<qreal>(options.dpi));
+    if (bgImage.isNull()) {
+        return QByteArray();
+    }
+    QVector<QRect> imgRegions;
+    if (!options.skipImageMasking) {
+        imgRegions = provider->imageRegions(providerPage, static_cast<qreal>(options.dpi));
+    }
+    DarkModeUtils::invertImageLightness(bgImage, imgRegions);
+    
+    return MuPdfExporter::compressImage(bgImage, false, pageSizePt, options.dpi);
+}
+
+QSize MuPdfExporter::compressedPixelSize(const QSize& imageSize, const QSizeF& displaySizePt,
+                                         int targetDpi)
+{
+    // Calculate if downsampling is needed
+    // Display size is in PDF points (72 DPI)
+    // Calculate the pixel size needed at target DPI
+    if (displaySizePt.width() <= 0 || displaySizePt.height() <= 0 || targetDpi <= 0
+        || imageSize.isEmpty()) {
+        return imageSize;
+    }
+    
+    // Display size in inches
+    qreal displayWidthInches = displaySizePt.width() / 72.0;
+    qreal displayHeightInches = displaySizePt.height() / 72.0;
+    
+    // Required pixels at target DPI
+    int requiredWidth = qRound(displayWidthInches * targetDpi);
+    int requiredHeight = qRound(displayHeightInches * targetDpi);
+    
+    // Only downsample if image is larger than needed
+    // (never upsample - that would increase file size without quality benefit)
+    if (imageSize.width() <= requiredWidth && imageSize.height() <= requiredHeight) {
+        return imageSize;
+    }
+    
+    // Calculate scale factor (maintain aspect ratio)
+    qreal scaleX = static_cast<qreal>(requiredWidth) / imageSize.width();
+    qreal scaleY = static_cast<qreal>(requiredHeight) / imageSize.height();
+    qreal scale = qMin(scaleX, scaleY);
+    
+    // Ensure minimum size of 1x1
+    return QSize(qMax(1, qRound(imageSize.width() * scale)),
+                 qMax(1, qRound(imageSize.height() * scale)));
 }
 
 QByteArray MuPdfExporter::compressImage(const QImage& image, bool hasAlpha,
@@ -2588,46 +2731,20 @@ QByteArray MuPdfExporter::compressImage(const QImage& image, bool hasAlpha,
         return QByteArray();
     }
     
-    // Calculate if downsampling is needed
-    // Display size is in PDF points (72 DPI)
-    // Calculate the pixel size needed at target DPI
     QImage workImage = image;
     
-    if (displaySizePt.width() > 0 && displaySizePt.height() > 0 && targetDpi > 0) {
-        // Display size in inches
-        qreal displayWidthInches = displaySizePt.width() / 72.0;
-        qreal displayHeightInches = displaySizePt.height() / 72.0;
-        
-        // Required pixels at target DPI
-        int requiredWidth = qRound(displayWidthInches * targetDpi);
-        int requiredHeight = qRound(displayHeightInches * targetDpi);
-        
-        // Only downsample if image is larger than needed
-        // (never upsample - that would increase file size without quality benefit)
-        if (image.width() > requiredWidth || image.height() > requiredHeight) {
-            // Calculate scale factor (maintain aspect ratio)
-            qreal scaleX = static_cast<qreal>(requiredWidth) / image.width();
-            qreal scaleY = static_cast<qreal>(requiredHeight) / image.height();
-            qreal scale = qMin(scaleX, scaleY);
-            
-            int newWidth = qRound(image.width() * scale);
-            int newHeight = qRound(image.height() * scale);
-            
-            // Ensure minimum size of 1x1
-            newWidth = qMax(1, newWidth);
-            newHeight = qMax(1, newHeight);
-            
-            #ifdef SPEEDYNOTE_DEBUG
-            qDebug() << "[MuPdfExporter] Downsampling image from"
-                     << image.width() << "x" << image.height()
-                     << "to" << newWidth << "x" << newHeight
-                     << "(target:" << targetDpi << "DPI)";
-            #endif
-            // Use smooth transformation for high quality downsampling
-            workImage = image.scaled(newWidth, newHeight, 
-                                     Qt::KeepAspectRatio, 
-                                     Qt::SmoothTransformation);
-        }
+    const QSize targetSize = compressedPixelSize(image.size(), displaySizePt, targetDpi);
+    if (targetSize != image.size()) {
+        #ifdef SPEEDYNOTE_DEBUG
+        qDebug() << "[MuPdfExporter] Downsampling image from"
+                 << image.width() << "x" << image.height()
+                 << "to" << targetSize.width() << "x" << targetSize.height()
+                 << "(target:" << targetDpi << "DPI)";
+        #endif
+        // Use smooth transformation for high quality downsampling
+        workImage = image.scaled(targetSize, 
+                                 Qt::KeepAspectRatio, 
+                                 Qt::SmoothTransformation);
     }
     
     // Compress the (possibly downsampled) image
@@ -10,8 +10,12 @@
 // - Page grafting: Copy unmodified PDF pages efficiently (no re-rendering)
 // - Vector strokes: Convert SpeedyNote strokes to PDF vector paths
 // - PDF backgrounds: Embed source PDF pages as XObjects (preserves quality)
-// - Image embedding: Export ImageObjects with smart compression
+// - Image embedding: Export ImageObjects with smart compression; each unique
+//   image (content, pixel size, alpha) is compressed and embedded once
 // - Metadata: Preserve original PDF metadata and outline
+// - Pipelined: page content (stroke paths, image compression, dark-mode
+//   rasters) is generated on worker threads while the calling thread writes
+//   finished pages into the output document in page order
 //
 // This is used on all platforms (desktop and Android) for PDF export,
 // while viewing continues to use Poppler (desktop) or MuPdfProvider (Android).
@@ -60,6 +64,9 @@ struct PdfExportResult {
 #include <QImage>
 #include <QSizeF>
 #include <QRectF>
+#include <QHash>
+#include <QSet>
+#include <QByteArray>
 
 // Forward declarations for MuPDF implementation
 class Page;
@@ -85,6 +92,8 @@ struct pdf_obj;
  * 
  * Thread Safety: This class is NOT thread-safe. Export operations should
  * be run from a single thread, though progress signals are emitted for UI updates.
+ * Internally, exportPdf() hands page content generation to a private thread
+ * pool; all MuPDF objects are only touched by the calling thread.
  * 
  * Usage:
  * @code
@@ -156,6 +165,16 @@ public:
      */
     static QVector<int> parsePageRange(const QString& rangeString, int totalPages);
     
+    /**
+     * @brief Pixel size compressImage() produces for an image.
+     * @param imageSize Source image size in pixels
+     * @param displaySizePt Display size in PDF points (72 DPI)
+     * @param targetDpi Target resolution for downsampling
+     * @return imageSize, or the downsampled size if the image exceeds targetDpi
+     */
+    static QSize compressedPixelSize(const QSize& imageSize, const QSizeF& displaySizePt,
+                                     int targetDpi);
+    
     /**
      * @brief Compress an image for PDF embedding with optional downsampling.
      * @param image Source image
@@ -250,6 +269,53 @@ private:
     
     // ===== Page Processing =====
     
+    /// Qt-only snapshot of one page's content, taken on the calling thread.
+    struct PageJob;
+    
+    /// Content stream and compressed images of one page, built by a worker.
+    struct PreparedPage;
+    
+    /// Pages prepared ahead of the writer, per pool thread.
+    static constexpr int PIPELINE_DEPTH_PER_THREAD = 2;
+    
+    /**
+     * @brief Snapshot what a worker needs to prepare a page.
+     * @param pageIndex 0-based page index (loaded here if needed)
+     * @param job Receives the snapshot (strokes, images, background inputs)
+     * @return false if the page does not exist
+     */
+    bool planPage(int pageIndex, PageJob& job);
+    
+    /**
+     * @brief Build a page's content stream and compressed images (worker thread).
+     * 
+     * Touches no MuPDF or Document state - only the snapshot in @p job.
+     */
+    static PreparedPage preparePage(const PageJob& job, const PdfExportOptions& options);
+    
+    /**
+     * @brief Add the images and ExtGStates a prepared page references to @p resources.
+     * 
+     * Must be called inside fz_try(m_ctx).
+     */
+    void addPreparedResources(pdf_obj* resources, const PreparedPage& prepared);
+    
+    /**
+     * @brief Reference a shared image XObject as /XObject/<name> in @p resources.
+     * @param key Image resource key (content, pixel size, alpha)
+     * @param data Compressed image; only needed the first time @p key is embedded
+     * @return false if @p key was never compressed (its first use failed)
+     * 
+     * Must be called inside fz_try(m_ctx).
+     */
+    bool addSharedImage(pdf_obj* resources, const char* name, const QByteArray& key,
+                        const QByteArray& data);
+    
+    /**
+     * @brief Keep compressed images a written page did not embed for later pages.
+     */
+    void keepUnembeddedImages(const PreparedPage& prepared);
+    
     /**
      * @brief Check if a page has been modified and needs rendering.
      * @param pageIndex 0-based page index
@@ -267,16 +333,18 @@ private:
     /**
      * @brief Render a modified page (strokes, images, background).
      * @param pageIndex 0-based page index
+     * @param prepared The page's content from preparePage()
      * @return true if successful
      */
-    bool renderModifiedPage(int pageIndex);
+    bool renderModifiedPage(int pageIndex, const PreparedPage& prepared);
     
     /**
      * @brief Render a page without PDF background (blank notebook page).
      * @param pageIndex 0-based page index
+     * @param prepared The page's content from preparePage()
      * @return true if successful
      */
-    bool renderBlankPage(int pageIndex);
+    bool renderBlankPage(int pageIndex, const PreparedPage& prepared);
     
     // ===== Vector Stroke Conversion =====
     
@@ -357,6 +425,12 @@ private:
     pdf_document* m_sourcePdf = nullptr;
     struct pdf_graft_map* m_graftMap = nullptr;
     
+    // Image resources shared across pages, by resource key (see planPage()).
+    // XObject references are owned here and dropped in cleanup().
+    QHash<QByteArray, pdf_obj*> m_imageXObjects;
+    QHash<QByteArray, QByteArray> m_unembeddedImages;  ///< Compressed, not yet drawn by any page
+    QSet<QByteArray> m_plannedImageKeys;               ///< Already handed to a worker to compress
+    
     // Export state
     bool m_isExporting = false;
     std::atomic<bool> m_cancelled{false};  ///< Thread-safe cancellation flag
@@ -11,6 +11,11 @@
 #include <QFile>
 #include <QMutexLocker>
 
+#include <cstddef>
+#include <cstdlib>
+
+#include "../core/CacheBudget.h"
+
 // CJK detection shared with PdfSearchEngine / DocumentViewport / OCR engines
 // so the "one PdfTextBox per CJK glyph" rule below stays consistent with the
 // space-joining heuristics used elsewhere.
@@ -28,8 +33,11 @@
 // Providing a real fz_locks_context shared across ALL provider instances lets
 // MuPDF's own fine-grained locking work correctly: only the critical sections
 // are serialised, while the rest of each render runs in parallel.
+//
+// The locks are installed on every build (not just Qt5/Win32): the render
+// pool clones contexts with fz_clone_context, which requires them to share
+// the resource store safely.
 // ============================================================================
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
 static QMutex s_mupdfLocks[FZ_LOCK_MAX];
 
 static void sn_mupdf_lock(void * /*user*/, int lock)
@@ -47,7 +55,62 @@ static fz_locks_context s_mupdfLocksCtx = {
     sn_mupdf_lock,
     sn_mupdf_unlock
 };
-#endif
+
+// ============================================================================
+// Allocation accounting
+// ============================================================================
+// MuPDF does not report how much its store holds, so each provider's
+// contexts allocate through these counting wrappers. Every block carries its
+// size in a header; the user pointer is the provider's byte counter, which
+// every clone of its context shares.
+// ============================================================================
+
+static constexpr size_t SN_ALLOC_HEADER = alignof(std::max_align_t);
+static_assert(SN_ALLOC_HEADER >= sizeof(size_t), "allocation header too small");
+
+// Net bytes the calling thread allocated through any provider; the
+// difference across recording a display list is that list's size.
+static thread_local qint64 t_mupdfThreadBytes = 0;
+
+static void* sn_mupdf_malloc(void* user, size_t size)
+{
+    char* block = static_cast<char*>(std::malloc(size + SN_ALLOC_HEADER));
+    if (!block) return nullptr;
+    *reinterpret_cast<size_t*>(block) = size;
+    static_cast<std::atomic<qint64>*>(user)->fetch_add(static_cast<qint64>(size),
+                                                       std::memory_order_relaxed);
+    t_mupdfThreadBytes += static_cast<qint64>(size);
+    return block + SN_ALLOC_HEADER;
+}
+
+static void sn_mupdf_free(void* user, void* ptr)
+{
+    if (!ptr) return;
+    char* block = static_cast<char*>(ptr) - SN_ALLOC_HEADER;
+    const size_t size = *reinterpret_cast<size_t*>(block);
+    static_cast<std::atomic<qint64>*>(user)->fetch_sub(static_cast<qint64>(size),
+                                                       std::memory_order_relaxed);
+    t_mupdfThreadBytes -= static_cast<qint64>(size);
+    std::free(block);
+}
+
+static void* sn_mupdf_realloc(void* user, void* ptr, size_t size)
+{
+    if (!ptr) return sn_mupdf_malloc(user, size);
+    if (size == 0) {
+        sn_mupdf_free(user, ptr);
+        return nullptr;
+    }
+    char* block = static_cast<char*>(ptr) - SN_ALLOC_HEADER;
+    const size_t oldSize = *reinterpret_cast<size_t*>(block);
+    char* grown = static_cast<char*>(std::realloc(block, size + SN_ALLOC_HEADER));
+    if (!grown) return nullptr;
+    *reinterpret_cast<size_t*>(grown) = size;
+    const qint64 delta = static_cast<qint64>(size) - static_cast<qint64>(oldSize);
+    static_cast<std::atomic<qint64>*>(user)->fetch_add(delta, std::memory_order_relaxed);
+    t_mupdfThreadBytes += delta;
+    return grown + SN_ALLOC_HEADER;
+}
 
 // ============================================================================
 // Construction / Destruction
@@ -58,12 +121,11 @@ static constexpr size_t SN_MUPDF_STORE_MAX = 32 << 20; // 32 MiB
 MuPdfProvider::MuPdfProvider(const QString& pdfPath)
     : m_path(pdfPath)
 {
-    // Create MuPDF context
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-    m_ctx = fz_new_context(nullptr, &s_mupdfLocksCtx, SN_MUPDF_STORE_MAX);
-#else
-    m_ctx = fz_new_context(nullptr, nullptr, SN_MUPDF_STORE_MAX);
-#endif
+    // Create MuPDF context (the store and the allocator are shared with
+    // every pooled clone; fz_new_context copies the allocator struct)
+    fz_alloc_context alloc = { &m_allocatedBytes, sn_mupdf_malloc,
+                               sn_mupdf_realloc, sn_mupdf_free };
+    m_ctx = fz_new_context(&alloc, &s_mupdfLocksCtx, SN_MUPDF_STORE_MAX);
     if (!m_ctx) {
         qWarning() << "MuPdfProvider: Failed to create MuPDF context";
         return;
@@ -102,6 +164,9 @@ MuPdfProvider::MuPdfProvider(const QString& pdfPath)
         qWarning() << "MuPdfProvider: Failed to get page count";
         m_pageCount = 0;
     }
+    
+    // What the parsed document holds; a store trim cannot free it
+    m_residentBytes = m_allocatedBytes.load();
     #ifdef SPEEDYNOTE_DEBUG
     qDebug() << "MuPdfProvider: Loaded" << pdfPath << "with" << m_pageCount << "pages";
     #endif
@@ -109,6 +174,14 @@ MuPdfProvider::MuPdfProvider(const QString& pdfPath)
 
 MuPdfProvider::~MuPdfProvider()
 {
+    clearDisplayListCache();
+    
+    // Clones must go before the document and the context they were cloned from
+    for (fz_context* ctx : m_idleContexts) {
+        fz_drop_context(ctx);
+    }
+    m_idleContexts.clear();
+    
     if (m_doc) {
         fz_drop_document(m_ctx, m_doc);
         m_doc = nullptr;
@@ -119,6 +192,175 @@ MuPdfProvider::~MuPdfProvider()
     }
 }
 
+// ============================================================================
+// Render Context Pool
+// ============================================================================
+
+class MuPdfProvider::ContextLease {
+public:
+    explicit ContextLease(const MuPdfProvider* provider)
+        : m_provider(provider), m_ctx(provider->acquireContext()) {}
+    ~ContextLease() {
+        if (m_ctx) m_provider->releaseContext(m_ctx);
+    }
+    ContextLease(const ContextLease&) = delete;
+    ContextLease& operator=(const ContextLease&) = delete;
+    
+    fz_context* get() const { return m_ctx; }
+    
+private:
+    const MuPdfProvider* m_provider;
+    fz_context* m_ctx;
+};
+
+fz_context* MuPdfProvider::acquireContext() const
+{
+    {
+        QMutexLocker locker(&m_poolMutex);
+        if (!m_idleContexts.isEmpty()) {
+            return m_idleContexts.takeLast();
+        }
+    }
+    
+    // Cloning reads the base context, so it counts as document access.
+    QMutexLocker locker(&m_mutex);
+    if (!m_ctx) return nullptr;
+    fz_context* ctx = fz_clone_context(m_ctx);
+    if (!ctx) {
+        qWarning() << "MuPdfProvider: Failed to clone render context";
+    }
+    return ctx;
+}
+
+void MuPdfProvider::releaseContext(fz_context* ctx) const
+{
+    QMutexLocker locker(&m_poolMutex);
+    if (m_idleContexts.size() < MAX_IDLE_CONTEXTS) {
+        m_idleContexts.append(ctx);
+        return;
+    }
+    locker.unlock();
+    fz_drop_context(ctx);
+}
+
+fz_display_list* MuPdfProvider::loadDisplayList(fz_context* ctx, int pageIndex,
+                                                QRectF& bounds, bool contentsOnly) const
+{
+    QMutexLocker locker(&m_mutex);
+    
+    fz_page* page = nullptr;
+    fz_display_list* list = nullptr;
+    
+    fz_try(ctx) {
+        page = fz_load_page(ctx, m_doc, pageIndex);
+        fz_rect r = fz_bound_page(ctx, page);
+        bounds = QRectF(r.x0, r.y0, r.x1 - r.x0, r.y1 - r.y0);
+        list = contentsOnly ? fz_new_display_list_from_page_contents(ctx, page)
+                            : fz_new_display_list_from_page(ctx, page);
+    }
+    fz_always(ctx) {
+        // Dropping the page touches the document too
+        if (page) fz_drop_page(ctx, page);
+    }
+    fz_catch(ctx) {
+        qWarning() << "MuPdfProvider: Failed to load page" << pageIndex
+                   << "-" << fz_caught_message(ctx);
+        return nullptr;
+    }
+    
+    return list;
+}
+
+// ============================================================================
+// Display List Cache
+// ============================================================================
+
+fz_display_list* MuPdfProvider::cachedDisplayList(fz_context* ctx, int pageIndex,
+                                                  QRectF& bounds) const
+{
+    {
+        QMutexLocker locker(&m_displayListMutex);
+        auto it = m_displayLists.find(pageIndex);
+        if (it != m_displayLists.end()) {
+            it->lastUse = CacheBudget::nowMs();
+            bounds = it->bounds;
+            return fz_keep_display_list(ctx, it->list);
+        }
+    }
+    
+    // Recording also loads fonts and images into the shared store; counting
+    // them against the list errs on the side of evicting it sooner.
+    const qint64 before = t_mupdfThreadBytes;
+    fz_display_list* list = loadDisplayList(ctx, pageIndex, bounds);
+    if (!list) {
+        return nullptr;
+    }
+    const qint64 bytes = qMax(MIN_DISPLAY_LIST_BYTES, t_mupdfThreadBytes - before);
+    if (bytes > MAX_DISPLAY_LIST_BYTES) {
+        return list;    // One huge page would flush every other list
+    }
+    
+    QMutexLocker locker(&m_displayListMutex);
+    if (m_displayLists.contains(pageIndex)) {
+        // Another thread recorded the same page meanwhile; keep theirs
+        return list;
+    }
+    
+    while (!m_displayLists.isEmpty() && m_displayListBytes + bytes > MAX_DISPLAY_LIST_BYTES) {
+        auto oldest = m_displayLists.begin();
+        for (auto it = m_displayLists.begin(); it != m_displayLists.end(); ++it) {
+            if (it->lastUse < oldest->lastUse) {
+                oldest = it;
+            }
+        }
+        m_displayListBytes -= oldest->bytes;
+        fz_drop_display_list(ctx, oldest->list);
+        m_displayLists.erase(oldest);
+    }
+    
+    CachedDisplayList entry;
+    entry.list = fz_keep_display_list(ctx, list);
+    entry.bounds = bounds;
+    entry.bytes = bytes;
+    entry.lastUse = CacheBudget::nowMs();
+    m_displayLists.insert(pageIndex, entry);
+    m_displayListBytes += bytes;
+    return list;
+}
+
+void MuPdfProvider::clearDisplayListCache() const
+{
+    QMutexLocker locker(&m_displayListMutex);
+    // Lists may come from any clone; they all share m_ctx's allocator and store
+    for (const CachedDisplayList& entry : m_displayLists) {
+        fz_drop_display_list(m_ctx, entry.list);
+    }
+    m_displayLists.clear();
+    m_displayListBytes = 0;
+}
+
+void MuPdfProvider::collectDisplayLists(QVector<DisplayListUsage>& lists) const
+{
+    QMutexLocker locker(&m_displayListMutex);
+    for (auto it = m_displayLists.constBegin(); it != m_displayLists.constEnd(); ++it) {
+        lists.append({it.key(), it->bytes, it->lastUse});
+    }
+}
+
+void MuPdfProvider::dropDisplayLists(const QVector<int>& pageIndices) const
+{
+    QMutexLocker locker(&m_displayListMutex);
+    for (int pageIndex : pageIndices) {
+        auto it = m_displayLists.find(pageIndex);
+        if (it == m_displayLists.end()) {
+            continue;
+        }
+        m_displayListBytes -= it->bytes;
+        fz_drop_display_list(m_ctx, it->list);
+        m_displayLists.erase(it);
+    }
+}
+
 // ============================================================================
 // Document Info
 // ============================================================================
@@ -130,6 +372,7 @@ bool MuPdfProvider::isValid() const
 
 bool MuPdfProvider::isLocked() const
 {
+    QMutexLocker locker(&m_mutex);
     if (!m_doc) return false;
     
     // Check if document needs password
@@ -166,6 +409,7 @@ QString MuPdfProvider::getMetadata(const char* key) const
 {
     if (!isValid()) return QString();
     
+    QMutexLocker locker(&m_mutex);
     char buf[256] = {0};
     fz_try(m_ctx) {
         fz_lookup_metadata(m_ctx, m_doc, key, buf, sizeof(buf));
@@ -185,6 +429,7 @@ bool MuPdfProvider::hasOutline() const
 {
     if (!isValid()) return false;
     
+    QMutexLocker locker(&m_mutex);
     fz_outline* ol = nullptr;
     fz_try(m_ctx) {
         ol = fz_load_outline(m_ctx, m_doc);
@@ -204,6 +449,7 @@ QVector<PdfOutlineItem> MuPdfProvider::outline() const
 {
     if (!isValid()) return {};
     
+    QMutexLocker locker(&m_mutex);
     fz_outline* ol = nullptr;
     fz_try(m_ctx) {
         ol = fz_load_outline(m_ctx, m_doc);
@@ -288,42 +534,66 @@ QSizeF MuPdfProvider::pageSize(int pageIndex) const
 
 QImage MuPdfProvider::renderPageToImage(int pageIndex, qreal dpi) const
 {
-    // Thread safety: MuPDF context is not thread-safe, so we need to serialize access
-    // This is especially important on Android where main thread sync renders can
-    // overlap with background async renders (BUG-A006)
-    QMutexLocker locker(&m_mutex);
-    
+    return renderPageArea(pageIndex, dpi, nullptr);
+}
+
+QImage MuPdfProvider::renderPageRegionToImage(int pageIndex, qreal dpi, const QRect& region) const
+{
+    if (region.isEmpty()) {
+        return QImage();
+    }
+    return renderPageArea(pageIndex, dpi, &region);
+}
+
+QImage MuPdfProvider::renderPageArea(int pageIndex, qreal dpi, const QRect* region) const
+{
+    // Thread safety: only loadDisplayList() touches the document (under
+    // m_mutex). Rasterization runs on this call's own cloned context, so
+    // main-thread sync renders, preload workers and thumbnails no longer
+    // queue behind each other (BUG-A006). A page rendered recently replays
+    // its cached display list and never takes m_mutex.
     if (!isValid() || pageIndex < 0 || pageIndex >= m_pageCount) {
         return QImage();
     }
+    m_lastRenderMs = CacheBudget::nowMs();
+    
+    ContextLease lease(this);
+    fz_context* ctx = lease.get();
+    if (!ctx) {
+        return QImage();
+    }
     
-    // Additional safety check for context
-    if (!m_ctx || !m_doc) {
-        qWarning() << "MuPdfProvider: Context or document is null";
+    QRectF pageBounds;
+    fz_display_list* list = cachedDisplayList(ctx, pageIndex, pageBounds);
+    if (!list) {
         return QImage();
     }
     
     // Scale factor: PDF points are 72 dpi
     float scale = dpi / 72.0f;
     
-    fz_page* page = nullptr;
     fz_pixmap* pix = nullptr;
+    fz_device* dev = nullptr;
     QImage result;
     
-    fz_try(m_ctx) {
-        // Load page
-        page = fz_load_page(m_ctx, m_doc, pageIndex);
-        if (!page) {
-            fz_throw(m_ctx, FZ_ERROR_GENERIC, "Failed to load page %d", pageIndex);
-        }
-        
+    fz_try(ctx) {
         // Create transformation matrix
         fz_matrix ctm = fz_scale(scale, scale);
         
         // Get page bounds at this scale
-        fz_rect bounds = fz_bound_page(m_ctx, page);
+        fz_rect bounds = fz_make_rect(pageBounds.left(), pageBounds.top(),
+                                      pageBounds.right(), pageBounds.bottom());
         fz_irect bbox = fz_round_rect(fz_transform_rect(bounds, ctm));
         
+        // Region renders keep the full page's pixel grid (region is relative
+        // to its top-left), so tiles line up exactly with a full render.
+        if (region) {
+            const fz_irect area = { bbox.x0 + region->left(), bbox.y0 + region->top(),
+                                    bbox.x0 + region->left() + region->width(),
+                                    bbox.y0 + region->top() + region->height() };
+            bbox = fz_intersect_irect(bbox, area);
+        }
+        
         // Bounds guard. Render DPI is already capped upstream (effectivePdfDpi()
         // caps at 300 DPI), so a full-page render is inherently memory-bounded by
         // the page's physical size. We only reject degenerate bounds and
@@ -339,36 +609,36 @@ QImage MuPdfProvider::renderPageToImage(int pageIndex, qreal dpi) const
             imgWidth > kMaxAxis || imgHeight > kMaxAxis ||
             totalPixels > kMaxPixels) {
             qWarning() << "MuPdfProvider: Invalid page bounds" << imgWidth << "x" << imgHeight;
-            fz_throw(m_ctx, FZ_ERROR_GENERIC, "Invalid page bounds");
+            fz_throw(ctx, FZ_ERROR_GENERIC, "Invalid page bounds");
         }
         
         // Create pixmap (BGRA for Qt compatibility)
-        pix = fz_new_pixmap_with_bbox(m_ctx, fz_device_bgr(m_ctx), bbox, nullptr, 1);
+        pix = fz_new_pixmap_with_bbox(ctx, fz_device_bgr(ctx), bbox, nullptr, 1);
         if (!pix) {
-            fz_throw(m_ctx, FZ_ERROR_GENERIC, "Failed to create pixmap");
+            fz_throw(ctx, FZ_ERROR_GENERIC, "Failed to create pixmap");
         }
-        fz_clear_pixmap_with_value(m_ctx, pix, 255); // White background
+        fz_clear_pixmap_with_value(ctx, pix, 255); // White background
         
-        // Render page to pixmap
-        fz_device* dev = fz_new_draw_device(m_ctx, ctm, pix);
+        // Render the recorded page to the pixmap
+        dev = fz_new_draw_device(ctx, ctm, pix);
         if (!dev) {
-            fz_throw(m_ctx, FZ_ERROR_GENERIC, "Failed to create draw device");
+            fz_throw(ctx, FZ_ERROR_GENERIC, "Failed to create draw device");
         }
-        fz_run_page(m_ctx, page, dev, fz_identity, nullptr);
-        fz_close_device(m_ctx, dev);
-        fz_drop_device(m_ctx, dev);
+        // Scissor to the pixmap so a tile skips everything outside it
+        fz_run_display_list(ctx, list, dev, fz_identity, fz_rect_from_irect(bbox), nullptr);
+        fz_close_device(ctx, dev);
         
         // Convert to QImage
-        int width = fz_pixmap_width(m_ctx, pix);
-        int height = fz_pixmap_height(m_ctx, pix);
-        int stride = fz_pixmap_stride(m_ctx, pix);
-        unsigned char* samples = fz_pixmap_samples(m_ctx, pix);
+        int width = fz_pixmap_width(ctx, pix);
+        int height = fz_pixmap_height(ctx, pix);
+        int stride = fz_pixmap_stride(ctx, pix);
+        unsigned char* samples = fz_pixmap_samples(ctx, pix);
         
         // Verify data is valid before copy
         if (!samples || stride < width * 4) {
             qWarning() << "MuPdfProvider: Invalid pixmap data - samples:" << (samples ? "valid" : "null")
                        << "stride:" << stride << "expected:" << (width * 4);
-            fz_throw(m_ctx, FZ_ERROR_GENERIC, "Invalid pixmap data");
+            fz_throw(ctx, FZ_ERROR_GENERIC, "Invalid pixmap data");
         }
         
         // Create QImage and copy data
@@ -376,7 +646,7 @@ QImage MuPdfProvider::renderPageToImage(int pageIndex, qreal dpi) const
         result = QImage(width, height, QImage::Format_ARGB32);
         if (result.isNull()) {
             qWarning() << "MuPdfProvider: Failed to allocate QImage" << width << "x" << height;
-            fz_throw(m_ctx, FZ_ERROR_GENERIC, "Failed to allocate QImage");
+            fz_throw(ctx, FZ_ERROR_GENERIC, "Failed to allocate QImage");
         }
         
         // Copy row by row, using QImage's bytesPerLine for destination stride
@@ -387,13 +657,14 @@ QImage MuPdfProvider::renderPageToImage(int pageIndex, qreal dpi) const
             memmove(dst, src, width * 4);
         }
     }
-    fz_always(m_ctx) {
-        if (pix) fz_drop_pixmap(m_ctx, pix);
-        if (page) fz_drop_page(m_ctx, page);
+    fz_always(ctx) {
+        if (dev) fz_drop_device(ctx, dev);
+        if (pix) fz_drop_pixmap(ctx, pix);
+        fz_drop_display_list(ctx, list);
     }
-    fz_catch(m_ctx) {
+    fz_catch(ctx) {
         qWarning() << "MuPdfProvider: Render failed for page" << pageIndex 
-                   << "-" << fz_caught_message(m_ctx);
+                   << "-" << fz_caught_message(ctx);
         return QImage();
     }
     
@@ -406,10 +677,35 @@ QImage MuPdfProvider::renderPageToImage(int pageIndex, qreal dpi) const
 
 void MuPdfProvider::trimStore() const
 {
+    // Called by the memory budget only. Cached display lists survive: they
+    // reference fz_image objects, not the decoded pixmaps this frees.
     QMutexLocker locker(&m_mutex);
     if (m_ctx) {
         fz_shrink_store(m_ctx, 0);
+        m_residentBytes = m_allocatedBytes.load() - displayListBytes();
+    }
+}
+
+qint64 MuPdfProvider::storeBytes() const
+{
+    // Renders in flight during the last trim raised the baseline; once they
+    // are freed, the lower total is the real floor.
+    const qint64 held = m_allocatedBytes.load() - displayListBytes();
+    qint64 resident = m_residentBytes.load();
+    while (held < resident && !m_residentBytes.compare_exchange_weak(resident, held)) {
     }
+    return qMax<qint64>(0, held - qMin(resident, held));
+}
+
+qint64 MuPdfProvider::lastRenderMs() const
+{
+    return m_lastRenderMs.load();
+}
+
+qint64 MuPdfProvider::displayListBytes() const
+{
+    QMutexLocker locker(&m_displayListMutex);
+    return m_displayListBytes;
 }
 
 // ============================================================================
@@ -448,24 +744,28 @@ static void img_collect_fill_image_mask(fz_context*, fz_device* dev_,
 
 QVector<QRect> MuPdfProvider::imageRegions(int pageIndex, qreal dpi) const
 {
-    QMutexLocker locker(&m_mutex);
     QVector<QRect> result;
 
     if (!isValid() || pageIndex < 0 || pageIndex >= m_pageCount)
         return result;
 
+    ContextLease lease(this);
+    // fz_new_derived_device macro internally references a bare 'ctx' variable
+    fz_context* ctx = lease.get();
+    if (!ctx)
+        return result;
+
+    QRectF pageBounds;
+    fz_display_list* list = cachedDisplayList(ctx, pageIndex, pageBounds);
+    if (!list)
+        return result;
+
     float scale = dpi / 72.0f;
     fz_matrix ctm = fz_scale(scale, scale);
-    fz_page* page = nullptr;
-
-    // fz_new_derived_device macro internally references a bare 'ctx' variable
-    fz_context* ctx = m_ctx;
 
     fz_device* dev = nullptr;
 
     fz_try(ctx) {
-        page = fz_load_page(ctx, m_doc, pageIndex);
-
         // Create a lightweight device that only records image positions
         ImageCollector* collector =
             fz_new_derived_device(ctx, ImageCollector);
@@ -474,12 +774,12 @@ QVector<QRect> MuPdfProvider::imageRegions(int pageIndex, qreal dpi) const
         collector->rects = &result;
 
         dev = &collector->super;
-        fz_run_page(ctx, page, dev, ctm, nullptr);
+        fz_run_display_list(ctx, list, dev, ctm, fz_infinite_rect, nullptr);
         fz_close_device(ctx, dev);
     }
     fz_always(ctx) {
         if (dev) fz_drop_device(ctx, dev);
-        if (page) fz_drop_page(ctx, page);
+        fz_drop_display_list(ctx, list);
     }
     fz_catch(ctx) {
         qWarning() << "MuPdfProvider: imageRegions failed for page" << pageIndex
@@ -496,22 +796,32 @@ QVector<QRect> MuPdfProvider::imageRegions(int pageIndex, qreal dpi) const
 
 QVector<PdfTextBox> MuPdfProvider::textBoxes(int pageIndex) const
 {
-    QMutexLocker locker(&m_mutex);
-    
     if (!isValid() || pageIndex < 0 || pageIndex >= m_pageCount) {
         return {};
     }
     
+    // Text extraction runs from the display list on a pooled context, so
+    // search workers only hold the document lock while the page is recorded.
+    ContextLease lease(this);
+    fz_context* ctx = lease.get();
+    if (!ctx) {
+        return {};
+    }
+    
+    QRectF pageBounds;
+    fz_display_list* list = loadDisplayList(ctx, pageIndex, pageBounds, true);
+    if (!list) {
+        return {};
+    }
+    
     QVector<PdfTextBox> boxes;
-    fz_page* page = nullptr;
     fz_stext_page* textPage = nullptr;
     
-    fz_try(m_ctx) {
-        page = fz_load_page(m_ctx, m_doc, pageIndex);
-        
-        // Extract text with positions
+    fz_try(ctx) {
+        // Extract text with positions (page contents only, as
+        // fz_new_stext_page_from_page does - annotation text is not selectable)
         fz_stext_options opts = {0};
-        textPage = fz_new_stext_page_from_page(m_ctx, page, &opts);
+        textPage = fz_new_stext_page_from_display_list(ctx, list, &opts);
         
         // Iterate through text blocks.
         //
@@ -584,11 +894,11 @@ QVector<PdfTextBox> MuPdfProvider::textBoxes(int pageIndex) const
             }
         }
     }
-    fz_always(m_ctx) {
-        if (textPage) fz_drop_stext_page(m_ctx, textPage);
-        if (page) fz_drop_page(m_ctx, page);
+    fz_always(ctx) {
+        if (textPage) fz_drop_stext_page(ctx, textPage);
+        fz_drop_display_list(ctx, list);
     }
-    fz_catch(m_ctx) {
+    fz_catch(ctx) {
         qWarning() << "MuPdfProvider: Text extraction failed for page" << pageIndex;
         return {};
     }
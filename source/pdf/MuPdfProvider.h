@@ -16,17 +16,37 @@
 // ============================================================================
 
 #include "PdfProvider.h"
+#include <QHash>
 #include <QMutex>
+#include <QVector>
+
+#include <atomic>
 
 // Forward declarations for MuPDF types (avoid exposing mupdf headers)
 struct fz_context;
 struct fz_document;
+struct fz_display_list;
 
 /**
  * @brief PdfProvider implementation using MuPDF.
  * 
  * Wraps the MuPDF library for PDF rendering, text extraction, and navigation.
  * Used on Android where Poppler is not available.
+ * 
+ * Thread safety: all methods may be called from any thread. Document access
+ * (loading a page and recording it into a display list) is serialized by
+ * m_mutex; the expensive part - rasterization, image-region collection and
+ * text extraction from that display list - runs outside the lock on a
+ * per-call context cloned from m_ctx (fz_clone_context). Clones share the
+ * resource store (fonts, decoded images), so several threads can render
+ * pages of one PDF in parallel without each reparsing the file.
+ * 
+ * The display lists of recently rendered pages are cached, so rendering a
+ * page again at another DPI (zoom settle, thumbnails) or scanning its image
+ * regions replays the recorded list instead of reinterpreting the content
+ * stream, and does not take m_mutex at all. The cache is sized in bytes
+ * (measured by the counting allocator) and each list is reported to
+ * CacheBudget through PdfProviderCache.
  */
 class MuPdfProvider : public PdfProvider {
 public:
@@ -65,8 +85,13 @@ public:
     
     // ===== Rendering =====
     QImage renderPageToImage(int pageIndex, qreal dpi) const override;
+    QImage renderPageRegionToImage(int pageIndex, qreal dpi, const QRect& region) const override;
     QVector<QRect> imageRegions(int pageIndex, qreal dpi) const override;
     void trimStore() const override;
+    qint64 storeBytes() const override;
+    qint64 lastRenderMs() const override;
+    void collectDisplayLists(QVector<DisplayListUsage>& lists) const override;
+    void dropDisplayLists(const QVector<int>& pageIndices) const override;
     
     // ===== Text Selection =====
     QVector<PdfTextBox> textBoxes(int pageIndex) const override;
@@ -91,6 +116,71 @@ private:
      */
     QVector<PdfOutlineItem> convertOutline(struct fz_outline* outline) const;
     
+    // ===== Render Context Pool =====
+    
+    class ContextLease;  ///< RAII acquire/release of a pooled context
+    
+    /// Idle cloned contexts kept for reuse; more may be live while busy.
+    static constexpr int MAX_IDLE_CONTEXTS = 8;
+    
+    /**
+     * @brief Take an idle cloned context, or clone a new one from m_ctx.
+     * @return nullptr if cloning fails.
+     */
+    fz_context* acquireContext() const;
+    
+    /// Return a context from acquireContext() to the pool.
+    void releaseContext(fz_context* ctx) const;
+    
+    /**
+     * @brief Load a page and record it into a display list.
+     * @param ctx A pooled context (the list belongs to it).
+     * @param pageIndex 0-based page index (validated by the caller).
+     * @param bounds Receives the page bounds (fz_bound_page) in PDF points.
+     * @param contentsOnly Record only the page contents, without annotations
+     *        and widgets (text extraction).
+     * @return The display list (caller drops it), or nullptr on failure.
+     *
+     * The only step that touches m_doc, so the only one holding m_mutex.
+     */
+    fz_display_list* loadDisplayList(fz_context* ctx, int pageIndex, QRectF& bounds,
+                                     bool contentsOnly = false) const;
+    
+    /**
+     * @brief Shared body of renderPageToImage() / renderPageRegionToImage().
+     * @param region Pixel rect within the full page image, or nullptr for
+     *        the whole page.
+     */
+    QImage renderPageArea(int pageIndex, qreal dpi, const QRect* region) const;
+    
+    // ===== Display List Cache =====
+    
+    /// Bytes of display lists kept per provider (LRU). fz_display_list does
+    /// not expose its size; it is what the recording thread allocated.
+    static constexpr qint64 MAX_DISPLAY_LIST_BYTES = 32LL << 20;
+    
+    /// Floor for a measured list size (frees during recording can offset it).
+    static constexpr qint64 MIN_DISPLAY_LIST_BYTES = 4096;
+    
+    /**
+     * @brief Cached full display list for a page, recording it on a miss.
+     * @return A new reference (caller drops it), or nullptr on failure.
+     */
+    fz_display_list* cachedDisplayList(fz_context* ctx, int pageIndex, QRectF& bounds) const;
+    
+    /// Drop every cached display list.
+    void clearDisplayListCache() const;
+    
+    /// Bytes held by the cached display lists.
+    qint64 displayListBytes() const;
+    
+    struct CachedDisplayList {
+        fz_display_list* list = nullptr;
+        QRectF bounds;          ///< Page bounds in PDF points
+        qint64 bytes = 0;       ///< Measured size
+        qint64 lastUse = 0;     ///< CacheBudget::nowMs() of the last use
+    };
+    
     // MuPDF context and document are mutable because fz_* functions 
     // modify internal state even for "read" operations like rendering.
     // This is required for proper const-correctness with MuPDF's API.
@@ -99,7 +189,22 @@ private:
     QString m_path;                       ///< Path to the PDF file
     int m_pageCount = 0;                  ///< Cached page count
     
-    // Mutex for thread-safety on Android (main thread sync + background async renders)
+    // Serializes document access (m_doc and m_ctx itself). MuPDF documents
+    // are not thread-safe even when each thread has its own context.
     mutable QMutex m_mutex;
+    
+    mutable QVector<fz_context*> m_idleContexts;  ///< Pooled clones of m_ctx
+    mutable QMutex m_poolMutex;                   ///< Guards m_idleContexts
+    
+    // Net bytes allocated by m_ctx and its clones (counting allocator), and
+    // that total minus the display lists right after opening or the last
+    // trimStore()
+    std::atomic<qint64> m_allocatedBytes{0};
+    mutable std::atomic<qint64> m_residentBytes{0};
+    mutable std::atomic<qint64> m_lastRenderMs{0};  ///< CacheBudget::nowMs()
+    
+    mutable QHash<int, CachedDisplayList> m_displayLists;  ///< Page index -> list
+    mutable qint64 m_displayListBytes = 0;
+    mutable QMutex m_displayListMutex;            ///< Guards m_displayLists
 };
 
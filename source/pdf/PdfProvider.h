@@ -212,6 +212,27 @@ public:
         return img.isNull() ? QPixmap() : QPixmap::fromImage(img);
     }
     
+    /**
+     * @brief Render one rectangle of a page to a QImage.
+     * @param pageIndex 0-based page index.
+     * @param dpi Resolution in dots per inch.
+     * @param region Rectangle in pixel coordinates of the full page image at
+     *        this DPI (the image renderPageToImage() would return).
+     * @return The part of the page inside @p region (clipped to the page),
+     *         or null QImage on error.
+     * 
+     * Used for tiled rendering at high zoom, where the full page image
+     * would be far larger than the visible part of it. Pixels match the
+     * full-page render exactly, so adjacent tiles join without seams.
+     * Default implementation crops renderPageToImage(); subclasses should
+     * override to render only the region.
+     */
+    virtual QImage renderPageRegionToImage(int pageIndex, qreal dpi, const QRect& region) const {
+        QImage img = renderPageToImage(pageIndex, dpi);
+        const QRect clipped = region.intersected(img.rect());
+        return clipped.isEmpty() ? QImage() : img.copy(clipped);
+    }
+    
     // ===== Image Region Detection (for dark-mode inversion masking) =====
 
     /**
@@ -234,11 +255,42 @@ public:
     /**
      * @brief Shrink the internal resource cache to free memory.
      *
-     * MuPDF keeps decoded images and fonts in an internal store.  Call this
-     * after rendering to release that memory when the application already
-     * caches the result at a higher level (e.g. QPixmap thumbnail cache).
+     * MuPDF keeps decoded images and fonts in an internal store, so rendering
+     * a page again does not decode them again. The memory budget
+     * (PdfProviderCache) calls this when the process is over its ceiling;
+     * renders do not trim.
      */
     virtual void trimStore() const {}
+    
+    /**
+     * @brief Bytes the internal resource cache holds that trimStore() can free.
+     *
+     * An estimate: what the backend allocated since opening or the last trim,
+     * beyond what it held then.
+     */
+    virtual qint64 storeBytes() const { return 0; }
+    
+    /// CacheBudget::nowMs() of the last render (0 = never rendered).
+    virtual qint64 lastRenderMs() const { return 0; }
+    
+    /**
+     * @brief A cached per-page recording the backend replays on later renders.
+     */
+    struct DisplayListUsage {
+        int pageIndex = -1;
+        qint64 bytes = 0;
+        qint64 lastUse = 0;     ///< CacheBudget::nowMs() of the last render using it
+    };
+    
+    /// Append every cached display list to @p lists.
+    virtual void collectDisplayLists(QVector<DisplayListUsage>& lists) const {
+        Q_UNUSED(lists);
+    }
+    
+    /// Drop the cached display lists of these pages (re-recorded on demand).
+    virtual void dropDisplayLists(const QVector<int>& pageIndices) const {
+        Q_UNUSED(pageIndices);
+    }
 
     // ===== Text Selection =====
     
@@ -287,6 +339,25 @@ public:
      */
     static std::unique_ptr<PdfProvider> create(const QString& pdfPath);
     
+    /**
+     * @brief Get the process-wide provider for the given file.
+     * @param pdfPath Path to the PDF file.
+     * @return Shared provider instance, or nullptr on failure.
+     * 
+     * Thread-safe. Every caller asking for the same file (same path, size
+     * and modification time) gets the same instance while anyone holds it,
+     * so documents, preload workers and thumbnail workers parse a PDF once
+     * and render from it concurrently (providers are internally thread-safe).
+     */
+    static std::shared_ptr<PdfProvider> shared(const QString& pdfPath);
+    
+    /**
+     * @brief Every provider handed out by shared() that is still held.
+     *
+     * Thread-safe. The references keep the providers alive; drop them soon.
+     */
+    static QVector<std::shared_ptr<PdfProvider>> sharedProviders();
+    
     /**
      * @brief Check if PDF support is available on this platform.
      * @return True if a PDF backend is available.
@@ -0,0 +1,83 @@
+// ============================================================================
+// PdfProviderCache - Implementation
+// ============================================================================
+
+#include "PdfProviderCache.h"
+#include "PdfProvider.h"
+
+#include <QHash>
+#include <QSet>
+
+PdfProviderCache::PdfProviderCache()
+{
+    CacheBudget::instance()->addClient(this);
+}
+
+PdfProviderCache* PdfProviderCache::instance()
+{
+    static PdfProviderCache* s_instance = new PdfProviderCache();
+    return s_instance;
+}
+
+// ===== CacheBudget::Client =====
+
+void PdfProviderCache::collectCacheItems(QVector<CacheBudget::Item>& items) const
+{
+    m_collected.clear();
+    const QVector<std::shared_ptr<PdfProvider>> providers = PdfProvider::sharedProviders();
+    for (const std::shared_ptr<PdfProvider>& provider : providers) {
+        const quint64 index = static_cast<quint64>(m_collected.size());
+        m_collected.append(provider);
+
+        const qint64 bytes = provider->storeBytes();
+        if (bytes > 0) {
+            CacheBudget::Item item;
+            item.key = (index << 32) | STORE_SLOT;
+            item.bytes = bytes;
+            item.lastUse = provider->lastRenderMs();
+            item.rebuildCost = CacheBudget::COST_PDF_RENDER;
+            items.append(item);
+        }
+
+        QVector<PdfProvider::DisplayListUsage> lists;
+        provider->collectDisplayLists(lists);
+        for (const PdfProvider::DisplayListUsage& list : lists) {
+            CacheBudget::Item item;
+            item.key = (index << 32) | static_cast<quint32>(list.pageIndex);
+            item.bytes = list.bytes;
+            item.lastUse = list.lastUse;
+            item.rebuildCost = CacheBudget::COST_DISPLAY_LIST;
+            items.append(item);
+        }
+    }
+}
+
+void PdfProviderCache::evictCacheItems(const QVector<quint64>& keys)
+{
+    QHash<int, QVector<int>> pagesByProvider;
+    QSet<int> trimmed;
+    for (quint64 key : keys) {
+        const int index = static_cast<int>(key >> 32);
+        const quint32 slot = static_cast<quint32>(key);
+        if (slot == STORE_SLOT) {
+            trimmed.insert(index);
+        } else {
+            pagesByProvider[index].append(static_cast<int>(slot));
+        }
+    }
+
+    auto providerAt = [this](int index) -> std::shared_ptr<PdfProvider> {
+        return index < m_collected.size() ? m_collected.at(index).lock() : nullptr;
+    };
+    // Lists first: trimming afterwards also frees what only they referenced
+    for (auto it = pagesByProvider.constBegin(); it != pagesByProvider.constEnd(); ++it) {
+        if (std::shared_ptr<PdfProvider> provider = providerAt(it.key())) {
+            provider->dropDisplayLists(it.value());
+        }
+    }
+    for (int index : trimmed) {
+        if (std::shared_ptr<PdfProvider> provider = providerAt(index)) {
+            provider->trimStore();
+        }
+    }
+}
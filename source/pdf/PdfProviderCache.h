@@ -0,0 +1,45 @@
+#pragma once
+
+// ============================================================================
+// PdfProviderCache - Memory budget client for the shared PDF providers
+// ============================================================================
+// Every PdfProvider::shared() instance keeps decoded images and fonts in its
+// backend store so a page renders again without decoding them again, and the
+// display lists of recently rendered pages so it does not reinterpret them.
+// That memory counts against CacheBudget like the rendered pixmaps do:
+// - Each provider's store is one item; evicting it trims the store
+//   (PdfProvider::trimStore()). Nothing else trims, so a page rendered twice
+//   in a row does not decode its images twice
+// - Each cached display list is one item; evicting it drops the list
+//
+// Thread safety: GUI thread only, like CacheBudget. Providers are thread-safe
+// and may render on workers while they are collected or trimmed.
+// ============================================================================
+
+#include "../core/CacheBudget.h"
+
+#include <QVector>
+
+#include <memory>
+
+class PdfProvider;
+
+class PdfProviderCache : public CacheBudget::Client {
+public:
+    /// The budget client (GUI thread; registered on first use).
+    static PdfProviderCache* instance();
+
+    // ===== CacheBudget::Client =====
+    QString cacheName() const override { return QStringLiteral("PDF provider stores"); }
+    void collectCacheItems(QVector<CacheBudget::Item>& items) const override;
+    void evictCacheItems(const QVector<quint64>& keys) override;
+
+private:
+    PdfProviderCache();
+
+    /// Item key: index into m_collected in the high half, slot in the low half.
+    static constexpr quint32 STORE_SLOT = 0xFFFFFFFFu;
+
+    /// Providers reported by the last collectCacheItems(), indexed by key.
+    mutable QVector<std::weak_ptr<PdfProvider>> m_collected;
+};
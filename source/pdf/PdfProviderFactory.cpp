@@ -12,9 +12,24 @@
 
 #include "PdfProvider.h"
 #include "MuPdfProvider.h"
+#include "PdfProviderCache.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
 
 #include <memory>
 
+namespace {
+// Registry behind PdfProvider::shared(): key -> provider while anyone holds it
+QMutex s_sharedMutex;
+QHash<QString, std::weak_ptr<PdfProvider>> s_sharedProviders;
+}
+
 // ============================================================================
 // Factory Methods
 // ============================================================================
@@ -28,6 +43,54 @@ std::unique_ptr<PdfProvider> PdfProvider::create(const QString& pdfPath)
     return nullptr;
 }
 
+std::shared_ptr<PdfProvider> PdfProvider::shared(const QString& pdfPath)
+{
+    // The budget client trims the providers' stores; it lives on the GUI thread
+    const QCoreApplication* app = QCoreApplication::instance();
+    if (app && QThread::currentThread() == app->thread()) {
+        PdfProviderCache::instance();
+    }
+    
+    // Size and mtime in the key: a file replaced on disk gets a new provider
+    // instead of the stale parse.
+    const QFileInfo info(pdfPath);
+    const QString key = info.absoluteFilePath() + QLatin1Char('|')
+                      + QString::number(info.size()) + QLatin1Char('|')
+                      + QString::number(info.lastModified().toMSecsSinceEpoch());
+    
+    QMutexLocker locker(&s_sharedMutex);
+    if (std::shared_ptr<PdfProvider> existing = s_sharedProviders.value(key).lock()) {
+        return existing;
+    }
+    
+    // Forget providers nobody holds any more
+    for (auto it = s_sharedProviders.begin(); it != s_sharedProviders.end();) {
+        if (it.value().expired()) {
+            it = s_sharedProviders.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    std::shared_ptr<PdfProvider> provider = create(pdfPath);
+    if (provider) {
+        s_sharedProviders.insert(key, provider);
+    }
+    return provider;
+}
+
+QVector<std::shared_ptr<PdfProvider>> PdfProvider::sharedProviders()
+{
+    QVector<std::shared_ptr<PdfProvider>> providers;
+    QMutexLocker locker(&s_sharedMutex);
+    for (const std::weak_ptr<PdfProvider>& weak : s_sharedProviders) {
+        if (std::shared_ptr<PdfProvider> provider = weak.lock()) {
+            providers.append(std::move(provider));
+        }
+    }
+    return providers;
+}
+
 bool PdfProvider::isAvailable()
 {
     // MuPDF is a compile-time dependency,
@@ -1,5 +1,6 @@
 #include "PdfSearchEngine.h"
 #include "PdfProvider.h"
+#include "PdfSearchIndex.h"
 #include "../core/Document.h"
 #include "../core/Page.h"
 #include "../ocr/OcrTextBlock.h"
@@ -32,6 +33,14 @@ PdfSearchEngine::PdfSearchEngine(QObject *parent)
             this, &PdfSearchEngine::onSearchFinished);
     connect(&m_precacheWatcher, &QFutureWatcher<void>::finished,
             this, &PdfSearchEngine::onPrecacheFinished);
+
+    // A whole-document scan indexes every page it touched: persist that even
+    // if the notebook itself is never saved this session.
+    connect(&m_scanWatcher, &QFutureWatcher<void>::finished, this, [this]() {
+        if (m_document) {
+            m_document->saveSearchIndex();
+        }
+    });
 }
 
 PdfSearchEngine::~PdfSearchEngine()
@@ -54,6 +63,7 @@ void PdfSearchEngine::setDocument(Document *doc)
         m_scanWatcher.waitForFinished();
         
         m_document = doc;
+        m_index = (doc && !doc->isEdgeless()) ? doc->searchIndex() : nullptr;
         clearCache();
         
         // Clear result state
@@ -153,20 +163,46 @@ QVector<PdfSearchMatch> PdfSearchEngine::searchPage(int pageIndex,
         return matches;
     }
     
-    // --- PDF text search (existing logic) ---
+    // The persistent index rules out pages that cannot match, so their PDF
+    // text is never extracted and (if evicted) the page is never loaded.
+    // Pages it doesn't know yet are searched as before and indexed on the way.
+    const QVector<quint64> queryTrigrams = PdfSearchIndex::trigrams(text);
+    
+    matches = searchPdfText(pageIndex, text, caseSensitive, wholeWord, queryTrigrams);
+    matches.append(searchPageText(pageIndex, text, caseSensitive, wholeWord,
+                                  queryTrigrams, matches.size()));
+    return matches;
+}
+
+QVector<PdfSearchMatch> PdfSearchEngine::searchPdfText(int pageIndex,
+                                                        const QString& text,
+                                                        bool caseSensitive,
+                                                        bool wholeWord,
+                                                        const QVector<quint64>& queryTrigrams) const
+{
+    QVector<PdfSearchMatch> matches;
+    
     // pageIndex is a notebook page index; resolve it to its own PDF source + page
     // number so that pages backed by ANY source (not just primary) are searchable.
     QString srcId;
     int pdfPageIdx = -1;
     if (m_document->pdfBindingForNotebookPage(pageIndex, srcId, pdfPageIdx)) {
+        const QString pdfKey = PdfSearchIndex::pdfKey(srcId, pdfPageIdx);
+        const bool pdfRuledOut = m_index
+            && m_index->lookup(pdfKey, queryTrigrams) == PdfSearchIndex::Lookup::Absent;
+        
         // Provider is pre-opened on the main thread (ensureAllPdfProvidersLoaded);
         // here we only read the cached provider from the worker thread.
-        const PdfProvider* pdf = m_document->providerForSource(srcId);
+        const PdfProvider* pdf = pdfRuledOut ? nullptr : m_document->providerForSource(srcId);
         // Translate the original page number to the provider's index (bundled sources
         // remap into a compact mini-PDF via pageMap).
         const int providerPage = m_document->resolveSourcePageIndex(srcId, pdfPageIdx);
-        QVector<PdfTextBox> textBoxes = (pdf && pdf->supportsTextExtraction() && providerPage >= 0)
+        const bool extracted = pdf && pdf->supportsTextExtraction() && providerPage >= 0;
+        QVector<PdfTextBox> textBoxes = extracted
             ? pdf->textBoxes(providerPage) : QVector<PdfTextBox>();
+        if (extracted && textBoxes.isEmpty() && m_index) {
+            m_index->setText(pdfKey, QString());  // No text layer (e.g. a scan)
+        }
         if (!textBoxes.isEmpty()) {
             QString pageText;
             QVector<QPair<int, int>> boxMapping;
@@ -198,6 +234,10 @@ QVector<PdfSearchMatch> PdfSearchEngine::searchPage(int pageIndex,
                 }
             }
             
+            if (m_index) {
+                m_index->setText(pdfKey, pageText);
+            }
+            
             Qt::CaseSensitivity cs = caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
             
             int searchPos = 0;
@@ -267,22 +307,46 @@ QVector<PdfSearchMatch> PdfSearchEngine::searchPage(int pageIndex,
         }
     }
     
+    return matches;
+}
+
+QVector<PdfSearchMatch> PdfSearchEngine::searchPageText(int pageIndex,
+                                                         const QString& text,
+                                                         bool caseSensitive,
+                                                         bool wholeWord,
+                                                         const QVector<quint64>& queryTrigrams,
+                                                         int matchIndexOffset) const
+{
+    QVector<PdfSearchMatch> matches;
+    
     // --- OCR text + TextBox / locked OCR object search (paged mode) ---
     if (pageIndex >= 0 && pageIndex < m_document->pageCount()) {
-        const Page* page = m_document->page(pageIndex);
+        // Only pages still on disk can be ruled out: a loaded page may hold
+        // unsaved text the index (which tracks saved pages) hasn't seen.
+        const QString pageKey = PdfSearchIndex::pageKey(m_document->pageUuidAt(pageIndex));
+        const bool wasLoaded = m_document->isPageLoaded(pageIndex);
+        const PdfSearchIndex::Lookup pageLookup = m_index
+            ? m_index->lookup(pageKey, queryTrigrams) : PdfSearchIndex::Lookup::Unknown;
+        const bool pageRuledOut = !wasLoaded && pageLookup == PdfSearchIndex::Lookup::Absent;
+        
+        const Page* page = pageRuledOut ? nullptr : m_document->page(pageIndex);
+        if (page && m_index && !wasLoaded && pageLookup == PdfSearchIndex::Lookup::Unknown) {
+            // Freshly loaded from disk, so its text is the saved text
+            m_index->setText(pageKey, PdfSearchIndex::pageText(page));
+        }
         if (page) {
             if (!page->ocrTextBlocks.isEmpty()) {
                 QVector<OcrTextBlock> blocks = page->ocrBlocksForSearch();
                 QVector<PdfSearchMatch> ocrMatches = searchOcrBlocks(
                     pageIndex, blocks, text, caseSensitive, wholeWord,
                     PdfSearchMatch::OcrText, 0, 0,
-                    matches.size());
+                    matchIndexOffset + matches.size());
                 matches.append(ocrMatches);
             }
 
             QVector<PdfSearchMatch> objMatches = searchTextBoxObjects(
                 pageIndex, page, text, caseSensitive, wholeWord,
-                PdfSearchMatch::TextBoxObj, 0, 0, matches.size());
+                PdfSearchMatch::TextBoxObj, 0, 0, matchIndexOffset + matches.size());
             matches.append(objMatches);
         }
     }
@@ -773,6 +837,7 @@ void PdfSearchEngine::startPrecaching(int centerPage, int direction)
 
     // Ensure all providers are open on the main thread before the worker reads them.
     m_document->ensureAllPdfProvidersLoaded();
+    m_document->searchIndex();  // Re-check PDF source hashes before workers query it
 
     m_precaching.store(true);
     
@@ -1048,6 +1113,7 @@ void PdfSearchEngine::findNext(const QString& text, bool caseSensitive, bool who
     // (and pre-cache) worker only reads the provider cache; providerForSource()
     // lazily mutates it, which must not race across threads.
     m_document->ensureAllPdfProvidersLoaded();
+    m_document->searchIndex();  // Re-check PDF source hashes before workers query it
 
     // Reset result state
     {
@@ -1104,6 +1170,7 @@ void PdfSearchEngine::findPrev(const QString& text, bool caseSensitive, bool who
 
     // Pre-open every source's provider on the main thread (see findNext()).
     m_document->ensureAllPdfProvidersLoaded();
+    m_document->searchIndex();  // Re-check PDF source hashes before workers query it
 
     // Reset result state
     {
@@ -1162,6 +1229,7 @@ void PdfSearchEngine::scanAllPages(const QString& text, bool caseSensitive, bool
 
     // Pre-open every source's provider on the main thread (see findNext()).
     m_document->ensureAllPdfProvidersLoaded();
+    m_document->searchIndex();  // Re-check PDF source hashes before workers query it
 
     QFuture<void> future = QtConcurrent::run([this]() {
         doScanAll();
@@ -1177,17 +1245,56 @@ void PdfSearchEngine::doScanAll()
     }
 
     const int totalPages = m_document->pageCount();
+    const QVector<quint64> queryTrigrams = PdfSearchIndex::trigrams(m_searchText);
+    const int batchSize = SCAN_BATCH_PER_THREAD * qMax(1, QThread::idealThreadCount());
     int total = 0;
 
-    for (int page = 0; page < totalPages; ++page) {
+    // Pages are scanned in batches. Within a batch the PDF text of uncached
+    // pages is extracted in parallel (each worker leases its own MuPDF
+    // context); the page's own text is then searched here in page order,
+    // because loading an evicted page mutates the Document and must not run
+    // concurrently. Each batch streams its hits before the next one starts.
+    for (int batchStart = 0; batchStart < totalPages; batchStart += batchSize) {
         if (m_scanCancelled.load()) {
             return;  // superseded/cancelled: do not emit scanComplete
         }
 
-        QVector<PdfSearchMatch> matches = getCachedOrSearch(page);
-        total += matches.size();
-        if (!matches.isEmpty()) {
-            emit pageScanned(page, matches);  // queued to the main thread
+        const int batchEnd = qMin(totalPages, batchStart + batchSize);
+        QVector<int> uncached;
+        for (int page = batchStart; page < batchEnd; ++page) {
+            if (!isPageCached(page)) {
+                uncached.append(page);
+            }
+        }
+
+        const auto pdfMatches = QtConcurrent::blockingMapped<QVector<QVector<PdfSearchMatch>>>(
+            uncached, [this, &queryTrigrams](int page) {
+                if (m_scanCancelled.load(std::memory_order_relaxed)) {
+                    return QVector<PdfSearchMatch>();
+                }
+                return searchPdfText(page, m_searchText, m_caseSensitive,
+                                     m_wholeWord, queryTrigrams);
+            });
+        if (m_scanCancelled.load()) {
+            return;  // results of skipped pages are incomplete - don't cache
+        }
+
+        int uncachedPos = 0;
+        for (int page = batchStart; page < batchEnd; ++page) {
+            QVector<PdfSearchMatch> matches;
+            if (uncachedPos < uncached.size() && uncached[uncachedPos] == page) {
+                matches = pdfMatches[uncachedPos++];
+                matches.append(searchPageText(page, m_searchText, m_caseSensitive,
+                                              m_wholeWord, queryTrigrams, matches.size()));
+                addToCache(page, matches);
+            } else {
+                matches = getCachedOrSearch(page);
+            }
+
+            total += matches.size();
+            if (!matches.isEmpty()) {
+                emit pageScanned(page, matches);  // queued to the main thread
+            }
         }
     }
 
@@ -9,7 +9,9 @@
 // - Searches one page at a time to minimize memory usage
 // - Caches search results per page for fast navigation
 // - Uses background thread for non-blocking search
+// - Scan-all extracts PDF text for batches of pages in parallel
 // - Pre-caches nearby pages after finding first result
+// - Skips pages the persistent PdfSearchIndex rules out (paged mode)
 // ============================================================================
 
 #include <QString>
@@ -25,6 +27,7 @@
 
 class Document;
 class Page;
+class PdfSearchIndex;
 struct OcrTextBlock;
 
 // ============================================================================
@@ -188,10 +191,11 @@ public:
      * @param wholeWord Whole word matching only.
      *
      * Walks every page on a background thread (reusing the per-page cache),
-     * emitting pageScanned() for each page with >=1 match and scanComplete()
-     * at the end. Independent of findNext/findPrev navigation. No-op for
-     * edgeless documents (page-axis markers are paged-only). Restarting cancels
-     * any in-flight scan.
+     * extracting PDF text for batches of pages in parallel, and emits
+     * pageScanned() in page order for each page with >=1 match as each batch
+     * completes, then scanComplete() at the end. Independent of
+     * findNext/findPrev navigation. No-op for edgeless documents (page-axis
+     * markers are paged-only). Restarting cancels any in-flight scan.
      */
     void scanAllPages(const QString& text, bool caseSensitive, bool wholeWord);
 
@@ -266,6 +270,29 @@ private:
      */
     QVector<PdfSearchMatch> searchPage(int pageIndex, const QString& text,
                                         bool caseSensitive, bool wholeWord) const;
+
+    /**
+     * @brief Search a page's PDF text layer only.
+     * 
+     * Safe to call for several pages at once: it only reads the Document and
+     * extracts text on a pooled MuPDF context.
+     * @param queryTrigrams PdfSearchIndex::trigrams() of @p text.
+     */
+    QVector<PdfSearchMatch> searchPdfText(int pageIndex, const QString& text,
+                                          bool caseSensitive, bool wholeWord,
+                                          const QVector<quint64>& queryTrigrams) const;
+    
+    /**
+     * @brief Search a page's OCR blocks, text boxes and locked OCR objects.
+     * 
+     * May load the page from disk, so it must not run concurrently with
+     * other Document access.
+     * @param matchIndexOffset First matchIndex to assign (PDF matches come first).
+     */
+    QVector<PdfSearchMatch> searchPageText(int pageIndex, const QString& text,
+                                           bool caseSensitive, bool wholeWord,
+                                           const QVector<quint64>& queryTrigrams,
+                                           int matchIndexOffset) const;
     
     /**
      * @brief Get cached results for a page, or search if not cached.
@@ -341,6 +368,7 @@ private:
     void buildEdgelessTileOrder();
 
     Document *m_document = nullptr;
+    PdfSearchIndex *m_index = nullptr;            ///< m_document's persistent index (paged only)
     std::atomic<bool> m_searchCancelled{false};   ///< Cancellation for main search only
     std::atomic<bool> m_precacheCancelled{false}; ///< Cancellation for pre-cache only
     std::atomic<bool> m_scanCancelled{false};     ///< SBS2: cancellation for whole-document scan
@@ -359,6 +387,7 @@ private:
     QFutureWatcher<void> m_searchWatcher;
     QFutureWatcher<void> m_precacheWatcher;
     QFutureWatcher<void> m_scanWatcher;              ///< SBS2: whole-document scan
+    static constexpr int SCAN_BATCH_PER_THREAD = 4;  ///< Scan-all batch size per pool thread
     
     // Result from background search (protected by mutex)
     mutable QMutex m_resultMutex;
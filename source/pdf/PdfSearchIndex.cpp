@@ -0,0 +1,316 @@
+#include "PdfSearchIndex.h"
+#include "../core/Page.h"
+#include "../ocr/OcrTextBlock.h"
+#include "../objects/TextBoxObject.h"
+#include "../objects/OcrTextObject.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QTextDocument>
+
+#include <algorithm>
+
+namespace {
+constexpr quint32 INDEX_MAGIC = 0x534E5349;  // "SNSI"
+}
+
+// ============================================================================
+// Keys and Text
+// ============================================================================
+
+QString PdfSearchIndex::pdfKey(const QString& sourceId, int pdfPage)
+{
+    return QStringLiteral("pdf:%1:%2").arg(sourceId).arg(pdfPage);
+}
+
+QString PdfSearchIndex::pageKey(const QString& pageUuid)
+{
+    return QStringLiteral("page:") + pageUuid;
+}
+
+QVector<quint64> PdfSearchIndex::trigrams(const QString& text)
+{
+    // Same folding as QString::indexOf(..., Qt::CaseInsensitive); whitespace
+    // is dropped so separators inserted between boxes/blocks don't matter.
+    const QString folded = text.toCaseFolded();
+    QVector<ushort> chars;
+    chars.reserve(folded.size());
+    for (const QChar c : folded) {
+        if (!c.isSpace()) {
+            chars.append(c.unicode());
+        }
+    }
+
+    QVector<quint64> result;
+    if (chars.size() < 3) {
+        return result;
+    }
+    result.reserve(chars.size() - 2);
+    for (int i = 0; i + 2 < chars.size(); ++i) {
+        result.append((quint64(chars[i]) << 32) | (quint64(chars[i + 1]) << 16) | chars[i + 2]);
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+QString PdfSearchIndex::pageText(const Page* page)
+{
+    QString text;
+    if (!page) {
+        return text;
+    }
+
+    // Every block, including ones awaiting re-OCR: the index may over-report
+    for (const OcrTextBlock& block : page->ocrTextBlocks) {
+        text += block.text;
+        text += QLatin1Char('\n');
+    }
+
+    for (const auto& objPtr : page->objects) {
+        if (!objPtr) continue;
+        const InsertedObject* rawObj = objPtr.get();
+
+        // Same object filter as PdfSearchEngine::searchTextBoxObjects()
+        const TextBoxObject* textBox = nullptr;
+        if (rawObj->type() == QLatin1String("textbox")) {
+            textBox = static_cast<const TextBoxObject*>(rawObj);
+        } else if (rawObj->type() == QLatin1String("ocr_text")) {
+            auto* ocrObj = static_cast<const OcrTextObject*>(rawObj);
+            if (ocrObj->ocrLocked)
+                textBox = ocrObj;
+        }
+        if (!textBox || textBox->text.isEmpty()) continue;
+
+        if (textBox->isMarkdown()) {
+            // Markdown boxes are searched as rendered text, not source
+            QTextDocument doc;
+            doc.setMarkdown(textBox->text);
+            text += doc.toPlainText();
+        } else {
+            text += textBox->text;
+        }
+        text += QLatin1Char('\n');
+    }
+    return text;
+}
+
+// ============================================================================
+// Lookup and Update
+// ============================================================================
+
+PdfSearchIndex::Lookup PdfSearchIndex::lookup(const QString& key,
+                                              const QVector<quint64>& queryTrigrams) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto idIt = m_entryIds.constFind(key);
+    if (idIt == m_entryIds.constEnd()) {
+        return Lookup::Unknown;
+    }
+    const int id = idIt.value();
+    for (quint64 gram : queryTrigrams) {
+        auto postIt = m_postings.constFind(gram);
+        if (postIt == m_postings.constEnd() || !postIt->contains(id)) {
+            return Lookup::Absent;
+        }
+    }
+    return Lookup::Possible;
+}
+
+void PdfSearchIndex::setText(const QString& key, const QString& text)
+{
+    QVector<quint64> grams = trigrams(text);
+
+    QMutexLocker locker(&m_mutex);
+    auto idIt = m_entryIds.constFind(key);
+    if (idIt != m_entryIds.constEnd() && m_entryTrigrams[idIt.value()] == grams) {
+        return;  // Unchanged (e.g. a page saved without text edits)
+    }
+    removeLocked(key);
+
+    int id;
+    if (!m_freeIds.isEmpty()) {
+        id = m_freeIds.takeLast();
+    } else {
+        id = static_cast<int>(m_entryTrigrams.size());
+        m_entryTrigrams.append(QVector<quint64>());
+    }
+    for (quint64 gram : grams) {
+        m_postings[gram].insert(id);
+    }
+    m_entryTrigrams[id] = std::move(grams);
+    m_entryIds.insert(key, id);
+    m_dirty = true;
+}
+
+void PdfSearchIndex::remove(const QString& key)
+{
+    QMutexLocker locker(&m_mutex);
+    removeLocked(key);
+}
+
+void PdfSearchIndex::removeLocked(const QString& key)
+{
+    auto idIt = m_entryIds.find(key);
+    if (idIt == m_entryIds.end()) {
+        return;
+    }
+    const int id = idIt.value();
+    m_entryIds.erase(idIt);
+
+    for (quint64 gram : m_entryTrigrams[id]) {
+        auto postIt = m_postings.find(gram);
+        if (postIt != m_postings.end()) {
+            postIt->remove(id);
+            if (postIt->isEmpty()) {
+                m_postings.erase(postIt);
+            }
+        }
+    }
+    m_entryTrigrams[id].clear();
+    m_freeIds.append(id);
+    m_dirty = true;
+}
+
+void PdfSearchIndex::syncSourceHashes(const QHash<QString, QString>& sourceHashes)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_sourceHashes == sourceHashes) {
+        return;
+    }
+
+    // Sources that were dropped or whose PDF changed lose their entries
+    QSet<QString> staleSources;
+    for (auto it = m_sourceHashes.constBegin(); it != m_sourceHashes.constEnd(); ++it) {
+        if (sourceHashes.value(it.key()) != it.value()) {
+            staleSources.insert(it.key());
+        }
+    }
+    if (!staleSources.isEmpty()) {
+        const QStringList keys = m_entryIds.keys();
+        for (const QString& key : keys) {
+            if (!key.startsWith(QLatin1String("pdf:"))) continue;
+            const QString sourceId = key.mid(4, key.lastIndexOf(QLatin1Char(':')) - 4);
+            if (staleSources.contains(sourceId)) {
+                removeLocked(key);
+            }
+        }
+    }
+
+    m_sourceHashes = sourceHashes;
+    m_dirty = true;
+}
+
+void PdfSearchIndex::retainPages(const QSet<QString>& pageUuids)
+{
+    QMutexLocker locker(&m_mutex);
+    const QStringList keys = m_entryIds.keys();
+    for (const QString& key : keys) {
+        if (key.startsWith(QLatin1String("page:")) && !pageUuids.contains(key.mid(5))) {
+            removeLocked(key);
+        }
+    }
+}
+
+bool PdfSearchIndex::isDirty() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_dirty;
+}
+
+int PdfSearchIndex::entryCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_entryIds.size());
+}
+
+// ============================================================================
+// Persistence
+// ============================================================================
+
+bool PdfSearchIndex::load(const QString& bundlePath)
+{
+    QFile file(bundlePath + QLatin1Char('/') + QLatin1String(FILE_NAME));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray payload = qUncompress(file.readAll());
+    file.close();
+
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != INDEX_MAGIC || version != FORMAT_VERSION) {
+        return false;
+    }
+
+    QHash<QString, QString> sourceHashes;
+    quint32 count = 0;
+    in >> sourceHashes >> count;
+
+    QMutexLocker locker(&m_mutex);
+    m_entryIds.clear();
+    m_entryTrigrams.clear();
+    m_freeIds.clear();
+    m_postings.clear();
+
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString key;
+        QVector<quint64> grams;
+        in >> key >> grams;
+        const int id = static_cast<int>(m_entryTrigrams.size());
+        for (quint64 gram : grams) {
+            m_postings[gram].insert(id);
+        }
+        m_entryTrigrams.append(grams);
+        m_entryIds.insert(key, id);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "PdfSearchIndex: corrupt index in" << bundlePath << "- rebuilding";
+        m_entryIds.clear();
+        m_entryTrigrams.clear();
+        m_postings.clear();
+        m_sourceHashes.clear();
+        m_dirty = false;
+        return false;
+    }
+
+    m_sourceHashes = sourceHashes;
+    m_dirty = false;
+    return true;
+}
+
+bool PdfSearchIndex::save(const QString& bundlePath)
+{
+    QByteArray payload;
+    {
+        QMutexLocker locker(&m_mutex);
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_12);
+        out << INDEX_MAGIC << FORMAT_VERSION << m_sourceHashes
+            << quint32(m_entryIds.size());
+        for (auto it = m_entryIds.constBegin(); it != m_entryIds.constEnd(); ++it) {
+            out << it.key() << m_entryTrigrams[it.value()];
+        }
+        m_dirty = false;
+    }
+
+    QSaveFile file(bundlePath + QLatin1Char('/') + QLatin1String(FILE_NAME));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "PdfSearchIndex: cannot write index to" << bundlePath;
+        return false;
+    }
+    file.write(qCompress(payload));
+    if (!file.commit()) {
+        qWarning() << "PdfSearchIndex: cannot write index to" << bundlePath;
+        QMutexLocker locker(&m_mutex);
+        m_dirty = true;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+// ============================================================================
+// PdfSearchIndex - Persistent trigram index over a notebook's searchable text
+// ============================================================================
+// Lets PdfSearchEngine skip pages that cannot contain a query without
+// extracting their PDF text or loading them from disk.
+//
+// Design:
+// - One entry per PDF page (keyed by source id + original page number) and
+//   one per notebook page (keyed by page UUID, covering OCR blocks, text
+//   boxes and locked OCR objects)
+// - Each entry stores the set of trigrams of its text after case folding and
+//   whitespace removal, so the synthetic separators the search inserts
+//   between boxes/blocks never hide a match
+// - An inverted map (trigram -> entries) answers "may this entry contain
+//   the query?" with one lookup per query trigram
+// - Stored in the bundle as search_index.bin; PDF entries are dropped when
+//   their source's hash changes, page entries are rewritten when the page
+//   or its OCR sidecar is saved
+//
+// The index only ever rules pages out: a hit still runs the exact search.
+// Queries shorter than three non-space characters are not pruned.
+//
+// Thread safety: all methods may be called from any thread.
+// ============================================================================
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class Page;
+
+class PdfSearchIndex {
+public:
+    /// File name inside the bundle directory.
+    static constexpr const char* FILE_NAME = "search_index.bin";
+
+    /**
+     * @brief Answer for one entry and query.
+     */
+    enum class Lookup {
+        Unknown,    ///< Entry not indexed yet - search the page
+        Possible,   ///< Entry has every query trigram - search the page
+        Absent      ///< Entry lacks a query trigram - the page cannot match
+    };
+
+    /// Entry key for a PDF page (@p sourceId empty = primary source).
+    static QString pdfKey(const QString& sourceId, int pdfPage);
+
+    /// Entry key for a notebook page's own text (OCR, text boxes).
+    static QString pageKey(const QString& pageUuid);
+
+    /**
+     * @brief Sorted, unique trigrams of @p text (case folded, no whitespace).
+     * @return Empty when fewer than three non-space characters remain.
+     */
+    static QVector<quint64> trigrams(const QString& text);
+
+    /**
+     * @brief Searchable text of a page's OCR blocks, text boxes and locked
+     *        OCR objects (markdown boxes as rendered plain text).
+     */
+    static QString pageText(const Page* page);
+
+    /**
+     * @brief Check whether an entry may contain a query.
+     * @param queryTrigrams trigrams() of the query.
+     */
+    Lookup lookup(const QString& key, const QVector<quint64>& queryTrigrams) const;
+
+    /**
+     * @brief Index (or re-index) an entry from its full text.
+     */
+    void setText(const QString& key, const QString& text);
+
+    /**
+     * @brief Forget an entry (it becomes Unknown).
+     */
+    void remove(const QString& key);
+
+    /**
+     * @brief Drop PDF entries whose source is gone or whose hash changed.
+     * @param sourceHashes Source id (empty = primary) -> current PDF hash.
+     */
+    void syncSourceHashes(const QHash<QString, QString>& sourceHashes);
+
+    /**
+     * @brief Drop page entries for pages no longer in the document.
+     */
+    void retainPages(const QSet<QString>& pageUuids);
+
+    /// True when entries changed since the last load()/save().
+    bool isDirty() const;
+
+    /// Number of indexed entries.
+    int entryCount() const;
+
+    /**
+     * @brief Load from a bundle directory. A missing or unreadable file
+     *        leaves the index empty.
+     */
+    bool load(const QString& bundlePath);
+
+    /**
+     * @brief Write to a bundle directory (atomically, via QSaveFile).
+     */
+    bool save(const QString& bundlePath);
+
+private:
+    /// On-disk format version; bump to discard old files.
+    static constexpr quint32 FORMAT_VERSION = 1;
+
+    void removeLocked(const QString& key);
+
+    mutable QMutex m_mutex;
+    QHash<QString, int> m_entryIds;                 ///< Key -> entry id
+    QVector<QVector<quint64>> m_entryTrigrams;      ///< Entry id -> sorted trigrams
+    QVector<int> m_freeIds;                         ///< Reusable entry ids
+    QHash<quint64, QSet<int>> m_postings;           ///< Trigram -> entry ids
+    QHash<QString, QString> m_sourceHashes;         ///< Source id -> hash at index time
+    bool m_dirty = false;
+};
@@ -0,0 +1,361 @@
+// ============================================================================
+// StrokeBinaryCodec - Implementation
+// ============================================================================
+
+#include "StrokeBinaryCodec.h"
+
+#include <QUuid>
+#include <QtEndian>
+#include <QtMath>
+
+#include <cstring>
+
+namespace StrokeBinaryCodec {
+
+namespace {
+
+constexpr char MAGIC[4] = { 'S', 'N', 'S', 'T' };
+constexpr int HEADER_SIZE = 8;  // magic + u16 version + u16 reserved
+
+enum StrokeFlags : quint8 {
+    FlagHasTimestamps = 0x01,   ///< Per-point timestamps follow the pressures
+    FlagUuidId        = 0x02,   ///< Id stored as 16 raw UUID bytes
+};
+
+// ---------------------------------------------------------------------------
+// Writer helpers
+// ---------------------------------------------------------------------------
+
+class Writer {
+public:
+    explicit Writer(QByteArray& buf) : m_buf(buf) {}
+
+    void u8(quint8 v) { m_buf.append(static_cast<char>(v)); }
+
+    void u16(quint16 v) {
+        const quint16 le = qToLittleEndian(v);
+        m_buf.append(reinterpret_cast<const char*>(&le), sizeof(le));
+    }
+
+    void u32(quint32 v) {
+        const quint32 le = qToLittleEndian(v);
+        m_buf.append(reinterpret_cast<const char*>(&le), sizeof(le));
+    }
+
+    void f32(qreal v) {
+        const float f = static_cast<float>(v);
+        quint32 bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        u32(bits);
+    }
+
+    void varint(quint64 v) {
+        while (v >= 0x80) {
+            m_buf.append(static_cast<char>((v & 0x7F) | 0x80));
+            v >>= 7;
+        }
+        m_buf.append(static_cast<char>(v));
+    }
+
+    void svarint(qint64 v) {
+        // Zigzag: small magnitudes of either sign become small unsigned values.
+        varint((static_cast<quint64>(v) << 1) ^ static_cast<quint64>(v >> 63));
+    }
+
+    void string(const QString& s) {
+        const QByteArray utf8 = s.toUtf8();
+        varint(static_cast<quint64>(utf8.size()));
+        m_buf.append(utf8);
+    }
+
+    void raw(const QByteArray& bytes) { m_buf.append(bytes); }
+
+private:
+    QByteArray& m_buf;
+};
+
+// ---------------------------------------------------------------------------
+// Reader helpers (bounds-checked; any overrun flips ok() to false)
+// ---------------------------------------------------------------------------
+
+class Reader {
+public:
+    Reader(const char* data, qsizetype size)
+        : m_p(reinterpret_cast<const uchar*>(data))
+        , m_end(reinterpret_cast<const uchar*>(data) + size) {}
+
+    bool ok() const { return m_ok; }
+
+    quint8 u8() {
+        if (!need(1)) return 0;
+        return *m_p++;
+    }
+
+    quint16 u16() {
+        if (!need(2)) return 0;
+        const quint16 v = qFromLittleEndian<quint16>(m_p);
+        m_p += 2;
+        return v;
+    }
+
+    quint32 u32() {
+        if (!need(4)) return 0;
+        const quint32 v = qFromLittleEndian<quint32>(m_p);
+        m_p += 4;
+        return v;
+    }
+
+    qreal f32() {
+        const quint32 bits = u32();
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return static_cast<qreal>(f);
+    }
+
+    quint64 varint() {
+        quint64 result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (!need(1)) return 0;
+            const uchar byte = *m_p++;
+            result |= static_cast<quint64>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return result;
+        }
+        m_ok = false;  // Over-long encoding
+        return 0;
+    }
+
+    qint64 svarint() {
+        const quint64 v = varint();
+        return static_cast<qint64>(v >> 1) ^ -static_cast<qint64>(v & 1);
+    }
+
+    QByteArray bytes(quint64 n) {
+        if (!need(n)) return QByteArray();
+        QByteArray out(reinterpret_cast<const char*>(m_p), static_cast<qsizetype>(n));
+        m_p += n;
+        return out;
+    }
+
+    QString string() {
+        const quint64 len = varint();
+        if (!need(len)) return QString();
+        QString s = QString::fromUtf8(reinterpret_cast<const char*>(m_p),
+                                      static_cast<qsizetype>(len));
+        m_p += len;
+        return s;
+    }
+
+private:
+    bool need(quint64 n) {
+        if (!m_ok || static_cast<quint64>(m_end - m_p) < n) {
+            m_ok = false;
+            return false;
+        }
+        return true;
+    }
+
+    const uchar* m_p;
+    const uchar* m_end;
+    bool m_ok = true;
+};
+
+inline qint64 quantize(qreal v, qreal scale)
+{
+    return qRound64(v * scale);
+}
+
+void encodeStroke(Writer& w, const VectorStroke& stroke)
+{
+    const bool hasTimestamps = stroke.points.hasTimestamps();
+
+    const QUuid uuid(stroke.id);
+    // Only take the compact path when the id round-trips exactly (lowercase,
+    // no braces); anything else is stored verbatim.
+    const bool uuidId = !uuid.isNull()
+        && uuid.toString(QUuid::WithoutBraces) == stroke.id;
+
+    quint8 flags = 0;
+    if (hasTimestamps) flags |= FlagHasTimestamps;
+    if (uuidId) flags |= FlagUuidId;
+    w.u8(flags);
+
+    if (uuidId) {
+        w.raw(uuid.toRfc4122());
+    } else {
+        w.string(stroke.id);
+    }
+
+    w.u32(stroke.color.rgba());
+    w.f32(stroke.baseThickness);
+    w.f32(stroke.boundingBox.x());
+    w.f32(stroke.boundingBox.y());
+    w.f32(stroke.boundingBox.width());
+    w.f32(stroke.boundingBox.height());
+
+    const int n = static_cast<int>(stroke.points.size());
+    w.varint(static_cast<quint64>(n));
+
+    const float* xs = stroke.points.xData();
+    const float* ys = stroke.points.yData();
+    const float* ps = stroke.points.pressureData();
+    qint64 prevX = 0, prevY = 0, prevP = 0;
+    for (int i = 0; i < n; ++i) {
+        const qint64 x = quantize(xs[i], COORD_SCALE);
+        const qint64 y = quantize(ys[i], COORD_SCALE);
+        const qint64 p = quantize(ps[i], PRESSURE_SCALE);
+        w.svarint(x - prevX);
+        w.svarint(y - prevY);
+        w.svarint(p - prevP);
+        prevX = x;
+        prevY = y;
+        prevP = p;
+    }
+
+    if (hasTimestamps) {
+        qint64 prevT = 0;
+        for (int i = 0; i < n; ++i) {
+            const qint64 t = stroke.points.timestamp(i);
+            w.svarint(t - prevT);
+            prevT = t;
+        }
+    }
+}
+
+bool decodeStroke(Reader& r, VectorStroke& stroke)
+{
+    const quint8 flags = r.u8();
+
+    if (flags & FlagUuidId) {
+        const QByteArray raw = r.bytes(16);
+        stroke.id = QUuid::fromRfc4122(raw).toString(QUuid::WithoutBraces);
+    } else {
+        stroke.id = r.string();
+    }
+    if (stroke.id.isEmpty()) {
+        stroke.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    }
+
+    stroke.color = QColor::fromRgba(r.u32());
+    stroke.baseThickness = r.f32();
+    const qreal bx = r.f32();
+    const qreal by = r.f32();
+    const qreal bw = r.f32();
+    const qreal bh = r.f32();
+
+    const quint64 n = r.varint();
+    if (!r.ok()) return false;
+
+    // Cap the reservation so a corrupt count cannot trigger a huge allocation;
+    // the bounds-checked reads below fail long before that many points.
+    stroke.points.clear();
+    stroke.points.reserve(static_cast<int>(qMin<quint64>(n, 1u << 16)));
+
+    qint64 x = 0, y = 0, p = 0;
+    for (quint64 i = 0; i < n; ++i) {
+        x += r.svarint();
+        y += r.svarint();
+        p += r.svarint();
+        if (!r.ok()) return false;
+        StrokePoint pt;
+        pt.pos = QPointF(x / COORD_SCALE, y / COORD_SCALE);
+        pt.pressure = p / PRESSURE_SCALE;
+        stroke.points.append(pt);
+    }
+
+    if (flags & FlagHasTimestamps) {
+        qint64 t = 0;
+        const int count = stroke.points.size();
+        for (int i = 0; i < count; ++i) {
+            t += r.svarint();
+            stroke.points.setTimestamp(i, t);
+        }
+        if (!r.ok()) return false;
+    }
+
+    stroke.boundingBox = QRectF(bx, by, bw, bh);
+    if (stroke.boundingBox.isNull() && !stroke.points.isEmpty()) {
+        stroke.updateBoundingBox();
+    }
+    return true;
+}
+
+} // namespace
+
+QByteArray encode(const QVector<LayerBlock>& layers)
+{
+    QByteArray buf;
+
+    // Rough pre-size: ~40 bytes of header per stroke, ~4 bytes per point.
+    qsizetype estimate = HEADER_SIZE;
+    for (const LayerBlock& layer : layers) {
+        if (!layer.strokes) continue;
+        for (const auto& stroke : *layer.strokes) {
+            estimate += 40 + stroke.points.size() * 4;
+        }
+    }
+    buf.reserve(estimate);
+
+    Writer w(buf);
+    buf.append(MAGIC, sizeof(MAGIC));
+    w.u16(FORMAT_VERSION);
+    w.u16(0);  // Reserved
+
+    w.varint(static_cast<quint64>(layers.size()));
+    for (const LayerBlock& layer : layers) {
+        w.string(layer.layerId);
+        const int count = layer.strokes ? static_cast<int>(layer.strokes->size()) : 0;
+        w.varint(static_cast<quint64>(count));
+        for (int i = 0; i < count; ++i) {
+            encodeStroke(w, layer.strokes->at(i));
+        }
+    }
+
+    return buf;
+}
+
+bool looksLikeContainer(const QByteArray& data)
+{
+    return data.size() >= HEADER_SIZE
+        && std::memcmp(data.constData(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool decode(const QByteArray& data, LayerStrokes& out)
+{
+    out.clear();
+    if (!looksLikeContainer(data)) {
+        return false;
+    }
+
+    Reader r(data.constData() + sizeof(MAGIC), data.size() - sizeof(MAGIC));
+    const quint16 version = r.u16();
+    r.u16();  // Reserved
+    if (!r.ok() || version == 0 || version > FORMAT_VERSION) {
+        return false;
+    }
+
+    const quint64 layerCount = r.varint();
+    for (quint64 l = 0; l < layerCount && r.ok(); ++l) {
+        const QString layerId = r.string();
+        const quint64 strokeCount = r.varint();
+        if (!r.ok()) return false;
+
+        QVector<VectorStroke>& strokes = out[layerId];
+        strokes.reserve(static_cast<int>(qMin<quint64>(strokeCount, 1u << 14)));
+        for (quint64 s = 0; s < strokeCount; ++s) {
+            VectorStroke stroke;
+            if (!decodeStroke(r, stroke)) {
+                out.clear();
+                return false;
+            }
+            strokes.append(std::move(stroke));
+        }
+    }
+
+    if (!r.ok()) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+} // namespace StrokeBinaryCodec
@@ -0,0 +1,82 @@
+#pragma once
+
+// ============================================================================
+// StrokeBinaryCodec - Compact binary container for page/tile strokes
+// ============================================================================
+// Replaces the per-point {"x","y","p","t"} JSON objects that dominate page
+// and tile files on heavy notebooks. Strokes are stored in a sidecar next to
+// the page/tile JSON (pages/<uuid>.strokes, tiles/x,y.strokes); the JSON file
+// keeps everything else (background, layer properties, objects) and carries a
+// "stroke_store" marker so readers know to look for the sidecar.
+//
+// Container layout (all multi-byte scalars little-endian):
+//   magic "SNST" | u16 version | u16 reserved | varint layerCount
+//   per layer:  varint idLen | utf8 id | varint strokeCount
+//   per stroke: u8 flags | id (16 raw UUID bytes, or varint len + utf8)
+//               | u32 ARGB color | f32 thickness | f32 bbox x,y,w,h
+//               | varint pointCount | points
+//   points: x/y quantized to 1/COORD_SCALE px, pressure to 1/PRESSURE_SCALE,
+//           first point absolute and the rest as zigzag-varint deltas;
+//           timestamps (only when FlagHasTimestamps) delta-coded the same way.
+// ============================================================================
+
+#include "VectorStroke.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+namespace StrokeBinaryCodec {
+
+/// Container version written into the header. Bump on layout changes; the
+/// decoder rejects versions it does not understand.
+constexpr quint16 FORMAT_VERSION = 1;
+
+/// Value of the "stroke_store" key in page/tile JSON whose strokes live in
+/// the binary sidecar instead of the layers' "strokes" arrays.
+inline QString storeMarker() { return QStringLiteral("snst1"); }
+
+/// File suffix of the sidecar (replaces ".json" in the page/tile file name).
+inline QString fileSuffix() { return QStringLiteral(".strokes"); }
+
+/// Coordinates are stored as integers in 1/64 page-pixel steps (~0.016 px),
+/// well below anything visible even at the maximum zoom level.
+constexpr qreal COORD_SCALE = 64.0;
+
+/// Pressure is stored in 1/4096 steps.
+constexpr qreal PRESSURE_SCALE = 4096.0;
+
+/// One layer's worth of strokes, keyed by layer id for encoding.
+struct LayerBlock {
+    QString layerId;
+    const QVector<VectorStroke>* strokes = nullptr;
+};
+
+/// Decoded strokes keyed by layer id.
+using LayerStrokes = QHash<QString, QVector<VectorStroke>>;
+
+/**
+ * @brief Encode the given layers into a binary container.
+ * @param layers Layers in document order. Empty layers are still written so
+ *               the decoder can distinguish "no strokes" from "missing".
+ */
+QByteArray encode(const QVector<LayerBlock>& layers);
+
+/**
+ * @brief Decode a binary container.
+ * @param data Raw file contents.
+ * @param out  Receives strokes keyed by layer id (cleared first).
+ * @return False on bad magic, unknown version or truncated data.
+ *
+ * Stroke bounding boxes are taken from the stored header instead of being
+ * recomputed per point.
+ */
+bool decode(const QByteArray& data, LayerStrokes& out);
+
+/**
+ * @brief Quick check whether @p data starts with a stroke container header.
+ */
+bool looksLikeContainer(const QByteArray& data);
+
+} // namespace StrokeBinaryCodec
@@ -0,0 +1,273 @@
+#pragma once
+
+// ============================================================================
+// StrokeOutlineBenchmark - Correctness check + microbenchmark for the outline
+// kernel (desktop debug builds, run with --bench-outline)
+// ============================================================================
+// Compares every available StrokeOutlineKernel backend against the original
+// multi-pass outline path (Catmull-Rom subdivision into a point list, then
+// separate half-width, tangent and edge passes in double precision), first
+// for geometry and then for time per stroke.
+// ============================================================================
+
+#include "StrokeOutlineKernel.h"
+#include "VectorStroke.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QPolygonF>
+#include <QVector>
+#include <QtMath>
+
+namespace StrokeOutlineBenchmark {
+
+/**
+ * @brief The pre-kernel outline path, kept verbatim as the reference.
+ */
+inline QPolygonF referenceOutline(const VectorStroke& stroke)
+{
+    const StrokePointStore& points = stroke.points;
+    const int n = points.size();
+
+    QVector<StrokePoint> pts;
+    if (n < 3) {
+        pts = points.toVector();
+    } else {
+        pts.reserve((n - 1) * StrokeOutlineKernel::SUBDIVISIONS + 1);
+        for (int i = 0; i < n - 1; ++i) {
+            const StrokePoint p0 = points[qMax(0, i - 1)];
+            const StrokePoint p1 = points[i];
+            const StrokePoint p2 = points[i + 1];
+            const StrokePoint p3 = points[qMin(n - 1, i + 2)];
+            if (i == 0) pts.append(p1);
+            for (int s = 1; s <= StrokeOutlineKernel::SUBDIVISIONS; ++s) {
+                const qreal t = static_cast<qreal>(s) / StrokeOutlineKernel::SUBDIVISIONS;
+                const qreal t2 = t * t;
+                const qreal t3 = t2 * t;
+                auto spline = [&](qreal v0, qreal v1, qreal v2, qreal v3) {
+                    return 0.5 * (2.0 * v1 + (-v0 + v2) * t
+                        + (2.0 * v0 - 5.0 * v1 + 4.0 * v2 - v3) * t2
+                        + (-v0 + 3.0 * v1 - 3.0 * v2 + v3) * t3);
+                };
+                StrokePoint pt;
+                pt.pos = QPointF(spline(p0.pos.x(), p1.pos.x(), p2.pos.x(), p3.pos.x()),
+                                 spline(p0.pos.y(), p1.pos.y(), p2.pos.y(), p3.pos.y()));
+                pt.pressure = qBound(0.1, spline(p0.pressure, p1.pressure,
+                                                 p2.pressure, p3.pressure), 1.0);
+                pts.append(pt);
+            }
+        }
+    }
+
+    const int m = static_cast<int>(pts.size());
+    QVector<qreal> halfWidths(m);
+    for (int i = 0; i < m; ++i) {
+        halfWidths[i] = stroke.baseThickness * pts[i].pressure / 2.0;
+    }
+
+    QVector<QPointF> leftEdge(m);
+    QVector<QPointF> rightEdge(m);
+    for (int i = 0; i < m; ++i) {
+        const QPointF pos = pts[i].pos;
+        QPointF tangent;
+        if (i == 0) {
+            tangent = pts[1].pos - pos;
+        } else if (i == m - 1) {
+            tangent = pos - pts[m - 2].pos;
+        } else {
+            tangent = pts[i + 1].pos - pts[i - 1].pos;
+        }
+        qreal len = qSqrt(tangent.x() * tangent.x() + tangent.y() * tangent.y());
+        if (len < 0.0001) {
+            tangent = QPointF(1.0, 0.0);
+            len = 1.0;
+        }
+        tangent /= len;
+        const QPointF perp(-tangent.y(), tangent.x());
+        leftEdge[i] = pos + perp * halfWidths[i];
+        rightEdge[i] = pos - perp * halfWidths[i];
+    }
+
+    QPolygonF polygon;
+    polygon.reserve(m * 2);
+    for (int i = 0; i < m; ++i) polygon << leftEdge[i];
+    for (int i = m - 1; i >= 0; --i) polygon << rightEdge[i];
+    return polygon;
+}
+
+/// Whether makeStrokes() made stroke @p index of @p total a zig-zag.
+inline bool isZigzag(int index, int total)
+{
+    return index < total - 1 && index % 7 == 0;   // The last one is a straight line
+}
+
+/**
+ * @brief Deterministic handwriting-like test strokes (smooth wander with
+ *        varying pressure, plus a few sharp zig-zags and a straight line).
+ */
+inline QVector<VectorStroke> makeStrokes(int count, int pointsPerStroke)
+{
+    QVector<VectorStroke> strokes;
+    strokes.reserve(count);
+    quint32 seed = 12345;
+    auto rnd = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<qreal>(seed >> 8) / static_cast<qreal>(1u << 24) * 2.0 - 1.0;
+    };
+    for (int s = 0; s < count; ++s) {
+        VectorStroke stroke;
+        stroke.baseThickness = 2.0 + (s % 5);
+        qreal x = 100 + (s % 20) * 30, y = 100 + (s / 20) * 30, angle = rnd() * M_PI;
+        const bool zigzag = isZigzag(s, count + 1);
+        for (int i = 0; i < pointsPerStroke; ++i) {
+            angle += zigzag ? ((i % 2) ? 2.5 : -2.5) : rnd() * 0.3;
+            x += qCos(angle) * 2.5;
+            y += qSin(angle) * 2.5;
+            stroke.points.append({QPointF(x, y), 0.5 + 0.4 * qSin(i * 0.1 + s)});
+        }
+        strokes.append(stroke);
+    }
+    VectorStroke line;
+    line.points.append({QPointF(0, 0), 0.7});
+    line.points.append({QPointF(50, 20), 0.9});
+    strokes.append(line);
+    return strokes;
+}
+
+inline bool runAllTests()
+{
+    using StrokeOutlineKernel::Backend;
+    qDebug() << "\n========================================";
+    qDebug() << "Stroke Outline Kernel Benchmark";
+    qDebug() << "========================================\n";
+    qDebug() << "Active backend:" << StrokeOutlineKernel::backendName(StrokeOutlineKernel::activeBackend());
+
+    const QVector<VectorStroke> strokes = makeStrokes(400, 120);
+    const Backend backends[] = { Backend::Scalar, Backend::SSE2, Backend::AVX2, Backend::NEON };
+    bool success = true;
+
+    // --- Geometry: every backend must match the reference outline ---
+    // The kernel takes its tangent from the spline derivative rather than a
+    // central difference, so vertices may move by a small fraction of the
+    // stroke width; anything beyond that is a bug. The two tangents differ
+    // most where the direction reverses between neighbouring points: the
+    // zig-zag strokes (a reversal at every point, far sharper than
+    // handwriting) measure ~6% there, the handwriting-like ones under 2%.
+    constexpr qreal MAX_DEVIATION = 0.03;          // x stroke width
+    constexpr qreal MAX_DEVIATION_ZIGZAG = 0.08;
+    qDebug() << "=== Test: Outline matches reference ===";
+    for (Backend backend : backends) {
+        if (!StrokeOutlineKernel::isSupported(backend)) continue;
+        qreal worst = 0;
+        qreal worstZigzag = 0;
+        for (int s = 0; s < strokes.size(); ++s) {
+            const VectorStroke& stroke = strokes[s];
+            const bool zigzag = isZigzag(s, strokes.size());
+            qreal& worstOfKind = zigzag ? worstZigzag : worst;
+            const QPolygonF ref = referenceOutline(stroke);
+            QPolygonF out(StrokeOutlineKernel::vertexCount(stroke.points.size()));
+            StrokeOutlineKernel::Caps caps;
+            StrokeOutlineKernel::buildWith(backend, stroke.points.xData(), stroke.points.yData(),
+                                           stroke.points.pressureData(), stroke.points.size(),
+                                           stroke.baseThickness, out.data(), caps);
+            if (out.size() != ref.size()) {
+                qDebug() << "FAIL:" << StrokeOutlineKernel::backendName(backend)
+                         << "vertex count" << out.size() << "expected" << ref.size();
+                success = false;
+                break;
+            }
+            for (int i = 0; i < out.size(); ++i) {
+                const QPointF d = out[i] - ref[i];
+                worstOfKind = qMax(worstOfKind,
+                                   qSqrt(d.x() * d.x() + d.y() * d.y()) / stroke.baseThickness);
+            }
+        }
+        qDebug() << " " << StrokeOutlineKernel::backendName(backend)
+                 << "max deviation:" << worst << "x stroke width (zig-zag:" << worstZigzag << ")";
+        if (worst > MAX_DEVIATION || worstZigzag > MAX_DEVIATION_ZIGZAG) {
+            qDebug() << "FAIL: outline deviates too far from reference";
+            success = false;
+        }
+    }
+
+    // --- Spans (live stroke rendering) must reproduce the full outline ---
+    qDebug() << "\n=== Test: Span outline matches full outline ===";
+    {
+        constexpr int SUB = StrokeOutlineKernel::SUBDIVISIONS;
+        qreal worst = 0;
+        for (const VectorStroke& stroke : strokes) {
+            const int n = stroke.points.size();
+            if (n < 3) continue;
+            QPolygonF full(StrokeOutlineKernel::vertexCount(n));
+            StrokeOutlineKernel::Caps caps;
+            StrokeOutlineKernel::buildWith(Backend::Scalar, stroke.points.xData(), stroke.points.yData(),
+                                           stroke.points.pressureData(), n,
+                                           stroke.baseThickness, full.data(), caps);
+            const int fullSamples = full.size() / 2;
+            for (int first = 0; first < n - 1; first += 7) {
+                const int last = qMin(n - 1, first + 3);
+                QPolygonF span(StrokeOutlineKernel::spanVertexCount(last - first));
+                StrokeOutlineKernel::buildSpan(stroke.points.xData(), stroke.points.yData(),
+                                               stroke.points.pressureData(), n, first, last,
+                                               stroke.baseThickness, span.data());
+                const int spanSamples = span.size() / 2;
+                for (int j = 0; j < spanSamples; ++j) {
+                    const int k = first * SUB + j;
+                    const QPointF dl = span[j] - full[k];
+                    const QPointF dr = span[2 * spanSamples - 1 - j] - full[2 * fullSamples - 1 - k];
+                    worst = qMax(worst, qMax(qAbs(dl.x()) + qAbs(dl.y()), qAbs(dr.x()) + qAbs(dr.y())));
+                }
+            }
+        }
+        qDebug() << "  max deviation:" << worst;
+        if (worst > 1e-3) {
+            qDebug() << "FAIL: span outline differs from full outline";
+            success = false;
+        }
+    }
+
+    // --- Timing ---
+    qDebug() << "\n=== Benchmark:" << strokes.size() << "strokes x 120 points ===";
+    constexpr int ROUNDS = 50;
+    QElapsedTimer timer;
+    volatile qreal sink = 0;
+
+    timer.start();
+    for (int r = 0; r < ROUNDS; ++r) {
+        for (const VectorStroke& stroke : strokes) {
+            sink = sink + referenceOutline(stroke).first().x();
+        }
+    }
+    const qint64 refNs = timer.nsecsElapsed();
+    const qreal perStroke = static_cast<qreal>(ROUNDS) * strokes.size();
+    qDebug() << "  reference:" << refNs / perStroke << "ns/stroke";
+
+    QPolygonF out;
+    for (Backend backend : backends) {
+        if (!StrokeOutlineKernel::isSupported(backend)) continue;
+        timer.restart();
+        for (int r = 0; r < ROUNDS; ++r) {
+            for (const VectorStroke& stroke : strokes) {
+                // Same allocation pattern as buildStrokePolygon
+                out = QPolygonF(StrokeOutlineKernel::vertexCount(stroke.points.size()));
+                StrokeOutlineKernel::Caps caps;
+                StrokeOutlineKernel::buildWith(backend, stroke.points.xData(), stroke.points.yData(),
+                                               stroke.points.pressureData(), stroke.points.size(),
+                                               stroke.baseThickness, out.data(), caps);
+                sink = sink + out.first().x();
+            }
+        }
+        const qint64 ns = timer.nsecsElapsed();
+        qDebug() << " " << StrokeOutlineKernel::backendName(backend) << ":"
+                 << ns / perStroke << "ns/stroke"
+                 << QStringLiteral("(%1x)").arg(static_cast<qreal>(refNs) / qMax<qint64>(1, ns), 0, 'f', 2);
+    }
+    Q_UNUSED(sink);
+
+    if (success) {
+        qDebug() << "\nPASS: Outline kernel matches reference on all backends";
+    }
+    return success;
+}
+
+} // namespace StrokeOutlineBenchmark
@@ -0,0 +1,507 @@
+// ============================================================================
+// StrokeOutlineKernel - Implementation
+// ============================================================================
+
+#include "StrokeOutlineKernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define SN_OUTLINE_SSE2 1
+#    define SN_OUTLINE_AVX2 1
+#    include <immintrin.h>
+#    if defined(_MSC_VER)
+#      include <intrin.h>
+#    endif
+#  endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#  define SN_OUTLINE_NEON 1
+#  include <arm_neon.h>
+#endif
+
+// GCC/Clang only emit AVX instructions inside functions that opt in; MSVC
+// accepts the intrinsics anywhere.
+#if defined(SN_OUTLINE_AVX2) && (defined(__GNUC__) || defined(__clang__))
+#  define SN_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#  define SN_TARGET_AVX2
+#endif
+
+namespace StrokeOutlineKernel {
+
+namespace {
+
+constexpr float MIN_PRESSURE = 0.1f;
+constexpr float MAX_PRESSURE = 1.0f;
+
+/// Squared tangent length below which the direction is treated as undefined
+/// (matches the old 0.0001 length threshold).
+constexpr float DEGENERATE_LEN_SQ = 1e-8f;
+
+/// Sample parameters t = s / SUBDIVISIONS for s = 1..SUBDIVISIONS.
+constexpr float T1 = 1.0f / SUBDIVISIONS;
+constexpr float T2 = 2.0f / SUBDIVISIONS;
+constexpr float T3 = 3.0f / SUBDIVISIONS;
+constexpr float T4 = 4.0f / SUBDIVISIONS;
+static_assert(SUBDIVISIONS == 4, "SIMD backends evaluate one segment per 4-wide vector");
+
+/**
+ * Uniform Catmull-Rom segment between points i and i+1, in Horner form:
+ *   q(t)  = a + t*(b + t*(c + t*d))
+ *   q'(t) = b + t*(2c + t*3d)
+ * (the usual 0.5 factor is folded into the coefficients). Endpoints are
+ * duplicated at the stroke boundaries (zero-acceleration boundary).
+ */
+struct Segment {
+    float ax, bx, cx, dx;
+    float ay, by, cy, dy;
+    float ap, bp, cp, dp;
+
+    Segment(const float* x, const float* y, const float* p, int n, int i) {
+        const int i0 = std::max(0, i - 1);
+        const int i3 = std::min(n - 1, i + 2);
+        init(x[i0], x[i], x[i + 1], x[i3], ax, bx, cx, dx);
+        init(y[i0], y[i], y[i + 1], y[i3], ay, by, cy, dy);
+        init(p[i0], p[i], p[i + 1], p[i3], ap, bp, cp, dp);
+    }
+
+private:
+    static void init(float p0, float p1, float p2, float p3,
+                     float& a, float& b, float& c, float& d) {
+        a = p1;
+        b = 0.5f * (p2 - p0);
+        c = 0.5f * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3);
+        d = 0.5f * (-p0 + 3.0f * p1 - 3.0f * p2 + p3);
+    }
+};
+
+/// Write one centerline sample's left/right edge vertices.
+/// Left edge runs forward from out[0]; right edge runs backward from
+/// out[2 * samples - 1], so the polygon closes without a reversal pass.
+inline void emitSample(QPointF* out, int samples, int k,
+                       float px, float py, float tx, float ty, float halfWidth)
+{
+    float lenSq = tx * tx + ty * ty;
+    if (lenSq < DEGENERATE_LEN_SQ) {
+        // Degenerate case: use arbitrary perpendicular
+        tx = 1.0f;
+        ty = 0.0f;
+        lenSq = 1.0f;
+    }
+    const float scale = halfWidth / std::sqrt(lenSq);
+    const float nx = -ty * scale;
+    const float ny = tx * scale;
+    out[k] = QPointF(px + nx, py + ny);
+    out[2 * samples - 1 - k] = QPointF(px - nx, py - ny);
+}
+
+/// Emit four samples already computed into lane arrays.
+inline void emitLanes(QPointF* out, int samples, int firstK,
+                      const float* lx, const float* ly,
+                      const float* rx, const float* ry, int lanes)
+{
+    QPointF* right = out + 2 * samples - 1 - firstK;
+    for (int l = 0; l < lanes; ++l) {
+        out[firstK + l] = QPointF(lx[l], ly[l]);
+        right[-l] = QPointF(rx[l], ry[l]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Scalar backend
+// ---------------------------------------------------------------------------
+
+/// Emit the SUBDIVISIONS samples of one segment, starting at sample @p k.
+inline void emitSegmentScalar(const Segment& s, float halfThickness,
+                              QPointF* out, int samples, int k)
+{
+    static const float ts[SUBDIVISIONS] = { T1, T2, T3, T4 };
+    for (int j = 0; j < SUBDIVISIONS; ++j, ++k) {
+        const float t = ts[j];
+        const float px = s.ax + t * (s.bx + t * (s.cx + t * s.dx));
+        const float py = s.ay + t * (s.by + t * (s.cy + t * s.dy));
+        const float pr = s.ap + t * (s.bp + t * (s.cp + t * s.dp));
+        const float tx = s.bx + t * (2.0f * s.cx + t * 3.0f * s.dx);
+        const float ty = s.by + t * (2.0f * s.cy + t * 3.0f * s.dy);
+        const float hw = halfThickness * std::min(std::max(pr, MIN_PRESSURE), MAX_PRESSURE);
+        emitSample(out, samples, k, px, py, tx, ty, hw);
+    }
+}
+
+void samplesScalar(const float* x, const float* y, const float* p, int n,
+                   float halfThickness, QPointF* out, int samples)
+{
+    int k = 1;
+    for (int i = 0; i < n - 1; ++i, k += SUBDIVISIONS) {
+        emitSegmentScalar(Segment(x, y, p, n, i), halfThickness, out, samples, k);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// SSE2 / AVX2 backends
+// ---------------------------------------------------------------------------
+
+#ifdef SN_OUTLINE_SSE2
+
+void samplesSse2(const float* x, const float* y, const float* p, int n,
+                 float halfThickness, QPointF* out, int samples)
+{
+    const __m128 t = _mm_setr_ps(T1, T2, T3, T4);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 three = _mm_set1_ps(3.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 pMin = _mm_set1_ps(MIN_PRESSURE);
+    const __m128 pMax = _mm_set1_ps(MAX_PRESSURE);
+    const __m128 eps = _mm_set1_ps(DEGENERATE_LEN_SQ);
+    const __m128 halfT = _mm_set1_ps(halfThickness);
+
+    alignas(16) float lx[4], ly[4], rx[4], ry[4];
+    int k = 1;
+    for (int i = 0; i < n - 1; ++i, k += SUBDIVISIONS) {
+        const Segment s(x, y, p, n, i);
+        const __m128 bx = _mm_set1_ps(s.bx), cx = _mm_set1_ps(s.cx), dx = _mm_set1_ps(s.dx);
+        const __m128 by = _mm_set1_ps(s.by), cy = _mm_set1_ps(s.cy), dy = _mm_set1_ps(s.dy);
+
+        const __m128 px = _mm_add_ps(_mm_set1_ps(s.ax),
+            _mm_mul_ps(t, _mm_add_ps(bx, _mm_mul_ps(t, _mm_add_ps(cx, _mm_mul_ps(t, dx))))));
+        const __m128 py = _mm_add_ps(_mm_set1_ps(s.ay),
+            _mm_mul_ps(t, _mm_add_ps(by, _mm_mul_ps(t, _mm_add_ps(cy, _mm_mul_ps(t, dy))))));
+        __m128 pr = _mm_add_ps(_mm_set1_ps(s.ap),
+            _mm_mul_ps(t, _mm_add_ps(_mm_set1_ps(s.bp),
+                _mm_mul_ps(t, _mm_add_ps(_mm_set1_ps(s.cp), _mm_mul_ps(t, _mm_set1_ps(s.dp)))))));
+        pr = _mm_min_ps(_mm_max_ps(pr, pMin), pMax);
+
+        __m128 tx = _mm_add_ps(bx, _mm_mul_ps(t, _mm_add_ps(_mm_mul_ps(two, cx),
+                                                             _mm_mul_ps(t, _mm_mul_ps(three, dx)))));
+        __m128 ty = _mm_add_ps(by, _mm_mul_ps(t, _mm_add_ps(_mm_mul_ps(two, cy),
+                                                             _mm_mul_ps(t, _mm_mul_ps(three, dy)))));
+        __m128 lenSq = _mm_add_ps(_mm_mul_ps(tx, tx), _mm_mul_ps(ty, ty));
+        const __m128 degenerate = _mm_cmplt_ps(lenSq, eps);
+        tx = _mm_or_ps(_mm_and_ps(degenerate, one), _mm_andnot_ps(degenerate, tx));
+        ty = _mm_andnot_ps(degenerate, ty);
+        lenSq = _mm_or_ps(_mm_and_ps(degenerate, one), _mm_andnot_ps(degenerate, lenSq));
+
+        const __m128 scale = _mm_div_ps(_mm_mul_ps(halfT, pr), _mm_sqrt_ps(lenSq));
+        const __m128 nx = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), ty), scale);
+        const __m128 ny = _mm_mul_ps(tx, scale);
+
+        _mm_store_ps(lx, _mm_add_ps(px, nx));
+        _mm_store_ps(ly, _mm_add_ps(py, ny));
+        _mm_store_ps(rx, _mm_sub_ps(px, nx));
+        _mm_store_ps(ry, _mm_sub_ps(py, ny));
+        emitLanes(out, samples, k, lx, ly, rx, ry, 4);
+    }
+}
+
+/// Two segments per iteration: lanes 0-3 belong to segment i, 4-7 to i+1.
+SN_TARGET_AVX2
+void samplesAvx2(const float* x, const float* y, const float* p, int n,
+                 float halfThickness, QPointF* out, int samples)
+{
+    const __m256 t = _mm256_setr_ps(T1, T2, T3, T4, T1, T2, T3, T4);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 three = _mm256_set1_ps(3.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 pMin = _mm256_set1_ps(MIN_PRESSURE);
+    const __m256 pMax = _mm256_set1_ps(MAX_PRESSURE);
+    const __m256 eps = _mm256_set1_ps(DEGENERATE_LEN_SQ);
+    const __m256 halfT = _mm256_set1_ps(halfThickness);
+
+    alignas(32) float lx[8], ly[8], rx[8], ry[8];
+    const int segments = n - 1;
+    int k = 1;
+    int i = 0;
+    for (; i + 1 < segments; i += 2, k += 2 * SUBDIVISIONS) {
+        const Segment s0(x, y, p, n, i);
+        const Segment s1(x, y, p, n, i + 1);
+#define SN_PAIR(field) _mm256_setr_ps(s0.field, s0.field, s0.field, s0.field, \
+                                      s1.field, s1.field, s1.field, s1.field)
+        const __m256 bx = SN_PAIR(bx), cx = SN_PAIR(cx), dx = SN_PAIR(dx);
+        const __m256 by = SN_PAIR(by), cy = SN_PAIR(cy), dy = SN_PAIR(dy);
+
+        const __m256 px = _mm256_add_ps(SN_PAIR(ax),
+            _mm256_mul_ps(t, _mm256_add_ps(bx, _mm256_mul_ps(t, _mm256_add_ps(cx, _mm256_mul_ps(t, dx))))));
+        const __m256 py = _mm256_add_ps(SN_PAIR(ay),
+            _mm256_mul_ps(t, _mm256_add_ps(by, _mm256_mul_ps(t, _mm256_add_ps(cy, _mm256_mul_ps(t, dy))))));
+        __m256 pr = _mm256_add_ps(SN_PAIR(ap),
+            _mm256_mul_ps(t, _mm256_add_ps(SN_PAIR(bp),
+                _mm256_mul_ps(t, _mm256_add_ps(SN_PAIR(cp), _mm256_mul_ps(t, SN_PAIR(dp)))))));
+#undef SN_PAIR
+        pr = _mm256_min_ps(_mm256_max_ps(pr, pMin), pMax);
+
+        __m256 tx = _mm256_add_ps(bx, _mm256_mul_ps(t, _mm256_add_ps(_mm256_mul_ps(two, cx),
+                                                                      _mm256_mul_ps(t, _mm256_mul_ps(three, dx)))));
+        __m256 ty = _mm256_add_ps(by, _mm256_mul_ps(t, _mm256_add_ps(_mm256_mul_ps(two, cy),
+                                                                      _mm256_mul_ps(t, _mm256_mul_ps(three, dy)))));
+        __m256 lenSq = _mm256_add_ps(_mm256_mul_ps(tx, tx), _mm256_mul_ps(ty, ty));
+        const __m256 degenerate = _mm256_cmp_ps(lenSq, eps, _CMP_LT_OQ);
+        tx = _mm256_blendv_ps(tx, one, degenerate);
+        ty = _mm256_andnot_ps(degenerate, ty);
+        lenSq = _mm256_blendv_ps(lenSq, one, degenerate);
+
+        const __m256 scale = _mm256_div_ps(_mm256_mul_ps(halfT, pr), _mm256_sqrt_ps(lenSq));
+        const __m256 nx = _mm256_mul_ps(_mm256_sub_ps(_mm256_setzero_ps(), ty), scale);
+        const __m256 ny = _mm256_mul_ps(tx, scale);
+
+        _mm256_store_ps(lx, _mm256_add_ps(px, nx));
+        _mm256_store_ps(ly, _mm256_add_ps(py, ny));
+        _mm256_store_ps(rx, _mm256_sub_ps(px, nx));
+        _mm256_store_ps(ry, _mm256_sub_ps(py, ny));
+        emitLanes(out, samples, k, lx, ly, rx, ry, 8);
+    }
+
+    // Odd segment count: finish the last one with the 4-wide path.
+    if (i < segments) {
+        static const float ts[SUBDIVISIONS] = { T1, T2, T3, T4 };
+        const Segment s(x, y, p, n, i);
+        for (int j = 0; j < SUBDIVISIONS; ++j, ++k) {
+            const float tt = ts[j];
+            const float px = s.ax + tt * (s.bx + tt * (s.cx + tt * s.dx));
+            const float py = s.ay + tt * (s.by + tt * (s.cy + tt * s.dy));
+            const float pr = s.ap + tt * (s.bp + tt * (s.cp + tt * s.dp));
+            const float tx = s.bx + tt * (2.0f * s.cx + tt * 3.0f * s.dx);
+            const float ty = s.by + tt * (2.0f * s.cy + tt * 3.0f * s.dy);
+            emitSample(out, samples, k, px, py, tx, ty,
+                       halfThickness * std::min(std::max(pr, MIN_PRESSURE), MAX_PRESSURE));
+        }
+    }
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7) return false;
+    __cpuid(regs, 1);
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    // OS must save the YMM state on context switches.
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+#endif // SN_OUTLINE_SSE2
+
+// ---------------------------------------------------------------------------
+// NEON backend
+// ---------------------------------------------------------------------------
+
+#ifdef SN_OUTLINE_NEON
+
+void samplesNeon(const float* x, const float* y, const float* p, int n,
+                 float halfThickness, QPointF* out, int samples)
+{
+    alignas(16) static const float tsArr[4] = { T1, T2, T3, T4 };
+    const float32x4_t t = vld1q_f32(tsArr);
+    const float32x4_t two = vdupq_n_f32(2.0f);
+    const float32x4_t three = vdupq_n_f32(3.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t pMin = vdupq_n_f32(MIN_PRESSURE);
+    const float32x4_t pMax = vdupq_n_f32(MAX_PRESSURE);
+    const float32x4_t eps = vdupq_n_f32(DEGENERATE_LEN_SQ);
+    const float32x4_t halfT = vdupq_n_f32(halfThickness);
+
+    alignas(16) float lx[4], ly[4], rx[4], ry[4];
+    int k = 1;
+    for (int i = 0; i < n - 1; ++i, k += SUBDIVISIONS) {
+        const Segment s(x, y, p, n, i);
+        const float32x4_t bx = vdupq_n_f32(s.bx), cx = vdupq_n_f32(s.cx), dx = vdupq_n_f32(s.dx);
+        const float32x4_t by = vdupq_n_f32(s.by), cy = vdupq_n_f32(s.cy), dy = vdupq_n_f32(s.dy);
+
+        const float32x4_t px = vaddq_f32(vdupq_n_f32(s.ax),
+            vmulq_f32(t, vaddq_f32(bx, vmulq_f32(t, vaddq_f32(cx, vmulq_f32(t, dx))))));
+        const float32x4_t py = vaddq_f32(vdupq_n_f32(s.ay),
+            vmulq_f32(t, vaddq_f32(by, vmulq_f32(t, vaddq_f32(cy, vmulq_f32(t, dy))))));
+        float32x4_t pr = vaddq_f32(vdupq_n_f32(s.ap),
+            vmulq_f32(t, vaddq_f32(vdupq_n_f32(s.bp),
+                vmulq_f32(t, vaddq_f32(vdupq_n_f32(s.cp), vmulq_f32(t, vdupq_n_f32(s.dp)))))));
+        pr = vminq_f32(vmaxq_f32(pr, pMin), pMax);
+
+        float32x4_t tx = vaddq_f32(bx, vmulq_f32(t, vaddq_f32(vmulq_f32(two, cx),
+                                                               vmulq_f32(t, vmulq_f32(three, dx)))));
+        float32x4_t ty = vaddq_f32(by, vmulq_f32(t, vaddq_f32(vmulq_f32(two, cy),
+                                                               vmulq_f32(t, vmulq_f32(three, dy)))));
+        float32x4_t lenSq = vaddq_f32(vmulq_f32(tx, tx), vmulq_f32(ty, ty));
+        const uint32x4_t degenerate = vcltq_f32(lenSq, eps);
+        tx = vbslq_f32(degenerate, one, tx);
+        ty = vbslq_f32(degenerate, zero, ty);
+        lenSq = vbslq_f32(degenerate, one, lenSq);
+
+        const float32x4_t scale = vdivq_f32(vmulq_f32(halfT, pr), vsqrtq_f32(lenSq));
+        const float32x4_t nx = vmulq_f32(vnegq_f32(ty), scale);
+        const float32x4_t ny = vmulq_f32(tx, scale);
+
+        vst1q_f32(lx, vaddq_f32(px, nx));
+        vst1q_f32(ly, vaddq_f32(py, ny));
+        vst1q_f32(rx, vsubq_f32(px, nx));
+        vst1q_f32(ry, vsubq_f32(py, ny));
+        emitLanes(out, samples, k, lx, ly, rx, ry, 4);
+    }
+}
+
+#endif // SN_OUTLINE_NEON
+
+// ---------------------------------------------------------------------------
+// Dispatch
+// ---------------------------------------------------------------------------
+
+using SamplesFn = void (*)(const float*, const float*, const float*, int,
+                           float, QPointF*, int);
+
+SamplesFn samplesFor(Backend backend)
+{
+    switch (backend) {
+    case Backend::Scalar:
+        return samplesScalar;
+#ifdef SN_OUTLINE_SSE2
+    case Backend::SSE2:
+        return samplesSse2;
+    case Backend::AVX2:
+        return cpuHasAvx2() ? samplesAvx2 : nullptr;
+#endif
+#ifdef SN_OUTLINE_NEON
+    case Backend::NEON:
+        return samplesNeon;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+Backend detectBackend()
+{
+#ifdef SN_OUTLINE_SSE2
+    if (cpuHasAvx2()) return Backend::AVX2;
+    return Backend::SSE2;
+#elif defined(SN_OUTLINE_NEON)
+    return Backend::NEON;
+#else
+    return Backend::Scalar;
+#endif
+}
+
+void buildImpl(SamplesFn samples, const float* x, const float* y, const float* p,
+               int n, qreal baseThickness, QPointF* out, Caps& caps)
+{
+    const float halfThickness = static_cast<float>(baseThickness) * 0.5f;
+
+    if (n < 3) {
+        // Straight line: no smoothing, both ends share the segment direction.
+        const float tx = x[1] - x[0];
+        const float ty = y[1] - y[0];
+        emitSample(out, 2, 0, x[0], y[0], tx, ty, halfThickness * p[0]);
+        emitSample(out, 2, 1, x[1], y[1], tx, ty, halfThickness * p[1]);
+        caps.startCenter = QPointF(x[0], y[0]);
+        caps.startRadius = halfThickness * p[0];
+        caps.endCenter = QPointF(x[1], y[1]);
+        caps.endRadius = halfThickness * p[1];
+        return;
+    }
+
+    const int total = (n - 1) * SUBDIVISIONS + 1;
+
+    // First sample is the first stored point itself (pressure not clamped,
+    // as before); its tangent is the first segment's derivative at t = 0.
+    const Segment first(x, y, p, n, 0);
+    emitSample(out, total, 0, x[0], y[0], first.bx, first.by, halfThickness * p[0]);
+
+    samples(x, y, p, n, halfThickness, out, total);
+
+    // Catmull-Rom passes through its control points, so the caps sit on the
+    // original stroke endpoints.
+    caps.startCenter = QPointF(x[0], y[0]);
+    caps.startRadius = halfThickness * p[0];
+    caps.endCenter = QPointF(x[n - 1], y[n - 1]);
+    caps.endRadius = halfThickness * std::min(std::max(p[n - 1], MIN_PRESSURE), MAX_PRESSURE);
+}
+
+} // namespace
+
+int vertexCount(int pointCount)
+{
+    if (pointCount < 2) return 0;
+    if (pointCount < 3) return 4;
+    return 2 * ((pointCount - 1) * SUBDIVISIONS + 1);
+}
+
+void build(const float* x, const float* y, const float* pressure, int n,
+           qreal baseThickness, QPointF* out, Caps& caps)
+{
+    static const SamplesFn active = samplesFor(activeBackend());
+    buildImpl(active, x, y, pressure, n, baseThickness, out, caps);
+}
+
+bool buildWith(Backend backend,
+               const float* x, const float* y, const float* pressure, int n,
+               qreal baseThickness, QPointF* out, Caps& caps)
+{
+    const SamplesFn fn = samplesFor(backend);
+    if (!fn) return false;
+    buildImpl(fn, x, y, pressure, n, baseThickness, out, caps);
+    return true;
+}
+
+int spanVertexCount(int segmentCount)
+{
+    if (segmentCount < 1) return 0;
+    return 2 * (segmentCount * SUBDIVISIONS + 1);
+}
+
+void buildSpan(const float* x, const float* y, const float* pressure, int n,
+               int firstSegment, int lastSegment, qreal baseThickness, QPointF* out)
+{
+    const int samples = (lastSegment - firstSegment) * SUBDIVISIONS + 1;
+    const float halfThickness = static_cast<float>(baseThickness) * 0.5f;
+
+    // Leading sample: the segment's start point. build() leaves the stroke's
+    // very first pressure unclamped; everywhere else this is the previous
+    // segment's t = 1 sample (Catmull-Rom is C1, so the tangent matches).
+    const Segment first(x, y, pressure, n, firstSegment);
+    const float p0 = pressure[firstSegment];
+    const float hw0 = halfThickness * (firstSegment == 0
+        ? p0 : std::min(std::max(p0, MIN_PRESSURE), MAX_PRESSURE));
+    emitSample(out, samples, 0, x[firstSegment], y[firstSegment], first.bx, first.by, hw0);
+
+    int k = 1;
+    for (int i = firstSegment; i < lastSegment; ++i, k += SUBDIVISIONS) {
+        emitSegmentScalar(Segment(x, y, pressure, n, i), halfThickness, out, samples, k);
+    }
+}
+
+Backend activeBackend()
+{
+    static const Backend backend = detectBackend();
+    return backend;
+}
+
+bool isSupported(Backend backend)
+{
+    return samplesFor(backend) != nullptr;
+}
+
+const char* backendName(Backend backend)
+{
+    switch (backend) {
+    case Backend::Scalar: return "scalar";
+    case Backend::SSE2:   return "sse2";
+    case Backend::AVX2:   return "avx2";
+    case Backend::NEON:   return "neon";
+    }
+    return "unknown";
+}
+
+} // namespace StrokeOutlineKernel
@@ -0,0 +1,268 @@
+#pragma once
+
+// ============================================================================
+// StrokePointStore - Compact structure-of-arrays storage for stroke points
+// ============================================================================
+// Replaces QVector<StrokePoint> (32 bytes per point: QPointF + qreal pressure
+// + qint64 timestamp) inside VectorStroke. Positions and pressure are kept as
+// separate float arrays so hit testing and outline building can stream
+// contiguous data; timestamps are only allocated once a point actually
+// carries one, and are stored as 32-bit offsets from the first timestamp.
+//
+// Footprint: 12 bytes per point, 16 with timestamps.
+//
+// Read access mirrors the QVector API (size, isEmpty, operator[], first,
+// last, range-for) and yields StrokePoint values, so existing read-only
+// callers keep working unchanged. Writes go through append/setPos/
+// setPressure or the bulk translate/map helpers.
+//
+// Every geometry change stamps the store with a new process-wide revision
+// number (copies keep it), which lets caches keyed on a stroke tell whether
+// its points moved since the entry was built.
+// ============================================================================
+
+#include "StrokePoint.h"
+
+#include <QPointF>
+#include <QTransform>
+#include <QVector>
+
+#include <atomic>
+#include <iterator>
+#include <limits>
+
+class StrokePointStore {
+public:
+    /**
+     * @brief Read-only iterator yielding StrokePoint values.
+     *
+     * Dereferencing materializes a StrokePoint, so `for (const auto& pt :
+     * stroke.points)` binds to a temporary - fine for reads, but writes must
+     * use the store's mutators.
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = StrokePoint;
+        using difference_type = int;
+        using pointer = void;
+        using reference = StrokePoint;
+
+        const_iterator(const StrokePointStore* store, int index)
+            : m_store(store), m_index(index) {}
+
+        StrokePoint operator*() const { return m_store->at(m_index); }
+        const_iterator& operator++() { ++m_index; return *this; }
+        const_iterator operator++(int) { const_iterator tmp = *this; ++m_index; return tmp; }
+        bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+
+    private:
+        const StrokePointStore* m_store;
+        int m_index;
+    };
+
+    StrokePointStore() = default;
+
+    // ===== Size =====
+
+    int size() const { return static_cast<int>(m_x.size()); }
+    int count() const { return size(); }
+    bool isEmpty() const { return m_x.isEmpty(); }
+
+    void reserve(int n) {
+        m_x.reserve(n);
+        m_y.reserve(n);
+        m_pressure.reserve(n);
+        if (!m_timeOffsets.isEmpty()) m_timeOffsets.reserve(n);
+    }
+
+    void clear() {
+        m_x.clear();
+        m_y.clear();
+        m_pressure.clear();
+        m_timeOffsets.clear();
+        m_timeBase = 0;
+        touch();
+    }
+
+    /// Release excess capacity (call once a stroke is finalized).
+    void squeeze() {
+        m_x.squeeze();
+        m_y.squeeze();
+        m_pressure.squeeze();
+        m_timeOffsets.squeeze();
+    }
+
+    // ===== Element Access (by value) =====
+
+    StrokePoint at(int i) const {
+        StrokePoint pt;
+        pt.pos = QPointF(m_x[i], m_y[i]);
+        pt.pressure = m_pressure[i];
+        pt.timestamp = timestamp(i);
+        return pt;
+    }
+    StrokePoint operator[](int i) const { return at(i); }
+    StrokePoint first() const { return at(0); }
+    StrokePoint last() const { return at(size() - 1); }
+
+    QPointF pos(int i) const { return QPointF(m_x[i], m_y[i]); }
+    qreal x(int i) const { return m_x[i]; }
+    qreal y(int i) const { return m_y[i]; }
+    qreal pressure(int i) const { return m_pressure[i]; }
+
+    qint64 timestamp(int i) const {
+        if (m_timeOffsets.isEmpty() || m_timeOffsets[i] == NO_TIMESTAMP) return 0;
+        return m_timeBase + m_timeOffsets[i];
+    }
+
+    /// True if at least one point carries a timestamp.
+    bool hasTimestamps() const { return !m_timeOffsets.isEmpty(); }
+
+    /**
+     * @brief Geometry revision (positions/pressure), 0 for a never-touched store.
+     *
+     * Unique across all stores, so two stores report the same non-zero value
+     * only if one is an unmodified copy of the other.
+     */
+    quint64 revision() const { return m_revision; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    // ===== Contiguous Data (for streaming kernels) =====
+
+    const float* xData() const { return m_x.constData(); }
+    const float* yData() const { return m_y.constData(); }
+    const float* pressureData() const { return m_pressure.constData(); }
+
+    // ===== Mutation =====
+
+    void append(const StrokePoint& pt) {
+        m_x.append(static_cast<float>(pt.pos.x()));
+        m_y.append(static_cast<float>(pt.pos.y()));
+        m_pressure.append(static_cast<float>(pt.pressure));
+        if (pt.timestamp != 0 || !m_timeOffsets.isEmpty()) {
+            appendTimestamp(pt.timestamp);
+        }
+        touch();
+    }
+
+    StrokePointStore& operator<<(const StrokePoint& pt) {
+        append(pt);
+        return *this;
+    }
+
+    void removeLast() {
+        m_x.removeLast();
+        m_y.removeLast();
+        m_pressure.removeLast();
+        if (!m_timeOffsets.isEmpty()) m_timeOffsets.removeLast();
+        touch();
+    }
+
+    void setPos(int i, const QPointF& p) {
+        m_x[i] = static_cast<float>(p.x());
+        m_y[i] = static_cast<float>(p.y());
+        touch();
+    }
+
+    void setPressure(int i, qreal p) {
+        m_pressure[i] = static_cast<float>(p);
+        touch();
+    }
+
+    void setTimestamp(int i, qint64 t) {
+        if (m_timeOffsets.isEmpty()) {
+            if (t == 0) return;
+            m_timeBase = t;
+            m_timeOffsets.fill(NO_TIMESTAMP, size());
+        }
+        m_timeOffsets[i] = timeOffset(t);
+    }
+
+    /// Offset every point by @p delta.
+    void translate(const QPointF& delta) {
+        const float dx = static_cast<float>(delta.x());
+        const float dy = static_cast<float>(delta.y());
+        float* xs = m_x.data();
+        float* ys = m_y.data();
+        const int n = size();
+        for (int i = 0; i < n; ++i) {
+            xs[i] += dx;
+            ys[i] += dy;
+        }
+        touch();
+    }
+
+    /// Map every point through @p transform (pressure/timestamps unchanged).
+    void map(const QTransform& transform) {
+        float* xs = m_x.data();
+        float* ys = m_y.data();
+        const int n = size();
+        for (int i = 0; i < n; ++i) {
+            const QPointF p = transform.map(QPointF(xs[i], ys[i]));
+            xs[i] = static_cast<float>(p.x());
+            ys[i] = static_cast<float>(p.y());
+        }
+        touch();
+    }
+
+    // ===== Conversion =====
+
+    QVector<StrokePoint> toVector() const {
+        QVector<StrokePoint> out;
+        out.reserve(size());
+        for (int i = 0; i < size(); ++i) out.append(at(i));
+        return out;
+    }
+
+    static StrokePointStore fromVector(const QVector<StrokePoint>& points) {
+        StrokePointStore store;
+        store.reserve(static_cast<int>(points.size()));
+        for (const auto& pt : points) store.append(pt);
+        return store;
+    }
+
+    /// Approximate heap bytes used by the point arrays.
+    qint64 bytesUsed() const {
+        return static_cast<qint64>(m_x.capacity() + m_y.capacity() + m_pressure.capacity())
+                   * sizeof(float)
+             + static_cast<qint64>(m_timeOffsets.capacity()) * sizeof(qint32);
+    }
+
+private:
+    /// Marks a point without a recorded timestamp once offsets are allocated.
+    static constexpr qint32 NO_TIMESTAMP = std::numeric_limits<qint32>::min();
+
+    void touch() {
+        static std::atomic<quint64> s_nextRevision{1};
+        m_revision = s_nextRevision.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void appendTimestamp(qint64 t) {
+        if (m_timeOffsets.isEmpty()) {
+            // First recorded timestamp: earlier points had none.
+            m_timeBase = t;
+            m_timeOffsets.fill(NO_TIMESTAMP, size() - 1);
+        }
+        m_timeOffsets.append(timeOffset(t));
+    }
+
+    qint32 timeOffset(qint64 t) const {
+        if (t == 0) return NO_TIMESTAMP;
+        // Offsets are relative to the first timestamp; a stroke would have to
+        // last ~24 days to overflow, so clamping is only a corruption guard.
+        return static_cast<qint32>(qBound<qint64>(std::numeric_limits<qint32>::min() + 1,
+                                                  t - m_timeBase,
+                                                  std::numeric_limits<qint32>::max()));
+    }
+
+    QVector<float> m_x;
+    QVector<float> m_y;
+    QVector<float> m_pressure;
+    QVector<qint32> m_timeOffsets;  ///< Empty when no point has a timestamp
+    qint64 m_timeBase = 0;
+    quint64 m_revision = 0;         ///< See revision()
+};
@@ -0,0 +1,224 @@
+#pragma once
+
+// ============================================================================
+// StrokeSpatialIndex - Uniform grid + id lookup over a layer's strokes
+// ============================================================================
+// Owned by VectorLayer. Answers "which strokes may touch this rect" and
+// "where is the stroke with this id" without scanning the whole stroke list,
+// so eraser hits, lasso selection, clipped rendering and undo lookups stay
+// cheap on pages with thousands of strokes.
+//
+// Strokes are referred to by *slot*: the position a stroke had when it was
+// inserted, counting removed strokes as tombstones. Appends take the next
+// slot and removals only record a tombstone, so neither has to renumber the
+// grid. The current index of a slot is `slot - (tombstones before it)`.
+// After enough removals the index flags itself stale and the owning layer
+// rebuilds it (compacting slots back to plain indices) on the next query.
+// ============================================================================
+
+#include "VectorStroke.h"
+
+#include <QHash>
+#include <QMultiHash>
+#include <QRectF>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+
+class StrokeSpatialIndex {
+public:
+    /// Grid cell edge in page/tile units. A typical handwriting stroke spans
+    /// 1-4 cells; a 1024px edgeless tile is 4x4 cells.
+    static constexpr qreal CELL_SIZE = 256.0;
+
+    /// Strokes covering more cells than this (long rulers, big shapes) are
+    /// kept in a separate list that every query scans instead of being
+    /// copied into dozens of cells.
+    static constexpr int MAX_CELLS_PER_STROKE = 64;
+
+    /// True if the index reflects the current stroke list.
+    bool isValid() const { return m_valid; }
+
+    /// Drop everything; the owner must call rebuild() before the next query.
+    void invalidate() {
+        m_valid = false;
+        m_grid.clear();
+        m_oversized.clear();
+        m_slotsById.clear();
+        m_removedSlots.clear();
+        m_nextSlot = 0;
+    }
+
+    /**
+     * @brief Rebuild from scratch (slots become plain indices again).
+     * @param strokes The owning layer's stroke list.
+     */
+    void rebuild(const QVector<VectorStroke>& strokes) {
+        invalidate();
+        m_slotsById.reserve(static_cast<int>(strokes.size()));
+        for (const VectorStroke& stroke : strokes) {
+            insertSlot(m_nextSlot++, stroke);
+        }
+        m_valid = true;
+    }
+
+    /**
+     * @brief Register a stroke that was just appended to the stroke list.
+     * No-op while the index is stale (the next rebuild picks it up).
+     */
+    void append(const VectorStroke& stroke) {
+        if (!m_valid) return;
+        insertSlot(m_nextSlot++, stroke);
+    }
+
+    /**
+     * @brief Index of the stroke with @p id, or -1.
+     *
+     * With duplicate ids the most recently added stroke wins, matching the
+     * back-to-front scan removeStroke() used to do.
+     */
+    int indexOf(const QString& id) const {
+        int best = -1;
+        for (auto it = m_slotsById.constFind(id);
+             it != m_slotsById.constEnd() && it.key() == id; ++it) {
+            best = qMax(best, it.value());
+        }
+        return best < 0 ? -1 : slotToIndex(best);
+    }
+
+    /**
+     * @brief Forget the stroke at @p index (call before removing it from the
+     *        stroke list).
+     * @param index Current index of the stroke.
+     * @param stroke The stroke itself (for its id and bounding box).
+     */
+    void remove(int index, const VectorStroke& stroke) {
+        if (!m_valid) return;
+        const int slot = indexToSlot(index);
+        m_slotsById.remove(stroke.id, slot);
+
+        forEachCell(stroke.boundingBox, [&](quint64 key) {
+            auto it = m_grid.find(key);
+            if (it == m_grid.end()) return;
+            it->removeOne(slot);
+            if (it->isEmpty()) m_grid.erase(it);
+        });
+        m_oversized.removeOne(slot);
+
+        m_removedSlots.insert(std::lower_bound(m_removedSlots.begin(),
+                                               m_removedSlots.end(), slot),
+                              slot);
+
+        // Tombstone lookups are O(log r); compact once they pile up.
+        if (m_removedSlots.size() > 64 &&
+            m_removedSlots.size() > (m_nextSlot - m_removedSlots.size()) / 4) {
+            m_valid = false;
+        }
+    }
+
+    /**
+     * @brief Indices of strokes whose grid cells overlap @p rect.
+     * @return Ascending (paint-order) indices. Candidates only: callers still
+     *         test the stroke's boundingBox, since a cell can be shared by
+     *         strokes that do not reach the rect itself.
+     */
+    QVector<int> candidates(const QRectF& rect) const {
+        QVector<int> slots;
+        const CellRange r = cellRange(rect.normalized());
+        const qint64 cellCount = static_cast<qint64>(r.x1 - r.x0 + 1) * (r.y1 - r.y0 + 1);
+        if (cellCount > m_grid.size()) {
+            // Query larger than the populated area: walk the occupied cells.
+            for (auto it = m_grid.constBegin(); it != m_grid.constEnd(); ++it) {
+                const int cx = static_cast<qint32>(it.key() >> 32);
+                const int cy = static_cast<qint32>(it.key() & 0xffffffffu);
+                if (cx >= r.x0 && cx <= r.x1 && cy >= r.y0 && cy <= r.y1) {
+                    slots += it.value();
+                }
+            }
+        } else {
+            for (int cy = r.y0; cy <= r.y1; ++cy) {
+                for (int cx = r.x0; cx <= r.x1; ++cx) {
+                    auto it = m_grid.constFind(cellKey(cx, cy));
+                    if (it != m_grid.constEnd()) slots += it.value();
+                }
+            }
+        }
+        slots += m_oversized;
+
+        std::sort(slots.begin(), slots.end());
+        slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+        for (int& s : slots) s = slotToIndex(s);
+        return slots;
+    }
+
+private:
+    struct CellRange { int x0, y0, x1, y1; };
+
+    static quint64 cellKey(int cx, int cy) {
+        return (static_cast<quint64>(static_cast<quint32>(cx)) << 32)
+             | static_cast<quint32>(cy);
+    }
+
+    static int cellCoord(qreal v) {
+        // Clamp so absurd coordinates cannot overflow the int cast.
+        return static_cast<int>(std::floor(qBound(-1.0e9, v, 1.0e9) / CELL_SIZE));
+    }
+
+    static CellRange cellRange(const QRectF& rect) {
+        return { cellCoord(rect.left()), cellCoord(rect.top()),
+                 cellCoord(rect.right()), cellCoord(rect.bottom()) };
+    }
+
+    static bool isOversized(const QRectF& bbox, CellRange& r) {
+        if (bbox.isNull()) return true;
+        r = cellRange(bbox);
+        return static_cast<qint64>(r.x1 - r.x0 + 1) * (r.y1 - r.y0 + 1) > MAX_CELLS_PER_STROKE;
+    }
+
+    template <typename Fn>
+    static void forEachCell(const QRectF& bbox, Fn fn) {
+        CellRange r;
+        if (isOversized(bbox, r)) return;
+        for (int cy = r.y0; cy <= r.y1; ++cy) {
+            for (int cx = r.x0; cx <= r.x1; ++cx) {
+                fn(cellKey(cx, cy));
+            }
+        }
+    }
+
+    void insertSlot(int slot, const VectorStroke& stroke) {
+        m_slotsById.insert(stroke.id, slot);
+        CellRange r;
+        if (isOversized(stroke.boundingBox, r)) {
+            m_oversized.append(slot);
+            return;
+        }
+        forEachCell(stroke.boundingBox, [&](quint64 key) {
+            m_grid[key].append(slot);
+        });
+    }
+
+    int slotToIndex(int slot) const {
+        const auto before = std::lower_bound(m_removedSlots.cbegin(),
+                                             m_removedSlots.cend(), slot);
+        return slot - static_cast<int>(before - m_removedSlots.cbegin());
+    }
+
+    int indexToSlot(int index) const {
+        // Each tombstone at or below the running slot shifts it up by one.
+        int slot = index;
+        for (int removed : m_removedSlots) {
+            if (removed > slot) break;
+            ++slot;
+        }
+        return slot;
+    }
+
+    QHash<quint64, QVector<int>> m_grid;   ///< Cell key -> slots (ascending)
+    QVector<int> m_oversized;              ///< Slots too large for the grid
+    QMultiHash<QString, int> m_slotsById;  ///< Stroke id -> slot
+    QVector<int> m_removedSlots;           ///< Tombstoned slots (sorted)
+    int m_nextSlot = 0;
+    bool m_valid = false;
+};
@@ -8,6 +8,7 @@
 // ============================================================================
 
 #include "StrokePoint.h"
+#include "StrokePointStore.h"
 
 #include <QMetaType>
 #include <QString>
@@ -24,11 +25,13 @@
  * 
  * Represents a single pen stroke from pen-down to pen-up.
  * Stores all points with pressure, color, and base thickness.
+ * Points live in a StrokePointStore (structure-of-arrays, float precision),
+ * so iteration yields StrokePoint values and writes go through its mutators.
  * Provides hit testing for eraser functionality and serialization.
  */
 struct VectorStroke {
     QString id;                     ///< UUID for tracking (used in undo/redo)
-    QVector<StrokePoint> points;    ///< All points in the stroke
+    StrokePointStore points;        ///< All points in the stroke
     QColor color;                   ///< Stroke color
     qreal baseThickness;            ///< Base thickness before pressure scaling
     QRectF boundingBox;             ///< Cached bounding box for fast culling/hit testing
@@ -51,13 +54,16 @@ struct VectorStroke {
             return;
         }
         qreal maxWidth = baseThickness * 2;
-        qreal minX = points[0].pos.x(), maxX = minX;
-        qreal minY = points[0].pos.y(), maxY = minY;
-        for (const auto& pt : points) {
-            minX = qMin(minX, pt.pos.x());
-            maxX = qMax(maxX, pt.pos.x());
-            minY = qMin(minY, pt.pos.y());
-            maxY = qMax(maxY, pt.pos.y());
+        const float* xs = points.xData();
+        const float* ys = points.yData();
+        const int n = points.size();
+        float minX = xs[0], maxX = minX;
+        float minY = ys[0], maxY = minY;
+        for (int i = 1; i < n; ++i) {
+            minX = qMin(minX, xs[i]);
+            maxX = qMax(maxX, xs[i]);
+            minY = qMin(minY, ys[i]);
+            maxY = qMax(maxY, ys[i]);
         }
         boundingBox = QRectF(minX - maxWidth, minY - maxWidth,
                              maxX - minX + maxWidth * 2,
@@ -83,8 +89,8 @@ struct VectorStroke {
         // Single-point stroke (dot): check distance to the single point
         // Use baseThickness/2 because that's the actual visual radius of the stroke
         if (points.size() == 1) {
-            qreal dx = point.x() - points[0].pos.x();
-            qreal dy = point.y() - points[0].pos.y();
+            qreal dx = point.x() - points.x(0);
+            qreal dy = point.y() - points.y(0);
             qreal distSq = dx * dx + dy * dy;
             qreal threshold = tolerance + baseThickness / 2.0;
             return distSq < threshold * threshold;
@@ -92,8 +98,13 @@ struct VectorStroke {
         
         // Multi-point stroke: check each segment
         // Hit when eraser edge (tolerance) touches stroke edge (baseThickness/2)
-        for (int i = 1; i < points.size(); ++i) {
-            if (distanceToSegment(point, points[i-1].pos, points[i].pos) < tolerance + baseThickness / 2.0) {
+        const float* xs = points.xData();
+        const float* ys = points.yData();
+        const qreal reach = tolerance + baseThickness / 2.0;
+        const qreal reachSq = reach * reach;
+        const int n = points.size();
+        for (int i = 1; i < n; ++i) {
+            if (distanceToSegmentSq(point.x(), point.y(), xs[i-1], ys[i-1], xs[i], ys[i]) < reachSq) {
                 return true;
             }
         }
@@ -134,6 +145,7 @@ struct VectorStroke {
         }
         
         QJsonArray pointsArray = obj["points"].toArray();
+        stroke.points.reserve(pointsArray.size());
         for (const auto& val : pointsArray) {
             stroke.points.append(StrokePoint::fromJson(val.toObject()));
         }
@@ -143,20 +155,24 @@ struct VectorStroke {
     
 private:
     /**
-     * @brief Calculate distance from a point to a line segment.
-     * @param p The point to test.
-     * @param a Start of segment.
-     * @param b End of segment.
-     * @return Distance from p to the nearest point on segment ab.
+     * @brief Calculate squared distance from a point to a line segment.
+     * @param px, py The point to test.
+     * @param ax, ay Start of segment.
+     * @param bx, by End of segment.
+     * @return Squared distance from p to the nearest point on segment ab.
+     *
+     * Works on raw coordinates so the hit test can stream the point arrays
+     * without materializing StrokePoints or taking square roots.
      */
-    static qreal distanceToSegment(const QPointF& p, const QPointF& a, const QPointF& b) {
-        QPointF ab = b - a;
-        QPointF ap = p - a;
-        qreal lenSq = ab.x() * ab.x() + ab.y() * ab.y();
-        if (lenSq < 0.0001) return QLineF(p, a).length();
-        qreal t = qBound(0.0, (ap.x() * ab.x() + ap.y() * ab.y()) / lenSq, 1.0);
-        QPointF closest = a + t * ab;
-        return QLineF(p, closest).length();
+    static qreal distanceToSegmentSq(qreal px, qreal py, qreal ax, qreal ay, qreal bx, qreal by) {
+        const qreal abx = bx - ax, aby = by - ay;
+        const qreal apx = px - ax, apy = py - ay;
+        const qreal lenSq = abx * abx + aby * aby;
+        if (lenSq < 0.0001) return apx * apx + apy * apy;
+        const qreal t = qBound(0.0, (apx * abx + apy * aby) / lenSq, 1.0);
+        const qreal dx = apx - t * abx;
+        const qreal dy = apy - t * aby;
+        return dx * dx + dy * dy;
     }
 };
 
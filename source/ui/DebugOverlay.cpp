@@ -193,7 +193,8 @@ QString DebugOverlay::generateEdgelessInfo() const
         "Edgeless Canvas | Tiles: %1\n"
         "Zoom: %2% | Pan: (%3, %4)\n"
         "Tool: %5%6 | Undo:%7 Redo:%8\n"
-        "Paint Rate: %9"
+        "Paint Rate: %9\n"
+        "%10"
     )
     .arg(doc->tileCount())
     .arg(m_viewport->zoomLevel() * 100, 0, 'f', 0)
@@ -205,7 +206,8 @@ QString DebugOverlay::generateEdgelessInfo() const
     .arg(m_viewport->canRedo() ? "Y" : "N")
     .arg(m_viewport->isBenchmarking() 
          ? QString("%1 Hz").arg(m_viewport->getPaintRate()) 
-         : "OFF");
+         : "OFF")
+    .arg(inkLatencyInfo());
 }
 
 QString DebugOverlay::generatePagedInfo() const
@@ -222,7 +224,8 @@ QString DebugOverlay::generatePagedInfo() const
         "Zoom: %4% | Pan: (%5, %6)\n"
         "Layout: %7 | Content: %8x%9\n"
         "Tool: %10%11 | Undo:%12 Redo:%13\n"
-        "Paint Rate: %14 [P=Pen, E=Eraser, B=Benchmark]"
+        "Paint Rate: %14 [P=Pen, E=Eraser, B=Benchmark]\n"
+        "%15"
     )
     .arg(doc->displayName())
     .arg(doc->pageCount())
@@ -239,7 +242,23 @@ QString DebugOverlay::generatePagedInfo() const
     .arg(m_viewport->canRedo() ? "Y" : "N")
     .arg(m_viewport->isBenchmarking() 
          ? QString("%1 Hz").arg(m_viewport->getPaintRate()) 
-         : "OFF (press F10)");
+         : "OFF (press F10)")
+    .arg(inkLatencyInfo());
+}
+
+QString DebugOverlay::inkLatencyInfo() const
+{
+    const InkPredictor::Latency& latency = m_viewport->inkLatency();
+    if (latency.samples == 0) {
+        return QString("Ink Latency: - (draw to measure)");
+    }
+    return QString("Ink Latency: %1 ms avg, %2 ms last, %3 ms max | Prediction: %4")
+        .arg(latency.meanMs, 0, 'f', 1)
+        .arg(latency.lastMs, 0, 'f', 0)
+        .arg(latency.maxMs, 0, 'f', 0)
+        .arg(DocumentViewport::predictedInkEnabled()
+             ? QString("%1 ms").arg(m_viewport->inkPredictionHorizonMs(), 0, 'f', 0)
+             : QString("OFF"));
 }
 
 QString DebugOverlay::generateCustomSections() const
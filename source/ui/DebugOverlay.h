@@ -173,6 +173,11 @@ private:
      */
     QString generatePagedInfo() const;
 
+    /**
+     * @brief Ink latency line (measured input-to-paint delay, prediction horizon).
+     */
+    QString inkLatencyInfo() const;
+
     /**
      * @brief Generate text for all custom sections.
      */
@@ -1,10 +1,13 @@
 #include "PageThumbnailModel.h"
 #include "ThumbnailRenderer.h"
+#include "ThumbnailStore.h"
 #include "../core/Document.h"
+#include "../core/CacheBudget.h"
 
 #include <QMimeData>
 #include <QByteArray>
 #include <QDataStream>
+#include <QtConcurrent>
 
 #ifdef __GLIBC__
 #include <malloc.h>
@@ -21,10 +24,13 @@ PageThumbnailModel::PageThumbnailModel(QObject* parent)
     // Connect renderer signals
     connect(m_renderer, &ThumbnailRenderer::thumbnailReady,
             this, &PageThumbnailModel::onThumbnailRendered);
+    
+    CacheBudget::instance()->addClient(this);
 }
 
 PageThumbnailModel::~PageThumbnailModel()
 {
+    CacheBudget::instance()->removeClient(this);
 }
 
 // ============================================================================
@@ -243,9 +249,21 @@ void PageThumbnailModel::setDocument(Document* doc)
     m_currentPageIndex = 0;
     m_thumbnailCache.clear();
     m_cacheAccessOrder.clear();
+    m_cacheLastUse.clear();
     
     endResetModel();
     
+    // Drop stored thumbnails of pages deleted since they were written
+    if (m_document && !m_document->bundlePath().isEmpty()) {
+        QSet<QString> pageUuids;
+        for (int i = 0; i < m_document->pageCount(); ++i) {
+            pageUuids.insert(m_document->pageUuidAt(i));
+        }
+        (void)QtConcurrent::run([bundlePath = m_document->bundlePath(), pageUuids]() {
+            ThumbnailStore::prune(bundlePath, pageUuids);
+        });
+    }
+    
 #ifdef __GLIBC__
     malloc_trim(0);
 #endif
@@ -326,6 +344,7 @@ void PageThumbnailModel::invalidateThumbnail(int pageIndex)
 {
     m_thumbnailCache.remove(pageIndex);
     m_cacheAccessOrder.removeAll(pageIndex);
+    m_cacheLastUse.remove(pageIndex);
     
     if (m_document && pageIndex >= 0 && pageIndex < m_document->pageCount()) {
         const QModelIndex modelIndex = createIndex(pageIndex, 0);
@@ -339,6 +358,7 @@ void PageThumbnailModel::invalidateAllThumbnails()
     
     m_thumbnailCache.clear();
     m_cacheAccessOrder.clear();
+    m_cacheLastUse.clear();
     
 #ifdef __GLIBC__
     malloc_trim(0);
@@ -373,6 +393,7 @@ void PageThumbnailModel::onPageCountChanged()
     // Clear cache since page indices may have changed
     m_thumbnailCache.clear();
     m_cacheAccessOrder.clear();
+    m_cacheLastUse.clear();
     
     // Clamp current page index
     if (m_document && m_currentPageIndex >= m_document->pageCount()) {
@@ -398,6 +419,7 @@ void PageThumbnailModel::onThumbnailRendered(int pageIndex, QPixmap thumbnail)
     m_thumbnailCache[pageIndex] = thumbnail;
     touchCache(pageIndex);      // LRU: add to access order
     evictOldestIfNeeded();      // LRU: evict if over limit
+    CacheBudget::instance()->requestEnforce();
     
     // Notify view that the thumbnail is ready
     const QModelIndex modelIndex = createIndex(pageIndex, 0);
@@ -485,6 +507,7 @@ void PageThumbnailModel::touchCache(int pageIndex) const
     // Move page to end of access order (most recently used)
     m_cacheAccessOrder.removeAll(pageIndex);
     m_cacheAccessOrder.append(pageIndex);
+    m_cacheLastUse[pageIndex] = CacheBudget::nowMs();
 }
 
 void PageThumbnailModel::evictOldestIfNeeded() const
@@ -492,12 +515,42 @@ void PageThumbnailModel::evictOldestIfNeeded() const
     while (m_thumbnailCache.size() > MAX_CACHED_THUMBNAILS && !m_cacheAccessOrder.isEmpty()) {
         int oldestPage = m_cacheAccessOrder.takeFirst();
         m_thumbnailCache.remove(oldestPage);
+        m_cacheLastUse.remove(oldestPage);
     }
     // Safeguard: if access order ran out but cache is still over limit
     // (desynchronization), force-clear everything to prevent unbounded growth.
     if (m_thumbnailCache.size() > MAX_CACHED_THUMBNAILS) {
         m_thumbnailCache.clear();
         m_cacheAccessOrder.clear();
+        m_cacheLastUse.clear();
     }
 }
 
+
+// ============================================================================
+// CacheBudget::Client
+// ============================================================================
+
+void PageThumbnailModel::collectCacheItems(QVector<CacheBudget::Item>& items) const
+{
+    for (auto it = m_thumbnailCache.constBegin(); it != m_thumbnailCache.constEnd(); ++it) {
+        CacheBudget::Item item;
+        item.key = static_cast<quint64>(it.key());
+        item.bytes = static_cast<qint64>(it.value().width()) * it.value().height()
+                     * it.value().depth() / 8;
+        item.lastUse = m_cacheLastUse.value(it.key());
+        item.rebuildCost = CacheBudget::COST_THUMBNAIL;
+        items.append(item);
+    }
+}
+
+void PageThumbnailModel::evictCacheItems(const QVector<quint64>& keys)
+{
+    // The delegate shows a placeholder and asks again when the row is painted
+    for (quint64 key : keys) {
+        const int pageIndex = static_cast<int>(key);
+        m_thumbnailCache.remove(pageIndex);
+        m_cacheAccessOrder.removeAll(pageIndex);
+        m_cacheLastUse.remove(pageIndex);
+    }
+}
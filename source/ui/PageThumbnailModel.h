@@ -5,6 +5,8 @@
 #include <QPixmap>
 #include <QHash>
 
+#include "../core/CacheBudget.h"
+
 class Document;
 class ThumbnailRenderer;
 
@@ -20,7 +22,7 @@ class ThumbnailRenderer;
  * The model connects to a Document and reflects its page structure.
  * Thumbnails are generated on-demand and cached in memory.
  */
-class PageThumbnailModel : public QAbstractListModel {
+class PageThumbnailModel : public QAbstractListModel, public CacheBudget::Client {
     Q_OBJECT
 
 public:
@@ -141,6 +143,12 @@ public:
      * @param lastVisible Last visible row index.
      */
     void requestVisibleThumbnails(int firstVisible, int lastVisible);
+    
+    // ===== CacheBudget::Client =====
+    
+    QString cacheName() const override { return QStringLiteral("page thumbnails"); }
+    void collectCacheItems(QVector<CacheBudget::Item>& items) const override;
+    void evictCacheItems(const QVector<quint64>& keys) override;
 
 signals:
     /**
@@ -212,6 +220,7 @@ private:
     // Thumbnail cache with LRU eviction
     mutable QHash<int, QPixmap> m_thumbnailCache;
     mutable QList<int> m_cacheAccessOrder;  // LRU: front = oldest, back = newest
+    mutable QHash<int, qint64> m_cacheLastUse;  // CacheBudget::nowMs() of last use
     
     void touchCache(int pageIndex) const;   // Mark page as recently used
     void evictOldestIfNeeded() const;       // Evict LRU entries if over limit
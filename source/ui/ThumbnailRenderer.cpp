@@ -10,18 +10,20 @@
 #include <QThreadStorage>
 #include <QDebug>
 
-// Thread-local cached PDF provider (keyed by resolved source path) so worker
-// threads never touch the Document's lazy provider map. Mirrors the same pattern
-// used by DocumentViewport's async PDF preload.
+// Thread-local reference to the shared PDF provider (keyed by resolved source
+// path) so worker threads never touch the Document's lazy provider map. The
+// provider is the process-wide instance from PdfProvider::shared(), so
+// thumbnails render from the same parse as the viewport. Mirrors the same
+// pattern used by DocumentViewport's async PDF preload.
 namespace {
 struct ThumbPdfCache {
     QString pdfPath;
-    std::unique_ptr<PdfProvider> provider;
+    std::shared_ptr<PdfProvider> provider;
     
     PdfProvider* getOrCreate(const QString& path) {
         if (pdfPath != path || !provider || !provider->isValid()) {
             pdfPath = path;
-            provider = PdfProvider::create(path);
+            provider = PdfProvider::shared(path);
         }
         return provider.get();
     }
@@ -46,6 +48,10 @@ void ThumbnailRenderer::requestThumbnail(Document* doc, int pageIndex, int width
         return;
     }
     
+    // Stored thumbnail of the page's saved state (main thread: reads the document)
+    const ThumbnailStore::Key storeKey = ThumbnailStore::makeKey(
+        doc, pageIndex, static_cast<int>(width * dpr), m_pdfDarkMode);
+    
     QMutexLocker locker(&m_mutex);
     
     // Check if already pending or active
@@ -64,7 +70,8 @@ void ThumbnailRenderer::requestThumbnail(Document* doc, int pageIndex, int width
         m_pendingRequests.removeFirst();
     }
     
-    m_pendingRequests.append({doc, pageIndex, width, dpr, m_pdfDarkMode});
+    m_pendingRequests.append({doc, pageIndex, width, dpr, m_pdfDarkMode,
+                              storeKey, doc->bundlePath()});
     
     locker.unlock();
     
@@ -90,6 +97,7 @@ void ThumbnailRenderer::cancelAll()
         delete watcher;
     }
     m_activeWatchers.clear();
+    m_storeLookups.clear();
     m_activePages.clear();
 }
 
@@ -123,6 +131,24 @@ void ThumbnailRenderer::startNextTask()
     while (m_activeWatchers.size() < m_maxConcurrent && !m_pendingRequests.isEmpty()) {
         ThumbnailRequest req = m_pendingRequests.takeFirst();
         
+        if (req.storeKey.isValid() && !req.storeChecked) {
+            // Cheap path first: decode the stored PNG in a worker
+            m_activePages.insert(req.pageIndex);
+            auto* watcher = watch(QtConcurrent::run(
+                [pageIndex = req.pageIndex, dpr = req.dpr,
+                 bundlePath = req.bundlePath, key = req.storeKey]() {
+                    QPixmap pixmap;
+                    const QImage image = ThumbnailStore::load(bundlePath, key);
+                    if (!image.isNull()) {
+                        pixmap = QPixmap::fromImage(image);
+                        pixmap.setDevicePixelRatio(dpr);
+                    }
+                    return qMakePair(pageIndex, pixmap);
+                }));
+            m_storeLookups.insert(watcher, req);
+            continue;
+        }
+        
         // Unlock while creating the heavy snapshot on the main thread
         locker.unlock();
         
@@ -132,6 +158,13 @@ void ThumbnailRenderer::startNextTask()
             req.doc, req.pageIndex, req.width, req.dpr,
             req.pdfDarkMode);
         
+        // Store the result if the snapshot shows a saved page state
+        if (snapshot.valid) {
+            snapshot.storeKey = ThumbnailStore::makeKey(
+                req.doc, req.pageIndex, static_cast<int>(req.width * req.dpr), req.pdfDarkMode);
+            snapshot.bundlePath = req.doc->bundlePath();
+        }
+        
         // Evict pages loaded only for thumbnail rendering to prevent
         // m_loadedPages from growing unboundedly during fast panel scrolling
         if (!wasLoaded && req.doc->isLazyLoadEnabled()
@@ -148,21 +181,29 @@ void ThumbnailRenderer::startNextTask()
         int pageIndex = snapshot.pageIndex;
         m_activePages.insert(pageIndex);
         
-        auto* watcher = new QFutureWatcher<QPair<int, QPixmap>>(this);
-        connect(watcher, &QFutureWatcher<QPair<int, QPixmap>>::finished,
-                this, &ThumbnailRenderer::onRenderFinished);
-        
-        m_activeWatchers.append(watcher);
-        
-        QFuture<QPair<int, QPixmap>> future = QtConcurrent::run([snapshot = std::move(snapshot)]() {
+        watch(QtConcurrent::run([snapshot = std::move(snapshot)]() {
             QPixmap result = renderFromSnapshot(snapshot);
+            TranslucentScratch::release();  // Pool threads keep no scratch
+            if (!result.isNull() && snapshot.storeKey.isValid()) {
+                ThumbnailStore::save(snapshot.bundlePath, snapshot.storeKey, result.toImage());
+            }
             return qMakePair(snapshot.pageIndex, result);
-        });
-        
-        watcher->setFuture(future);
+        }));
     }
 }
 
+QFutureWatcher<QPair<int, QPixmap>>* ThumbnailRenderer::watch(
+    const QFuture<QPair<int, QPixmap>>& future)
+{
+    auto* watcher = new QFutureWatcher<QPair<int, QPixmap>>(this);
+    connect(watcher, &QFutureWatcher<QPair<int, QPixmap>>::finished,
+            this, &ThumbnailRenderer::onRenderFinished);
+    
+    m_activeWatchers.append(watcher);
+    watcher->setFuture(future);
+    return watcher;
+}
+
 void ThumbnailRenderer::onRenderFinished()
 {
     if (m_shuttingDown) {
@@ -190,6 +231,17 @@ void ThumbnailRenderer::onRenderFinished()
         if (!wasCancelled) {
             m_activePages.remove(result.first);
         }
+        
+        // Nothing stored for this page state: queue the full render
+        auto lookupIt = m_storeLookups.find(watcher);
+        if (lookupIt != m_storeLookups.end()) {
+            if (!wasCancelled && result.second.isNull()) {
+                ThumbnailRequest req = lookupIt.value();
+                req.storeChecked = true;
+                m_pendingRequests.append(req);
+            }
+            m_storeLookups.erase(lookupIt);
+        }
     }
     
     // Delete watcher immediately to free the QFuture's result QPixmap.
@@ -350,7 +402,6 @@ QPixmap ThumbnailRenderer::renderFromSnapshot(const ThumbnailSnapshot& snapshot)
                 }
                 pdfBackground = QPixmap::fromImage(pdfImage);
             }
-            threadPdf->trimStore();
         }
     }
     
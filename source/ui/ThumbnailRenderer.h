@@ -11,11 +11,16 @@
 // Page/stroke data is snapshot-copied on the main thread before async rendering.
 // PDF rendering is deferred to the worker thread via Document::renderPdfPageToImage()
 // which is mutex-protected inside MuPdfProvider.
+//
+// Thumbnails of saved pages are kept in the bundle (ThumbnailStore): a
+// request first tries the stored PNG in a worker and only falls back to a
+// full render on a miss; full renders of clean pages are stored afterwards.
 // ============================================================================
 
 #include <QObject>
 #include <QPixmap>
 #include <QSet>
+#include <QHash>
 #include <QMutex>
 #include <QFuture>
 #include <QFutureWatcher>
@@ -23,6 +28,7 @@
 
 #include "../strokes/VectorStroke.h"
 #include "../core/Page.h"
+#include "ThumbnailStore.h"
 
 class Document;
 
@@ -137,6 +143,10 @@ private:
         QPixmap objectsLayer;
         bool hasObjects = false;
         
+        // Where to store the result (invalid key = page has unsaved changes)
+        ThumbnailStore::Key storeKey;
+        QString bundlePath;
+        
         // Validity flag
         bool valid = false;
     };
@@ -181,6 +191,9 @@ private:
         int width;
         qreal dpr;
         bool pdfDarkMode;
+        ThumbnailStore::Key storeKey;   ///< Stored thumbnail to try first (if valid)
+        QString bundlePath;
+        bool storeChecked = false;      ///< Store lookup missed: render
     };
     
     /**
@@ -188,6 +201,11 @@ private:
      */
     void startNextTask();
     
+    /**
+     * @brief Track a worker result; onRenderFinished() picks it up.
+     */
+    QFutureWatcher<QPair<int, QPixmap>>* watch(const QFuture<QPair<int, QPixmap>>& future);
+    
     // Lightweight pending requests (no heavy data)
     QList<ThumbnailRequest> m_pendingRequests;
     
@@ -199,6 +217,9 @@ private:
     // Future watchers for active renders
     QList<QFutureWatcher<QPair<int, QPixmap>>*> m_activeWatchers;
     
+    // Active watchers that load from ThumbnailStore rather than render
+    QHash<QFutureWatcher<QPair<int, QPixmap>>*, ThumbnailRequest> m_storeLookups;
+    
     // Mutex for thread safety
     mutable QMutex m_mutex;
     
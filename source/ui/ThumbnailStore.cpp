@@ -0,0 +1,116 @@
+// ============================================================================
+// ThumbnailStore - Implementation
+// ============================================================================
+
+#include "ThumbnailStore.h"
+#include "../core/Document.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDebug>
+
+namespace {
+QString storeDir(const QString& bundlePath)
+{
+    return bundlePath + "/" + QLatin1String(ThumbnailStore::DIR_NAME);
+}
+}
+
+ThumbnailStore::Key ThumbnailStore::makeKey(const Document* doc, int pageIndex,
+                                            int physicalWidth, bool pdfDarkMode)
+{
+    Key key;
+    if (!doc || doc->bundlePath().isEmpty() || physicalWidth <= 0
+        || doc->isPageDirty(pageIndex)) {
+        return key;
+    }
+
+    // Relinking or replacing a PDF changes the pixels of every PDF page
+    QCryptographicHash pdfHash(QCryptographicHash::Md5);
+    for (const PdfSource& source : doc->pdfSources()) {
+        pdfHash.addData(source.id.toUtf8());
+        pdfHash.addData(source.hash.toUtf8());
+    }
+
+    key.pageUuid = doc->pageUuidAt(pageIndex);
+    key.revision = doc->pageRevision(pageIndex);
+    key.variant = QString("%1%2-%3")
+                      .arg(physicalWidth)
+                      .arg(pdfDarkMode ? "d" : "")
+                      .arg(QString::fromLatin1(pdfHash.result().toHex().left(8)));
+    return key;
+}
+
+QString ThumbnailStore::fileName(const Key& key)
+{
+    return QString("%1_%2_%3.png").arg(key.pageUuid).arg(key.revision).arg(key.variant);
+}
+
+QImage ThumbnailStore::load(const QString& bundlePath, const Key& key)
+{
+    if (bundlePath.isEmpty() || !key.isValid()) {
+        return QImage();
+    }
+    const QString path = storeDir(bundlePath) + "/" + fileName(key);
+    if (!QFile::exists(path)) {
+        return QImage();
+    }
+    return QImage(path, "PNG");
+}
+
+bool ThumbnailStore::save(const QString& bundlePath, const Key& key, const QImage& image)
+{
+    if (bundlePath.isEmpty() || !key.isValid() || image.isNull()) {
+        return false;
+    }
+    const QString dirPath = storeDir(bundlePath);
+    if (!QDir().mkpath(dirPath)) {
+        return false;
+    }
+
+    const QString name = fileName(key);
+    QSaveFile file(dirPath + "/" + name);
+    if (!file.open(QIODevice::WriteOnly) || !image.save(&file, "PNG") || !file.commit()) {
+        qWarning() << "ThumbnailStore: cannot write" << file.fileName();
+        return false;
+    }
+
+    // Older revisions and other variants of this page
+    QDir dir(dirPath);
+    const QStringList stale = dir.entryList({key.pageUuid + "_*"}, QDir::Files);
+    for (const QString& other : stale) {
+        if (other != name) {
+            dir.remove(other);
+        }
+    }
+    return true;
+}
+
+void ThumbnailStore::prune(const QString& bundlePath, const QSet<QString>& pageUuids)
+{
+    if (bundlePath.isEmpty()) {
+        return;
+    }
+    QDir dir(storeDir(bundlePath));
+    if (!dir.exists()) {
+        return;
+    }
+
+    int removed = 0;
+    const QStringList files = dir.entryList(QDir::Files);
+    for (const QString& name : files) {
+        if (!pageUuids.contains(name.section('_', 0, 0)) && dir.remove(name)) {
+            ++removed;
+        }
+    }
+
+#ifdef SPEEDYNOTE_DEBUG
+    if (removed > 0) {
+        qDebug() << "ThumbnailStore: pruned" << removed << "thumbnails of removed pages";
+    }
+#else
+    Q_UNUSED(removed);
+#endif
+}
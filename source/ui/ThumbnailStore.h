@@ -0,0 +1,70 @@
+#pragma once
+
+// ============================================================================
+// ThumbnailStore - Page thumbnails persisted inside the bundle
+// ============================================================================
+// Part of the Page Panel feature
+// The panel's in-memory cache starts empty for every opened notebook, so each
+// open used to re-render every visible thumbnail: page load, PDF raster and
+// stroke painting. ThumbnailStore keeps the rendered thumbnails as PNGs in the
+// bundle, so they show up instantly and only changed pages are re-rendered.
+//
+// Design:
+// - thumbnails/<page uuid>_<revision>_<variant>.png in the bundle
+// - revision is Document::pageRevision(): it advances whenever a save writes
+//   the page, so a stored file is valid exactly while its page is clean and
+//   at that revision; edited pages simply miss and are re-rendered
+// - variant covers everything else that changes the pixels: physical width,
+//   PDF dark mode, and the content hashes of the PDF sources (relink)
+// - One file per page: saving a thumbnail removes the page's older ones;
+//   prune() removes files of pages no longer in the document
+//
+// Thread safety: all functions are static and only touch the filesystem;
+// call load()/save()/prune() from worker threads. makeKey() reads the
+// Document and is main thread only.
+// ============================================================================
+
+#include <QImage>
+#include <QSet>
+#include <QString>
+
+class Document;
+
+class ThumbnailStore {
+public:
+    /// Directory inside the bundle.
+    static constexpr const char* DIR_NAME = "thumbnails";
+
+    /**
+     * @brief Identity of one stored thumbnail.
+     */
+    struct Key {
+        QString pageUuid;
+        quint32 revision = 0;
+        QString variant;    ///< Render parameters (size, dark mode, PDF sources)
+
+        bool isValid() const { return !pageUuid.isEmpty() && !variant.isEmpty(); }
+    };
+
+    /**
+     * @brief Key of a page's current saved state (main thread).
+     * @return An invalid key if the page has unsaved changes or the
+     *         document has no bundle yet - such thumbnails are not stored.
+     */
+    static Key makeKey(const Document* doc, int pageIndex, int physicalWidth, bool pdfDarkMode);
+
+    /// Stored thumbnail for @p key, or a null image.
+    static QImage load(const QString& bundlePath, const Key& key);
+
+    /**
+     * @brief Store a thumbnail atomically and drop the page's older ones.
+     * @return False if the file could not be written.
+     */
+    static bool save(const QString& bundlePath, const Key& key, const QImage& image);
+
+    /// Remove thumbnails of pages not in @p pageUuids.
+    static void prune(const QString& bundlePath, const QSet<QString>& pageUuids);
+
+private:
+    static QString fileName(const Key& key);
+};
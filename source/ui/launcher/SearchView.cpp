@@ -4,12 +4,14 @@
 #include "NotebookCardDelegate.h"
 #include "../ThemeColors.h"
 #include "../../core/NotebookLibrary.h"
+#include "../../core/LibraryContentIndex.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QKeyEvent>
 #include <QPainter>
 #include <QPainterPath>
+#include <QSet>
 
 // ============================================================================
 // CompositeSearchDelegate - Handles section headers, folder items, notebook cards
@@ -212,6 +214,10 @@ SearchView::SearchView(QWidget* parent)
     m_debounceTimer->setSingleShot(true);
     m_debounceTimer->setInterval(DEBOUNCE_MS);
     connect(m_debounceTimer, &QTimer::timeout, this, &SearchView::performSearch);
+    
+    // Content matches stream in while the library index is (re)built
+    connect(NotebookLibrary::instance()->contentIndex(), &LibraryContentIndex::indexUpdated,
+            this, &SearchView::onContentIndexUpdated);
 }
 
 void SearchView::setupUi()
@@ -342,6 +348,7 @@ void SearchView::clearSearch()
 {
     m_searchInput->clear();
     m_lastQuery.clear();
+    m_lastResultPaths.clear();
     m_clearButton->setVisible(false);
     m_statusLabel->setVisible(false);
     m_model->clear();
@@ -352,6 +359,9 @@ void SearchView::focusSearchInput()
 {
     m_searchInput->setFocus();
     m_searchInput->selectAll();
+    
+    // Pick up notebooks edited since the view was last shown
+    NotebookLibrary::instance()->refreshContentIndex();
 }
 
 void SearchView::onSearchTextChanged(const QString& text)
@@ -381,17 +391,52 @@ void SearchView::performSearch()
     m_lastQuery = query;
     
     if (query.isEmpty()) {
+        m_lastResultPaths.clear();
         m_model->clear();
         m_statusLabel->setVisible(false);
         showEmptyState(tr("Type to search notebooks and folders"));
         return;
     }
     
-    // Perform search for both folders and notebooks (L-009)
+    showSearchResults(query);
+}
+
+void SearchView::onContentIndexUpdated()
+{
+    if (m_lastQuery.isEmpty()) {
+        return;
+    }
+    // Only rebuild (and reset the scroll position) if the results changed
+    showSearchResults(m_lastQuery, true);
+}
+
+void SearchView::showSearchResults(const QString& query, bool onlyIfChanged)
+{
+    // Perform search for both folders and notebooks (L-009).
+    // Name matches come first, then notebooks whose contents match.
     NotebookLibrary* lib = NotebookLibrary::instance();
     QStringList folders = lib->searchStarredFolders(query);
     QList<NotebookInfo> notebooks = lib->search(query);
     
+    QStringList resultPaths = folders;
+    QSet<QString> nameMatches;
+    for (const NotebookInfo& nb : notebooks) {
+        nameMatches.insert(nb.bundlePath);
+        resultPaths.append(nb.bundlePath);
+    }
+    const QList<NotebookInfo> contentMatches = lib->searchContent(query);
+    for (const NotebookInfo& nb : contentMatches) {
+        if (!nameMatches.contains(nb.bundlePath)) {
+            notebooks.append(nb);
+            resultPaths.append(nb.bundlePath);
+        }
+    }
+    
+    if (onlyIfChanged && resultPaths == m_lastResultPaths) {
+        return;
+    }
+    m_lastResultPaths = resultPaths;
+    
     int folderCount = static_cast<int>(folders.size());
     int notebookCount = static_cast<int>(notebooks.size());
     int totalCount = folderCount + notebookCount;
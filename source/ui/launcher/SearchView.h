@@ -5,6 +5,7 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QLabel>
+#include <QStringList>
 #include <QTimer>
 #include <QStyledItemDelegate>
 
@@ -16,7 +17,9 @@ struct NotebookInfo;
 /**
  * @brief Search view for the Launcher.
  * 
- * Provides search functionality for notebooks by name and PDF filename.
+ * Provides search functionality for notebooks by name and PDF filename,
+ * and by contents (PDF text, OCR, markdown notes) through the library's
+ * LibraryContentIndex.
  * 
  * Features:
  * - Search input with clear button
@@ -26,7 +29,8 @@ struct NotebookInfo;
  * - Keyboard-friendly: Enter to search, Escape to clear
  * - Touch-friendly scrolling with kinetic momentum
  * 
- * Search scope (per Q&A): Notebook names + PDF filenames
+ * Search scope: notebook names + PDF filenames first, then content matches
+ * ranked by relevance (these fill in while the content index is updating).
  * 
  * Phase P.3: Refactored to use Model/View for virtualization and performance.
  */
@@ -77,6 +81,7 @@ private slots:
     void onSearchTextChanged(const QString& text);
     void onSearchTriggered();
     void performSearch();
+    void onContentIndexUpdated();
     
     // Slots for list view signals
     void onNotebookClicked(const QString& bundlePath);
@@ -85,6 +90,7 @@ private slots:
 
 private:
     void setupUi();
+    void showSearchResults(const QString& query, bool onlyIfChanged = false);
     void showEmptyState(const QString& message);
     void showResults();
     void updateSearchIcon();
@@ -109,6 +115,7 @@ private:
     QTimer* m_debounceTimer = nullptr;
     
     QString m_lastQuery;
+    QStringList m_lastResultPaths;  ///< Folders + bundle paths currently shown
     bool m_darkMode = false;
     
     // Constants